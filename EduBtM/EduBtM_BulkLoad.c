@@ -0,0 +1,725 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_BulkLoad.c
+ *
+ * Description :
+ *  Build a B+tree index from items sorted by the key value. The items are
+ *  cut into contiguous chunks, and the leaves of the chunks are built by
+ *  threads in parallel into pages allocated beforehand. The internal levels
+ *  are built afterwards from the first keys of the leaves, and the top level
+ *  goes into the root page, which keeps its PageID.
+ *
+ * Exports:
+ *  Four EduBtM_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four, Pool*, DeallocListElem*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "RDsM.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+#include "OM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four, Pool*, DeallocListElem*);
+Four edubtm_RunBulkChunks(btm_BulkChunk*, Four, void *(*)(void*));
+void *edubtm_PlanBulkLeaves(void*);
+void *edubtm_BuildBulkLeaves(void*);
+Four edubtm_BuildBulkLevels(ObjectID*, PageID*, BatchItem*, Four*, ShortPageID*, Four, PageID*, Four*);
+Four edubtm_BulkInternalEnd(BatchItem*, Four*, Four, Four, Four);
+void edubtm_FillBulkLeaf(BtreeLeaf*, BatchItem*, Four, Four);
+void edubtm_FillBulkInternal(BtreeInternal*, BatchItem*, Four*, ShortPageID*, Four, Four);
+
+
+
+/*@================================
+ * EduBtM_BulkLoad()
+ *================================*/
+/*
+ * Function: Four EduBtM_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four,
+ *                             Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Load 'nItems' items into an empty index with at most 'nWorkers' threads.
+ *  The items should be sorted by the key value, with no key value twice;
+ *  this is checked while the leaves are planned, before any page is
+ *  allocated. The pages are filled up to BTM_BULKLOAD_FILL percent, so that
+ *  the first inserts after the load do not split them at once.
+ *
+ *  The index is latched exclusively for the whole load. If the load fails
+ *  after the pages have been allocated, they are put into the dealloc list
+ *  and the index is left empty.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eDUPLICATEDKEY_BTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_BulkLoad(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of an empty index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    Four                        nItems,         /* IN # of items */
+    BatchItem                   *items,         /* IN the items, sorted by the key value */
+    Four                        nWorkers,       /* IN # of threads at most */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    int                         i;
+    Four                        e;              /* error number */
+
+
+    if (catObjForFile == NULL || root == NULL || kdesc == NULL) ERR(eBADPARAMETER_BTM);
+    if (nItems < 0 || (nItems > 0 && items == NULL)) ERR(eBADPARAMETER_BTM);
+    if (nWorkers < 1 || nWorkers > BTM_MAXBULKLOADWORKERS) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    if (nItems == 0) return(eNOERROR);
+
+    /* No one else reads the index while it is built */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    e = edubtm_BulkLoad(catObjForFile, root, kdesc, nItems, items, nWorkers, dlPool, dlHead);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* EduBtM_BulkLoad() */
+
+
+
+/*@================================
+ * edubtm_BulkLoad()
+ *================================*/
+/*
+ * Function: Four edubtm_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four,
+ *                             Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Do the bulk load of EduBtM_BulkLoad(...) under the latch of the tree.
+ *
+ *  1) The threads plan the leaves of their chunks: each finds the first
+ *     item of every leaf, checking the order of the items on the way.
+ *  2) All the leaves are allocated by one call of the disk manager, so that
+ *     each chunk gets a contiguous range of them.
+ *  3) The threads fill their leaves; the links between the leaves, at the
+ *     boundaries of the chunks too, are known from the allocated range.
+ *  4) The internal levels are built, and the top one goes into the root.
+ *
+ *  The buffer manager mutex is held only around the calls of the buffer
+ *  manager, so that the threads fill their pages at the same time.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_BulkLoad(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of an empty index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    Four                        nItems,         /* IN # of items */
+    BatchItem                   *items,         /* IN the items, sorted by the key value */
+    Four                        nWorkers,       /* IN # of threads at most */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Four                        c;              /* index of a chunk */
+    Four                        i;              /* index */
+    Four                        nChunks;        /* # of chunks */
+    Four                        nLeaves;        /* # of leaves */
+    Four                        nPages;         /* # of pages allocated */
+    Four                        firstExtNo;     /* first extent of the index file */
+    Boolean                     empty;          /* TRUE if the index is empty */
+    Boolean                     filtered;       /* TRUE if the index keeps a Bloom filter */
+    Two                         eff;            /* extent fill factor of the index file */
+    PhysicalFileID              pFid;           /* physical file ID of the index file */
+    SlottedPage                 *catPage;       /* buffer page containing the catalog object */
+    sm_CatOverlayForBtree       *catEntry;      /* B+ tree file catalog information */
+    BtreePage                   *apage;         /* pointer to the buffer holding a page */
+    Four                        *leafStart;     /* first item of each leaf */
+    PageID                      *pages;         /* the pages allocated: the leaves, then the internal pages */
+    ShortPageID                 *level;         /* pages of a level being built */
+    DeallocListElem             *dlElem;        /* an element of dealloc list */
+    btm_BulkChunk               chunks[BTM_MAXBULKLOADWORKERS]; /* the chunks */
+
+
+    edubtm_EnterBfM();
+
+    /* The items go only into an empty index */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    empty = ((apage->any.hdr.type & LEAF) && apage->bl.hdr.nSlots == 0) ? TRUE : FALSE;
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    if (!empty) { edubtm_LeaveBfM(); ERR(eBADPARAMETER_BTM); }
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    eff = catEntry->eff;
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    edubtm_LeaveBfM();
+
+    if ((leafStart = (Four*)malloc(sizeof(Four)*(nItems+1))) == NULL) ERR(eMEMORYALLOCERR_BTM);
+
+    /* 1) Plan the leaves of the chunks */
+    nChunks = MIN(nWorkers, nItems/BTM_BULKLOAD_MINCHUNK);
+    if (nChunks < 1) nChunks = 1;
+    for (c = 0; c < nChunks; c++) {
+        chunks[c].kdesc = kdesc;
+        chunks[c].items = items;
+        chunks[c].from = (Four)(((double)nItems*c)/nChunks);
+        chunks[c].to = (Four)(((double)nItems*(c+1))/nChunks);
+        chunks[c].leafStart = leafStart;
+    }
+
+    if ((e = edubtm_RunBulkChunks(chunks, nChunks, edubtm_PlanBulkLeaves)) < 0) {
+        free(leafStart);
+        ERR(e);
+    }
+
+    /* The chunk writes its leaves from leafStart[from]; they are moved together */
+    for (c = 0, nLeaves = 0; c < nChunks; c++) {
+        for (i = 0; i < chunks[c].nLeaves; i++)
+            leafStart[nLeaves + i] = leafStart[chunks[c].from + i];
+        chunks[c].firstLeaf = nLeaves;
+        nLeaves += chunks[c].nLeaves;
+    }
+    leafStart[nLeaves] = nItems;
+
+    edubtm_EnterBfM();
+
+    /* A single leaf is the root itself */
+    if (nLeaves == 1) {
+        e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF);
+        if (e >= 0) {
+            edubtm_FillBulkLeaf(&(apage->bl), items, 0, nItems);
+            if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) (Four) BfM_FreeTrain((TrainID*)root, PAGE_BUF);
+            else e = BfM_FreeTrain((TrainID*)root, PAGE_BUF);
+        }
+        edubtm_LeaveBfM();
+        free(leafStart);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    /* The internal pages are fewer than the leaves */
+    if ((pages = (PageID*)malloc(sizeof(PageID)*2*nLeaves)) == NULL ||
+        (level = (ShortPageID*)malloc(sizeof(ShortPageID)*nLeaves)) == NULL) {
+        edubtm_LeaveBfM();
+        if (pages != NULL) free(pages);
+        free(leafStart);
+        ERR(eMEMORYALLOCERR_BTM);
+    }
+
+    /* 2) Allocate all the leaves at once, near the root */
+    nPages = 0;
+    e = RDsM_PageIdToExtNo((PageID*)&pFid, &firstExtNo);
+    if (e >= 0) e = RDsM_AllocTrains(root->volNo, firstExtNo, root, eff, nLeaves, PAGESIZE2, pages);
+    if (e >= 0) nPages = nLeaves;
+
+    edubtm_LeaveBfM();
+
+    /* 3) Fill the leaves */
+    if (e >= 0) {
+        for (c = 0; c < nChunks; c++) {
+            chunks[c].nAllLeaves = nLeaves;
+            chunks[c].leaves = pages;
+        }
+        e = edubtm_RunBulkChunks(chunks, nChunks, edubtm_BuildBulkLeaves);
+    }
+
+    /* 4) Build the internal levels from the leaves */
+    if (e >= 0) {
+        for (i = 0; i < nLeaves; i++) level[i] = pages[i].pageNo;
+
+        edubtm_EnterBfM();
+        e = edubtm_BuildBulkLevels(catObjForFile, root, items, leafStart, level, nLeaves, pages, &nPages);
+
+        /* The root has become an internal page */
+        if (e >= 0) edubtm_StaleUpperCache(root);
+
+        /* The first and the last of the allocated leaves are the end leaves */
+        if (e >= 0) e = edubtm_NoteEndLeaves(catObjForFile, root, pages[0].pageNo, pages[nLeaves-1].pageNo);
+
+        /* The Bloom filter of the index is sized for the loaded key values */
+        if (e >= 0) e = edubtm_IsBloomFiltered(root, &filtered);
+        if (e >= 0 && filtered) e = edubtm_BuildBloomFilter(catObjForFile, root, kdesc);
+        edubtm_LeaveBfM();
+    }
+
+    /* The pages of a failed load are freed; the root is not changed then */
+    if (e < 0) {
+        for (i = 0; i < nPages; i++) {
+            if (Util_getElementFromPool(dlPool, &dlElem) < 0) break;
+            dlElem->type = DL_PAGE;
+            dlElem->elem.pid = pages[i];
+            dlElem->next = dlHead->next;
+            dlHead->next = dlElem;
+        }
+    }
+
+    free(level);
+    free(pages);
+    free(leafStart);
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_BulkLoad() */
+
+
+
+/*@================================
+ * edubtm_RunBulkChunks()
+ *================================*/
+/*
+ * Function: Four edubtm_RunBulkChunks(btm_BulkChunk*, Four, void *(*)(void*))
+ *
+ * Description :
+ *  Run 'work' on every chunk with a thread of its own, and wait for all of
+ *  them. A chunk whose thread cannot be created is done by the caller.
+ *
+ * Returns:
+ *  the first error of the chunks
+ */
+Four edubtm_RunBulkChunks(
+    btm_BulkChunk               *chunks,        /* INOUT the chunks */
+    Four                        nChunks,        /* IN # of chunks */
+    void                        *(*work)(void*)) /* IN the work on a chunk */
+{
+    Four                        c;              /* index of a chunk */
+    Four                        e;              /* error number */
+
+
+    for (c = 0; c < nChunks; c++) {
+        chunks[c].error = eNOERROR;
+        chunks[c].started = (pthread_create(&chunks[c].thread, NULL, work, &chunks[c]) == 0) ? TRUE : FALSE;
+    }
+
+    for (c = 0; c < nChunks; c++)
+        if (!chunks[c].started) (void) (*work)(&chunks[c]);
+
+    e = eNOERROR;
+    for (c = 0; c < nChunks; c++) {
+        if (chunks[c].started) pthread_join(chunks[c].thread, NULL);
+        if (e == eNOERROR && chunks[c].error < 0) e = chunks[c].error;
+    }
+
+    return(e);
+
+} /* edubtm_RunBulkChunks() */
+
+
+
+/*@================================
+ * edubtm_PlanBulkLeaves()
+ *================================*/
+/*
+ * Function: void *edubtm_PlanBulkLeaves(void*)
+ *
+ * Description :
+ *  Cut the items of a chunk into leaves, filling each leaf up to
+ *  BTM_BULKLOAD_FILL percent, and record the first item of every leaf from
+ *  leafStart[from]. The key values are checked to be ascending, with the
+ *  last item of the previous chunk too.
+ *
+ * Returns:
+ *  NULL; the error is kept in the chunk
+ */
+void *edubtm_PlanBulkLeaves(
+    void                        *arg)           /* IN the chunk, btm_BulkChunk* */
+{
+    Four                        i;              /* index of an item */
+    Four                        cmp;            /* result of a comparison */
+    Four                        len;            /* space taken by an entry */
+    Four                        used;           /* space taken in the current leaf */
+    Four                        limit;          /* space to be filled in a leaf */
+    btm_BulkChunk               *chunk;         /* the chunk */
+
+
+    chunk = (btm_BulkChunk*)arg;
+    limit = ((PAGESIZE - BL_FIXED + sizeof(Two)) * BTM_BULKLOAD_FILL) / 100;
+
+    chunk->nLeaves = 0;
+    used = 0;
+
+    for (i = chunk->from; i < chunk->to; i++) {
+        if (i > 0) {
+            cmp = edubtm_KeyCompare(chunk->kdesc, &(chunk->items[i-1].kval), &(chunk->items[i].kval));
+            if (cmp != LESS) {
+                chunk->error = (cmp == EQUAL) ? eDUPLICATEDKEY_BTM : eBADPARAMETER_BTM;
+                return(NULL);
+            }
+        }
+
+        len = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(chunk->items[i].kval.len) + OBJECTID_SIZE + sizeof(Two);
+
+        /* A leaf has at least one entry */
+        if (chunk->nLeaves == 0 || used + len > limit) {
+            chunk->leafStart[chunk->from + chunk->nLeaves++] = i;
+            used = 0;
+        }
+        used += len;
+    }
+
+    return(NULL);
+
+} /* edubtm_PlanBulkLeaves() */
+
+
+
+/*@================================
+ * edubtm_BuildBulkLeaves()
+ *================================*/
+/*
+ * Function: void *edubtm_BuildBulkLeaves(void*)
+ *
+ * Description :
+ *  Fill the leaves of a chunk as planned. The leaves of all the chunks were
+ *  allocated in the key order, so the neighbors of the first and the last
+ *  leaf of the chunk are known without waiting for the other chunks.
+ *
+ * Returns:
+ *  NULL; the error is kept in the chunk
+ */
+void *edubtm_BuildBulkLeaves(
+    void                        *arg)           /* IN the chunk, btm_BulkChunk* */
+{
+    Four                        e;              /* error number */
+    Four                        g;              /* ordinal of a leaf among all the leaves */
+    PageID                      pid;            /* the leaf */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+    btm_BulkChunk               *chunk;         /* the chunk */
+
+
+    chunk = (btm_BulkChunk*)arg;
+
+    for (g = chunk->firstLeaf; g < chunk->firstLeaf + chunk->nLeaves; g++) {
+        pid = chunk->leaves[g];
+
+        edubtm_EnterBfM();
+        e = edubtm_InitLeaf(&pid, FALSE, FALSE);
+        if (e >= 0) e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+        edubtm_LeaveBfM();
+        if (e < 0) {
+            chunk->error = e;
+            return(NULL);
+        }
+
+        /* The page is fixed; it is filled outside of the buffer manager mutex */
+        edubtm_FillBulkLeaf(&(apage->bl), chunk->items, chunk->leafStart[g], chunk->leafStart[g+1]);
+        apage->bl.hdr.prevPage = (g > 0) ? chunk->leaves[g-1].pageNo : NIL;
+        apage->bl.hdr.nextPage = (g < chunk->nAllLeaves-1) ? chunk->leaves[g+1].pageNo : NIL;
+
+        edubtm_EnterBfM();
+        if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+        else e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+        edubtm_LeaveBfM();
+        if (e < 0) {
+            chunk->error = e;
+            return(NULL);
+        }
+    }
+
+    return(NULL);
+
+} /* edubtm_BuildBulkLeaves() */
+
+
+
+/*@================================
+ * edubtm_BuildBulkLevels()
+ *================================*/
+/*
+ * Function: Four edubtm_BuildBulkLevels(ObjectID*, PageID*, BatchItem*, Four*, ShortPageID*,
+ *                                    Four, PageID*, Four*)
+ *
+ * Description :
+ *  Build the internal levels over the pages 'level', whose first items are
+ *  given in 'first'. A level is packed into new internal pages until it
+ *  fits in one page, which is then written into the root page; the root
+ *  keeps its flags and its meta page. The arrays are overwritten by the
+ *  levels built, and the new pages are appended to 'pages'.
+ *
+ *  The caller should be in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_BuildBulkLevels(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the index */
+    BatchItem                   *items,         /* IN the items */
+    Four                        *first,         /* INOUT first item of each page of the level */
+    ShortPageID                 *level,         /* INOUT pages of the level */
+    Four                        nPages,         /* IN # of pages of the level */
+    PageID                      *pages,         /* INOUT pages allocated */
+    Four                        *nAllocated)    /* INOUT # of pages allocated */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* first child of the page being built */
+    Four                        j;              /* the child after the last one of the page */
+    Four                        n;              /* # of pages of the level built */
+    Four                        limit;          /* space to be filled in a non-root page */
+    Four                        flags;          /* flags of the root */
+    Four                        reserved;       /* meta page of the root */
+    Boolean                     leafParent;     /* TRUE if the children are leaves */
+    PageID                      near;           /* page near which a page is allocated */
+    PageID                      newPid;         /* a new internal page */
+    BtreePage                   *apage;         /* pointer to the buffer holding a page */
+
+
+    limit = ((PAGESIZE - BI_FIXED + sizeof(Two)) * BTM_BULKLOAD_FILL) / 100;
+    leafParent = TRUE;
+    near = pages[*nAllocated - 1];
+
+    /* Pack the levels into new pages until one fits in the root */
+    while (edubtm_BulkInternalEnd(items, first, 0, nPages, PAGESIZE - BI_FIXED + sizeof(Two)) < nPages) {
+
+        for (i = 0, n = 0; i < nPages; i = j, n++) {
+            j = edubtm_BulkInternalEnd(items, first, i, nPages, limit);
+
+            if ((e = btm_AllocPage(catObjForFile, &near, &newPid)) < 0) ERR(e);
+            pages[(*nAllocated)++] = newPid;
+            near = newPid;
+
+            if ((e = edubtm_InitInternal(&newPid, FALSE, FALSE)) < 0) ERR(e);
+            if ((e = BfM_GetTrain((TrainID*)&newPid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+            if (leafParent) apage->bi.hdr.flags |= BTM_LEAFPARENT;
+            edubtm_FillBulkInternal(&(apage->bi), items, first, level, i, j);
+
+            if ((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF)) < 0) ERRB1(e, &newPid, PAGE_BUF);
+            if ((e = BfM_FreeTrain((TrainID*)&newPid, PAGE_BUF)) < 0) ERR(e);
+
+            /* The page takes the place of its first child; n <= i */
+            level[n] = newPid.pageNo;
+            first[n] = first[i];
+        }
+
+        nPages = n;
+        leafParent = FALSE;
+    }
+
+    /* The top level goes into the root page */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+    flags = apage->any.hdr.flags;
+    reserved = apage->any.hdr.reserved;
+
+    if ((e = edubtm_InitInternal(root, TRUE, FALSE)) < 0) ERRB1(e, root, PAGE_BUF);
+    apage->bi.hdr.flags |= (flags & BTM_ROOTFLAGS);
+    if (leafParent) apage->bi.hdr.flags |= BTM_LEAFPARENT;
+    apage->bi.hdr.reserved = reserved;
+
+    edubtm_FillBulkInternal(&(apage->bi), items, first, level, 0, nPages);
+
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_BuildBulkLevels() */
+
+
+
+/*@================================
+ * edubtm_BulkInternalEnd()
+ *================================*/
+/*
+ * Function: Four edubtm_BulkInternalEnd(BatchItem*, Four*, Four, Four, Four)
+ *
+ * Description :
+ *  Decide which children, from the child 'from' on, go into one internal
+ *  page holding at most 'limit' bytes of entries and slots. The first child
+ *  becomes 'p0' and takes no entry. A page gets at least two children, and
+ *  the last page of the level is not left with a single child.
+ *
+ * Returns:
+ *  the child after the last one of the page
+ */
+Four edubtm_BulkInternalEnd(
+    BatchItem                   *items,         /* IN the items */
+    Four                        *first,         /* IN first item of each child */
+    Four                        from,           /* IN first child of the page */
+    Four                        nChildren,      /* IN # of children of the level */
+    Four                        limit)          /* IN space of the page */
+{
+    Four                        j;              /* a child */
+    Four                        len;            /* space taken by an entry */
+    Four                        used;           /* space taken in the page */
+
+
+    used = 0;
+    for (j = from + 1; j < nChildren; j++) {
+        len = BTM_INTERNALENTRY_LEN(items[first[j]].kval.len) + sizeof(Two);
+        if (used + len > limit) break;
+        used += len;
+    }
+
+    if (j == from + 1 && j < nChildren) j++;
+
+    /* A single child left over goes with the previous page or joins this one */
+    if (nChildren - j == 1) j = (j - from >= 3) ? j - 1 : nChildren;
+
+    return(j);
+
+} /* edubtm_BulkInternalEnd() */
+
+
+
+/*@================================
+ * edubtm_FillBulkLeaf()
+ *================================*/
+/*
+ * Function: void edubtm_FillBulkLeaf(BtreeLeaf*, BatchItem*, Four, Four)
+ *
+ * Description :
+ *  Write the items 'from' up to 'to' into an empty leaf, in order. Each key
+ *  value has a single ObjectID, as with EduBtM_InsertObject(...).
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_FillBulkLeaf(
+    BtreeLeaf                   *page,          /* INOUT the leaf */
+    BatchItem                   *items,         /* IN the items */
+    Four                        from,           /* IN first item */
+    Four                        to)             /* IN the item after the last one */
+{
+    Four                        i;              /* index of an item */
+    Two                         alignedKlen;    /* aligned length of the key */
+    btm_LeafEntry               *entry;         /* an entry of the leaf */
+
+
+    page->hdr.nSlots = 0;
+    page->hdr.free = 0;
+    page->hdr.unused = 0;
+
+    for (i = from; i < to; i++) {
+        entry = (btm_LeafEntry*)&(page->data[page->hdr.free]);
+        alignedKlen = ALIGNED_LENGTH(items[i].kval.len);
+
+        entry->nObjects = 1;
+        entry->klen = items[i].kval.len;
+        memcpy(entry->kval, items[i].kval.val, items[i].kval.len);
+        memcpy(&(entry->kval[alignedKlen]), &(items[i].oid), OBJECTID_SIZE);
+
+        page->slot[-page->hdr.nSlots] = page->hdr.free;
+        page->hdr.nSlots++;
+        page->hdr.free += BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
+    }
+
+} /* edubtm_FillBulkLeaf() */
+
+
+
+/*@================================
+ * edubtm_FillBulkInternal()
+ *================================*/
+/*
+ * Function: void edubtm_FillBulkInternal(BtreeInternal*, BatchItem*, Four*, ShortPageID*, Four, Four)
+ *
+ * Description :
+ *  Write the children 'from' up to 'to' into an empty internal page: the
+ *  first one as 'p0', and each of the others with the first key value
+ *  under it.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_FillBulkInternal(
+    BtreeInternal               *page,          /* INOUT the internal page */
+    BatchItem                   *items,         /* IN the items */
+    Four                        *first,         /* IN first item of each child */
+    ShortPageID                 *children,      /* IN the children */
+    Four                        from,           /* IN first child */
+    Four                        to)             /* IN the child after the last one */
+{
+    Four                        j;              /* index of a child */
+    KeyValue                    *kval;          /* key value of a child */
+    btm_InternalEntry           *entry;         /* an entry of the page */
+
+
+    page->hdr.p0 = children[from];
+
+    for (j = from + 1; j < to; j++) {
+        kval = &(items[first[j]].kval);
+        entry = (btm_InternalEntry*)&(page->data[page->hdr.free]);
+
+        entry->spid = children[j];
+        entry->klen = kval->len;
+        memcpy(entry->kval, kval->val, kval->len);
+
+        page->slot[-page->hdr.nSlots] = page->hdr.free;
+        page->hdr.nSlots++;
+        page->hdr.free += BTM_INTERNALENTRY_LEN(kval->len);
+    }
+
+} /* edubtm_FillBulkInternal() */
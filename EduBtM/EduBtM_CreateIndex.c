@@ -96,8 +96,11 @@ Four EduBtM_CreateIndex(
     PhysicalFileID pFid;	/* physical file ID */
     /**/
 
+    /* The new root is not visible to other threads, only the buffer manager is shared */
+    edubtm_EnterBfM();
+
     /* Fix the page to the buffer */    
-    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
 
     GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
     
@@ -106,14 +109,15 @@ Four EduBtM_CreateIndex(
     MAKE_PAGEID(*rootPid, pFid.volNo, catEntry->firstPage); 
 
     /* Allocate a new page to be used as a B+ index page, pid = catEntry->firstPage */
-    if((e = btm_AllocPage(catObjForFile, (PageID*)&pFid, rootPid))<0) ERR(e);
+    if((e = btm_AllocPage(catObjForFile, (PageID*)&pFid, rootPid))<0) { edubtm_LeaveBfM(); ERR(e); }
 
     /* Initiate the page as a leaf page */
-    if((e = edubtm_InitLeaf(rootPid, TRUE, FALSE))<0) ERR(e);
+    if((e = edubtm_InitLeaf(rootPid, TRUE, FALSE))<0) { edubtm_LeaveBfM(); ERR(e); }
 
     /* Unfix the page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF))<0) ERR(e);
+    if((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF))<0) { edubtm_LeaveBfM(); ERR(e); }
     /**/
+    edubtm_LeaveBfM();
     return(eNOERROR);
     
 } /* EduBtM_CreateIndex() */
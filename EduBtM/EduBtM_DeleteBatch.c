@@ -0,0 +1,437 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_DeleteBatch.c
+ *
+ * Description :
+ *  Delete from a B+tree a set of (key value, ObjectID) pairs. Each leaf
+ *  page affected by the batch is visited only once.
+ *
+ * Exports:
+ *  Four EduBtM_DeleteBatch(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Pool*, DeallocListElem*)
+ */
+
+
+#include <stdlib.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "OM_Internal.h"	/* for "SlottedPage" including catalog object */
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+void edubtm_SortBatchItems(KeyDesc*, BatchItem*, Four*, Four);
+Four edubtm_BatchItemCompare(KeyDesc*, BatchItem*, BatchItem*);
+Four edubtm_DeleteBatch(PhysicalFileID*, PageID*, KeyDesc*, BatchItem*, Four*, Four, Four, Four*, Pool*, DeallocListElem*);
+
+
+
+/*@================================
+ * EduBtM_DeleteBatch()
+ *================================*/
+/*
+ * Function: Four EduBtM_DeleteBatch(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*,
+ *                                   Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Delete from a B+tree the 'nItems' (key value, ObjectID) pairs given in
+ *  'items'. Pairs which do not exist in the B+tree are ignored.
+ *
+ *  The pairs are sorted first, and then the tree is traversed once: each
+ *  internal page distributes the sorted pairs among its children, and each
+ *  affected leaf is fixed once, removing all the matching ObjectIDs from
+ *  its ObjectID arrays in one pass. EduBtM keeps every ObjectID of a key in
+ *  its leaf entry; there are no overflow page lists. An array of the
+ *  indexes of the pairs is sorted, so 'items' is left as the caller gave it.
+ *
+ *  The merge or redistribution of the leaves which are not half full any
+ *  more is deferred to the end of the batch, when it is done once per leaf.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_DeleteBatch(
+    ObjectID *catObjForFile,	/* IN catalog object of B+-tree file */
+    PageID   *root,		/* IN root Page IDentifier */
+    KeyDesc  *kdesc,		/* IN a key descriptor */
+    Four     nItems,		/* IN # of (key value, ObjectID) pairs */
+    BatchItem *items,		/* IN (key value, ObjectID) pairs to delete */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    int		i;
+    Four    e;			/* error number */
+    Four    nUnderflows;	/* # of leaves which are not half full */
+    Boolean lf;			/* flag for merging */
+    Boolean lh;			/* flag for splitting */
+    InternalItem item;		/* Internal item */
+    SlottedPage *catPage;	/* buffer page containing the catalog object */
+    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
+    PhysicalFileID pFid;        /* B+-tree file's FileID */
+    Four    *order;		/* indexes of the pairs in the sorted order */
+    DeallocListElem *dlMark;	/* first element of the dealloc list before the batch */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (nItems < 0 || (nItems > 0 && items == NULL)) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    if (nItems == 0) return(eNOERROR);
+
+    /* Merges and splits of the batch may reach any page of the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    /* A batch is not written to the side log of a build */
+    if (edubtm_InOnlineBuild(root)) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    edubtm_EnterBfM();
+    dlMark = dlHead->next;
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERRTL(e, root);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    if ((order = (Four*)malloc(sizeof(Four)*nItems)) == NULL) ERRTL(eMEMORYALLOCERR_BTM, root);
+
+    /* Sort the pairs in the order of the leaf entries */
+    for (i = 0; i < nItems; i++) order[i] = i;
+    edubtm_SortBatchItems(kdesc, items, order, nItems);
+
+    /* The pending messages of the pairs should reach the leaves first */
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, &(items[order[0]].kval), &(items[order[nItems-1]].kval),
+                                         dlPool, dlHead)) < 0) { free(order); ERRTL(e, root); }
+
+    /* Delete the pairs visiting each affected leaf once */
+    nUnderflows = 0;
+    if ((e = edubtm_DeleteBatch(&pFid, root, kdesc, items, order, 0, nItems, &nUnderflows, dlPool, dlHead)) < 0) {
+        free(order);
+        ERRTL(e, root);
+    }
+
+    /*
+     * The pairs having the key values of the leaves which are not half full
+     * are now at order[0] ... order[nUnderflows-1]. Merge or redistribute them.
+     */
+    for (i = 0; i < nUnderflows; i++) {
+        if ((e = edubtm_RepairUnderflow(catObjForFile, root, kdesc, &(items[order[i]].kval), &lf, &lh, &item, dlPool, dlHead)) < 0) {
+            free(order);
+            ERRTL(e, root);
+        }
+
+        if (lh) {
+            if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) { free(order); ERRTL(e, root); }
+        }
+        else if (lf) {
+            if ((e = edubtm_root_delete(catObjForFile, root, kdesc, dlPool, dlHead)) < 0) { free(order); ERRTL(e, root); }
+        }
+    }
+
+    free(order);
+
+    /* The emptied pages are kept for the later splits instead of going back to the volume */
+    if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_DeleteBatch() */
+
+
+
+/*@================================
+ * edubtm_DeleteBatch()
+ *================================*/
+/*
+ * Function: Four edubtm_DeleteBatch(PhysicalFileID*, PageID*, KeyDesc*, BatchItem*, Four*,
+ *                                   Four, Four, Four*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the pairs items[order[first]] ... items[order[last-1]], which are
+ *  in the sorted order, from the subtree whose root is 'root'.
+ *
+ *  In an internal page, the pairs are partitioned into the runs routed to
+ *  the same child, and each run is deleted from its child recursively. In a
+ *  leaf page, the ObjectIDs of each run of the same key value are removed
+ *  from the entry by merging the two sorted lists.
+ *
+ *  When a leaf is not half full after the deletion, order[first] is copied
+ *  into order[*nUnderflows] so that the caller can repair the leaf later by
+ *  its key value. This never overwrites an unprocessed index since every
+ *  leaf consumes at least one pair.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_DeleteBatch(
+    PhysicalFileID              *pFid,          /* IN FileID of the Btree file */
+    PageID                      *root,          /* IN root of the subtree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    BatchItem                   *items,         /* IN pairs to delete */
+    Four                        *order,         /* INOUT indexes of the pairs in the sorted order */
+    Four                        first,          /* IN first index of 'order' to delete */
+    Four                        last,           /* IN one past the last index of 'order' to delete */
+    Four                        *nUnderflows,   /* INOUT # of leaves which are not half full */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of the first pair of a run */
+    Four                        j;              /* index one past the last pair of a run */
+    Two                         idx;            /* the index by the binary search */
+    Two                         k;              /* index of the ObjectID array */
+    Two                         nObjects;       /* # of remaining ObjectIDs */
+    Four                        m;              /* index of the pairs in a run */
+    Boolean                     found;          /* search result */
+    Boolean                     dirty;          /* TRUE if the leaf is changed */
+    Four                        cmp;            /* result of the ObjectID comparison */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+    ObjectID                    *oidArray;      /* ObjectID array of a leaf entry */
+    Two                         alignedKlen;    /* aligned length of the key length */
+
+
+    /* Fix the root page to the buffer */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    if (apage->any.hdr.type & INTERNAL) {
+
+        for (i = first; i < last; i = j) {
+            edubtm_BinarySearchInternal(&(apage->bi), kdesc, &(items[order[i]].kval), &idx);
+
+            if (idx == -1) MAKE_PAGEID(child, root->volNo, apage->bi.hdr.p0);
+            else MAKE_PAGEID(child, root->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]))->spid);
+
+            /* The pairs routed to the same child */
+            if (idx == apage->bi.hdr.nSlots - 1) j = last;
+            else {
+                iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(idx+1)]]);
+                for (j = i + 1; j < last; j++)
+                    if (edubtm_KeyCompare(kdesc, &(items[order[j]].kval), (KeyValue*)&(iEntry->klen)) != LESS) break;
+            }
+
+            if ((e = edubtm_DeleteBatch(pFid, &child, kdesc, items, order, i, j, nUnderflows, dlPool, dlHead)) < 0)
+                ERRB1(e, root, PAGE_BUF);
+        }
+    }
+    else if (apage->any.hdr.type & LEAF) {
+
+        dirty = FALSE;
+        for (i = first; i < last; i = j) {
+            /* The pairs having the same key value */
+            for (j = i + 1; j < last; j++)
+                if (edubtm_KeyCompare(kdesc, &(items[order[j]].kval), &(items[order[i]].kval)) != EQUAL) break;
+
+            found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, &(items[order[i]].kval), &idx);
+            if (!found) continue;
+
+            lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+            alignedKlen = ALIGNED_LENGTH(lEntry->klen);
+
+            /* Merge the ObjectID array with the sorted ObjectIDs to delete */
+            oidArray = (ObjectID*)&(lEntry->kval[alignedKlen]);
+            nObjects = 0;
+            m = i;
+            for (k = 0; k < lEntry->nObjects; k++) {
+                cmp = LESS;
+                while (m < j && (cmp = btm_ObjectIdComp(&(items[order[m]].oid), &(oidArray[k]))) == LESS) m++;
+
+                if (m < j && cmp == EQUAL) m++;
+                else oidArray[nObjects++] = oidArray[k];
+            }
+
+            if (nObjects == lEntry->nObjects) continue;
+
+            apage->bl.hdr.unused += (lEntry->nObjects - nObjects)*OBJECTID_SIZE;
+            lEntry->nObjects = nObjects;
+
+            /* Remove the entry having no more ObjectIDs */
+            if (nObjects == 0) {
+                edubtm_DeleteLeafEntries(&(apage->bl), idx, idx);
+                edubtm_BumpVersion(root);
+            }
+
+            dirty = TRUE;
+        }
+
+        if (dirty) {
+            /* Set the DIRTY bit */
+            if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+
+            /* Remember the leaf which is not half full */
+            if (!(apage->any.hdr.type & ROOT) && BL_FREE(&(apage->bl)) > BL_HALF) {
+                order[*nUnderflows] = order[first];
+                (*nUnderflows)++;
+            }
+        }
+    }
+    else
+        ERRB1(eBADBTREEPAGE_BTM, root, PAGE_BUF);
+
+    /* Unfix the root page from the buffer */
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_DeleteBatch() */
+
+
+
+/*@================================
+ * edubtm_BatchItemCompare()
+ *================================*/
+/*
+ * Function: Four edubtm_BatchItemCompare(KeyDesc*, BatchItem*, BatchItem*)
+ *
+ * Description:
+ *  Compare two (key value, ObjectID) pairs by the key value first and then
+ *  by the ObjectID.
+ *
+ * Returns:
+ *  Result of Comparison
+ *    EQUAL
+ *    GREATER
+ *    LESS
+ */
+Four edubtm_BatchItemCompare(
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    BatchItem                   *left,          /* IN left pair */
+    BatchItem                   *right)         /* IN right pair */
+{
+    Four                        cmp;            /* result of the comparison */
+
+
+    cmp = edubtm_KeyCompare(kdesc, &(left->kval), &(right->kval));
+    if (cmp != EQUAL) return(cmp);
+
+    return(btm_ObjectIdComp(&(left->oid), &(right->oid)));
+
+}   /* edubtm_BatchItemCompare() */
+
+
+
+/*@================================
+ * edubtm_SortBatchItems()
+ *================================*/
+/*
+ * Function: void edubtm_SortBatchItems(KeyDesc*, BatchItem*, Four*, Four)
+ *
+ * Description:
+ *  Sort the indexes of the pairs in 'order' by the pairs they refer to, by
+ *  heap sort, which needs no recursion. The pairs themselves are not moved.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SortBatchItems(
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    BatchItem                   *items,         /* IN pairs to sort */
+    Four                        *order,         /* INOUT indexes of the pairs to sort */
+    Four                        nItems)         /* IN # of pairs */
+{
+    Four                        i;              /* index variable */
+    Four                        end;            /* # of pairs in the heap */
+    Four                        parent;         /* a node of the heap */
+    Four                        child;          /* the greater child of 'parent' */
+    Four                        tIndex;         /* temporary index for swapping */
+
+
+    /* Build a max heap, then move the maximum to the end one by one */
+    for (i = nItems/2 - 1, end = nItems; end > 1; ) {
+        if (i >= 0)
+            parent = i--;
+        else {
+            end--;
+            tIndex = order[0];
+            order[0] = order[end];
+            order[end] = tIndex;
+            parent = 0;
+        }
+
+        /* Sift down order[parent] */
+        while ((child = 2*parent + 1) < end) {
+            if (child + 1 < end && edubtm_BatchItemCompare(kdesc, &items[order[child+1]], &items[order[child]]) == GREATER)
+                child++;
+
+            if (edubtm_BatchItemCompare(kdesc, &items[order[child]], &items[order[parent]]) != GREATER) break;
+
+            tIndex = order[parent];
+            order[parent] = order[child];
+            order[child] = tIndex;
+            parent = child;
+        }
+    }
+
+}   /* edubtm_SortBatchItems() */
@@ -83,9 +83,19 @@
  *  may be splitted in spite of deleting. In this case, it is used the 'lh'
  *  flag and an internal item as similar to inserting.
  *
+ *  If the changes of the index are buffered and the leaf is not in the
+ *  buffer pool, the delete is kept in the change buffer without reading the
+ *  leaf; then an ObjectID which is not in the index is not reported.
+ *
+ *  The delete is not latch coupled: it holds the tree latch exclusively,
+ *  because the merge and the redistribution of an underflowed page change
+ *  its siblings as well. Deletes are thus serialized with all the other
+ *  operations on the index.
+ *
  * Returns:
  *  error code
  *    eBADPARAMETER_BTM
+ *    eNOTFOUND_BTM
  *    some errors caused by fucntion calls
  */
 Four EduBtM_DeleteObject(
@@ -102,10 +112,12 @@ Four EduBtM_DeleteObject(
     Four    e;			/* error number */
     Boolean lf;			/* flag for merging */
     Boolean lh;			/* flag for splitting */
+    Boolean buffered;		/* whether the index is buffered */
+    Boolean found;		/* whether the key value is in the buffered index */
+    ObjectID curOid;		/* ObjectID of the key value in the buffered index */
+    Boolean logged;		/* whether the delete goes to the side log */
     InternalItem item;		/* Internal item */
-    SlottedPage *catPage;	/* buffer page containing the catalog object */
-    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
-    PhysicalFileID pFid;        /* B+-tree file's FileID */
+    DeallocListElem *dlMark;	/* first element of the dealloc list before the delete */
 
 
     /*@ check parameters */
@@ -130,21 +142,67 @@ Four EduBtM_DeleteObject(
 
     /**/
 
+    for (;;) {
+        /* The delete from an index being built goes to its side log */
+        if ((e = edubtm_LogSideChange(root, BTM_MSG_DELETE, kval, oid, &logged)) < 0) ERR(e);
+        if (logged) return(eNOERROR);
 
+        /* The delete path is not latch coupled; hold the tree exclusively */
+        if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
 
-    /* Handle underflow that has occured in the root page */
-    if(lf){
-        if ((e = btm_root_delete(&pFid, root, dlPool, dlHead)) < 0) ERR(e);       
+        /* Check again, since a build may have begun before the latch was granted */
+        if (!edubtm_InOnlineBuild(root)) break;
+        (Four) edubtm_UnlatchTree(root);
+    }
+    edubtm_EnterBfM();
+    dlMark = dlHead->next;
+
+    /* The delete from a buffered index is put into the message buffer of the root */
+    if ((e = edubtm_IsBufferedIndex(root, &buffered)) < 0) ERRTL(e, root);
+    if (buffered) {
+        /* The ObjectID may be in a pending message or in its leaf */
+        if ((e = edubtm_SearchPending(root, kdesc, kval, &found, &curOid)) < 0) ERRTL(e, root);
+        if (!found || btm_ObjectIdComp(oid, &curOid) != EQUAL) ERRTL(eNOTFOUND_BTM, root);
+
+        if ((e = edubtm_BufferUpdate(catObjForFile, root, kdesc, BTM_MSG_DELETE, kval, oid, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        /* A flush of the message buffers may have merged pages */
+        if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+        return(eNOERROR);
     }
 
-    /**/
+    /* The delete from a leaf not in the buffer pool is kept in the change buffer */
+    if ((e = edubtm_BufferLeafDelete(catObjForFile, root, kdesc, kval, oid, &buffered)) < 0) ERRTL(e, root);
+    if (buffered) {
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+        return(eNOERROR);
+    }
 
-	/* Delete following 3 lines before implement this function */
-	printf("Implementation of delete operation is optional (not compulsory),\n");
-	printf("and delete operation has not been implemented yet.\n");
-	return(eNOTSUPPORTED_EDUBTM);
+    /* The pending changes of the key value go to the leaf first */
+    if ((e = edubtm_MergeChanges(root, kdesc, kval, kval, 0)) < 0) ERRTL(e, root);
 
-    
+    /* Delete the ObjectID from the leaf on the path of the key value */
+    lf = lh = FALSE;
+    if ((e = edubtm_Delete(catObjForFile, root, kdesc, kval, oid, &lf, &lh, &item, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    /* The root got a new discriminator key it has no room for */
+    if (lh) {
+        if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
+    }
+    /* Handle underflow that has occured in the root page */
+    else if (lf) {
+        if ((e = edubtm_root_delete(catObjForFile, root, kdesc, dlPool, dlHead)) < 0) ERRTL(e, root);
+    }
+
+    /* The pages freed by the merges are kept for the splits of the file */
+    if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    /**/
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
     return(eNOERROR);
     
 }   /* EduBtM_DeleteObject() */
@@ -0,0 +1,521 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_DeleteRange.c
+ *
+ * Description :
+ *  Delete from a B+ tree all the ObjectIDs whose key values are in the range
+ *  [lowKey, highKey]. The subtrees lying completely inside the range are
+ *  dropped at once without visiting their entries.
+ *
+ * Exports:
+ *  Four EduBtM_DeleteRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Pool*, DeallocListElem*)
+ *  Four edubtm_FreeSubtrees(PhysicalFileID*, BtreeInternal*, Two, Two, Pool*, DeallocListElem*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "OM_Internal.h"	/* for "SlottedPage" including catalog object */
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_DeleteRange(PhysicalFileID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
+Four edubtm_EdgeLeafLink(PageID*, Boolean, ShortPageID*);
+
+
+
+/*@================================
+ * EduBtM_DeleteRange()
+ *================================*/
+/*
+ * Function: Four EduBtM_DeleteRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*,
+ *                                   Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Delete from a B+ tree all the ObjectIDs whose key values are greater than
+ *  or equal to 'lowKey' and less than or equal to 'highKey'. A NULL 'lowKey'
+ *  ('highKey') means that the range is not bounded below (above).
+ *
+ *  Only the two boundary leaves are trimmed entry by entry. The children of
+ *  an internal page which lie completely inside the range are unlinked from
+ *  the leaf page list, removed from the internal page, and all of their pages
+ *  are put into the dealloc list by edubtm_FreePages(...). Hence the cost is
+ *  proportional to the pages on the two boundary paths and the freed pages,
+ *  not to the number of deleted keys.
+ *
+ *  The boundary pages may not be half full after trimming; they are merged or
+ *  redistributed once at the end by edubtm_RepairUnderflow(...).
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_DeleteRange(
+    ObjectID *catObjForFile,	/* IN catalog object of B+-tree file */
+    PageID   *root,		/* IN root Page IDentifier */
+    KeyDesc  *kdesc,		/* IN a key descriptor */
+    KeyValue *lowKey,		/* IN lower bound of the range (inclusive), NULL if unbounded */
+    KeyValue *highKey,		/* IN upper bound of the range (inclusive), NULL if unbounded */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    int		i;
+    Four    e;			/* error number */
+    Boolean lf;			/* flag for merging */
+    Boolean lh;			/* flag for splitting */
+    Boolean buffered;		/* whether the index is buffered */
+    Four    flags;		/* flags of the root kept over the initialization */
+    Four    reserved;		/* PageNo of the meta page kept by the root */
+    InternalItem item;		/* Internal item */
+    BtreePage *rpage;		/* pointer to the buffer holding the root page */
+    KeyValue *bKey[2];		/* keys on the two boundary paths */
+    SlottedPage *catPage;	/* buffer page containing the catalog object */
+    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
+    PhysicalFileID pFid;        /* B+-tree file's FileID */
+    DeallocListElem *dlMark;	/* first element of the dealloc list before the delete */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* Nothing to do for an empty range */
+    if (lowKey != NULL && highKey != NULL && edubtm_KeyCompare(kdesc, lowKey, highKey) == GREATER)
+        return(eNOERROR);
+
+    /* Dropping whole subtrees excludes every other user of the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    /* The range cannot be dropped from the tree while a build logs the changes */
+    if (edubtm_InOnlineBuild(root)) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    edubtm_EnterBfM();
+    dlMark = dlHead->next;
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERRTL(e, root);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    /* The pending messages of the range should reach the leaves first */
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, lowKey, highKey, dlPool, dlHead)) < 0) ERRTL(e, root);
+    if ((e = edubtm_IsBufferedIndex(root, &buffered)) < 0) ERRTL(e, root);
+
+    /* Trim the boundary leaves and drop the covered subtrees */
+    if ((e = edubtm_DeleteRange(&pFid, root, kdesc, lowKey, highKey, NULL, NULL, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    /* If every child of the root has been dropped, the root becomes an empty leaf */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    if ((rpage->any.hdr.type & INTERNAL) && rpage->bi.hdr.p0 == NIL) {
+        flags = rpage->any.hdr.flags & BTM_ROOTFLAGS;
+        reserved = rpage->any.hdr.reserved;
+
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERRTL(e, root);
+        if ((e = edubtm_InitLeaf(root, TRUE, FALSE)) < 0) ERRTL(e, root);
+
+        /* The root keeps the update modes and the meta page of the index */
+        if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERRTL(e, root);
+        rpage->any.hdr.flags |= flags;
+        rpage->any.hdr.reserved = reserved;
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) { (Four) BfM_FreeTrain((TrainID*)root, PAGE_BUF); ERRTL(e, root); }
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERRTL(e, root);
+
+        /* The dropped pages are kept for the splits of the file */
+        if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+        return(eNOERROR);
+    }
+
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    /* Merge or redistribute the pages on the boundary paths */
+    bKey[0] = lowKey;
+    bKey[1] = highKey;
+    for (i = 0; i < 2; i++) {
+        if (bKey[i] == NULL) continue;
+
+        if ((e = edubtm_RepairUnderflow(catObjForFile, root, kdesc, bKey[i], &lf, &lh, &item, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        if (lh) {
+            if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
+        }
+        else if (lf) {
+            if ((e = edubtm_root_delete(catObjForFile, root, kdesc, dlPool, dlHead)) < 0) ERRTL(e, root);
+        }
+    }
+
+    if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_DeleteRange() */
+
+
+
+/*@================================
+ * edubtm_DeleteRange()
+ *================================*/
+/*
+ * Function: Four edubtm_DeleteRange(PhysicalFileID*, PageID*, KeyDesc*, KeyValue*, KeyValue*,
+ *                                   KeyValue*, KeyValue*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Delete the entries in [lowKey, highKey] from the subtree whose root is
+ *  'root'. All the key values in the subtree are in [lowBound, highBound);
+ *  NULL bounds mean that the subtree is not bounded on that side.
+ *
+ *  In a leaf, the entries in the range are removed. In an internal page,
+ *  the children whose key ranges lie completely inside [lowKey, highKey] are
+ *  dropped by edubtm_FreeSubtrees(...) and removed from the page; the (at most
+ *  two) children which overlap the range only partially are handled by the
+ *  recursive calls.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  Underflows are not handled here.
+ */
+Four edubtm_DeleteRange(
+    PhysicalFileID              *pFid,          /* IN FileID of the Btree file */
+    PageID                      *root,          /* IN root of the subtree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *lowKey,        /* IN lower bound of the range, NULL if unbounded */
+    KeyValue                    *highKey,       /* IN upper bound of the range, NULL if unbounded */
+    KeyValue                    *lowBound,      /* IN smallest possible key of the subtree, NULL if unbounded */
+    KeyValue                    *highBound,     /* IN every key of the subtree is less than this, NULL if unbounded */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* the index by the binary search */
+    Two                         first;          /* first slot or child in the range */
+    Two                         last;           /* last slot or child in the range */
+    Two                         cLow;           /* child containing 'lowKey' */
+    Two                         cHigh;          /* child containing 'highKey' */
+    Boolean                     found;          /* search result */
+    Boolean                     cLowCovered;    /* TRUE if child 'cLow' lies inside the range */
+    Boolean                     cHighCovered;   /* TRUE if child 'cHigh' lies inside the range */
+    KeyValue                    *cLowBound;     /* lower bound of a child */
+    KeyValue                    *cHighBound;    /* upper bound of a child */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    /* Fix the root page to the buffer */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    if (apage->any.hdr.type & LEAF) {
+
+        /* The first slot whose key is greater than or equal to 'lowKey' */
+        if (lowKey == NULL) first = 0;
+        else {
+            found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, lowKey, &idx);
+            first = (found) ? idx : idx + 1;
+        }
+
+        /* The last slot whose key is less than or equal to 'highKey' */
+        if (highKey == NULL) last = apage->bl.hdr.nSlots - 1;
+        else {
+            edubtm_BinarySearchLeaf(&(apage->bl), kdesc, highKey, &idx);
+            last = idx;
+        }
+
+        if (first <= last) {
+            /* The ObjectIDs are in the entries; nothing hangs from them */
+            edubtm_DeleteLeafEntries(&(apage->bl), first, last);
+            edubtm_BumpVersion(root);
+
+            /* Set the DIRTY bit */
+            if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+        }
+
+        /* Unfix the leaf page from the buffer */
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (!(apage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, root, PAGE_BUF);
+
+    /* Children containing the both ends of the range; -1 denotes 'p0' */
+    if (lowKey == NULL) cLow = -1;
+    else edubtm_BinarySearchInternal(&(apage->bi), kdesc, lowKey, &cLow);
+
+    if (highKey == NULL) cHigh = apage->bi.hdr.nSlots - 1;
+    else edubtm_BinarySearchInternal(&(apage->bi), kdesc, highKey, &cHigh);
+
+    /* Is the lower bound of child 'cLow' inside the range? */
+    if (cLow == -1) cLowBound = lowBound;
+    else cLowBound = (KeyValue*)&(((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-cLow]]))->klen);
+    cLowCovered = (lowKey == NULL || (cLowBound != NULL && edubtm_KeyCompare(kdesc, cLowBound, lowKey) != LESS)) ? TRUE : FALSE;
+
+    /* Is the upper bound of child 'cHigh' inside the range? */
+    if (cHigh == apage->bi.hdr.nSlots - 1) cHighBound = highBound;
+    else cHighBound = (KeyValue*)&(((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(cHigh+1)]]))->klen);
+    cHighCovered = (highKey == NULL || (cHighBound != NULL && edubtm_KeyCompare(kdesc, cHighBound, highKey) != GREATER)) ? TRUE : FALSE;
+
+    /* A single child is covered only if both of its bounds are inside the range */
+    if (cLow == cHigh) cLowCovered = cHighCovered = (cLowCovered && cHighCovered) ? TRUE : FALSE;
+
+    /* Children which overlap the range partially */
+    if (!cLowCovered) {
+        if (cLow == -1) MAKE_PAGEID(child, root->volNo, apage->bi.hdr.p0);
+        else MAKE_PAGEID(child, root->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-cLow]]))->spid);
+
+        if (cLow == apage->bi.hdr.nSlots - 1) cHighBound = highBound;
+        else cHighBound = (KeyValue*)&(((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(cLow+1)]]))->klen);
+
+        if ((e = edubtm_DeleteRange(pFid, &child, kdesc, lowKey, highKey, cLowBound, cHighBound, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+    }
+
+    if (!cHighCovered && cHigh != cLow) {
+        MAKE_PAGEID(child, root->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-cHigh]]))->spid);
+
+        cLowBound = (KeyValue*)&(((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-cHigh]]))->klen);
+        if (cHigh == apage->bi.hdr.nSlots - 1) cHighBound = highBound;
+        else cHighBound = (KeyValue*)&(((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(cHigh+1)]]))->klen);
+
+        if ((e = edubtm_DeleteRange(pFid, &child, kdesc, lowKey, highKey, cLowBound, cHighBound, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+    }
+
+    /* Children which lie completely inside the range */
+    first = (cLowCovered) ? cLow : cLow + 1;
+    last = (cHighCovered) ? cHigh : cHigh - 1;
+
+    if (first <= last) {
+        if ((e = edubtm_FreeSubtrees(pFid, &(apage->bi), first, last, dlPool, dlHead)) < 0) ERRB1(e, root, PAGE_BUF);
+
+        if (first >= 0)
+            edubtm_DeleteInternalEntries(&(apage->bi), first, last);
+        else if (last == apage->bi.hdr.nSlots - 1) {
+            /* every child is dropped */
+            apage->bi.hdr.p0 = NIL;
+            edubtm_DeleteInternalEntries(&(apage->bi), 0, last);
+        }
+        else {
+            /* the first remaining child becomes 'p0' */
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(last+1)]]);
+            apage->bi.hdr.p0 = iEntry->spid;
+            edubtm_DeleteInternalEntries(&(apage->bi), 0, last + 1);
+        }
+
+        /* Set the DIRTY bit */
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+
+    /* Unfix the root page from the buffer */
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_DeleteRange() */
+
+
+
+/*@================================
+ * edubtm_FreeSubtrees()
+ *================================*/
+/*
+ * Function: Four edubtm_FreeSubtrees(PhysicalFileID*, BtreeInternal*, Two, Two,
+ *                                    Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Free the subtrees of the children 'first' ... 'last' of the given internal
+ *  page (-1 denotes 'p0'). The leaves of these subtrees form a contiguous part
+ *  of the leaf page list, so the leaf just before the part and the leaf just
+ *  after the part are linked to each other before the pages are freed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The entries of the children are not removed from the given page.
+ */
+Four edubtm_FreeSubtrees(
+    PhysicalFileID              *pFid,          /* IN FileID of the Btree file */
+    BtreeInternal               *ipage,         /* IN the parent page */
+    Two                         first,          /* IN first child to be freed */
+    Two                         last,           /* IN last child to be freed */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* child No. */
+    PageID                      child;          /* a child page */
+    PageID                      prevPid;        /* the leaf before the freed leaves */
+    PageID                      nextPid;        /* the leaf after the freed leaves */
+    ShortPageID                 prevPage;       /* PageNo of 'prevPid' */
+    ShortPageID                 nextPage;       /* PageNo of 'nextPid' */
+    BtreeLeaf                   *lpage;         /* pointer to the buffer holding a leaf */
+
+
+    /* Neighbors of the freed part of the leaf page list */
+    if (first == -1) MAKE_PAGEID(child, pFid->volNo, ipage->hdr.p0);
+    else MAKE_PAGEID(child, pFid->volNo, ((btm_InternalEntry*)&(ipage->data[ipage->slot[-first]]))->spid);
+    if ((e = edubtm_EdgeLeafLink(&child, TRUE, &prevPage)) < 0) ERR(e);
+
+    if (last == -1) MAKE_PAGEID(child, pFid->volNo, ipage->hdr.p0);
+    else MAKE_PAGEID(child, pFid->volNo, ((btm_InternalEntry*)&(ipage->data[ipage->slot[-last]]))->spid);
+    if ((e = edubtm_EdgeLeafLink(&child, FALSE, &nextPage)) < 0) ERR(e);
+
+    /* Put all the pages of the subtrees into the dealloc list */
+    for (i = first; i <= last; i++) {
+        if (i == -1) MAKE_PAGEID(child, pFid->volNo, ipage->hdr.p0);
+        else MAKE_PAGEID(child, pFid->volNo, ((btm_InternalEntry*)&(ipage->data[ipage->slot[-i]]))->spid);
+
+        if ((e = edubtm_FreePages(pFid, &child, dlPool, dlHead)) < 0) ERR(e);
+    }
+
+    /* Link the neighbors to each other */
+    if (prevPage != NIL) {
+        MAKE_PAGEID(prevPid, pFid->volNo, prevPage);
+        if ((e = BfM_GetTrain((TrainID*)&prevPid, (char**)&lpage, PAGE_BUF)) < 0) ERR(e);
+        lpage->hdr.nextPage = nextPage;
+        if ((e = BfM_SetDirty((TrainID*)&prevPid, PAGE_BUF)) < 0) ERRB1(e, &prevPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&prevPid, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    if (nextPage != NIL) {
+        MAKE_PAGEID(nextPid, pFid->volNo, nextPage);
+        if ((e = BfM_GetTrain((TrainID*)&nextPid, (char**)&lpage, PAGE_BUF)) < 0) ERR(e);
+        lpage->hdr.prevPage = prevPage;
+        if ((e = BfM_SetDirty((TrainID*)&nextPid, PAGE_BUF)) < 0) ERRB1(e, &nextPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_FreeSubtrees() */
+
+
+
+/*@================================
+ * edubtm_EdgeLeafLink()
+ *================================*/
+/*
+ * Function: Four edubtm_EdgeLeafLink(PageID*, Boolean, ShortPageID*)
+ *
+ * Description:
+ *  Descend the subtree along its leftmost (rightmost) path and return the
+ *  'prevPage' of its leftmost leaf ('nextPage' of its rightmost leaf).
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_EdgeLeafLink(
+    PageID                      *root,          /* IN root of the subtree */
+    Boolean                     leftmost,       /* IN TRUE: leftmost leaf, FALSE: rightmost leaf */
+    ShortPageID                 *link)          /* OUT the link to the outside of the subtree */
+{
+    Four                        e;              /* error number */
+    PageID                      curPid;         /* PageID of the current page */
+    PageID                      child;          /* PageID of the child page */
+    BtreePage                   *apage;         /* a page pointer */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    curPid = *root;
+    while (TRUE) {
+        if ((e = BfM_GetTrain((TrainID*)&curPid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+        if (apage->any.hdr.type & LEAF) {
+            *link = (leftmost) ? apage->bl.hdr.prevPage : apage->bl.hdr.nextPage;
+            if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERR(e);
+            break;
+        }
+
+        if (!(apage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, &curPid, PAGE_BUF);
+
+        if (leftmost || apage->bi.hdr.nSlots == 0)
+            MAKE_PAGEID(child, curPid.volNo, apage->bi.hdr.p0);
+        else {
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(apage->bi.hdr.nSlots-1)]]);
+            MAKE_PAGEID(child, curPid.volNo, iEntry->spid);
+        }
+
+        if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERR(e);
+        curPid = child;
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_EdgeLeafLink() */
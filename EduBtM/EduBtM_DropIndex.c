@@ -71,6 +71,9 @@
  *
  *  Drop the B+ tree Index specified by 'rootPid', a root PageID of the B+tree.
  *
+ *  Only the internal pages are read; the leaves are deallocated without
+ *  being fixed in the buffer (see edubtm_DropTree(...)).
+ *
  * Returns:
  *  error code
  *    some errors : by other function calls
@@ -83,11 +86,29 @@ Four EduBtM_DropIndex(
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four e;			/* for the error number */
+    PageID metaPid;		/* meta page of the index */
 
     /*@ Free all pages concerned with the root. */
     /**/
-    if((e = edubtm_FreePages(pFid, rootPid, dlPool, dlHead))<0) ERR(e);
+    /* Wait for the current users of the tree before freeing its pages */
+    if ((e = edubtm_LatchTree(rootPid, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    if((e = edubtm_GetMetaPage(NULL, rootPid, FALSE, &metaPid))<0) ERRTL(e, rootPid);
+
+    /* The cached upper pages are given back, and the model of the leaves, the result cache and the Bloom filter dropped, before the pages are freed */
+    if((e = edubtm_ReleaseUpperCache(rootPid))<0) ERRTL(e, rootPid);
+    edubtm_DropLearnedIndex(rootPid);
+    edubtm_DropResultCache(rootPid);
+    if((e = edubtm_DropBloomFilter(rootPid, dlPool, dlHead))<0) ERRTL(e, rootPid);
+
+    if((e = edubtm_DropTree(pFid, rootPid, dlPool, dlHead))<0) ERRTL(e, rootPid);
+
+    /* The file forgets the leaf run and the free page list if they were kept by the dropped index */
+    if((e = edubtm_ReleaseLeafRun(pFid, &metaPid))<0) ERRTL(e, rootPid);
 	/**/
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(rootPid);
     return(eNOERROR);
     
 } /* EduBtM_DropIndex() */
@@ -0,0 +1,3503 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_FeatureTest.c
+ *
+ * Description : 
+ *  Test the operations of EduBtM beyond the basic ones run by EduBtM_Test(),
+ *  without the user's input. Each test builds an index of its own in a file,
+ *  runs the operation, checks the objects found in the index afterwards, and
+ *  drops the index; a test which finds a wrong result prints FAIL.
+ *  Where an operation works by a mechanism of its own, the test also checks
+ *  that mechanism on the pages of the index.
+ *
+ * Exports:
+ *  Four EduBtM_FeatureTest(Four, Four)
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <pthread.h>
+#include "EduBtM_common.h"
+#include "EduBtM_basictypes.h"
+#include "EduBtM.h"
+#include "EduBtM_TestModule.h"
+#include "BfM.h"
+#include "OM_Internal.h"
+#include "SM_Internal.h"
+#include "EduBtM_Internal.h"
+
+
+#define NUMOFTESTKEYS		2000	/* # of the key values inserted by a test */
+#define NUMOFTESTTHREADS	4		/* # of the threads of the concurrent tests */
+#define TESTSTRINGLEN		200		/* length of the string key values */
+
+/* Check a condition of a test; a wrong result is counted and printed */
+#define CHECK(cond, msg) \
+	do { \
+		if (!(cond)) { \
+			printf("FAIL: %s (%s:%d)\n", (msg), __FILE__, __LINE__); \
+			nFailures++; \
+		} \
+	} while (0)
+
+/* Stop the test at an unexpected error */
+#define CHECKERR(e) \
+	do { \
+		if ((e) < eNOERROR) { \
+			printf("FAIL: error %ld (%s:%d)\n", (long)(e), __FILE__, __LINE__); \
+			nFailures++; \
+			return(e); \
+		} \
+	} while (0)
+
+/* Data type of the objects collected by a callback */
+typedef struct {
+	Four n;				/* # of objects collected */
+	Four max;			/* size of the arrays */
+	Four *keys;			/* key values of the objects */
+	Four *seconds;		/* the second part of the key values */
+	Four *groups;		/* the second argument of the callback */
+	Boolean ordered;	/* FALSE if a key value came before a smaller one */
+} TestCollect;
+
+/* Data type of the work of an inserting thread */
+typedef struct {
+	ObjectID *catObjForFile;	/* catalog object of B+ tree file */
+	PageID *root;				/* root of the index */
+	KeyDesc *kdesc;				/* key descriptor */
+	Four first;					/* first key value to insert */
+	Four step;					/* difference of the key values inserted */
+	Four n;						/* # of key values to insert */
+	Four error;					/* error of the thread */
+	Boolean found;				/* TRUE if the key value looked up is found */
+	volatile Boolean done;		/* TRUE when the thread has finished */
+} TestWorker;
+
+static Four nFailures;			/* # of wrong results found */
+static Four testVolId;			/* volume of the test */
+
+
+Four test_CreateIndex(ObjectID*, PageID*);
+Four test_DropIndex(ObjectID*, PageID*);
+void test_SetKey(KeyValue*, Four);
+void test_SetKey2(KeyValue*, Four, Four);
+void test_SetStringKey(KeyValue*, Four);
+void test_SetOid(ObjectID*, Four);
+void test_SetIntDesc(KeyDesc*);
+void test_SetComposite(KeyDesc*);
+Four test_InsertKeys(ObjectID*, PageID*, KeyDesc*, Four, Four, Four);
+Four test_Lookup(PageID*, KeyDesc*, Four, Boolean*, ObjectID*);
+Four test_ScanKeys(PageID*, KeyDesc*, Four*, Four, Four*);
+Four test_CheckKeys(PageID*, KeyDesc*, Boolean*, Four, char*);
+Four test_Collect(void*, Four, Four, BtreeCursor*);
+Four test_CountLeaves(PageID*, Four*);
+Four test_CountDealloc(void);
+Four test_CountChanges(PageID*, Four*);
+Four test_CountFreePages(PageID*, Four*);
+Four test_CountBackwardLeaves(PageID*, Four*);
+Four test_GetEndLeafHints(PageID*, ShortPageID*, ShortPageID*);
+Four test_TreeLeaf(PageID*, KeyDesc*, Four, ShortPageID*);
+Four test_CachedLookup(PageID*, KeyDesc*, Four, Boolean*, ObjectID*);
+void *test_InsertWorker(void*);
+void *test_LookupWorker(void*);
+
+Four test_InsertDelete(ObjectID*, KeyDesc*);
+Four test_DeleteRange(ObjectID*, KeyDesc*);
+Four test_DeleteBatch(ObjectID*, KeyDesc*);
+Four test_InsertIfAbsentUpsert(ObjectID*, KeyDesc*);
+Four test_UpdateKey(ObjectID*, KeyDesc*);
+Four test_BufferedIndex(ObjectID*, KeyDesc*);
+Four test_ChangeBuffer(ObjectID*, KeyDesc*);
+Four test_LatchCoupling(ObjectID*, KeyDesc*);
+Four test_ConcurrentInsert(ObjectID*, KeyDesc*);
+Four test_OptimisticRead(ObjectID*, KeyDesc*);
+Four test_RightLink(ObjectID*, KeyDesc*);
+Four test_ParallelScan(ObjectID*, KeyDesc*);
+Four test_BulkLoad(ObjectID*, KeyDesc*);
+Four test_OnlineBuild(ObjectID*, KeyDesc*);
+Four test_FreePageList(ObjectID*, KeyDesc*);
+Four test_Reorganize(ObjectID*, KeyDesc*);
+Four test_DropTree(ObjectID*, KeyDesc*);
+Four test_EndLeaves(ObjectID*, KeyDesc*);
+Four test_UpperCache(ObjectID*, KeyDesc*);
+Four test_SwizzledRefs(ObjectID*, KeyDesc*);
+Four test_LearnedIndex(ObjectID*, KeyDesc*);
+Four test_BloomFilter(ObjectID*, KeyDesc*);
+Four test_ResultCache(ObjectID*, KeyDesc*);
+Four test_FetchBatch(ObjectID*, KeyDesc*);
+Four test_FetchMulti(ObjectID*, KeyDesc*);
+Four test_SkipScan(ObjectID*, KeyDesc*);
+
+
+
+/*@================================
+ * EduBtM_FeatureTest()
+ *================================*/
+/*
+ * Function: EduBtM_FeatureTest(Four volId, Four handle)
+ *
+ * Description : 
+ *  Run the tests of the operations of EduBtM one after another in a new
+ *  file and print the result of each.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR if every test passes, -1 if a test finds a wrong result
+ *    some errors caused by function calls
+ */
+Four EduBtM_FeatureTest(Four volId, Four handle){
+
+	Four e;												/* for errors */
+	Four i;												/* loop index */
+	Four before;										/* # of failures before a test */
+	FileID      fid;                                    /* file identifier */
+	ObjectID    catalogEntry;                           /* catalog object */
+	KeyDesc		kdesc;									/* key descriptor */
+	static struct {
+		char *name;										/* name of the test */
+		Four (*run)(ObjectID*, KeyDesc*);				/* the test */
+	} tests[] = {
+		{ "EduBtM_InsertObject/EduBtM_DeleteObject", test_InsertDelete },
+		{ "EduBtM_DeleteRange", test_DeleteRange },
+		{ "EduBtM_DeleteBatch", test_DeleteBatch },
+		{ "EduBtM_InsertIfAbsent/EduBtM_Upsert", test_InsertIfAbsentUpsert },
+		{ "EduBtM_UpdateKey", test_UpdateKey },
+		{ "EduBtM_SetBufferMode", test_BufferedIndex },
+		{ "EduBtM_SetChangeBuffering/EduBtM_MergeChangeBuffer", test_ChangeBuffer },
+		{ "latch coupling", test_LatchCoupling },
+		{ "concurrent EduBtM_InsertObject", test_ConcurrentInsert },
+		{ "optimistic reads of the internal pages", test_OptimisticRead },
+		{ "B-link right links", test_RightLink },
+		{ "EduBtM_ParallelScan", test_ParallelScan },
+		{ "EduBtM_BulkLoad", test_BulkLoad },
+		{ "online index build", test_OnlineBuild },
+		{ "free page list of the index file", test_FreePageList },
+		{ "EduBtM_Reorganize", test_Reorganize },
+		{ "EduBtM_DropIndex without reading the leaves", test_DropTree },
+		{ "SM_BOF/SM_EOF fetch from the end leaves", test_EndLeaves },
+		{ "cache of the upper levels", test_UpperCache },
+		{ "swizzled child references of the cached pages", test_SwizzledRefs },
+		{ "learned model of the leaf level", test_LearnedIndex },
+		{ "EduBtM_SetBloomFilter", test_BloomFilter },
+		{ "EduBtM_SetResultCache", test_ResultCache },
+		{ "EduBtM_FetchBatch", test_FetchBatch },
+		{ "EduBtM_FetchMulti", test_FetchMulti },
+		{ "EduBtM_SkipScan", test_SkipScan },
+	};
+
+	printf("Loading EduBtM_FeatureTest() complete...\n");
+
+	testVolId = volId;
+	nFailures = 0;
+
+	/* Create File */
+	e = SM_CreateFile(volId, &fid, FALSE, NULL);
+	if (e < eNOERROR) ERR(e);
+	/* Get catalog entry */
+	e = sm_GetCatalogEntryFromDataFileId(ARRAYINDEX, &fid, &catalogEntry);
+	if (e < eNOERROR) ERR(e);
+
+	test_SetIntDesc(&kdesc);
+
+	for (i = 0; i < sizeof(tests)/sizeof(tests[0]); i++) {
+		printf("****************************** TEST#%ld, %s. ******************************\n", (long)i+1, tests[i].name);
+		before = nFailures;
+		e = tests[i].run(&catalogEntry, &kdesc);
+		if (e < eNOERROR && nFailures == before) nFailures++;
+		printf("%s\n", (nFailures == before) ? "PASS" : "FAIL");
+	}
+
+	printf("############################## %ld test(s) failed ##############################\n", (long)nFailures);
+
+	return((nFailures == 0) ? eNOERROR : -1);
+
+}   /* EduBtM_FeatureTest() */
+
+
+
+/*@================================
+ * test_CreateIndex()
+ *================================*/
+/*
+ * Function: Four test_CreateIndex(ObjectID*, PageID*)
+ *
+ * Description:
+ *  Create a new index in the file of the test.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CreateIndex(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	PageID *root)					/* OUT root of the new index */
+{
+	Four e;							/* for errors */
+
+
+	e = EduBtM_CreateIndex(catObjForFile, root);
+	CHECKERR(e);
+
+	return(eNOERROR);
+
+}   /* test_CreateIndex() */
+
+
+
+/*@================================
+ * test_DropIndex()
+ *================================*/
+/*
+ * Function: Four test_DropIndex(ObjectID*, PageID*)
+ *
+ * Description:
+ *  Drop an index of the file of the test.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_DropIndex(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	PageID *root)					/* IN root of the index */
+{
+	Four e;							/* for errors */
+	PhysicalFileID pFid;			/* physical file identifier for EduBtM_DropIndex() */
+	SlottedPage *catPage;			/* buffer page containing the catalog object */
+	sm_CatOverlayForBtree *catEntry;/* pointer to Btree file catalog information */
+
+
+	/* Get the B+ tree file's FileID from the catalog object */
+	e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF);
+	CHECKERR(e);
+
+	GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+
+	MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+
+	e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF);
+	CHECKERR(e);
+
+	e = EduBtM_DropIndex(&pFid, root, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	return(eNOERROR);
+
+}   /* test_DropIndex() */
+
+
+
+/*@================================
+ * test_SetKey()
+ *================================*/
+/*
+ * Function: void test_SetKey(KeyValue*, Four)
+ *
+ * Description:
+ *  Make the key value of an integer key.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetKey(
+	KeyValue *kval,					/* OUT key value */
+	Four n)							/* IN integer of the key value */
+{
+	Four_Invariable v = n;			/* integer as stored in the key value */
+
+
+	kval->len = sizeof(Four_Invariable);
+	memcpy(&kval->val[0], &v, sizeof(Four_Invariable));
+
+}   /* test_SetKey() */
+
+
+
+/*@================================
+ * test_SetKey2()
+ *================================*/
+/*
+ * Function: void test_SetKey2(KeyValue*, Four, Four)
+ *
+ * Description:
+ *  Make the key value of a key of two integers.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetKey2(
+	KeyValue *kval,					/* OUT key value */
+	Four first,						/* IN integer of the first part */
+	Four second)					/* IN integer of the second part */
+{
+	Four_Invariable v;				/* integer as stored in the key value */
+
+
+	kval->len = 2*sizeof(Four_Invariable);
+	v = first;
+	memcpy(&kval->val[0], &v, sizeof(Four_Invariable));
+	v = second;
+	memcpy(&kval->val[sizeof(Four_Invariable)], &v, sizeof(Four_Invariable));
+
+}   /* test_SetKey2() */
+
+
+
+/*@================================
+ * test_SetStringKey()
+ *================================*/
+/*
+ * Function: void test_SetStringKey(KeyValue*, Four)
+ *
+ * Description:
+ *  Make the key value of a string key of TESTSTRINGLEN characters: the
+ *  integer in decimal digits padded out, so that the strings are in the
+ *  order of the integers.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetStringKey(
+	KeyValue *kval,					/* OUT key value */
+	Four n)							/* IN integer of the key value */
+{
+	Two len = TESTSTRINGLEN;		/* length of the string */
+
+
+	memcpy(&kval->val[0], &len, sizeof(Two));
+	memset(&kval->val[sizeof(Two)], '.', TESTSTRINGLEN);
+	sprintf(&kval->val[sizeof(Two)], "%010ld", (long)n);
+	kval->val[sizeof(Two)+10] = '.';
+	kval->len = sizeof(Two) + TESTSTRINGLEN;
+
+}   /* test_SetStringKey() */
+
+
+
+/*@================================
+ * test_SetOid()
+ *================================*/
+/*
+ * Function: void test_SetOid(ObjectID*, Four)
+ *
+ * Description:
+ *  Make the ObjectID stored with a key value; its unique field tells the
+ *  ObjectIDs apart.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetOid(
+	ObjectID *oid,					/* OUT ObjectID */
+	Four n)							/* IN unique number of the ObjectID */
+{
+	oid->pageNo = 777;
+	oid->volNo = testVolId;
+	oid->slotNo = n % 10000;
+	oid->unique = n;
+
+}   /* test_SetOid() */
+
+
+
+/*@================================
+ * test_SetIntDesc()
+ *================================*/
+/*
+ * Function: void test_SetIntDesc(KeyDesc*)
+ *
+ * Description:
+ *  Make the key descriptor of a unique integer key.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetIntDesc(
+	KeyDesc *kdesc)					/* OUT key descriptor */
+{
+	kdesc->flag = KEYFLAG_UNIQUE;
+	kdesc->nparts = 1;
+	kdesc->kpart[0].type = SM_INT;
+	kdesc->kpart[0].offset = 0;
+	kdesc->kpart[0].length = sizeof(Four);
+
+}   /* test_SetIntDesc() */
+
+
+
+/*@================================
+ * test_SetComposite()
+ *================================*/
+/*
+ * Function: void test_SetComposite(KeyDesc*)
+ *
+ * Description:
+ *  Make the key descriptor of a unique key of two integers.
+ *
+ * Returns:
+ *  None
+ */
+void test_SetComposite(
+	KeyDesc *kdesc)					/* OUT key descriptor */
+{
+	kdesc->flag = KEYFLAG_UNIQUE;
+	kdesc->nparts = 2;
+	kdesc->kpart[0].type = SM_INT;
+	kdesc->kpart[0].offset = 0;
+	kdesc->kpart[0].length = sizeof(Four);
+	kdesc->kpart[1].type = SM_INT;
+	kdesc->kpart[1].offset = sizeof(Four);
+	kdesc->kpart[1].length = sizeof(Four);
+
+}   /* test_SetComposite() */
+
+
+
+/*@================================
+ * test_InsertKeys()
+ *================================*/
+/*
+ * Function: Four test_InsertKeys(ObjectID*, PageID*, KeyDesc*, Four, Four, Four)
+ *
+ * Description:
+ *  Insert the 'n' key values first, first+step, ... in a shuffled order;
+ *  the ObjectID of each has the key value as its unique field. At most
+ *  NUMOFTESTKEYS key values are inserted.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_InsertKeys(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Four first,						/* IN first key value */
+	Four step,						/* IN difference of the key values */
+	Four n)							/* IN # of key values */
+{
+	Four e;							/* for errors */
+	Four i, j;						/* indexes */
+	Four t;							/* for swapping */
+	static Four keys[NUMOFTESTKEYS];	/* the key values in the order of the inserts */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+
+
+	if (n > NUMOFTESTKEYS) n = NUMOFTESTKEYS;
+
+	for (i = 0; i < n; i++) keys[i] = first + step*i;
+	for (i = n-1; i > 0; i--) {
+		j = rand() % (i+1);
+		t = keys[i]; keys[i] = keys[j]; keys[j] = t;
+	}
+
+	for (i = 0; i < n; i++) {
+		test_SetKey(&kval, keys[i]);
+		test_SetOid(&oid, keys[i]);
+		e = EduBtM_InsertObject(catObjForFile, root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+	}
+
+	return(eNOERROR);
+
+}   /* test_InsertKeys() */
+
+
+
+/*@================================
+ * test_Lookup()
+ *================================*/
+/*
+ * Function: Four test_Lookup(PageID*, KeyDesc*, Four, Boolean*, ObjectID*)
+ *
+ * Description:
+ *  Look up an integer key value by EduBtM_Fetch() with SM_EQ.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  found : TRUE if the key value is found
+ *  oid   : the ObjectID found
+ */
+Four test_Lookup(
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Four n,							/* IN key value */
+	Boolean *found,					/* OUT TRUE if the key value is found */
+	ObjectID *oid)					/* OUT ObjectID found */
+{
+	Four e;							/* for errors */
+	KeyValue kval;					/* key value */
+	BtreeCursor cursor;				/* cursor of the lookup */
+
+
+	test_SetKey(&kval, n);
+
+	e = EduBtM_Fetch(root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECKERR(e);
+
+	*found = (cursor.flag == CURSOR_ON);
+	if (*found && oid != NULL) *oid = cursor.oid;
+
+	return(eNOERROR);
+
+}   /* test_Lookup() */
+
+
+
+/*@================================
+ * test_ScanKeys()
+ *================================*/
+/*
+ * Function: Four test_ScanKeys(PageID*, KeyDesc*, Four*, Four, Four*)
+ *
+ * Description:
+ *  Read all the objects of an index of an integer key forward by
+ *  EduBtM_Fetch() and EduBtM_FetchNext(), and collect their key values.
+ *  The unique field of each ObjectID should be the key value.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  keys : the first 'max' key values read
+ *  n    : the # of the objects read
+ */
+Four test_ScanKeys(
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Four *keys,						/* OUT key values read */
+	Four max,						/* IN size of 'keys' */
+	Four *n)						/* OUT # of the objects read */
+{
+	Four e;							/* for errors */
+	Four_Invariable v;				/* integer of a key value */
+	KeyValue kval;					/* key value of the conditions */
+	BtreeCursor cursor;				/* cursor of the scan */
+	BtreeCursor next;				/* next object cursor from EduBtM_FetchNext() */
+
+
+	test_SetKey(&kval, 0);
+	*n = 0;
+
+	e = EduBtM_Fetch(root, kdesc, &kval, SM_BOF, &kval, SM_EOF, &cursor);
+	CHECKERR(e);
+
+	while (cursor.flag == CURSOR_ON) {
+		memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+		CHECK(cursor.oid.unique == v, "the ObjectID of a key value is wrong");
+		if (*n < max) keys[*n] = v;
+		(*n)++;
+
+		e = EduBtM_FetchNext(root, kdesc, &kval, SM_EOF, &cursor, &next);
+		CHECKERR(e);
+		cursor = next;
+	}
+
+	return(eNOERROR);
+
+}   /* test_ScanKeys() */
+
+
+
+/*@================================
+ * test_CheckKeys()
+ *================================*/
+/*
+ * Function: Four test_CheckKeys(PageID*, KeyDesc*, Boolean*, Four, char*)
+ *
+ * Description:
+ *  Check that an index of an integer key holds exactly the key values k
+ *  in [0, range) with present[k] TRUE: the full scan reads them in the
+ *  ascending order, and a lookup finds each of them and none of the others.
+ *  'range' is at most NUMOFTESTKEYS.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CheckKeys(
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Boolean *present,				/* IN TRUE for the key values which should be found */
+	Four range,						/* IN size of 'present' */
+	char *what)						/* IN name of the state checked */
+{
+	Four e;							/* for errors */
+	Four i, j;						/* indexes */
+	Four n;							/* # of objects read */
+	static Four keys[NUMOFTESTKEYS];	/* key values read */
+	Boolean found;					/* TRUE if a lookup finds its key value */
+	ObjectID oid;					/* ObjectID found */
+	Boolean ok = TRUE;				/* FALSE if a result is wrong */
+
+
+	if (range > NUMOFTESTKEYS) range = NUMOFTESTKEYS;
+
+	e = test_ScanKeys(root, kdesc, keys, range, &n);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0, j = 0; i < range; i++) {
+		if (!present[i]) continue;
+		if (j >= n || keys[j] != i) ok = FALSE;
+		j++;
+	}
+	if (j != n) ok = FALSE;
+
+	for (i = 0; i < range; i++) {
+		e = test_Lookup(root, kdesc, i, &found, &oid);
+		if (e < eNOERROR) return(e);
+		if (found != present[i] || (found && oid.unique != i)) ok = FALSE;
+	}
+
+	if (!ok) printf("FAIL: wrong objects %s\n", what);
+	if (!ok) nFailures++;
+
+	return(eNOERROR);
+
+}   /* test_CheckKeys() */
+
+
+/*@================================
+ * test_Collect()
+ *================================*/
+/*
+ * Function: Four test_Collect(void*, Four, Four, BtreeCursor*)
+ *
+ * Description:
+ *  Callback of the scans which collects the objects handed to it into a
+ *  TestCollect.
+ *
+ * Returns:
+ *  error code
+ *    eNOERROR
+ */
+Four test_Collect(
+	void *arg,						/* IN TestCollect collecting the objects */
+	Four group,						/* IN # of the range or of the first part */
+	Four n,							/* IN # of the cursors */
+	BtreeCursor *cursors)			/* IN cursors of the objects */
+{
+	TestCollect *c = (TestCollect*)arg;	/* objects collected */
+	Four i;							/* index */
+	Four_Invariable v;				/* integer of a key value */
+	Four_Invariable w;				/* integer of the second part */
+
+
+	for (i = 0; i < n; i++) {
+		memcpy(&v, &cursors[i].key.val[0], sizeof(Four_Invariable));
+		w = 0;
+		if (cursors[i].key.len >= 2*sizeof(Four_Invariable))
+			memcpy(&w, &cursors[i].key.val[sizeof(Four_Invariable)], sizeof(Four_Invariable));
+
+		if (c->n > 0 && c->n <= c->max &&
+			(c->keys[c->n-1] > v || (c->keys[c->n-1] == v && c->seconds[c->n-1] >= w)))
+			c->ordered = FALSE;
+
+		if (c->n < c->max) {
+			c->keys[c->n] = v;
+			c->seconds[c->n] = w;
+			c->groups[c->n] = group;
+		}
+		c->n++;
+	}
+
+	return(eNOERROR);
+
+}   /* test_Collect() */
+
+
+
+/*@================================
+ * test_CountLeaves()
+ *================================*/
+/*
+ * Function: Four test_CountLeaves(PageID*, Four*)
+ *
+ * Description:
+ *  Count the leaves of an index by following the leaf list from the leftmost
+ *  leaf, and check that each leaf points back to the one before it.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CountLeaves(
+	PageID *root,					/* IN root of the index */
+	Four *n)						/* OUT # of the leaves */
+{
+	Four e;							/* for errors */
+	PageID pid;						/* page read */
+	PageID next;					/* the page after it */
+	ShortPageID prev;				/* the leaf before it */
+	BtreePage *apage;				/* buffer holding the page */
+
+
+	*n = 0;
+	pid = *root;
+	prev = NIL;
+
+	for (;;) {
+		e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+		CHECKERR(e);
+
+		next = pid;
+		if (apage->any.hdr.type & INTERNAL) next.pageNo = apage->bi.hdr.p0;
+		else {
+			CHECK(apage->bl.hdr.prevPage == prev, "a leaf does not point back to the leaf before it");
+			(*n)++;
+			prev = pid.pageNo;
+			next.pageNo = apage->bl.hdr.nextPage;
+		}
+
+		e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+		CHECKERR(e);
+
+		if (next.pageNo == NIL) break;
+		pid = next;
+	}
+
+	return(eNOERROR);
+
+}   /* test_CountLeaves() */
+
+
+
+/*@================================
+ * test_CountDealloc()
+ *================================*/
+/*
+ * Function: Four test_CountDealloc(void)
+ *
+ * Description:
+ *  Count the pages handed to the dealloc list of the test module.
+ *
+ * Returns:
+ *  # of the elements in the dealloc list
+ */
+Four test_CountDealloc(void)
+{
+	Four n;							/* # of elements */
+	DeallocListElem *dlElem;		/* an element of the dealloc list */
+
+
+	for (n = 0, dlElem = dlHead.next; dlElem != NULL; dlElem = dlElem->next) n++;
+
+	return(n);
+
+}   /* test_CountDealloc() */
+
+
+
+/*@================================
+ * test_CountChanges()
+ *================================*/
+/*
+ * Function: Four test_CountChanges(PageID*, Four*)
+ *
+ * Description:
+ *  Count the records in the change buffer of an index.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CountChanges(
+	PageID *root,					/* IN root of the index */
+	Four *n)						/* OUT # of the change records */
+{
+	Four e;							/* for errors */
+	PageID pid;						/* page read */
+	ShortPageID next;				/* the page after it */
+	BtreePage *apage;				/* buffer holding the page */
+
+
+	*n = 0;
+
+	e = edubtm_GetMetaPage(NULL, root, FALSE, &pid);
+	CHECKERR(e);
+	if (pid.pageNo == NIL) return(eNOERROR);
+
+	e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	next = apage->bm.hdr.cbFirst;
+	e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+	CHECKERR(e);
+
+	while (next != NIL) {
+		pid.pageNo = next;
+		e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+		CHECKERR(e);
+		*n += apage->bc.hdr.nRecords;
+		next = apage->bc.hdr.nextPage;
+		e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+		CHECKERR(e);
+	}
+
+	return(eNOERROR);
+
+}   /* test_CountChanges() */
+
+
+
+/*@================================
+ * test_CountFreePages()
+ *================================*/
+/*
+ * Function: Four test_CountFreePages(PageID*, Four*)
+ *
+ * Description:
+ *  Count the pages in the free page list kept by the meta page of an index.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CountFreePages(
+	PageID *root,					/* IN root of the index */
+	Four *n)						/* OUT # of the pages in the list */
+{
+	Four e;							/* for errors */
+	PageID pid;						/* the meta page */
+	BtreePage *apage;				/* buffer holding the page */
+
+
+	*n = 0;
+
+	e = edubtm_GetMetaPage(NULL, root, FALSE, &pid);
+	CHECKERR(e);
+	if (pid.pageNo == NIL) return(eNOERROR);
+
+	e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	*n = apage->bm.hdr.nFreePages;
+	e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+	CHECKERR(e);
+
+	return(eNOERROR);
+
+}   /* test_CountFreePages() */
+
+
+
+/*@================================
+ * test_CountBackwardLeaves()
+ *================================*/
+/*
+ * Function: Four test_CountBackwardLeaves(PageID*, Four*)
+ *
+ * Description:
+ *  Count the leaves of an index which lie on the volume before the leaf
+ *  preceding them in the leaf list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CountBackwardLeaves(
+	PageID *root,					/* IN root of the index */
+	Four *n)						/* OUT # of the leaves out of the key order */
+{
+	Four e;							/* for errors */
+	PageID pid;						/* page read */
+	PageID next;					/* the page after it */
+	ShortPageID prev;				/* the leaf before it */
+	BtreePage *apage;				/* buffer holding the page */
+
+
+	*n = 0;
+	pid = *root;
+	prev = NIL;
+
+	for (;;) {
+		e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+		CHECKERR(e);
+
+		next = pid;
+		if (apage->any.hdr.type & INTERNAL) next.pageNo = apage->bi.hdr.p0;
+		else {
+			if (prev != NIL && pid.pageNo < prev) (*n)++;
+			prev = pid.pageNo;
+			next.pageNo = apage->bl.hdr.nextPage;
+		}
+
+		e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+		CHECKERR(e);
+
+		if (next.pageNo == NIL) break;
+		pid = next;
+	}
+
+	return(eNOERROR);
+
+}   /* test_CountBackwardLeaves() */
+
+
+
+/*@================================
+ * test_GetEndLeafHints()
+ *================================*/
+/*
+ * Function: Four test_GetEndLeafHints(PageID*, ShortPageID*, ShortPageID*)
+ *
+ * Description:
+ *  Read the leftmost and the rightmost leaves remembered by the meta page
+ *  of an index; both are NIL if the index has no meta page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_GetEndLeafHints(
+	PageID *root,					/* IN root of the index */
+	ShortPageID *first,				/* OUT the leftmost leaf remembered */
+	ShortPageID *last)				/* OUT the rightmost leaf remembered */
+{
+	Four e;							/* for errors */
+	PageID pid;						/* the meta page */
+	BtreePage *apage;				/* buffer holding the page */
+
+
+	*first = *last = NIL;
+
+	e = edubtm_GetMetaPage(NULL, root, FALSE, &pid);
+	CHECKERR(e);
+	if (pid.pageNo == NIL) return(eNOERROR);
+
+	e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	*first = apage->bm.hdr.firstLeaf;
+	*last = apage->bm.hdr.lastLeaf;
+	e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+	CHECKERR(e);
+
+	return(eNOERROR);
+
+}   /* test_GetEndLeafHints() */
+
+
+
+/*@================================
+ * test_TreeLeaf()
+ *================================*/
+/*
+ * Function: Four test_TreeLeaf(PageID*, KeyDesc*, Four, ShortPageID*)
+ *
+ * Description:
+ *  Find the leaf of a key value of an index of an integer key by going
+ *  down the tree. The descent notes its path, so the model of the leaves
+ *  is not used.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_TreeLeaf(
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Four n,							/* IN key value */
+	ShortPageID *pageNo)			/* OUT page of the leaf */
+{
+	Four e;							/* for errors */
+	KeyValue kval;					/* key value */
+	PageID leaf;					/* leaf of the key value */
+	BtreePage *apage;				/* buffer holding the leaf */
+	btm_TreePath path;				/* internal pages on the way */
+
+
+	test_SetKey(&kval, n);
+	e = edubtm_SearchLeaf(root, kdesc, &kval, FALSE, BTM_LATCH_S, &path, &leaf, &apage);
+	if (e < eNOERROR) return(e);
+	*pageNo = leaf.pageNo;
+
+	return(edubtm_UnfixPage(&leaf, FALSE));
+
+}   /* test_TreeLeaf() */
+
+
+
+/*@================================
+ * test_CachedLookup()
+ *================================*/
+/*
+ * Function: Four test_CachedLookup(PageID*, KeyDesc*, Four, Boolean*, ObjectID*)
+ *
+ * Description:
+ *  Look up a key value of an index of an integer key in its result cache
+ *  only.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_CachedLookup(
+	PageID *root,					/* IN root of the index */
+	KeyDesc *kdesc,					/* IN key descriptor */
+	Four n,							/* IN key value */
+	Boolean *hit,					/* OUT TRUE if the cache answered the lookup */
+	ObjectID *oid)					/* OUT ObjectID found */
+{
+	Four e;							/* for errors */
+	KeyValue kval;					/* key value */
+	BtreeCursor cursor;				/* cursor of the lookup */
+
+
+	test_SetKey(&kval, n);
+	e = edubtm_ResultCacheFetch(root, kdesc, &kval, &kval, SM_EQ, &cursor, hit);
+	if (e < eNOERROR) return(e);
+	if (*hit && cursor.flag == CURSOR_ON) *oid = cursor.oid;
+
+	return(eNOERROR);
+
+}   /* test_CachedLookup() */
+
+
+
+/*@================================
+ * test_InsertWorker()
+ *================================*/
+/*
+ * Function: void *test_InsertWorker(void*)
+ *
+ * Description:
+ *  Body of a thread of the concurrent inserts.
+ *
+ * Returns:
+ *  NULL
+ *
+ * Side effects:
+ *  the error and the done fields of the TestWorker
+ */
+void *test_InsertWorker(
+	void *arg)						/* IN TestWorker of the thread */
+{
+	TestWorker *w = (TestWorker*)arg;	/* work of the thread */
+	Four i;							/* index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+
+
+	w->error = eNOERROR;
+	for (i = 0; i < w->n && w->error >= eNOERROR; i++) {
+		test_SetKey(&kval, w->first + w->step*i);
+		test_SetOid(&oid, w->first + w->step*i);
+		w->error = EduBtM_InsertObject(w->catObjForFile, w->root, w->kdesc, &kval, &oid, &dlPool, &dlHead);
+	}
+	w->done = TRUE;
+
+	return(NULL);
+
+}   /* test_InsertWorker() */
+
+
+
+/*@================================
+ * test_LookupWorker()
+ *================================*/
+/*
+ * Function: void *test_LookupWorker(void*)
+ *
+ * Description:
+ *  Body of a thread looking up the key value 'first' by EduBtM_Fetch().
+ *
+ * Returns:
+ *  NULL
+ *
+ * Side effects:
+ *  the error, the found and the done fields of the TestWorker
+ */
+void *test_LookupWorker(
+	void *arg)						/* IN TestWorker of the thread */
+{
+	TestWorker *w = (TestWorker*)arg;	/* work of the thread */
+	KeyValue kval;					/* key value */
+	BtreeCursor cursor;				/* cursor of the lookup */
+
+
+	test_SetKey(&kval, w->first);
+	w->error = EduBtM_Fetch(w->root, w->kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	w->found = (w->error >= eNOERROR && cursor.flag == CURSOR_ON && cursor.oid.unique == w->first);
+	w->done = TRUE;
+
+	return(NULL);
+
+}   /* test_LookupWorker() */
+
+
+
+/*@================================
+ * test_InsertDelete()
+ *================================*/
+/*
+ * Function: Four test_InsertDelete(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Insert key values in a shuffled order, delete half of them, and insert
+ *  them again into the pages freed meanwhile.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_InsertDelete(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts");
+	if (e < eNOERROR) return(e);
+
+	test_SetKey(&kval, 10);
+	test_SetOid(&oid, 10);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eDUPLICATEDKEY_BTM, "a duplicated key value is inserted");
+
+	for (i = 1; i < NUMOFTESTKEYS; i += 2) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = FALSE;
+	}
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the deletes");
+	if (e < eNOERROR) return(e);
+
+	test_SetKey(&kval, 1);
+	test_SetOid(&oid, 1);
+	e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eNOTFOUND_BTM, "a key value not in the index is deleted");
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts again");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_InsertDelete() */
+
+
+
+/*@================================
+ * test_DeleteRange()
+ *================================*/
+/*
+ * Function: Four test_DeleteRange(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Delete a range in the middle of an index, and the ranges unbounded
+ *  below and above. The leaves lying inside the middle range are unlinked
+ *  from the leaf list and go to the dealloc list as a whole.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_DeleteRange(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nLeaves, n;				/* # of the leaves before and after a delete */
+	Four nFreed;					/* # of the pages in the dealloc list before a delete */
+	PageID root;					/* root of the index */
+	KeyValue low, high;				/* bounds of a range */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+	nFreed = test_CountDealloc();
+
+	test_SetKey(&low, 500);
+	test_SetKey(&high, 1499);
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, &low, &high, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	e = test_CountLeaves(&root, &n);
+	if (e < eNOERROR) return(e);
+	CHECK(n < nLeaves, "no leaf inside the range is unlinked");
+	CHECK(test_CountDealloc() - nFreed >= nLeaves - n, "the unlinked leaves are not in the dealloc list");
+
+	for (i = 500; i <= 1499; i++) present[i] = FALSE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting [500, 1499]");
+	if (e < eNOERROR) return(e);
+
+	test_SetKey(&high, 99);
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, NULL, &high, &dlPool, &dlHead);
+	CHECKERR(e);
+	for (i = 0; i <= 99; i++) present[i] = FALSE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting [BOF, 99]");
+	if (e < eNOERROR) return(e);
+
+	test_SetKey(&low, 1900);
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, &low, NULL, &dlPool, &dlHead);
+	CHECKERR(e);
+	for (i = 1900; i < NUMOFTESTKEYS; i++) present[i] = FALSE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting [1900, EOF]");
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, NULL, NULL, &dlPool, &dlHead);
+	CHECKERR(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = FALSE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting all");
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 3, NUMOFTESTKEYS/3);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 3 == 0 && i/3 < NUMOFTESTKEYS/3);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts into the emptied index");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_DeleteRange() */
+
+
+
+/*@================================
+ * test_DeleteBatch()
+ *================================*/
+/*
+ * Function: Four test_DeleteBatch(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Delete an unsorted batch of pairs, some of which are not in the index,
+ *  and check that the batch is left as it was given. The leaves emptied by
+ *  the last batch are merged when the batch ends, and their pages go to
+ *  the dealloc list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_DeleteBatch(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i, n;						/* indexes */
+	Four nLeaves, nLeft;			/* # of the leaves before and after the last batch */
+	Four nFreed;					/* # of the pages in the dealloc list before the last batch */
+	PageID root;					/* root of the index */
+	static BatchItem items[NUMOFTESTKEYS];	/* batch of the pairs to delete */
+	static BatchItem copy[NUMOFTESTKEYS];	/* the batch as given */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0);
+
+	/* the multiples of 3 in the descending order; the odd ones are not in the index */
+	for (i = NUMOFTESTKEYS-1, n = 0; i >= 0; i--) {
+		if (i % 3 != 0) continue;
+		memset(&items[n], 0, sizeof(BatchItem));
+		test_SetKey(&items[n].kval, i);
+		test_SetOid(&items[n].oid, i);
+		n++;
+		present[i] = FALSE;
+	}
+	memcpy(copy, items, sizeof(BatchItem)*n);
+
+	e = EduBtM_DeleteBatch(catObjForFile, &root, kdesc, n, items, &dlPool, &dlHead);
+	CHECKERR(e);
+	CHECK(memcmp(copy, items, sizeof(BatchItem)*n) == 0, "the batch is changed");
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the batch delete");
+	if (e < eNOERROR) return(e);
+
+	/* a pair with a wrong ObjectID is not deleted */
+	memset(&items[0], 0, sizeof(BatchItem));
+	test_SetKey(&items[0].kval, 2);
+	test_SetOid(&items[0].oid, 3);
+	e = EduBtM_DeleteBatch(catObjForFile, &root, kdesc, 1, items, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	/* all the rest */
+	for (i = 0, n = 0; i < NUMOFTESTKEYS; i++) {
+		if (!present[i]) continue;
+		memset(&items[n], 0, sizeof(BatchItem));
+		test_SetKey(&items[n].kval, i);
+		test_SetOid(&items[n].oid, i);
+		n++;
+	}
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting a wrong pair");
+	if (e < eNOERROR) return(e);
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+	nFreed = test_CountDealloc();
+
+	e = EduBtM_DeleteBatch(catObjForFile, &root, kdesc, n, items, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	e = test_CountLeaves(&root, &nLeft);
+	if (e < eNOERROR) return(e);
+	CHECK(nLeft < nLeaves, "the emptied leaves are not merged");
+	CHECK(test_CountDealloc() - nFreed >= nLeaves - nLeft, "the merged leaves are not in the dealloc list");
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = FALSE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting all");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_DeleteBatch() */
+
+
+
+/*@================================
+ * test_InsertIfAbsentUpsert()
+ *================================*/
+/*
+ * Function: Four test_InsertIfAbsentUpsert(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Insert key values present and absent by EduBtM_InsertIfAbsent() and
+ *  EduBtM_Upsert().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_InsertIfAbsentUpsert(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	ObjectID oldOid;				/* ObjectID found in the index */
+	Boolean exists;					/* TRUE if the key value was in the index */
+	Boolean found;					/* TRUE if a lookup finds its key value */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < 200; i++) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, 10000+i);
+		e = EduBtM_InsertIfAbsent(catObjForFile, &root, kdesc, &kval, &oid, &exists, &oldOid, &dlPool, &dlHead);
+		CHECKERR(e);
+		CHECK(exists == (i % 2 == 0), "InsertIfAbsent tells a wrong existence");
+		if (exists) CHECK(oldOid.unique == i, "InsertIfAbsent returns a wrong ObjectID");
+
+		e = test_Lookup(&root, kdesc, i, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found && oid.unique == ((i % 2 == 0) ? i : 10000+i), "InsertIfAbsent leaves a wrong ObjectID");
+	}
+
+	for (i = 0; i < 400; i++) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, 20000+i);
+		e = EduBtM_Upsert(catObjForFile, &root, kdesc, &kval, &oid, &exists, &oldOid, &dlPool, &dlHead);
+		CHECKERR(e);
+		CHECK(exists == (i < 200 || i % 2 == 0), "Upsert tells a wrong existence");
+		if (exists) CHECK(oldOid.unique == ((i % 2 == 0) ? i : 10000+i), "Upsert returns a wrong ObjectID");
+
+		e = test_Lookup(&root, kdesc, i, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found && oid.unique == 20000+i, "Upsert leaves a wrong ObjectID");
+	}
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_InsertIfAbsentUpsert() */
+
+
+
+/*@================================
+ * test_UpdateKey()
+ *================================*/
+/*
+ * Function: Four test_UpdateKey(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Change the key values of objects, within the same leaf and to far away
+ *  leaves. A new key value within the range of the leaf is found in the
+ *  same leaf afterwards.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_UpdateKey(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	KeyValue oldKey, newKey;		/* key values */
+	ObjectID oid;					/* ObjectID */
+	Boolean found;					/* TRUE if a lookup finds its key value */
+	BtreeCursor before, after;		/* cursors on the old and the new key values */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+
+	/* 2i -> 2i+1 stays in the leaf; 2i -> 2i+NUMOFTESTKEYS+1 moves to the end */
+	for (i = 0; i < NUMOFTESTKEYS; i += 4) {
+		test_SetKey(&oldKey, i);
+		test_SetKey(&newKey, (i % 8 == 0) ? i+1 : i+NUMOFTESTKEYS+1);
+		test_SetOid(&oid, i);
+		e = EduBtM_Fetch(&root, kdesc, &oldKey, SM_EQ, &oldKey, SM_EQ, &before);
+		CHECKERR(e);
+
+		e = EduBtM_UpdateKey(catObjForFile, &root, kdesc, &oldKey, &newKey, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+
+		/* a key value staying in the range of its leaf is moved within the leaf */
+		if (i % 8 != 0) continue;
+		e = EduBtM_Fetch(&root, kdesc, &newKey, SM_EQ, &newKey, SM_EQ, &after);
+		CHECKERR(e);
+		CHECK(after.flag == CURSOR_ON && after.leaf.pageNo == before.leaf.pageNo, "an entry is moved out of its leaf");
+	}
+
+	for (i = 0; i < NUMOFTESTKEYS; i += 2) {
+		e = test_Lookup(&root, kdesc, i, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found == (i % 4 != 0), "an updated key value is found");
+		if (i % 4 != 0) continue;
+
+		e = test_Lookup(&root, kdesc, (i % 8 == 0) ? i+1 : i+NUMOFTESTKEYS+1, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found && oid.unique == i, "the new key value is not found");
+	}
+
+	test_SetKey(&oldKey, 3);
+	test_SetKey(&newKey, 5);
+	test_SetOid(&oid, 3);
+	e = EduBtM_UpdateKey(catObjForFile, &root, kdesc, &oldKey, &newKey, &oid, &dlPool, &dlHead);
+	CHECK(e == eNOTFOUND_BTM, "a key value not in the index is updated");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_UpdateKey() */
+
+
+
+/*@================================
+ * test_BufferedIndex()
+ *================================*/
+/*
+ * Function: Four test_BufferedIndex(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Insert and delete in the buffered mode, read the index while messages
+ *  are pending, and turn the mode off. The updates should wait in the
+ *  message buffer of the root, a duplicated key value or a missing one
+ *  should be refused even while its message is pending, and the leaves
+ *  emptied by the buffered deletes should be merged.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_BufferedIndex(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nPending;					/* # of the messages in the root */
+	Four nLeaves, nLeft;			/* # of the leaves before and after the deletes */
+	Four nDealloc;					/* # of the freed pages before the deletes */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	BtreePage *rpage;				/* buffer holding the root */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_SetBufferMode(&root, kdesc, TRUE);
+	CHECKERR(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, 1, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i >= NUMOFTESTKEYS/2 || (i < NUMOFTESTKEYS/2 && i % 2 == 0));
+
+	/* The last inserts wait in the message buffer of the root */
+	e = BfM_GetTrain((TrainID*)&root, (char**)&rpage, PAGE_BUF);
+	CHECKERR(e);
+	nPending = ((rpage->any.hdr.type & INTERNAL) && (rpage->bi.hdr.flags & BTM_MSGBUFFER)) ?
+	           BTM_MSGBUF_HDR(&(rpage->bi))->nMsgs : 0;
+	e = BfM_FreeTrain((TrainID*)&root, PAGE_BUF);
+	CHECKERR(e);
+	CHECK(nPending > 0, "the updates are not buffered in the root");
+
+	/* The pending messages and the leaves are both searched */
+	test_SetKey(&kval, 0);
+	test_SetOid(&oid, NUMOFTESTKEYS);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eDUPLICATEDKEY_BTM, "a duplicated key value in a leaf is inserted");
+
+	for (i = NUMOFTESTKEYS/2; i < NUMOFTESTKEYS; i++) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, NUMOFTESTKEYS);
+		e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		if (e != eDUPLICATEDKEY_BTM) break;
+	}
+	CHECK(i == NUMOFTESTKEYS, "a duplicated key value in a message is inserted");
+
+	test_SetKey(&kval, 1);
+	test_SetOid(&oid, 1);
+	e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eNOTFOUND_BTM, "a key value not in the index is deleted");
+
+	test_SetKey(&kval, NUMOFTESTKEYS-1);
+	test_SetOid(&oid, 0);
+	e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eNOTFOUND_BTM, "a key value is deleted with another ObjectID");
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+	nDealloc = test_CountDealloc();
+
+	/* The deletes empty the leaves of the upper half on their delivery */
+	for (i = NUMOFTESTKEYS/2; i < NUMOFTESTKEYS; i++) {
+		if (i % 8 == 0) continue;
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = FALSE;
+	}
+
+	e = test_CountLeaves(&root, &nLeft);
+	if (e < eNOERROR) return(e);
+	CHECK(nLeft < nLeaves && test_CountDealloc() > nDealloc, "the leaves emptied by buffered deletes are not merged");
+
+	/* A deleted key value can be inserted again while its delete is pending */
+	test_SetKey(&kval, NUMOFTESTKEYS-1);
+	test_SetOid(&oid, NUMOFTESTKEYS-1);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+	present[NUMOFTESTKEYS-1] = TRUE;
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "in the buffered mode");
+	if (e < eNOERROR) return(e);
+
+	for (i = 1; i < NUMOFTESTKEYS/2; i += 2) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = TRUE;
+	}
+
+	e = EduBtM_SetBufferMode(&root, kdesc, FALSE);
+	CHECKERR(e);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the buffered mode");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_BufferedIndex() */
+
+
+
+/*@================================
+ * test_ChangeBuffer()
+ *================================*/
+/*
+ * Function: Four test_ChangeBuffer(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Force all the pages out of the buffer pool and delete with the change
+ *  buffer on. The deletes should be kept in the change buffer without
+ *  reading the leaves, an insert should still refuse a duplicated key
+ *  value, and the changes should be merged by a background merge and by
+ *  the reads.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_ChangeBuffer(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nDeleted;					/* # of the deletes */
+	Four nChanges;					/* # of the records in the change buffer */
+	Four nLeft;						/* # of the records left after a merge */
+	PageID root;					/* root of the index */
+	PageID leaf;					/* leaf of the first key value */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0);
+
+	e = EduBtM_SetChangeBuffering(catObjForFile, &root, kdesc, TRUE);
+	CHECKERR(e);
+
+	test_SetKey(&kval, 0);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECKERR(e);
+	leaf = cursor.leaf;
+
+	/* Force the leaves out of the buffer pool; the cached upper levels are given back first */
+	e = edubtm_ReleaseUpperCache(&root);
+	CHECKERR(e);
+	e = BfM_FlushAll();
+	CHECKERR(e);
+	e = BfM_DiscardAll();
+	CHECKERR(e);
+	CHECK(bfm_LookUp((TrainID*)&leaf, PAGE_BUF) == NOTFOUND_IN_HTABLE, "the leaf is not forced out of the buffer pool");
+
+	for (i = 0, nDeleted = 0; i < NUMOFTESTKEYS; i += 10) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = FALSE;
+		nDeleted++;
+	}
+
+	/* The deletes are kept in the change buffer without reading the leaves */
+	CHECK(bfm_LookUp((TrainID*)&leaf, PAGE_BUF) == NOTFOUND_IN_HTABLE, "a buffered delete reads its leaf");
+	e = test_CountChanges(&root, &nChanges);
+	if (e < eNOERROR) return(e);
+	CHECK(nChanges == nDeleted, "the deletes are not kept in the change buffer");
+
+	/* An insert reads the leaf to find a duplicated key value */
+	test_SetKey(&kval, 2);
+	test_SetOid(&oid, NUMOFTESTKEYS);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECK(e == eDUPLICATEDKEY_BTM, "a duplicated key value is inserted into a leaf not in the buffer pool");
+
+	/* The pending delete of a key value is merged before it is inserted again */
+	test_SetKey(&kval, 0);
+	test_SetOid(&oid, 0);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+	present[0] = TRUE;
+	e = test_CountChanges(&root, &nLeft);
+	if (e < eNOERROR) return(e);
+	CHECK(nLeft == nChanges-1, "the pending delete of an inserted key value is not merged");
+
+	/* A background merge in a small step */
+	e = EduBtM_MergeChangeBuffer(&root, kdesc, 50);
+	CHECKERR(e);
+	e = test_CountChanges(&root, &nChanges);
+	if (e < eNOERROR) return(e);
+	CHECK(nChanges == nLeft-50, "a background merge does not merge the given # of changes");
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 1; i < NUMOFTESTKEYS; i += 2) present[i] = TRUE;
+
+	/* The reads merge the changes */
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "with the change buffer");
+	if (e < eNOERROR) return(e);
+	e = test_CountChanges(&root, &nChanges);
+	if (e < eNOERROR) return(e);
+	CHECK(nChanges == 0, "the reads do not merge the changes");
+
+	e = EduBtM_SetChangeBuffering(catObjForFile, &root, kdesc, FALSE);
+	CHECKERR(e);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the change buffering");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_ChangeBuffer() */
+
+
+
+/*@================================
+ * test_LatchCoupling()
+ *================================*/
+/*
+ * Function: Four test_LatchCoupling(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Hold the latch of the first leaf as another thread would, and insert
+ *  by a thread. An insert into another leaf should finish meanwhile, as
+ *  the pages are latched one by one, while an insert into the latched
+ *  leaf should wait for the latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_LatchCoupling(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	PageID first;					/* leaf of the first key value */
+	PageID last;					/* leaf of the last key value */
+	KeyValue kval;					/* key value */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	pthread_t thread;				/* the inserting thread */
+	TestWorker worker;				/* work of the thread */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0);
+
+	test_SetKey(&kval, 0);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECKERR(e);
+	first = cursor.leaf;
+	test_SetKey(&kval, NUMOFTESTKEYS-2);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECKERR(e);
+	last = cursor.leaf;
+	CHECK(first.pageNo != last.pageNo, "the index has a single leaf");
+
+	worker.catObjForFile = catObjForFile;
+	worker.root = &root;
+	worker.kdesc = kdesc;
+	worker.step = 2;
+	worker.n = 1;
+
+	e = edubtm_LatchPage(&first, BTM_LATCH_X);
+	CHECKERR(e);
+
+	/* An insert into the last leaf does not need the latch of the first one */
+	worker.first = NUMOFTESTKEYS-1;
+	worker.done = FALSE;
+	present[NUMOFTESTKEYS-1] = TRUE;
+	if (pthread_create(&thread, NULL, test_InsertWorker, &worker) != 0) {
+		(Four) edubtm_UnlatchPage(&first);
+		CHECK(FALSE, "a thread is not created");
+		return(eNOERROR);
+	}
+	for (i = 0; i < 500 && !worker.done; i++) usleep(10000);
+	CHECK(worker.done, "an insert into another leaf waits for the latch of a leaf");
+
+	/* An insert into the first leaf waits until its latch is released */
+	if (worker.done) {
+		pthread_join(thread, NULL);
+		CHECKERR(worker.error);
+
+		worker.first = 1;
+		worker.done = FALSE;
+		if (pthread_create(&thread, NULL, test_InsertWorker, &worker) != 0) {
+			(Four) edubtm_UnlatchPage(&first);
+			CHECK(FALSE, "a thread is not created");
+			return(eNOERROR);
+		}
+		usleep(200000);
+		CHECK(!worker.done, "an insert into a leaf does not wait for the latch of the leaf");
+		present[1] = TRUE;
+	}
+
+	e = edubtm_UnlatchPage(&first);
+	pthread_join(thread, NULL);
+	CHECKERR(e);
+	CHECKERR(worker.error);
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the latched inserts");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_LatchCoupling() */
+
+
+
+/*@================================
+ * test_ConcurrentInsert()
+ *================================*/
+/*
+ * Function: Four test_ConcurrentInsert(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Insert interleaved key values by several threads at the same time, so
+ *  that they split the same pages, and read the index meanwhile.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_ConcurrentInsert(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	pthread_t threads[NUMOFTESTTHREADS];	/* the inserting threads */
+	TestWorker workers[NUMOFTESTTHREADS];	/* work of the threads */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+	Four keys[NUMOFTESTKEYS];		/* key values read */
+	Four n;							/* # of the objects read */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTTHREADS; i++) {
+		workers[i].catObjForFile = catObjForFile;
+		workers[i].root = &root;
+		workers[i].kdesc = kdesc;
+		workers[i].first = i;
+		workers[i].step = NUMOFTESTTHREADS;
+		workers[i].n = NUMOFTESTKEYS/NUMOFTESTTHREADS;
+		if (pthread_create(&threads[i], NULL, test_InsertWorker, &workers[i]) != 0) {
+			workers[i].error = eNOERROR;
+			threads[i] = 0;
+			CHECK(FALSE, "a thread is not created");
+		}
+	}
+
+	e = test_ScanKeys(&root, kdesc, keys, NUMOFTESTKEYS, &n);
+
+	for (i = 0; i < NUMOFTESTTHREADS; i++) {
+		if (threads[i] != 0) pthread_join(threads[i], NULL);
+		CHECKERR(workers[i].error);
+	}
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the concurrent inserts");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_ConcurrentInsert() */
+
+
+
+/*@================================
+ * test_OptimisticRead()
+ *================================*/
+/*
+ * Function: Four test_OptimisticRead(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Check the version word of the root, which the readers validate instead
+ *  of latching it. A lookup should leave the version as it is, while an
+ *  exclusive latch should invalidate it; a lookup meanwhile should start
+ *  over until the latch is released and then find its key value.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_OptimisticRead(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	PageID root;					/* root of the index */
+	UFour version;					/* version of the root */
+	UFour latched;					/* version of the root under the exclusive latch */
+	Boolean found;					/* TRUE if a key value is found */
+	pthread_t thread;				/* the looking up thread */
+	TestWorker worker;				/* work of the thread */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+
+	/* A lookup does not write the version of the root */
+	CHECK(edubtm_ReadVersion(&root, &version), "the root is latched exclusively after the inserts");
+	e = test_Lookup(&root, kdesc, NUMOFTESTKEYS/2, &found, NULL);
+	if (e < eNOERROR) return(e);
+	CHECK(found, "a key value is not found");
+	CHECK(edubtm_ValidateVersion(&root, version), "a lookup changes the version of the root");
+
+	/* A writer invalidates the version read */
+	e = edubtm_LatchPage(&root, BTM_LATCH_X);
+	CHECKERR(e);
+	CHECK(!edubtm_ReadVersion(&root, &latched), "the version of a latched root is valid");
+	CHECK(!edubtm_ValidateVersion(&root, version), "an exclusive latch does not invalidate the version");
+
+	worker.root = &root;
+	worker.kdesc = kdesc;
+	worker.first = NUMOFTESTKEYS/2;
+	worker.done = FALSE;
+	if (pthread_create(&thread, NULL, test_LookupWorker, &worker) != 0) {
+		(Four) edubtm_UnlatchPage(&root);
+		CHECK(FALSE, "a thread is not created");
+		return(eNOERROR);
+	}
+	usleep(200000);
+	CHECK(!worker.done, "a lookup uses a root being written");
+
+	e = edubtm_UnlatchPage(&root);
+	pthread_join(thread, NULL);
+	CHECKERR(e);
+	CHECKERR(worker.error);
+	CHECK(worker.found, "a lookup started over does not find its key value");
+	CHECK(edubtm_ReadVersion(&root, &latched) && latched != version, "releasing an exclusive latch does not bump the version");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_OptimisticRead() */
+
+
+
+/*@================================
+ * test_RightLink()
+ *================================*/
+/*
+ * Function: Four test_RightLink(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Split the first leaf by a thread while the root is latched in the
+ *  shared mode, so that the separator cannot be posted. The split should
+ *  be visible meanwhile by the right link of the leaf, and a lookup of a
+ *  key value moved to the new leaf should follow it. Once the root is
+ *  released, the separator should be posted and the link removed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_RightLink(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four highest;					/* the greatest key value in the first leaf */
+	PageID root;					/* root of the index */
+	PageID first;					/* leaf of the first key value */
+	PageID right;					/* the new leaf */
+	KeyValue kval;					/* key value */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	BtreeCursor next;				/* cursor of the next object */
+	BtreePage *apage;				/* buffer holding the first leaf */
+	Boolean pending;				/* TRUE if the split of the first leaf is pending */
+	pthread_t thread;				/* the inserting thread */
+	TestWorker worker;				/* work of the thread */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0);
+
+	/* Find the greatest key value in the first leaf */
+	test_SetKey(&kval, 0);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_BOF, &kval, SM_EOF, &cursor);
+	CHECKERR(e);
+	first = cursor.leaf;
+	while (cursor.flag == CURSOR_ON && cursor.leaf.pageNo == first.pageNo) {
+		highest = cursor.oid.unique;
+		e = EduBtM_FetchNext(&root, kdesc, &kval, SM_EOF, &cursor, &next);
+		CHECKERR(e);
+		cursor = next;
+	}
+	CHECK(cursor.flag == CURSOR_ON, "the index has a single leaf");
+
+	/* The separator of a split cannot be posted to the root meanwhile */
+	e = edubtm_LatchPage(&root, BTM_LATCH_S);
+	CHECKERR(e);
+
+	worker.catObjForFile = catObjForFile;
+	worker.root = &root;
+	worker.kdesc = kdesc;
+	worker.first = 1;
+	worker.step = 2;
+	worker.n = highest;
+	worker.done = FALSE;
+	if (pthread_create(&thread, NULL, test_InsertWorker, &worker) != 0) {
+		(Four) edubtm_UnlatchPage(&root);
+		CHECK(FALSE, "a thread is not created");
+		return(eNOERROR);
+	}
+
+	for (i = 0, pending = FALSE; i < 500 && !pending && !worker.done; i++) {
+		usleep(10000);
+		if ((e = edubtm_FixPage(&first, &apage, BTM_LATCH_S)) < 0) break;
+		pending = (apage->any.hdr.flags & BTM_SPLITPENDING) ? TRUE : FALSE;
+		if (pending) pending = edubtm_FollowRightLink(&first, apage, kdesc, NULL, TRUE, &right);
+		if ((e = edubtm_UnfixPage(&first, FALSE)) < 0) break;
+	}
+	CHECK(pending, "the split of a leaf has no right link while its parent is latched");
+	CHECK(!worker.done, "the separator of a split is posted to a latched parent");
+
+	/* The key value moved to the new leaf is found through the right link */
+	if (e >= eNOERROR && pending) {
+		test_SetKey(&kval, highest);
+		e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+		CHECK(e >= eNOERROR && cursor.flag == CURSOR_ON && cursor.leaf.pageNo == right.pageNo,
+			  "a lookup does not follow the right link of a split leaf");
+	}
+
+	(Four) edubtm_UnlatchPage(&root);
+	pthread_join(thread, NULL);
+	CHECKERR(e);
+	CHECKERR(worker.error);
+	for (i = 1; i < 2*highest; i += 2) present[i] = TRUE;
+
+	e = edubtm_FixPage(&first, &apage, BTM_LATCH_S);
+	CHECKERR(e);
+	CHECK(!(apage->any.hdr.flags & BTM_SPLITPENDING), "the right link is left after the separator is posted");
+	e = edubtm_UnfixPage(&first, FALSE);
+	CHECKERR(e);
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the posted split");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_RightLink() */
+
+
+
+/*@================================
+ * test_ParallelScan()
+ *================================*/
+/*
+ * Function: Four test_ParallelScan(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Read a range by several threads, in the key order and in no order. The
+ *  range should be split into sub-ranges of consecutive key values, and in
+ *  the key order the sub-ranges should be handed over one after another.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_ParallelScan(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nGroups;					/* # of the sub-ranges read */
+	PageID root;					/* root of the index */
+	KeyValue start, stop;			/* conditions of the scan */
+	TestCollect c;					/* objects read */
+	Four keys[NUMOFTESTKEYS];		/* key values read */
+	Four seconds[NUMOFTESTKEYS];	/* second parts of the key values read */
+	Four groups[NUMOFTESTKEYS];		/* sub-ranges of the key values read */
+	Four lastKey[NUMOFTESTTHREADS];	/* the last key value read in a sub-range */
+	Boolean seen[NUMOFTESTKEYS];	/* TRUE for the key values read */
+	Boolean ok;						/* FALSE if a result is wrong */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+
+	c.keys = keys; c.seconds = seconds; c.groups = groups; c.max = NUMOFTESTKEYS;
+
+	/* in the key order */
+	c.n = 0; c.ordered = TRUE;
+	test_SetKey(&start, 100);
+	test_SetKey(&stop, 1899);
+	e = EduBtM_ParallelScan(&root, kdesc, &start, SM_GE, &stop, SM_LE, NUMOFTESTTHREADS, TRUE, test_Collect, &c);
+	CHECKERR(e);
+	CHECK(c.n == 1800, "the ordered scan reads a wrong # of objects");
+	CHECK(c.ordered, "the ordered scan is not in the key order");
+	for (i = 0, ok = TRUE; i < c.n && i < c.max; i++) if (keys[i] != 100+i) ok = FALSE;
+	CHECK(ok, "the ordered scan reads wrong objects");
+
+	/* the sub-ranges come one after another */
+	for (i = 1, nGroups = 1, ok = TRUE; i < c.n && i < c.max; i++) {
+		if (groups[i] < groups[i-1]) ok = FALSE;
+		if (groups[i] != groups[i-1]) nGroups++;
+	}
+	CHECK(ok, "the ordered scan hands over the sub-ranges out of order");
+	CHECK(nGroups > 1 && nGroups <= NUMOFTESTTHREADS, "the range is not split among the threads");
+
+	/* in no order */
+	c.n = 0; c.ordered = TRUE;
+	e = EduBtM_ParallelScan(&root, kdesc, &start, SM_BOF, &stop, SM_EOF, NUMOFTESTTHREADS, FALSE, test_Collect, &c);
+	CHECKERR(e);
+	CHECK(c.n == NUMOFTESTKEYS, "the unordered scan reads a wrong # of objects");
+	for (i = 0; i < NUMOFTESTKEYS; i++) seen[i] = FALSE;
+	for (i = 0, ok = TRUE; i < c.n && i < c.max; i++) {
+		if (keys[i] < 0 || keys[i] >= NUMOFTESTKEYS || seen[keys[i]]) ok = FALSE;
+		else seen[keys[i]] = TRUE;
+	}
+	CHECK(ok, "the unordered scan reads wrong objects");
+
+	/* each sub-range is read in the key order by its own cursor */
+	for (i = 0; i < NUMOFTESTTHREADS; i++) lastKey[i] = -1;
+	for (i = 0, ok = TRUE; i < c.n && i < c.max; i++) {
+		if (groups[i] < 0 || groups[i] >= NUMOFTESTTHREADS || keys[i] <= lastKey[groups[i]]) ok = FALSE;
+		else lastKey[groups[i]] = keys[i];
+	}
+	CHECK(ok, "a sub-range of the unordered scan is not in the key order");
+
+	/* an empty range */
+	c.n = 0;
+	test_SetKey(&start, 500);
+	test_SetKey(&stop, 500);
+	e = EduBtM_ParallelScan(&root, kdesc, &start, SM_GT, &stop, SM_LT, NUMOFTESTTHREADS, TRUE, test_Collect, &c);
+	CHECKERR(e);
+	CHECK(c.n == 0, "the empty range reads objects");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_ParallelScan() */
+
+
+
+/*@================================
+ * test_BulkLoad()
+ *================================*/
+/*
+ * Function: Four test_BulkLoad(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Load an empty index by several threads, reject an unsorted batch, and
+ *  insert into the loaded index. The loaded leaves should be packed more
+ *  densely than the leaves of an index built by inserting the same items.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_BulkLoad(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nLoaded;					/* # of the leaves of the loaded index */
+	Four nInserted;					/* # of the leaves of the index built by inserts */
+	PageID root;					/* root of the index */
+	PageID other;					/* root of the index built by inserts */
+	static BatchItem items[NUMOFTESTKEYS];	/* items to load */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS/2; i++) {
+		memset(&items[i], 0, sizeof(BatchItem));
+		test_SetKey(&items[i].kval, 2*i);
+		test_SetOid(&items[i].oid, 2*i);
+	}
+
+	/* a duplicated key value is found before any page is allocated */
+	items[100].kval = items[99].kval;
+	e = EduBtM_BulkLoad(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, items, NUMOFTESTTHREADS, &dlPool, &dlHead);
+	CHECK(e == eDUPLICATEDKEY_BTM, "an unsorted batch is loaded");
+	test_SetKey(&items[100].kval, 200);
+
+	e = EduBtM_BulkLoad(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, items, NUMOFTESTTHREADS, &dlPool, &dlHead);
+	CHECKERR(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the bulk load");
+	if (e < eNOERROR) return(e);
+
+	/* the same items inserted one by one leave half-full leaves behind */
+	e = test_CreateIndex(catObjForFile, &other);
+	if (e < eNOERROR) return(e);
+	e = test_InsertKeys(catObjForFile, &other, kdesc, 0, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+
+	e = test_CountLeaves(&root, &nLoaded);
+	CHECKERR(e);
+	e = test_CountLeaves(&other, &nInserted);
+	CHECKERR(e);
+	CHECK(nLoaded > 1 && nLoaded < nInserted, "the bulk load does not pack the leaves");
+
+	e = test_DropIndex(catObjForFile, &other);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts into the loaded index");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_BulkLoad() */
+
+
+
+/*@================================
+ * test_OnlineBuild()
+ *================================*/
+/*
+ * Function: Four test_OnlineBuild(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Insert and delete while an index is built by the bulk load, and apply
+ *  the side log at the end of the build. The changes should not reach the
+ *  tree before the end of the build, an insert also in the snapshot should
+ *  be applied harmlessly, and a key value inserted with another ObjectID
+ *  than in the snapshot should be rejected.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_OnlineBuild(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	Boolean found;					/* TRUE if a key value is found */
+	static BatchItem items[NUMOFTESTKEYS];	/* items to load */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_BeginOnlineBuild(catObjForFile, &root);
+	CHECKERR(e);
+
+	/* the changes made during the build go to the side log */
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 2, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0 || i < NUMOFTESTKEYS/2);
+
+	for (i = 1; i < NUMOFTESTKEYS/2; i += 6) {
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = FALSE;
+	}
+
+	e = test_Lookup(&root, kdesc, 1, &found, &oid);
+	CHECKERR(e);
+	CHECK(!found, "an insert during the build goes to the tree");
+
+	/* the same entry is in the snapshot */
+	e = test_InsertKeys(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, 1, 1);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS/2; i++) {
+		memset(&items[i], 0, sizeof(BatchItem));
+		test_SetKey(&items[i].kval, 2*i);
+		test_SetOid(&items[i].oid, 2*i);
+	}
+	e = EduBtM_BulkLoad(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, items, NUMOFTESTTHREADS, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	/* a delete of a loaded key value */
+	test_SetKey(&kval, 0);
+	test_SetOid(&oid, 0);
+	e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+	present[0] = FALSE;
+
+	e = EduBtM_EndOnlineBuild(&root, kdesc, &dlPool, &dlHead);
+	CHECKERR(e);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the online build");
+	if (e < eNOERROR) return(e);
+
+	e = test_DropIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	/* a key value of the snapshot inserted with another ObjectID */
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_BeginOnlineBuild(catObjForFile, &root);
+	CHECKERR(e);
+
+	test_SetKey(&kval, 4);
+	test_SetOid(&oid, NUMOFTESTKEYS+4);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	e = EduBtM_BulkLoad(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, items, NUMOFTESTTHREADS, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	e = EduBtM_EndOnlineBuild(&root, kdesc, &dlPool, &dlHead);
+	CHECK(e == eDUPLICATEDKEY_BTM, "a duplicated key value in the side log is replayed");
+
+	e = test_Lookup(&root, kdesc, 4, &found, &oid);
+	CHECKERR(e);
+	CHECK(found && oid.unique == 4, "the entry of the snapshot is replaced by the side log");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_OnlineBuild() */
+
+
+
+/*@================================
+ * test_FreePageList()
+ *================================*/
+/*
+ * Function: Four test_FreePageList(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Delete a range of an index whose root is the first page of a new file,
+ *  and check that the leaves unlinked by the delete are kept in the free
+ *  page list instead of the dealloc list. The inserts of the range again
+ *  take the pages of the list for their splits.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_FreePageList(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nLeaves, n;				/* # of the leaves before and after the delete */
+	Four nFreed;					/* # of the pages in the dealloc list before the delete */
+	Four nKept, nLeft;				/* # of the pages in the free page list */
+	FileID fid;						/* file of the index */
+	ObjectID catEntry;				/* catalog object of the file */
+	PageID root;					/* root of the index */
+	KeyValue low, high;				/* bounds of the range */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	/* The list is kept by the index whose root is the first page of its file */
+	e = SM_CreateFile(testVolId, &fid, FALSE, NULL);
+	CHECKERR(e);
+	e = sm_GetCatalogEntryFromDataFileId(ARRAYINDEX, &fid, &catEntry);
+	CHECKERR(e);
+
+	e = test_CreateIndex(&catEntry, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(&catEntry, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+	nFreed = test_CountDealloc();
+
+	test_SetKey(&low, 500);
+	test_SetKey(&high, 1499);
+	e = EduBtM_DeleteRange(&catEntry, &root, kdesc, &low, &high, &dlPool, &dlHead);
+	CHECKERR(e);
+	for (i = 500; i <= 1499; i++) present[i] = FALSE;
+
+	e = test_CountLeaves(&root, &n);
+	if (e < eNOERROR) return(e);
+	e = test_CountFreePages(&root, &nKept);
+	if (e < eNOERROR) return(e);
+	CHECK(n < nLeaves, "no leaf inside the range is unlinked");
+	CHECK(nKept >= nLeaves - n, "the unlinked leaves are not kept in the free page list");
+	CHECK(test_CountDealloc() == nFreed, "a freed page goes to the dealloc list while the free page list has room");
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting [500, 1499]");
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(&catEntry, &root, kdesc, 500, 1, 1000);
+	if (e < eNOERROR) return(e);
+	for (i = 500; i <= 1499; i++) present[i] = TRUE;
+
+	e = test_CountFreePages(&root, &nLeft);
+	if (e < eNOERROR) return(e);
+	CHECK(nLeft < nKept, "the splits do not take the pages of the free page list");
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts into the freed range");
+	if (e < eNOERROR) return(e);
+
+	/* The pages left in the list go to the dealloc list with the index */
+	e = test_DropIndex(&catEntry, &root);
+	if (e < eNOERROR) return(e);
+	CHECK(test_CountDealloc() - nFreed > nLeft, "the pages of the free page list are not freed with the index");
+
+	e = SM_DestroyFile(&fid, NULL);
+	CHECKERR(e);
+
+	return(eNOERROR);
+
+}   /* test_FreePageList() */
+
+
+
+/*@================================
+ * test_Reorganize()
+ *================================*/
+/*
+ * Function: Four test_Reorganize(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Reorganize an index built by inserts in a random order, whose splits
+ *  leave some leaves on the volume before the leaves preceding them, and
+ *  check that the leaves are laid out in the order of their keys. Then
+ *  reorganize it again after most of its objects are deleted, and insert
+ *  into it afterwards.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_Reorganize(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nLeaves, n;				/* # of the leaves before and after a reorganization */
+	Four nBackward;					/* # of the leaves out of the key order */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+	e = test_CountBackwardLeaves(&root, &nBackward);
+	if (e < eNOERROR) return(e);
+	CHECK(nBackward > 0, "the inserts leave no leaf out of the key order");
+
+	e = EduBtM_Reorganize(catObjForFile, &root, kdesc, &dlPool, &dlHead);
+	CHECKERR(e);
+
+	e = test_CountLeaves(&root, &n);
+	if (e < eNOERROR) return(e);
+	e = test_CountBackwardLeaves(&root, &nBackward);
+	if (e < eNOERROR) return(e);
+	CHECK(n <= nLeaves, "the reorganization adds a leaf");
+	CHECK(nBackward == 0, "a leaf lies before the leaf preceding it after the reorganization");
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the reorganization");
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) {
+		present[i] = (i % 4 == 0);
+		if (present[i]) continue;
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+	}
+
+	e = EduBtM_Reorganize(catObjForFile, &root, kdesc, &dlPool, &dlHead);
+	CHECKERR(e);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the deletes and the reorganization");
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 2, 4, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+	for (i = 2; i < NUMOFTESTKEYS; i += 4) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts into the reorganized index");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_Reorganize() */
+
+
+
+/*@================================
+ * test_DropTree()
+ *================================*/
+/*
+ * Function: Four test_DropTree(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Drop an index of several leaves, and check that every leaf goes to the
+ *  dealloc list while the leaves are not read: a leaf fixed by the drop
+ *  would have been marked FREEPAGE.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_DropTree(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four nLeaves;					/* # of the leaves of the index */
+	Four nFreed;					/* # of the pages in the dealloc list before the drop */
+	Boolean unread;					/* TRUE if the first leaf is not marked FREEPAGE */
+	PageID root;					/* root of the index */
+	PageID first;					/* the first leaf */
+	BtreePage *apage;				/* buffer holding a page */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+
+	e = test_CountLeaves(&root, &nLeaves);
+	if (e < eNOERROR) return(e);
+
+	e = BfM_GetTrain((TrainID*)&root, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	first = root;
+	first.pageNo = apage->bi.hdr.p0;
+	CHECK((apage->any.hdr.type & INTERNAL) && (apage->bi.hdr.flags & BTM_LEAFPARENT),
+		  "the root is not the parent of the leaves");
+	e = BfM_FreeTrain((TrainID*)&root, PAGE_BUF);
+	CHECKERR(e);
+
+	nFreed = test_CountDealloc();
+
+	e = test_DropIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+	CHECK(test_CountDealloc() - nFreed > nLeaves, "a page of the index does not go to the dealloc list");
+
+	e = BfM_GetTrain((TrainID*)&first, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	unread = (apage->any.hdr.type & LEAF) ? TRUE : FALSE;
+	e = BfM_FreeTrain((TrainID*)&first, PAGE_BUF);
+	CHECKERR(e);
+	CHECK(unread, "a leaf is read while the index is dropped");
+
+	return(eNOERROR);
+
+}   /* test_DropTree() */
+
+
+
+/*@================================
+ * test_EndLeaves()
+ *================================*/
+/*
+ * Function: Four test_EndLeaves(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Fetch the first and the last objects with SM_BOF and SM_EOF, and read
+ *  backward from the last one. The meta page remembers the end leaves, and
+ *  SM_EOF goes to the remembered leaf without a descent: given the last
+ *  leaf of another index, it finds the last object of that index. The end
+ *  leaves are forgotten when pages of the index are freed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_EndLeaves(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four n;							/* # of objects read */
+	Four_Invariable v;				/* integer of a key value */
+	Boolean ordered = TRUE;			/* FALSE if an object comes out of the order */
+	ShortPageID first, last;		/* the end leaves remembered */
+	ShortPageID otherLast;			/* the rightmost leaf of the other index */
+	PageID root;					/* root of the index */
+	PageID other;					/* root of the other index */
+	KeyValue kval;					/* key value of the conditions */
+	KeyValue high;					/* upper bound of the range deleted */
+	BtreeCursor cursor, next;		/* cursors */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	test_SetKey(&kval, 0);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_BOF, &kval, SM_EOF, &cursor);
+	CHECKERR(e);
+	CHECK(cursor.flag == CURSOR_EOS, "an empty index has a first object");
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 5, 5, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_BOF, &kval, SM_EOF, &cursor);
+	CHECKERR(e);
+	memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+	CHECK(cursor.flag == CURSOR_ON && v == 5, "SM_BOF finds a wrong object");
+
+	e = test_GetEndLeafHints(&root, &first, &last);
+	if (e < eNOERROR) return(e);
+	CHECK(first == cursor.leaf.pageNo, "the meta page does not remember the leftmost leaf");
+
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EOF, &kval, SM_BOF, &cursor);
+	CHECKERR(e);
+	memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+	CHECK(cursor.flag == CURSOR_ON && v == 5*NUMOFTESTKEYS, "SM_EOF finds a wrong object");
+
+	/* The splits of the last leaf are found by the descent of SM_EOF */
+	e = test_GetEndLeafHints(&root, &first, &last);
+	if (e < eNOERROR) return(e);
+	CHECK(last == cursor.leaf.pageNo, "the meta page does not remember the rightmost leaf");
+
+	for (n = 0; cursor.flag == CURSOR_ON; n++) {
+		memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+		if (v != 5*(NUMOFTESTKEYS-n)) ordered = FALSE;
+		e = EduBtM_FetchNext(&root, kdesc, &kval, SM_BOF, &cursor, &next);
+		CHECKERR(e);
+		cursor = next;
+	}
+	CHECK(n == NUMOFTESTKEYS && ordered, "the backward scan reads wrong objects");
+
+	/* Give the index the rightmost leaf of another one; SM_EOF should not notice */
+	e = test_CreateIndex(catObjForFile, &other);
+	if (e < eNOERROR) return(e);
+	e = test_InsertKeys(catObjForFile, &other, kdesc, 3, 3, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+	e = EduBtM_Fetch(&other, kdesc, &kval, SM_EOF, &kval, SM_BOF, &cursor);
+	CHECKERR(e);
+	otherLast = cursor.leaf.pageNo;
+
+	e = edubtm_NoteEndLeaves(catObjForFile, &root, first, otherLast);
+	CHECKERR(e);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EOF, &kval, SM_BOF, &cursor);
+	CHECKERR(e);
+	memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+	CHECK(cursor.flag == CURSOR_ON && v == 3*(NUMOFTESTKEYS/4), "SM_EOF descends from the root instead of using the remembered leaf");
+	e = edubtm_NoteEndLeaves(catObjForFile, &root, first, last);
+	CHECKERR(e);
+
+	e = test_DropIndex(catObjForFile, &other);
+	if (e < eNOERROR) return(e);
+
+	/* A freed leaf may be given to another index; the end leaves are forgotten */
+	test_SetKey(&high, 5*(NUMOFTESTKEYS/2));
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, NULL, &high, &dlPool, &dlHead);
+	CHECKERR(e);
+	e = test_GetEndLeafHints(&root, &first, &last);
+	if (e < eNOERROR) return(e);
+	CHECK(first == NIL && last == NIL, "the end leaves are remembered after pages of the index are freed");
+
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_BOF, &kval, SM_EOF, &cursor);
+	CHECKERR(e);
+	memcpy(&v, &cursor.key.val[0], sizeof(Four_Invariable));
+	CHECK(cursor.flag == CURSOR_ON && v == 5*(NUMOFTESTKEYS/2+1), "SM_BOF finds a wrong object after the delete");
+	e = test_GetEndLeafHints(&root, &first, &last);
+	if (e < eNOERROR) return(e);
+	CHECK(first == cursor.leaf.pageNo, "the leftmost leaf found by a descent is not remembered");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_EndLeaves() */
+
+
+
+/*@================================
+ * test_UpperCache()
+ *================================*/
+/*
+ * Function: Four test_UpperCache(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Look up a key value in an index of two levels, and check that the root
+ *  is then kept in the cache of the upper levels and taken from there in
+ *  the buffer it is fixed in. The cache is dropped when pages of the index
+ *  are freed, and the lookups go on reading the right objects.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_UpperCache(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Boolean found;					/* TRUE if a key value is found */
+	btm_CachedPage *entry;			/* the root in the cache */
+	PageID root;					/* root of the index */
+	KeyValue low, high;				/* bounds of the range deleted */
+	ObjectID oid;					/* ObjectID found */
+	BtreePage *apage;				/* buffer holding the root */
+	BtreePage *cpage;				/* the root taken from the cache */
+	btm_UpperCache *cache;			/* the cache of the index */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+
+	e = test_Lookup(&root, kdesc, NUMOFTESTKEYS/2, &found, &oid);
+	if (e < eNOERROR) return(e);
+	CHECK(found, "a key value in the index is not found");
+
+	e = edubtm_EnterUpperCache(&root, &cache);
+	CHECKERR(e);
+	CHECK(cache != NULL && cache->nPages > 0, "the upper levels of the index are not cached");
+	if (cache == NULL) return(eNOERROR);
+
+	e = BfM_GetTrain((TrainID*)&root, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	e = BfM_FreeTrain((TrainID*)&root, PAGE_BUF);
+	CHECKERR(e);
+
+	e = edubtm_PinUpperPage(cache, &root, &cpage, &entry);
+	CHECKERR(e);
+	CHECK(entry != NULL && cpage == apage, "the root is not taken from the cache");
+	e = edubtm_UnpinUpperPage(&root, entry != NULL);
+	CHECKERR(e);
+	edubtm_LeaveUpperCache(cache);
+
+	/* A freed page may not stay fixed in the cache */
+	test_SetKey(&low, 500);
+	test_SetKey(&high, 1499);
+	e = EduBtM_DeleteRange(catObjForFile, &root, kdesc, &low, &high, &dlPool, &dlHead);
+	CHECKERR(e);
+	CHECK(!cache->inUse || cache->root.pageNo != root.pageNo || cache->root.volNo != root.volNo,
+		  "the cache is kept after pages of the index are freed");
+	for (i = 500; i <= 1499; i++) present[i] = FALSE;
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after deleting [500, 1499]");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_UpperCache() */
+
+
+
+/*@================================
+ * test_SwizzledRefs()
+ *================================*/
+/*
+ * Function: Four test_SwizzledRefs(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Build an index of three levels with long string keys, so that the root
+ *  and its children are cached, and check that each child reference of
+ *  the cached root is swizzled to the child in the cache and followed
+ *  from there. The lookups through the cache find the right objects.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_SwizzledRefs(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key, not used */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nWrong;					/* # of the lookups finding a wrong object */
+	Boolean resolved;				/* TRUE if every child reference of the root is resolved */
+	KeyDesc sdesc;					/* key descriptor of a string key */
+	PageID root;					/* root of the index */
+	PageID child;					/* a child of the root */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	BtreePage *apage;				/* buffer holding the root */
+	BtreePage *cpage;				/* buffer holding the child */
+	btm_UpperCache *cache;			/* the cache of the index */
+	btm_CachedPage *entry;			/* the root in the cache */
+	btm_CachedPage *cEntry;			/* the child in the cache */
+	btm_SwizzledRef *ref;			/* a child reference of the root */
+
+
+	sdesc.flag = KEYFLAG_UNIQUE;
+	sdesc.nparts = 1;
+	sdesc.kpart[0].type = SM_VARSTRING;
+	sdesc.kpart[0].offset = 0;
+	sdesc.kpart[0].length = TESTSTRINGLEN;
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) {
+		test_SetStringKey(&kval, (i * 7919) % NUMOFTESTKEYS);
+		test_SetOid(&oid, (i * 7919) % NUMOFTESTKEYS);
+		e = EduBtM_InsertObject(catObjForFile, &root, &sdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+	}
+
+	/* The lookups read the cache, which is built by the first of them */
+	for (i = 0, nWrong = 0; i < NUMOFTESTKEYS; i += 7) {
+		test_SetStringKey(&kval, i);
+		e = EduBtM_Fetch(&root, &sdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+		CHECKERR(e);
+		if (cursor.flag != CURSOR_ON || cursor.oid.unique != i) nWrong++;
+	}
+	CHECK(nWrong == 0, "a lookup through the cache finds a wrong object");
+
+	e = edubtm_EnterUpperCache(&root, &cache);
+	CHECKERR(e);
+	CHECK(cache != NULL && cache->nPages > 1, "the children of the root are not cached");
+	if (cache == NULL || cache->nPages <= 1) {
+		edubtm_LeaveUpperCache(cache);
+		return(test_DropIndex(catObjForFile, &root));
+	}
+
+	e = edubtm_PinUpperPage(cache, &root, &apage, &entry);
+	CHECKERR(e);
+	CHECK(entry != NULL && entry->nRefs == apage->bi.hdr.nSlots + 1, "the child references of the root are not swizzled");
+
+	resolved = (entry != NULL && entry->nRefs > 0);
+	for (i = 0; resolved && i < entry->nRefs; i++) {
+		ref = &(cache->refs[entry->firstRef + i]);
+		if (ref->cacheIdx < 0 || cache->pages[ref->cacheIdx].pageNo != ref->pageNo) resolved = FALSE;
+	}
+	CHECK(resolved, "a child reference of the root does not lead to the child in the cache");
+
+	/* The last child is followed by its reference */
+	if (resolved) {
+		child = root;
+		child.pageNo = ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(apage->bi.hdr.nSlots-1)]]))->spid;
+		e = edubtm_PinUpperChild(cache, entry, apage->bi.hdr.nSlots-1, &child, &cpage, &cEntry);
+		CHECKERR(e);
+		ref = &(cache->refs[entry->firstRef + entry->nRefs - 1]);
+		CHECK(cEntry == &(cache->pages[ref->cacheIdx]) && cpage == cEntry->page, "the child is not taken by its reference");
+		e = edubtm_UnpinUpperPage(&child, cEntry != NULL);
+		CHECKERR(e);
+	}
+
+	e = edubtm_UnpinUpperPage(&root, entry != NULL);
+	CHECKERR(e);
+	edubtm_LeaveUpperCache(cache);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_SwizzledRefs() */
+
+
+
+/*@================================
+ * test_LearnedIndex()
+ *================================*/
+/*
+ * Function: Four test_LearnedIndex(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Build the model of the leaves of an index and compare the leaf it
+ *  predicts for each key value with the leaf found by going down the tree.
+ *  After splits, a leaf taken by the model must still be the leaf of the
+ *  tree, the key values moved away fall back to the descent, and the
+ *  lookups read the right objects. Dropping the model stops its use.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_LearnedIndex(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nMissed;					/* # of the key values the model did not find */
+	Four nWrong;					/* # of the key values the model found in a wrong leaf */
+	Boolean found;					/* TRUE if the model found the leaf */
+	PageID root;					/* root of the index */
+	PageID leaf;					/* leaf found by the model */
+	KeyValue kval;					/* key value */
+	BtreePage *apage;				/* buffer holding the leaf */
+	ShortPageID treeLeaf;			/* leaf found by going down the tree */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	/* Evenly spread key values */
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 3, NUMOFTESTKEYS/3);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 3 == 0 && i < 3*(NUMOFTESTKEYS/3));
+
+	e = EduBtM_SetLearnedIndex(&root, kdesc, TRUE);
+	CHECKERR(e);
+
+	/*
+	 * Every key value of the index goes to the leaf of the tree; one
+	 * between two leaves may miss, but never goes to a wrong leaf
+	 */
+	for (i = 0, nMissed = nWrong = 0; i < NUMOFTESTKEYS; i++) {
+		test_SetKey(&kval, i);
+		e = edubtm_LearnedSearchLeaf(&root, kdesc, &kval, BTM_LATCH_S, &leaf, &apage, &found);
+		CHECKERR(e);
+		if (!found) {
+			if (present[i]) nMissed++;
+			continue;
+		}
+		e = edubtm_UnfixPage(&leaf, FALSE);
+		CHECKERR(e);
+
+		e = test_TreeLeaf(&root, kdesc, i, &treeLeaf);
+		CHECKERR(e);
+		if (leaf.pageNo != treeLeaf) nWrong++;
+	}
+	CHECK(nMissed == 0, "the model does not find the leaf of a key value in the index");
+	CHECK(nWrong == 0, "the model predicts a leaf other than the leaf of the tree");
+
+	/* The splits move key values away from the leaves of the model */
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 3, NUMOFTESTKEYS/3);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 3 != 2 && i < 3*(NUMOFTESTKEYS/3));
+
+	for (i = 0, nMissed = nWrong = 0; i < NUMOFTESTKEYS; i++) {
+		test_SetKey(&kval, i);
+		e = edubtm_LearnedSearchLeaf(&root, kdesc, &kval, BTM_LATCH_S, &leaf, &apage, &found);
+		CHECKERR(e);
+		if (!found) { nMissed++; continue; }
+		e = edubtm_UnfixPage(&leaf, FALSE);
+		CHECKERR(e);
+
+		e = test_TreeLeaf(&root, kdesc, i, &treeLeaf);
+		CHECKERR(e);
+		if (leaf.pageNo != treeLeaf) nWrong++;
+	}
+	CHECK(nMissed > 0, "the key values moved by the splits are found by the model");
+	CHECK(nWrong == 0, "the model takes a leaf other than the leaf of the tree after splits");
+
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the splits");
+	if (e < eNOERROR) return(e);
+
+	/* A dropped model is not used */
+	e = EduBtM_SetLearnedIndex(&root, kdesc, FALSE);
+	CHECKERR(e);
+	test_SetKey(&kval, 0);
+	e = edubtm_LearnedSearchLeaf(&root, kdesc, &kval, BTM_LATCH_S, &leaf, &apage, &found);
+	CHECKERR(e);
+	CHECK(!found, "a dropped model is used");
+	if (found) (Four) edubtm_UnfixPage(&leaf, FALSE);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_LearnedIndex() */
+
+
+
+/*@================================
+ * test_BloomFilter()
+ *================================*/
+/*
+ * Function: Four test_BloomFilter(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Look up key values absent and present with the Bloom filter, which is
+ *  built from the index and kept up by the inserts. While the root cannot
+ *  be read as a page of the tree, the absent key values are still answered:
+ *  the filter rejects them without going down the tree.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_BloomFilter(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Four nAbsent;					/* # of the absent key values looked up */
+	Four nRejected;					/* # of the absent key values answered without a descent */
+	One type;						/* type of the root page */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	BtreePage *apage;				/* buffer holding the root */
+	Boolean present[NUMOFTESTKEYS];	/* TRUE for the key values in the index */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 2, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_SetBloomFilter(catObjForFile, &root, kdesc, TRUE);
+	CHECKERR(e);
+	for (i = 0; i < NUMOFTESTKEYS; i++) present[i] = (i % 2 == 0 && i < NUMOFTESTKEYS/2);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "with the Bloom filter");
+	if (e < eNOERROR) return(e);
+
+	/* A descent fails on the root while its type is cleared */
+	e = BfM_GetTrain((TrainID*)&root, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	type = apage->any.hdr.type;
+	apage->any.hdr.type = 0;
+
+	test_SetKey(&kval, 0);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECK(e == eBADBTREEPAGE_BTM, "a key value in the index is found without going down the tree");
+
+	for (i = 1, nAbsent = nRejected = 0; i < NUMOFTESTKEYS/2; i += 2) {
+		test_SetKey(&kval, i);
+		e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+		nAbsent++;
+		if (e == eNOERROR && cursor.flag == CURSOR_EOS) nRejected++;
+	}
+	/* At 10 bits per key value a few percent of the absent ones may pass */
+	CHECK(nRejected * 10 >= nAbsent * 9, "the absent key values are not rejected by the Bloom filter without a descent");
+
+	apage->any.hdr.type = type;
+	e = BfM_FreeTrain((TrainID*)&root, PAGE_BUF);
+	CHECKERR(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, NUMOFTESTKEYS/2, 1, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < NUMOFTESTKEYS; i += 8) {
+		if (!present[i]) continue;
+		test_SetKey(&kval, i);
+		test_SetOid(&oid, i);
+		e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+		CHECKERR(e);
+		present[i] = FALSE;
+	}
+	for (i = NUMOFTESTKEYS/2; i < NUMOFTESTKEYS; i++) present[i] = TRUE;
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the inserts with the Bloom filter");
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_SetBloomFilter(catObjForFile, &root, kdesc, FALSE);
+	CHECKERR(e);
+	e = test_CheckKeys(&root, kdesc, present, NUMOFTESTKEYS, "after the Bloom filter");
+	if (e < eNOERROR) return(e);
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_BloomFilter() */
+
+
+
+/*@================================
+ * test_ResultCache()
+ *================================*/
+/*
+ * Function: Four test_ResultCache(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Repeat the lookups of hot key values with the result cache, while the
+ *  objects found are deleted, moved by splits, and inserted again. A
+ *  repeated lookup is answered by the cache, even while the root cannot
+ *  be read as a page of the tree, and a change of the leaf invalidates
+ *  the result.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_ResultCache(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	One type;						/* type of the root page */
+	PageID root;					/* root of the index */
+	KeyValue kval;					/* key value */
+	ObjectID oid;					/* ObjectID */
+	BtreeCursor cursor;				/* cursor of a lookup */
+	BtreePage *apage;				/* buffer holding the root */
+	Boolean found;					/* TRUE if a lookup finds its key value */
+	Boolean hit;					/* TRUE if the result cache answers a lookup */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 4, NUMOFTESTKEYS/4);
+	if (e < eNOERROR) return(e);
+
+	e = EduBtM_SetResultCache(&root, TRUE);
+	CHECKERR(e);
+
+	/* The first lookup fills the cache, and the next one hits */
+	e = test_CachedLookup(&root, kdesc, 400, &hit, &oid);
+	CHECKERR(e);
+	CHECK(!hit, "a key value not looked up yet is in the result cache");
+	for (i = 0; i < 2; i++) {
+		e = test_Lookup(&root, kdesc, 400, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found && oid.unique == 400, "a cached lookup finds a wrong object");
+	}
+	e = test_CachedLookup(&root, kdesc, 400, &hit, &oid);
+	CHECKERR(e);
+	CHECK(hit && oid.unique == 400, "a repeated lookup is not answered by the result cache");
+
+	/* A hit does not go down the tree; a descent fails on the root while its type is cleared */
+	e = BfM_GetTrain((TrainID*)&root, (char**)&apage, PAGE_BUF);
+	CHECKERR(e);
+	type = apage->any.hdr.type;
+	apage->any.hdr.type = 0;
+	test_SetKey(&kval, 400);
+	e = EduBtM_Fetch(&root, kdesc, &kval, SM_EQ, &kval, SM_EQ, &cursor);
+	CHECK(e == eNOERROR && cursor.flag == CURSOR_ON && cursor.oid.unique == 400,
+		  "a cached lookup goes down the tree");
+	apage->any.hdr.type = type;
+	e = BfM_FreeTrain((TrainID*)&root, PAGE_BUF);
+	CHECKERR(e);
+
+	/* a delete */
+	test_SetKey(&kval, 400);
+	test_SetOid(&oid, 400);
+	e = EduBtM_DeleteObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+	e = test_CachedLookup(&root, kdesc, 400, &hit, &oid);
+	CHECKERR(e);
+	CHECK(!hit, "the result of a deleted object is not invalidated");
+	e = test_Lookup(&root, kdesc, 400, &found, &oid);
+	if (e < eNOERROR) return(e);
+	CHECK(!found, "a cached lookup finds a deleted object");
+
+	/* an insert again with another ObjectID */
+	test_SetOid(&oid, 10400);
+	e = EduBtM_InsertObject(catObjForFile, &root, kdesc, &kval, &oid, &dlPool, &dlHead);
+	CHECKERR(e);
+	e = test_Lookup(&root, kdesc, 400, &found, &oid);
+	if (e < eNOERROR) return(e);
+	CHECK(found && oid.unique == 10400, "a cached lookup finds an old object");
+
+	/* an insert before the cached slot in the same leaf */
+	e = test_Lookup(&root, kdesc, 400, &found, &oid);
+	if (e < eNOERROR) return(e);
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 398, 1, 1);
+	if (e < eNOERROR) return(e);
+	e = test_CachedLookup(&root, kdesc, 400, &hit, &oid);
+	CHECKERR(e);
+	CHECK(!hit, "the result is not invalidated by an insert into its leaf");
+
+	/* splits around the cached slot */
+	e = test_Lookup(&root, kdesc, 1200, &found, &oid);
+	if (e < eNOERROR) return(e);
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 1, 2, NUMOFTESTKEYS/2);
+	if (e < eNOERROR) return(e);
+	for (i = 0; i < 2; i++) {
+		e = test_Lookup(&root, kdesc, 1200, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(found && oid.unique == 1200, "a cached lookup finds a wrong object after splits");
+		e = test_Lookup(&root, kdesc, 1202, &found, &oid);
+		if (e < eNOERROR) return(e);
+		CHECK(!found, "a cached lookup finds an absent key value");
+	}
+
+	e = EduBtM_SetResultCache(&root, FALSE);
+	CHECKERR(e);
+	e = test_CachedLookup(&root, kdesc, 1200, &hit, &oid);
+	CHECKERR(e);
+	CHECK(!hit, "a lookup is answered by a dropped result cache");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_ResultCache() */
+
+
+
+/*@================================
+ * test_FetchBatch()
+ *================================*/
+/*
+ * Function: Four test_FetchBatch(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Look up an unsorted batch of key values, present and absent.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_FetchBatch(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i, k;						/* indexes */
+	Boolean ok = TRUE;				/* FALSE if a result is wrong */
+	PageID root;					/* root of the index */
+	static BatchItem items[NUMOFTESTKEYS];	/* key values to look up */
+	Boolean found[NUMOFTESTKEYS];	/* TRUE for the key values found */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 3, NUMOFTESTKEYS/3);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) {
+		memset(&items[i], 0, sizeof(BatchItem));
+		test_SetKey(&items[i].kval, (i*7) % NUMOFTESTKEYS);
+	}
+
+	e = EduBtM_FetchBatch(&root, kdesc, NUMOFTESTKEYS, items, found);
+	CHECKERR(e);
+
+	for (i = 0; i < NUMOFTESTKEYS; i++) {
+		k = (i*7) % NUMOFTESTKEYS;
+		if (found[i] != (k % 3 == 0 && k/3 < NUMOFTESTKEYS/3)) ok = FALSE;
+		if (found[i] && items[i].oid.unique != k) ok = FALSE;
+	}
+	CHECK(ok, "the batch lookup finds wrong objects");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_FetchBatch() */
+
+
+
+/*@================================
+ * test_FetchMulti()
+ *================================*/
+/*
+ * Function: Four test_FetchMulti(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Read a list of ranges: close ones in the same leaf, far ones, an IN
+ *  list, an empty one, and ones out of order.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_FetchMulti(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *kdesc)					/* IN key descriptor of an integer key */
+{
+	Four e;							/* for errors */
+	Four i;							/* index */
+	Boolean ok = TRUE;				/* FALSE if a result is wrong */
+	PageID root;					/* root of the index */
+	btm_FetchRange ranges[8];		/* ranges to read */
+	TestCollect c;					/* objects read */
+	Four keys[NUMOFTESTKEYS];		/* key values read */
+	Four seconds[NUMOFTESTKEYS];	/* second parts of the key values read */
+	Four groups[NUMOFTESTKEYS];		/* ranges of the key values read */
+	static struct {
+		Four start, startCompOp, stop, stopCompOp;	/* conditions of a range */
+	} conds[8] = {
+		{ 0, SM_BOF, 3, SM_LE },
+		{ 10, SM_GE, 20, SM_LT },
+		{ 20, SM_GT, 24, SM_LE },
+		{ 500, SM_EQ, 500, SM_EQ },
+		{ 501, SM_EQ, 501, SM_EQ },
+		{ 1300, SM_GT, 1301, SM_LT },
+		{ 1995, SM_GE, 0, SM_EOF },
+		{ 100, SM_GE, 104, SM_LE },
+	};
+	static Four expected[] = { 0, 1, 2, 3, 10, 11, 12, 13, 14, 15, 16, 17, 18, 19,
+							   21, 22, 23, 24, 500, 501, 1995, 1996, 1997, 1998, 1999,
+							   100, 101, 102, 103, 104 };
+	static Four expectedGroups[] = { 0, 0, 0, 0, 1, 1, 1, 1, 1, 1, 1, 1, 1, 1,
+									 2, 2, 2, 2, 3, 4, 6, 6, 6, 6, 6,
+									 7, 7, 7, 7, 7 };
+	Four nExpected = sizeof(expected)/sizeof(expected[0]);	/* # of the objects expected */
+
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	e = test_InsertKeys(catObjForFile, &root, kdesc, 0, 1, NUMOFTESTKEYS);
+	if (e < eNOERROR) return(e);
+
+	for (i = 0; i < 8; i++) {
+		test_SetKey(&ranges[i].start, conds[i].start);
+		ranges[i].startCompOp = conds[i].startCompOp;
+		test_SetKey(&ranges[i].stop, conds[i].stop);
+		ranges[i].stopCompOp = conds[i].stopCompOp;
+	}
+
+	c.keys = keys; c.seconds = seconds; c.groups = groups; c.max = NUMOFTESTKEYS;
+	c.n = 0; c.ordered = TRUE;
+
+	e = EduBtM_FetchMulti(&root, kdesc, 8, ranges, test_Collect, &c);
+	CHECKERR(e);
+
+	CHECK(c.n == nExpected, "the multi-range fetch reads a wrong # of objects");
+	for (i = 0; i < c.n && i < nExpected; i++)
+		if (keys[i] != expected[i] || groups[i] != expectedGroups[i]) ok = FALSE;
+	CHECK(ok, "the multi-range fetch reads wrong objects");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_FetchMulti() */
+
+
+
+/*@================================
+ * test_SkipScan()
+ *================================*/
+/*
+ * Function: Four test_SkipScan(ObjectID*, KeyDesc*)
+ *
+ * Description:
+ *  Read the objects of a key of two integers by a condition on the second
+ *  part only.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four test_SkipScan(
+	ObjectID *catObjForFile,		/* IN catalog object of B+ tree file */
+	KeyDesc *intDesc)				/* IN key descriptor of an integer key; not used */
+{
+	Four e;							/* for errors */
+	Four i, j;						/* indexes */
+	Boolean ok = TRUE;				/* FALSE if a result is wrong */
+	PageID root;					/* root of the index */
+	KeyDesc kdesc;					/* key descriptor of a key of two integers */
+	KeyValue kval;					/* key value */
+	KeyValue start, stop;			/* conditions of the scan on the second part */
+	ObjectID oid;					/* ObjectID */
+	TestCollect c;					/* objects read */
+	Four keys[NUMOFTESTKEYS];		/* key values read */
+	Four seconds[NUMOFTESTKEYS];	/* second parts of the key values read */
+	Four groups[NUMOFTESTKEYS];		/* first parts of the key values read */
+
+
+	test_SetComposite(&kdesc);
+
+	e = test_CreateIndex(catObjForFile, &root);
+	if (e < eNOERROR) return(e);
+
+	/* the first part 0, 10, ..., 190 and the second one 0 .. 99 */
+	for (i = 0; i < 20; i++) {
+		for (j = 0; j < 100; j++) {
+			test_SetKey2(&kval, 10*i, j);
+			test_SetOid(&oid, 100*i+j);
+			e = EduBtM_InsertObject(catObjForFile, &root, &kdesc, &kval, &oid, &dlPool, &dlHead);
+			CHECKERR(e);
+		}
+	}
+
+	c.keys = keys; c.seconds = seconds; c.groups = groups; c.max = NUMOFTESTKEYS;
+	c.n = 0; c.ordered = TRUE;
+
+	test_SetKey(&start, 40);
+	test_SetKey(&stop, 43);
+	e = EduBtM_SkipScan(&root, &kdesc, &start, SM_GE, &stop, SM_LT, test_Collect, &c);
+	CHECKERR(e);
+
+	CHECK(c.n == 20*3, "the skip scan reads a wrong # of objects");
+	CHECK(c.ordered, "the skip scan is not in the key order");
+	for (i = 0; i < c.n && i < c.max; i++)
+		if (keys[i] != 10*(i/3) || seconds[i] != 40+i%3 || groups[i] != i/3) ok = FALSE;
+	CHECK(ok, "the skip scan reads wrong objects");
+
+	/* no condition on the start */
+	c.n = 0; c.ordered = TRUE;
+	test_SetKey(&stop, 0);
+	e = EduBtM_SkipScan(&root, &kdesc, &start, SM_BOF, &stop, SM_EQ, test_Collect, &c);
+	CHECKERR(e);
+	CHECK(c.n == 20, "the skip scan from SM_BOF reads a wrong # of objects");
+	for (i = 0, ok = TRUE; i < c.n && i < c.max; i++)
+		if (keys[i] != 10*i || seconds[i] != 0) ok = FALSE;
+	CHECK(ok, "the skip scan from SM_BOF reads wrong objects");
+
+	return(test_DropIndex(catObjForFile, &root));
+
+}   /* test_SkipScan() */
@@ -69,11 +69,6 @@
 #include "EduBtM_Internal.h"
 
 
-/*@ Internal Function Prototypes */
-Four edubtm_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
-
-
-
 /*@================================
  * EduBtM_Fetch()
  *================================*/
@@ -107,6 +102,11 @@ Four EduBtM_Fetch(
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     int i;
     Four e;		   /* error number */
+    KeyValue *low;	   /* lower bound of the range to be read, NULL if unbounded */
+    KeyValue *high;	   /* upper bound of the range to be read, NULL if unbounded */
+    Four mode;		   /* mode of the tree latch */
+    Boolean maybe;	   /* FALSE if the Bloom filter tells the key value is absent */
+    Boolean hit;	   /* TRUE if the result cache answered the lookup */
     
     if (root == NULL) ERR(eBADPARAMETER_BTM);
 
@@ -118,21 +118,77 @@ Four EduBtM_Fetch(
     }
 
     /**/
-    switch(startCompOp){
+    /* Push the pending messages of the range to be read down to the leaves */
+    low = high = NULL;
+    if (startCompOp == SM_EQ)
+        low = high = startKval;
+    else if (startCompOp == SM_BOF || startCompOp == SM_GE || startCompOp == SM_GT) {
+        if (startCompOp != SM_BOF) low = startKval;
+        if (stopCompOp == SM_LT || stopCompOp == SM_LE || stopCompOp == SM_EQ) high = stopKval;
+    }
+    else {
+        if (startCompOp != SM_EOF) high = startKval;
+        if (stopCompOp == SM_GT || stopCompOp == SM_GE || stopCompOp == SM_EQ) low = stopKval;
+    }
+    /* Only an index buffering the updates or the changes has pending ones; it is latched exclusively */
+    if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+
+    /* An absent key value is answered by the Bloom filter of the index, if any */
+    maybe = TRUE;
+    if (startCompOp == SM_EQ) {
+        if ((e = edubtm_BloomFilterMayContain(root, startKval, &maybe)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+        if (!maybe) {
+            cursor->flag = CURSOR_EOS;
+            (Four) edubtm_UnlatchTree(root);
+            return(eNOERROR);
+        }
+    }
+
+    if (mode == BTM_LATCH_X) {
+        edubtm_EnterBfM();
+        if ((e = edubtm_FlushPendingMessages(root, kdesc, low, high, NULL, NULL)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+    }
+
+    /* A key value looked up before may be found without searching the tree */
+    hit = FALSE;
+    if (startCompOp == SM_EQ) {
+        if ((e = edubtm_ResultCacheFetch(root, kdesc, startKval, stopKval, stopCompOp, cursor, &hit)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+    }
+
+    if (hit) e = eNOERROR;
+    else switch(startCompOp){
         case SM_BOF :
             /* Find the first ObjectID of the given Btree */
-            if((e = edubtm_FirstObject(root, kdesc, stopKval, stopCompOp, cursor))<0) ERR(e);
+            e = edubtm_FirstObject(root, kdesc, stopKval, stopCompOp, cursor);
             break;
 
         case SM_EOF :
             /* Find the last ObjectID of the given Btree */
-            if((e = edubtm_LastObject(root, kdesc,	stopKval, stopCompOp, cursor))<0) ERR(e);
+            e = edubtm_LastObject(root, kdesc, stopKval, stopCompOp, cursor);
             break;
 
         default :
             /* Find the first object satisfying the given condition */
-            if((e = btm_Fetch(root, kdesc, startKval, startCompOp, stopKval, stopCompOp, cursor))<0) ERR(e);                
+            e = edubtm_Fetch(root, kdesc, startKval, startCompOp, stopKval, stopCompOp, cursor);
     }    
+
+    /* The filter let an absent key value through */
+    if (e >= 0 && !hit && startCompOp == SM_EQ && cursor->flag == CURSOR_EOS) edubtm_NoteBloomFalsePositive(root);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (e < 0) ERR(e);
+
+    /* The filter is built again when it lets too many through */
+    if (startCompOp == SM_EQ) {
+        if ((e = edubtm_RefreshBloomFilter(root, kdesc)) < 0) ERR(e);
+    }
     /**/
     return(eNOERROR);
 
@@ -154,6 +210,9 @@ Four EduBtM_Fetch(
  *  This function handles only the following conditions:
  *  SM_EQ, SM_LT, SM_LE, SM_GT, SM_GE.
  *
+ *  The leaf is found by edubtm_SearchLeaf(...), which reads the internal pages
+ *  optimistically; the caller should hold the tree latch.
+ *
  * Returns:
  *  Error code *   
  *    eBADCOMPOP_BTM
@@ -169,26 +228,13 @@ Four edubtm_Fetch(
     Four                stopCompOp,     /* IN comparison operator of stop condition */
     BtreeCursor         *cursor)        /* OUT Btree Cursor */
 {
-	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four                e;              /* error number */
-    Four                cmp;            /* result of comparison */
     Two                 idx;            /* index */
-    PageID              child;          /* child page when the root is an internla page */
-    Two                 alignedKlen;    /* aligned size of the key length */
-    BtreePage           *apage;         /* a Page Pointer to the given root */
-    BtreeOverflow       *opage;         /* a page pointer if it necessary to access an overflow page */
+    Two                 slotNo;         /* slot of the first entry satisfying the start condition */
     Boolean             found;          /* search result */
-    PageID              *leafPid;       /* leaf page pointed by the cursor */
-    Two                 slotNo;         /* slot pointed by the slot */
-    PageID              ovPid;          /* PageID of the overflow page */
-    PageNo              ovPageNo;       /* PageNo of the overflow page */
-    PageID              prevPid;        /* PageID of the previous page */
-    PageID              nextPid;        /* PageID of the next page */
-    ObjectID            *oidArray;      /* array of the ObjectIDs */
-    Two                 iEntryOffset;   /* starting offset of an internal entry */
-    btm_InternalEntry   *iEntry;        /* an internal entry */
-    Two                 lEntryOffset;   /* starting offset of a leaf entry */
-    btm_LeafEntry       *lEntry;        /* a leaf entry */
+    Boolean             forward;        /* direction of the scan */
+    PageID              leaf;           /* leaf covering the start key value */
+    BtreePage           *apage;         /* pointer to the buffer holding the leaf */
 
 
     /* Error check whether using not supported functionality by EduBtM */
@@ -200,132 +246,39 @@ Four edubtm_Fetch(
     }
 
     /**/
+    if (startCompOp != SM_EQ && startCompOp != SM_LT && startCompOp != SM_LE &&
+        startCompOp != SM_GT && startCompOp != SM_GE) ERR(eBADCOMPOP_BTM);
 
-    /* Fix the page to the buffer */
-    if((e = BfM_GetTrain(root, (char**)&apage, PAGE_BUF))<0) ERR(e);
-    
-    if(apage->any.hdr.type & INTERNAL){
-        if ((e = edubtm_BinarySearchInternal(&(apage->bi), kdesc, startKval, &idx)) < 0) ERR(e);
-        iEntryOffset = apage->bi.slot[-idx];
-        iEntry = (btm_InternalEntry *)&(apage->bi.data[iEntryOffset]);
-        MAKE_PAGEID(child, root->volNo, iEntry->spid);
-
-        /* Recursive Call */
-        if ((e = edubtm_Fetch(&child, kdesc, startKval, startCompOp, stopKval, stopCompOp, cursor))<0) ERR(e);
-    }
-    
-    else if (apage->any.hdr.type & LEAF){
-        found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, startKval, &idx);
-
-        if(found){
-            if (startCompOp == SM_LT){
-                if (idx == 0){
-                    /* If current is the first entry of the whole index*/
-                    if(apage->bl.hdr.prevPage == NIL){
-                        cursor->flag = CURSOR_EOS;
-                        if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                        return(eNOERROR);                        
-                    }
-
-                     /* Else */
-                    if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
-                    MAKE_PAGEID(*root, root->volNo, apage->bl.hdr.prevPage);        
-                    if((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
-                    idx = apage->bl.hdr.nSlots;
-                }
-                idx = idx - 1;
-            }
-                
-            else if (startCompOp == SM_GT){
-                if (idx == apage->bl.hdr.nSlots-1){
-                    /* If current is the first entry of the whole index*/
-                    if(apage->bl.hdr.nextPage == NIL){
-                        cursor->flag = CURSOR_EOS;
-                        if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                        return(eNOERROR);                        
-                    }
-
-                     /* Else */
-                    if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
-                    MAKE_PAGEID(*root, root->volNo, apage->bl.hdr.nextPage);        
-                    if((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
-                    idx = -1;
-                }
-                idx = idx + 1;
-            }                 
-        }
-
-        else{
-            if (startCompOp == SM_EQ){
-                cursor->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);                
-            }
-
-            else if ((startCompOp == SM_GT) || (startCompOp == SM_GE)){
-                if (idx == apage->bl.hdr.nSlots-1){
-                    /* If current is the first entry of the whole index*/
-                    if(apage->bl.hdr.nextPage == NIL){
-                        cursor->flag = CURSOR_EOS;
-                        if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                        return(eNOERROR);                        
-                    }
+    /* Descend to the leaf; only the leaf is latched */
+    if ((e = edubtm_SearchLeaf(root, kdesc, startKval, FALSE, BTM_LATCH_S, NULL, &leaf, &apage)) < 0) ERR(e);
 
-                     /* Else */
-                    if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
-                    MAKE_PAGEID(*root, root->volNo, apage->bl.hdr.nextPage);        
-                    if((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
-                    idx = -1;
-                }
-                idx = idx + 1;
-            }
-        }
-    
-        lEntryOffset = apage->bl.slot[-idx];    
-        lEntry = (btm_LeafEntry *)&(apage->bl.data[lEntryOffset]);
+    /* 'idx' is the last slot whose key value is not greater than the start key value */
+    found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, startKval, &idx);
 
-        cmp = edubtm_KeyCompare(kdesc, lEntry->kval, stopKval);
+    forward = (startCompOp == SM_LT || startCompOp == SM_LE) ? FALSE : TRUE;
 
-        if(cmp == EQUAL){
-            if ((stopCompOp == SM_LT) || (stopCompOp == SM_GT)){
+    switch (startCompOp) {
+        case SM_EQ:
+            if (!found) {
                 cursor->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);             
+                if ((e = edubtm_UnfixPage(&leaf, FALSE)) < 0) ERR(e);
+                return(eNOERROR);
             }
-        }
-
-        if(cmp == LESS){
-            if ((stopCompOp == SM_EQ) || (stopCompOp == SM_GT) || (stopCompOp == SM_GE)){
-                cursor->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);             
-            }        
-        }
+            slotNo = idx;
 
-        if(cmp == GREATER){
-            if ((stopCompOp == SM_EQ) || (stopCompOp == SM_LT) || (stopCompOp == SM_LE)){
-                cursor->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);             
-            }        
-        }
+            /* The next lookup of the key value may use the position */
+            edubtm_FillResultCache(root, startKval, &leaf, apage, slotNo);
+            break;
+        case SM_LT: slotNo = (found) ? idx-1 : idx; break;
+        case SM_LE: slotNo = idx; break;
+        case SM_GT: slotNo = idx+1; break;
+        case SM_GE: slotNo = (found) ? idx : idx+1; break;
+    }
 
-        /* Satisfied */
-        cursor->flag = CURSOR_ON;
-        cursor->leaf = *root;
-        cursor->slotNo = idx;
-        cursor->oidArrayElemNo = 1;
-        alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-        cursor->oid = *(ObjectID *)(&(lEntry->kval) + alignedKlen);
-        cursor->key = *(KeyValue *)(&(lEntry->klen));
+    /* The entry may be in a sibling; the leaf is released here */
+    if ((e = edubtm_PositionCursor(&leaf, apage, slotNo, forward, kdesc, stopKval, stopCompOp, cursor)) < 0) ERR(e);
 
-        /* Unfix the leaf page from the buffer */ 
-        if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);    
-    
-    }
-    
     /**/
-
     return(eNOERROR);
     
 } /* edubtm_Fetch() */
@@ -0,0 +1,142 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_FetchBatch.c
+ *
+ * Description :
+ *  Look up a batch of independent key values (SM_EQ) in a B+tree, such as
+ *  the probes of a join. The lookups are interleaved so that their memory
+ *  accesses overlap (see edubtm_Interleave.c).
+ *
+ * Exports:
+ *  Four EduBtM_FetchBatch(PageID*, KeyDesc*, Four, BatchItem*, Boolean*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_FetchBatch()
+ *================================*/
+/*
+ * Function: Four EduBtM_FetchBatch(PageID*, KeyDesc*, Four, BatchItem*, Boolean*)
+ *
+ * Description :
+ *  Look up the key value of each of the 'nItems' items, as EduBtM_Fetch()
+ *  does with SM_EQ and no stop condition. The ObjectID of a key value found
+ *  is stored in its item, and 'found' tells which key values were found.
+ *  The items need not be sorted; they are neither sorted nor reordered.
+ *
+ *  Up to BTM_INTERLEAVEGROUP lookups are in flight at once, each one going
+ *  down one level of the tree at a time and prefetching the next page
+ *  before the others take their turn.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  items : the 'oid' field of each item whose key value is found
+ *  found : TRUE for each item whose key value is found
+ */
+Four EduBtM_FetchBatch(
+    PageID   *root,		/* IN root Page IDentifier */
+    KeyDesc  *kdesc,		/* IN Btree key descriptor */
+    Four     nItems,		/* IN # of key values to look up */
+    BatchItem *items,		/* INOUT key values to look up, and their ObjectIDs */
+    Boolean  *found)		/* OUT TRUE if the key value of the item is found */
+{
+    int		i;
+    Four    e;			/* error number */
+    Four    mode;		/* mode of the tree latch */
+
+
+    /*@ check parameters */
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (nItems < 0 || (nItems > 0 && (items == NULL || found == NULL))) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    if (nItems == 0) return(eNOERROR);
+
+    /* Only an index buffering the updates or the changes has pending ones; it is latched exclusively */
+    if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+
+    /* The pending messages of the key values are pushed down to the leaves first */
+    if (mode == BTM_LATCH_X) {
+        edubtm_EnterBfM();
+        for (i = 0; i < nItems; i++)
+            if ((e = edubtm_FlushPendingMessages(root, kdesc, &items[i].kval, &items[i].kval, NULL, NULL)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+    }
+
+    if ((e = edubtm_InterleavedLookup(root, kdesc, nItems, items, found)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    (Four) edubtm_UnlatchTree(root);
+
+    return(eNOERROR);
+
+}   /* EduBtM_FetchBatch() */
@@ -0,0 +1,418 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_FetchMulti.c
+ *
+ * Description :
+ *  Read several ranges of a B+tree index in one pass, e.g. for a `key IN
+ *  (...)' list or a disjunction of ranges. A range which starts close to
+ *  where the previous one ended is read from the leaf at hand instead of
+ *  descending from the root again.
+ *
+ * Exports:
+ *  Four EduBtM_FetchMulti(PageID*, KeyDesc*, Four, btm_FetchRange*, btm_ScanCallback, void*)
+ *  Four edubtm_StartRange(PageID*, KeyDesc*, btm_FetchRange*, Boolean, Boolean*, PageID*, BtreePage**, Two*)
+ *  Four edubtm_ReadRange(KeyDesc*, btm_FetchRange*, Four, PageID*, BtreePage**, Two*, Boolean*, btm_ScanCallback, void*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Boolean edubtm_InRange(KeyDesc*, btm_LeafEntry*, btm_FetchRange*);
+
+
+
+/*@================================
+ * EduBtM_FetchMulti()
+ *================================*/
+/*
+ * Function: Four EduBtM_FetchMulti(PageID*, KeyDesc*, Four, btm_FetchRange*, btm_ScanCallback, void*)
+ *
+ * Description :
+ *  Read the objects of each of the 'nRanges' ranges forward and hand them
+ *  to 'callback' in batches of cursors, with the # of the range as the
+ *  second argument. The batches of a range all come before those of the
+ *  next range; a range which finds nothing gets no call. When the callback
+ *  returns an error, the fetch stops and returns the error.
+ *
+ *  A range has the start condition SM_BOF, SM_EQ, SM_GE, or SM_GT and the
+ *  stop condition SM_EOF, SM_EQ, SM_LT, or SM_LE; an IN list is a list of
+ *  ranges with SM_EQ as both conditions. The ranges should come in the
+ *  order of their start key values: a range starting in the leaf where
+ *  the previous one ended, or at most BTM_MULTIHOPS leaves to its right,
+ *  continues from there. Any other range descends the tree as
+ *  EduBtM_Fetch(...) does, so ranges out of order or overlapping are read
+ *  correctly, only without the savings.
+ *
+ *  The index is latched as by EduBtM_Fetch(...) for the whole fetch, and
+ *  the leaf at hand stays latched in the shared mode while the callback is
+ *  called; the callback should not update the index.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eBADCOMPOP_BTM
+ *    some errors caused by function calls or by the callback
+ */
+Four EduBtM_FetchMulti(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    Four                        nRanges,        /* IN # of ranges */
+    btm_FetchRange              *ranges,        /* IN the ranges, in the order of their start key values */
+    btm_ScanCallback            callback,       /* IN function receiving the batches */
+    void                        *arg)           /* IN argument of the callback */
+{
+    int                         i;
+    Four                        e;              /* error number */
+    Four                        r;              /* # of the current range */
+    Four                        mode;           /* mode of the tree latch */
+    Two                         slotNo;         /* current slot in the leaf */
+    Boolean                     held;           /* TRUE if a leaf is fixed and latched */
+    Boolean                     eos;            /* TRUE if the last range reached the end of the leaves */
+    KeyValue                    *low;           /* lower bound of the range, NULL if unbounded */
+    KeyValue                    *high;          /* upper bound of the range, NULL if unbounded */
+    PageID                      leaf;           /* the leaf at hand */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+    btm_FetchRange              *range;         /* the current range */
+
+
+    if (root == NULL || kdesc == NULL || callback == NULL) ERR(eBADPARAMETER_BTM);
+    if (nRanges < 0 || (nRanges > 0 && ranges == NULL)) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* Only the forward ranges are read */
+    for (r = 0; r < nRanges; r++) {
+        if (ranges[r].startCompOp != SM_BOF && ranges[r].startCompOp != SM_EQ &&
+            ranges[r].startCompOp != SM_GE && ranges[r].startCompOp != SM_GT) ERR(eBADCOMPOP_BTM);
+        if (ranges[r].stopCompOp != SM_EOF && ranges[r].stopCompOp != SM_EQ &&
+            ranges[r].stopCompOp != SM_LT && ranges[r].stopCompOp != SM_LE) ERR(eBADCOMPOP_BTM);
+    }
+
+    if (nRanges == 0) return(eNOERROR);
+
+    /* Only an index buffering the updates or the changes has pending ones; it is latched exclusively */
+    if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+
+    /* The pending messages of the ranges are pushed down to the leaves first */
+    if (mode == BTM_LATCH_X) {
+        edubtm_EnterBfM();
+        for (r = 0; r < nRanges; r++) {
+            low = (ranges[r].startCompOp == SM_BOF) ? NULL : &ranges[r].start;
+            high = (ranges[r].stopCompOp != SM_EOF) ? &ranges[r].stop :
+                   (ranges[r].startCompOp == SM_EQ) ? &ranges[r].start : NULL;
+            if ((e = edubtm_FlushPendingMessages(root, kdesc, low, high, NULL, NULL)) < 0) ERRTL(e, root);
+        }
+        edubtm_LeaveBfM();
+    }
+
+    held = FALSE;
+    for (r = 0; r < nRanges; r++) {
+        range = &ranges[r];
+
+        /* From the leaf at hand, or from the root */
+        if ((e = edubtm_StartRange(root, kdesc, range, FALSE, &held, &leaf, &apage, &slotNo)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+
+        if ((e = edubtm_ReadRange(kdesc, range, r, &leaf, &apage, &slotNo, &eos, callback, arg)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+    }
+
+    if (held) {
+        if ((e = edubtm_UnfixPage(&leaf, FALSE)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+    }
+
+    (Four) edubtm_UnlatchTree(root);
+
+    return(eNOERROR);
+
+}   /* EduBtM_FetchMulti() */
+
+
+
+/*@================================
+ * edubtm_StartRange()
+ *================================*/
+/*
+ * Function: Four edubtm_StartRange(PageID*, KeyDesc*, btm_FetchRange*, Boolean, Boolean*, PageID*,
+ *                                  BtreePage**, Two*)
+ *
+ * Description:
+ *  Find the first slot at or after the start condition of the range. The
+ *  leaf at hand is used if its first key value is not greater than the
+ *  start key value, since all the leaves to its left hold smaller key
+ *  values only then, or if the caller knows so otherwise ('before'). If
+ *  the start key value is beyond the leaf, the search moves right along
+ *  the leaves as long as each one holds smaller key values only, up to
+ *  BTM_MULTIHOPS leaves. Otherwise the leaf is released and the tree is
+ *  searched from the root.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  held   : TRUE; a leaf is fixed and latched on return
+ *  leaf   : the leaf where the range starts
+ *  apage  : pointer to the buffer holding the leaf
+ *  slotNo : the first slot of the range; it may be past the last slot of
+ *           the leaf, and then the range starts in the next leaf
+ *
+ * Note:
+ *  On an error, no leaf is fixed.
+ */
+Four edubtm_StartRange(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    btm_FetchRange              *range,         /* IN the range */
+    Boolean                     before,         /* IN TRUE if the leaves left of the leaf at hand are before the range */
+    Boolean                     *held,          /* INOUT TRUE if a leaf is fixed and latched */
+    PageID                      *leaf,          /* INOUT the leaf at hand */
+    BtreePage                   **apage,        /* INOUT pointer to the buffer holding the leaf */
+    Two                         *slotNo)        /* OUT the first slot of the range */
+{
+    Four                        e;              /* error number */
+    Two                         hops;           /* # of leaves moved right */
+    Two                         idx;            /* result of the binary search */
+    Boolean                     found;          /* TRUE if the start key value is in the leaf */
+    Boolean                     eos;            /* TRUE if there is no more leaf */
+    KeyValue                    *kval;          /* start key value, NULL for SM_BOF */
+    btm_LeafEntry               *lEntry;        /* the first entry of the leaf */
+
+
+    kval = (range->startCompOp == SM_BOF) ? NULL : &range->start;
+
+    if (*held && kval != NULL && (*apage)->bl.hdr.nSlots > 0) {
+        lEntry = (btm_LeafEntry*)&((*apage)->bl.data[(*apage)->bl.slot[0]]);
+
+        if (before || edubtm_KeyCompare(kdesc, (KeyValue*)&(lEntry->klen), kval) != GREATER) {
+            for (hops = 0; ; hops++) {
+                found = edubtm_BinarySearchLeaf(&((*apage)->bl), kdesc, kval, &idx);
+                *slotNo = (found && range->startCompOp != SM_GT) ? idx : idx+1;
+                if (*slotNo < (*apage)->bl.hdr.nSlots || hops == BTM_MULTIHOPS) break;
+
+                /* The whole leaf is before the range */
+                if ((e = edubtm_MoveToSibling(leaf, apage, TRUE, &eos)) < 0) {
+                    *held = FALSE;
+                    ERR(e);
+                }
+                if (eos) return(eNOERROR);
+            }
+
+            if (*slotNo < (*apage)->bl.hdr.nSlots) return(eNOERROR);
+        }
+    }
+
+    /* The range starts too far away */
+    if (*held) {
+        *held = FALSE;
+        if ((e = edubtm_UnfixPage(leaf, FALSE)) < 0) ERR(e);
+    }
+
+    if ((e = edubtm_SearchLeaf(root, kdesc, kval, FALSE, BTM_LATCH_S, NULL, leaf, apage)) < 0) ERR(e);
+    *held = TRUE;
+
+    if (kval == NULL) *slotNo = 0;
+    else {
+        found = edubtm_BinarySearchLeaf(&((*apage)->bl), kdesc, kval, &idx);
+        *slotNo = (found && range->startCompOp != SM_GT) ? idx : idx+1;
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_StartRange() */
+
+
+
+/*@================================
+ * edubtm_ReadRange()
+ *================================*/
+/*
+ * Function: Four edubtm_ReadRange(KeyDesc*, btm_FetchRange*, Four, PageID*, BtreePage**, Two*, Boolean*,
+ *                                 btm_ScanCallback, void*)
+ *
+ * Description:
+ *  Read the range forward from the given slot, coupling the shared latches
+ *  along the leaves, and hand its objects to the callback in batches of
+ *  BTM_SCANBATCHSIZE cursors with 'rangeNo' as the # of the range. The
+ *  leaf where the range ends is kept for the caller.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls or by the callback
+ *
+ * Side effects:
+ *  leaf   : the leaf where the range ends, still fixed and latched
+ *  apage  : pointer to the buffer holding the leaf
+ *  slotNo : the first slot after the range; the # of slots of the leaf
+ *           if 'eos' is TRUE
+ *  eos    : TRUE if the range reaches the end of the leaves
+ *
+ * Note:
+ *  On an error, the leaf is released.
+ */
+Four edubtm_ReadRange(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    btm_FetchRange              *range,         /* IN the range */
+    Four                        rangeNo,        /* IN # of the range given to the callback */
+    PageID                      *leaf,          /* INOUT leaf fixed with a shared latch */
+    BtreePage                   **apage,        /* INOUT pointer to the buffer holding the leaf */
+    Two                         *slotNo,        /* INOUT the first slot of the range */
+    Boolean                     *eos,           /* OUT TRUE if there is no more leaf */
+    btm_ScanCallback            callback,       /* IN function receiving the batches */
+    void                        *arg)           /* IN argument of the callback */
+{
+    Four                        e;              /* error number */
+    Four                        nCursors;       /* # of cursors in the batch */
+    btm_LeafEntry               *lEntry;        /* the current leaf entry */
+    BtreeCursor                 batch[BTM_SCANBATCHSIZE]; /* cursors not handed to the callback yet */
+
+
+    *eos = FALSE;
+    nCursors = 0;
+    for (;;) {
+        if (*slotNo >= (*apage)->bl.hdr.nSlots) {
+            if ((e = edubtm_MoveToSibling(leaf, apage, TRUE, eos)) < 0) ERR(e);
+            if (*eos) break;
+
+            *slotNo = 0;
+            continue;
+        }
+
+        lEntry = (btm_LeafEntry*)&((*apage)->bl.data[(*apage)->bl.slot[-*slotNo]]);
+        if (!edubtm_InRange(kdesc, lEntry, range)) break;
+
+        batch[nCursors].flag = CURSOR_ON;
+        batch[nCursors].leaf = *leaf;
+        batch[nCursors].overflow.pageNo = NIL;
+        batch[nCursors].slotNo = *slotNo;
+        batch[nCursors].oidArrayElemNo = 0;
+        batch[nCursors].key.len = lEntry->klen;
+        memcpy(batch[nCursors].key.val, lEntry->kval, lEntry->klen);
+        memcpy(&(batch[nCursors].oid), &(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)]), OBJECTID_SIZE);
+        nCursors++;
+        (*slotNo)++;
+
+        if (nCursors == BTM_SCANBATCHSIZE) {
+            if ((e = (*callback)(arg, rangeNo, nCursors, batch)) < 0) {
+                (Four) edubtm_UnfixPage(leaf, FALSE);
+                ERR(e);
+            }
+            nCursors = 0;
+        }
+    }
+
+    if (nCursors > 0) {
+        if ((e = (*callback)(arg, rangeNo, nCursors, batch)) < 0) {
+            (Four) edubtm_UnfixPage(leaf, FALSE);
+            ERR(e);
+        }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_ReadRange() */
+
+
+
+/*@================================
+ * edubtm_InRange()
+ *================================*/
+/*
+ * Function: Boolean edubtm_InRange(KeyDesc*, btm_LeafEntry*, btm_FetchRange*)
+ *
+ * Description:
+ *  Check the key value of a leaf entry reached from the start of the range
+ *  against the stop condition, and against the start key value if the
+ *  range is a single key value (SM_EQ).
+ *
+ * Returns:
+ *  TRUE if the entry belongs to the range; FALSE if the range is over
+ */
+Boolean edubtm_InRange(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    btm_LeafEntry               *lEntry,        /* IN a leaf entry */
+    btm_FetchRange              *range)         /* IN the range */
+{
+    Four                        cmp;            /* result of comparison */
+
+
+    if (range->startCompOp == SM_EQ &&
+        edubtm_KeyCompare(kdesc, (KeyValue*)&(lEntry->klen), &range->start) != EQUAL) return(FALSE);
+
+    if (range->stopCompOp == SM_EOF) return(TRUE);
+
+    cmp = edubtm_KeyCompare(kdesc, (KeyValue*)&(lEntry->klen), &range->stop);
+
+    switch (range->stopCompOp) {
+        case SM_EQ: return((cmp == EQUAL) ? TRUE : FALSE);
+        case SM_LT: return((cmp == LESS) ? TRUE : FALSE);
+        case SM_LE: return((cmp != GREATER) ? TRUE : FALSE);
+    }
+
+    return(FALSE);
+
+}   /* edubtm_InRange() */
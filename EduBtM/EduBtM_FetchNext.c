@@ -64,10 +64,6 @@
 #include "EduBtM_Internal.h"
 
 
-/*@ Internal Function Prototypes */
-Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
-
-
 
 /*@================================
  * EduBtM_FetchNext()
@@ -134,14 +130,14 @@ Four EduBtM_FetchNext(
 
     /* Search the next first object satisfying the given condition */
     
-    /* Fix the leaf page of current cursor to the buffer */    
-    if((e = BfM_GetTrain((TrainID*)&(current->leaf), (char**)&apage, PAGE_BUF)) < 0) ERR(e);    
+    /* The writers of the index are kept out of the leaves the scan goes through */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_S)) < 0) ERR(e);
 
     /* Get the cursor to the next item */
-    if((e = edubtm_FetchNext(kdesc, kval, compOp, current, next))<0) ERR(e);
-    
-    /* Unfix the leaf page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)&(current->leaf), PAGE_BUF))<0) ERR(e);
+    e = edubtm_FetchNext(root, kdesc, kval, compOp, current, next);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (e < 0) ERR(e);
 
     /**/
     return(eNOERROR);
@@ -154,7 +150,7 @@ Four EduBtM_FetchNext(
  * edubtm_FetchNext()
  *================================*/
 /*
- * Function: Four edubtm_FetchNext(KeyDesc*, KeyValue*, Four,
+ * Function: Four edubtm_FetchNext(PageID*, KeyDesc*, KeyValue*, Four,
  *                              BtreeCursor*, BtreeCursor*)
  *
  * Description:
@@ -164,29 +160,30 @@ Four EduBtM_FetchNext(
  *  Get the next item. We assume that the current cursor is valid; that is.
  *  'current' rightly points to an existing ObjectID.
  *
+ *  Other threads may have moved the current entry since the cursor was set.
+ *  The entry is searched by its key value in the leaf of the cursor, and if
+ *  it is not there any more, the next item is searched from the root.
+ *
  * Returns:
  *  Error code
  *    eBADCOMPOP_BTM
  *    some errors caused by function calls
  */
 Four edubtm_FetchNext(
+    PageID		*root,		/* IN root of the Btree */
     KeyDesc  		*kdesc,		/* IN key descriptor */
     KeyValue 		*kval,		/* IN key value of stop condition */
     Four     		compOp,		/* IN comparison operator of stop condition */
     BtreeCursor 	*current,	/* IN current cursor */
     BtreeCursor 	*next)		/* OUT next cursor */
 {
-	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     Four 		e;		/* error number */
-    Four 		cmp;		/* comparison result */
-    Two 		alignedKlen;	/* aligned length of a key length */
+    Two 		idx;		/* slot of the current entry */
+    Boolean 		found;		/* search result */
+    Boolean 		forward;	/* direction of the scan */
     PageID 		leaf;		/* temporary PageID of a leaf page */
-    PageID 		overflow;	/* temporary PageID of an overflow page */
-    ObjectID 		*oidArray;	/* array of ObjectIDs */
-    BtreeLeaf 		*apage;		/* pointer to a buffer holding a leaf page */
-    BtreeOverflow 	*opage;		/* pointer to a buffer holding an overflow page */
-    btm_LeafEntry 	*entry;		/* pointer to a leaf entry */        
-    Boolean found = FALSE;
+    BtreePage 		*apage;		/* pointer to a buffer holding a leaf page */
+    btm_LeafEntry 	*entry;		/* pointer to a leaf entry */
 
     /* Error check whether using not supported functionality by EduBtM */
     int i;
@@ -196,115 +193,48 @@ Four edubtm_FetchNext(
             ERR(eNOTSUPPORTED_EDUBTM);
     }
     /**/
-    /* Search the next first object satisfying the given condition */
-    leaf = current->leaf;
-
-    /* Fix the leaf page of current cursor to the buffer */    
-    if((e = BfM_GetTrain((TrainID*)&leaf, (char**)&apage, PAGE_BUF)) < 0) ERR(e);    
-    
-    /* Get the next leaf index entry */
-     
-    /* Check if the entry satisfies compOp */
-    
-    if (compOp == SM_EQ){
-        next->flag = CURSOR_EOS;
-        if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-        return(eNOERROR);
-    }
-
-    if ((compOp == SM_LT) || (compOp == SM_LE)){
-
-        if(current->slotNo == apage->hdr.nSlots-1){
-            /* If current is the first entry of the whole index*/
-            if( apage->hdr.nextPage == NIL ){
-                next->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);
-            }
-
-            /* Else */
-            if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);
-            MAKE_PAGEID(leaf, leaf.volNo, apage->hdr.nextPage);        
-            if((e = BfM_GetTrain((TrainID*)&leaf, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
-            i = 0;
-        }
-
-        else i = (current->slotNo) - 1;
-
-        entry = (btm_LeafEntry *)&(apage->data[apage->slot[-i]]);
-        cmp = edubtm_KeyCompare(kdesc, (KeyValue *)(&(entry->klen)), kval);
-        if(!((cmp == GREATER) || ((cmp == EQUAL)&&(compOp == SM_GE)))){
-            next->flag = CURSOR_EOS;
-            if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-            return(eNOERROR);
-        }
+    /* The scan goes toward the stop condition */
+    switch (compOp) {
+        case SM_EQ: case SM_LT: case SM_LE: case SM_EOF:
+            forward = TRUE;
+            break;
+        case SM_GT: case SM_GE: case SM_BOF:
+            forward = FALSE;
+            break;
+        default:
+            ERR(eBADCOMPOP_BTM);
     }
 
-    else if ((compOp == SM_GT) || (compOp == SM_GE)){
-
-        if(current->slotNo == 0){
-            /* If current is the first entry of the whole index*/
-            if( apage->hdr.prevPage == NIL ){
-                next->flag = CURSOR_EOS;
-                if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-                return(eNOERROR);
-            }
-
-            /* Else */
-            if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);
-            MAKE_PAGEID(leaf, leaf.volNo, apage->hdr.prevPage);        
-            if((e = BfM_GetTrain((TrainID*)&leaf, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
-            i = apage->hdr.nSlots - 1;
-        }
-
-        else i = (current->slotNo) - 1;
-
-        entry = (btm_LeafEntry *)&(apage->data[apage->slot[-i]]);
-        cmp = edubtm_KeyCompare(kdesc, (KeyValue *)(&(entry->klen)), kval);
-        if(!((cmp == GREATER) || ((cmp == EQUAL)&&(compOp == SM_GE)))){
-            next->flag = CURSOR_EOS;
-            if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-            return(eNOERROR);
+    /* Fix the leaf page of current cursor with a shared latch */
+    leaf = current->leaf;
+    if ((e = edubtm_FixPage(&leaf, &apage, BTM_LATCH_S)) < 0) ERR(e);
+
+    /* Find the current entry in the leaf */
+    found = FALSE;
+    if (apage->any.hdr.type & LEAF) {
+        idx = current->slotNo;
+        if (idx >= 0 && idx < apage->bl.hdr.nSlots) {
+            entry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+            found = (edubtm_KeyCompare(kdesc, (KeyValue*)&(entry->klen), &(current->key)) == EQUAL) ? TRUE : FALSE;
         }
+        if (!found)
+            found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, &(current->key), &idx);
     }
-/*
 
-    switch(compOp){
-        case SM_EQ :
-            if(cmp == EQUAL) found = TRUE;            
-            break;
-
-        case SM_LT :
-            if(cmp == LESS) found = TRUE;
-            break;
+    if (!found) {
+        /* The entry moved to another leaf or was deleted */
+        if ((e = edubtm_UnfixPage(&leaf, FALSE)) < 0) ERR(e);
 
-        case SM_LE :
-            if((cmp == LESS) || (cmp == EQUAL)) found = TRUE;
-            break;
-                        
-        case SM_GT :
-            if(cmp == GREATER) found = TRUE;
-            break;
+        if ((e = edubtm_Fetch(root, kdesc, &(current->key), (forward) ? SM_GT : SM_LT, kval, compOp, next)) < 0) ERR(e);
 
-        case SM_GE :
-            if((cmp == GREATER) || (cmp == EQUAL)) found = TRUE;
-            break;
+        return(eNOERROR);
     }
-*/
-    /* Satisfied */
 
-    next->flag = CURSOR_ON;
-    next->leaf = leaf;
-    next->slotNo = i;
-    next->oidArrayElemNo = 1;
-    alignedKlen = ALIGNED_LENGTH(entry->klen);
-    next->oid = *(ObjectID *)(&(entry->kval) + alignedKlen);
-    next->key = *(KeyValue *)(&(entry->klen));
+    /* Get the next leaf index entry; the leaf is released here */
+    idx = (forward) ? idx+1 : idx-1;
+    if ((e = edubtm_PositionCursor(&leaf, apage, idx, forward, kdesc, kval, compOp, next)) < 0) ERR(e);
 
-    /* Unfix the leaf page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)&leaf, PAGE_BUF))<0) ERR(e);    
-    
-    /**/    
+    /**/
     return(eNOERROR);
     
 } /* edubtm_FetchNext() */
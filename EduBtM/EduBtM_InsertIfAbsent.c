@@ -0,0 +1,117 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_InsertIfAbsent.c
+ *
+ * Description :
+ *  Insert an ObjectID into a B+tree unless its key value is already there.
+ *
+ * Exports:
+ *  Four EduBtM_InsertIfAbsent(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, ObjectID*, Pool*, DeallocListElem*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_InsertIfAbsent()
+ *================================*/
+/*
+ * Function: Four EduBtM_InsertIfAbsent(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *                                      Boolean*, ObjectID*, Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Insert an ObjectID 'oid' into a Btree whose key value is 'kval' if the
+ *  key value does not exist in the Btree. Otherwise the Btree is not changed
+ *  and the ObjectID having the key value is returned in 'foundOid'.
+ *
+ *  The existence check and the insertion are done in the same descent, so
+ *  calling EduBtM_Fetch() beforehand is not needed. Both are done by
+ *  edubtm_InsertWithMode(...).
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  found : TRUE if the key value already exists and 'oid' is not inserted
+ */
+Four EduBtM_InsertIfAbsent(
+    ObjectID *catObjForFile,	/* IN catalog object of B+ tree file */
+    PageID   *root,		/* IN the root of Btree */
+    KeyDesc  *kdesc,		/* IN key descriptor */
+    KeyValue *kval,		/* IN key value */
+    ObjectID *oid,		/* IN ObjectID which will be inserted */
+    Boolean  *found,		/* OUT whether the key value already exists */
+    ObjectID *foundOid,		/* OUT ObjectID of the existing key value */
+    Pool     *dlPool,		/* INOUT pool of dealloc list */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+
+    /*@ check parameters */
+
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kval == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (oid == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (found == NULL || foundOid == NULL) ERR(eBADPARAMETER_BTM);
+
+    return(edubtm_InsertWithMode(catObjForFile, root, kdesc, kval, oid, BTM_INSERTIFABSENT, found, foundOid, dlPool, dlHead));
+
+}   /* EduBtM_InsertIfAbsent() */
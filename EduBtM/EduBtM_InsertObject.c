@@ -97,10 +97,12 @@ Four EduBtM_InsertObject(
     Four e;			/* error number */
     Boolean lh;			/* for spliting */
     Boolean lf;			/* for merging */
+    Boolean exists;		/* whether the key value already exists */
+    Boolean buffered;		/* whether the index is buffered */
+    ObjectID oldOid;		/* ObjectID of the key value in the buffered index */
+    Boolean logged;		/* whether the insert goes to the side log */
+    Four mode;			/* mode of the tree latch */
     InternalItem item;		/* Internal Item */
-    SlottedPage *catPage;	/* buffer page containing the catalog object */
-    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
-    PhysicalFileID pFid;	 /* B+-tree file's FileID */
     
     /*@ check parameters */
     
@@ -121,22 +123,67 @@ Four EduBtM_InsertObject(
             ERR(eNOTSUPPORTED_EDUBTM);
     }
     /**/
-    
+
+    for (;;) {
+        /* The insert into an index being built goes to its side log */
+        if ((e = edubtm_LogSideChange(root, BTM_MSG_INSERT, kval, oid, &logged)) < 0) ERR(e);
+        if (logged) return(eNOERROR);
+
+        /* An index buffering the updates is latched exclusively; otherwise the pages are latched on the way down */
+        if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+
+        /* A build may have begun while the latch was awaited */
+        if (!edubtm_InOnlineBuild(root)) break;
+        (Four) edubtm_UnlatchTree(root);
+    }
+
+    /* The key value is in the Bloom filter before it can be found in the tree */
+    if ((e = edubtm_AddToBloomFilter(root, kval)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    if (mode == BTM_LATCH_S) {
+        /* Insert the object */
+        e = edubtm_CoupledInsert(catObjForFile, root, kdesc, kval, oid, BTM_INSERT, &exists, NULL, dlPool, dlHead);
+
+        (Four) edubtm_UnlatchTree(root);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    edubtm_EnterBfM();
+
     lh = FALSE; //Initially splitting flag is false
 
-    /* Fix the catpage to the buffer */    
-    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    /* The insert into a buffered index is put into the message buffer of the root */
+    if ((e = edubtm_IsBufferedIndex(root, &buffered)) < 0) ERRTL(e, root);
+    if (buffered) {
+        /* The key value may be in a pending message or in its leaf */
+        if ((e = edubtm_SearchPending(root, kdesc, kval, &exists, &oldOid)) < 0) ERRTL(e, root);
+        if (exists) ERRTL(eDUPLICATEDKEY_BTM, root);
+
+        if ((e = edubtm_BufferUpdate(catObjForFile, root, kdesc, BTM_MSG_INSERT, kval, oid, dlPool, dlHead)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+        return(eNOERROR);
+    }
+
+    /* The leaf is read even if the changes are buffered, to reject a duplicated key value;
+       the pending changes of the key value go to the leaf first */
+    if ((e = edubtm_MergeChanges(root, kdesc, kval, kval, 0)) < 0) ERRTL(e, root);
 
     /* Insert the object */
-    if ((e = edubtm_Insert(catObjForFile, root, kdesc, kval, oid, &lf, &lh, &item, dlPool, dlHead))<0) ERR(e);    
+    if ((e = edubtm_Insert(catObjForFile, root, kdesc, kval, oid, BTM_INSERT, &exists, NULL, &lf, &lh, &item, dlPool, dlHead))<0) ERRTL(e, root);    
     
     /* If root page is splitted */
     if(lh){        
-        if((e = btm_root_insert(catObjForFile, root, &item)<0)) ERR(e);
+        if((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
     }
     
-    /* Unfix the page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)catObjForFile,PAGE_BUF))<0) ERR(e); 
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
        
     /**/
     return(eNOERROR);
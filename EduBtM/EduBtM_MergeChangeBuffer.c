@@ -0,0 +1,115 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_MergeChangeBuffer.c
+ *
+ * Description :
+ *  Merge the changes kept in the change buffer of a B+tree index.
+ *
+ * Exports:
+ *  Four EduBtM_MergeChangeBuffer(PageID*, KeyDesc*, Four)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_MergeChangeBuffer()
+ *================================*/
+/*
+ * Function: Four EduBtM_MergeChangeBuffer(PageID*, KeyDesc*, Four)
+ *
+ * Description :
+ *  Merge the oldest 'maxChanges' changes in the change buffer of the index
+ *  into the leaves; all of them if 'maxChanges' is not positive. It is
+ *  called by a background merger, in small steps, to keep the change buffer
+ *  from becoming full in the middle of the inserts.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_MergeChangeBuffer(
+    PageID   *root,		/* IN the root of Btree */
+    KeyDesc  *kdesc,		/* IN key descriptor */
+    Four     maxChanges)	/* IN max # of changes to merge, 0 if unlimited */
+{
+    int i;
+    Four e;			/* error number */
+
+
+    /*@ check parameters */
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* Merging the changes rewrites leaves without coupling */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    if ((e = edubtm_MergeChanges(root, kdesc, NULL, NULL, maxChanges)) < 0) ERRTL(e, root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_MergeChangeBuffer() */
@@ -0,0 +1,175 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_OnlineBuild.c
+ *
+ * Description :
+ *  Build an index while its data file is being updated.
+ *
+ *  The caller creates an empty index, and calls EduBtM_BeginOnlineBuild().
+ *  Then it reads a snapshot of the data file, sorts the items, and loads
+ *  them by EduBtM_BulkLoad(). The inserts and deletes of the data file made
+ *  meanwhile by EduBtM_InsertObject() and EduBtM_DeleteObject() go to the
+ *  side log of the index, so the writers are not blocked by the build.
+ *  EduBtM_EndOnlineBuild() replays the side log into the tree; after that
+ *  the caller may publish the index in the catalog.
+ *
+ * Exports:
+ *  Four EduBtM_BeginOnlineBuild(ObjectID*, PageID*)
+ *  Four EduBtM_EndOnlineBuild(PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_BeginOnlineBuild()
+ *================================*/
+/*
+ * Function: Four EduBtM_BeginOnlineBuild(ObjectID*, PageID*)
+ *
+ * Description:
+ *  Begin the online build of an empty index. The side log hangs from the
+ *  meta page of the index, which is allocated if not exists.
+ *
+ *  The build begins under the exclusive latch of the tree, so no insert or
+ *  delete is halfway in the tree; the ones waiting for the latch see the
+ *  build and go to the side log.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eONLINEBUILDTABLEFULL_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_BeginOnlineBuild(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root)          /* IN root of an empty index */
+{
+    Four                        e;              /* error number */
+    Boolean                     empty;          /* TRUE if the index is empty */
+    PageID                      metaPid;        /* PageID of the meta page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root page */
+
+
+    if (catObjForFile == NULL || root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    /* The snapshot is loaded only into an empty index */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERRTL(e, root);
+    empty = ((apage->any.hdr.type & LEAF) && apage->bl.hdr.nSlots == 0) ? TRUE : FALSE;
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERRTL(e, root);
+    if (!empty) ERRTL(eBADPARAMETER_BTM, root);
+
+    if ((e = edubtm_GetMetaPage(catObjForFile, root, TRUE, &metaPid)) < 0) ERRTL(e, root);
+
+    /* The table of the builds is entered out of the buffer manager mutex */
+    edubtm_LeaveBfM();
+
+    e = edubtm_RegisterOnlineBuild(catObjForFile, root, &metaPid);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* EduBtM_BeginOnlineBuild() */
+
+
+
+/*@================================
+ * EduBtM_EndOnlineBuild()
+ *================================*/
+/*
+ * Function: Four EduBtM_EndOnlineBuild(PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  End the online build of an index: the changes in the side log are
+ *  applied to the tree in the order they were made, and the pages of the
+ *  side log are put into the dealloc list. The changes made after this go
+ *  to the tree directly.
+ *
+ *  A key value inserted while the index was built is rejected if the tree
+ *  has it with another ObjectID; then the build ends unfinished, and the
+ *  caller should drop the index.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eDUPLICATEDKEY_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_EndOnlineBuild(
+    PageID                      *root,          /* IN root of the index being built */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+
+
+    if (root == NULL || kdesc == NULL) ERR(eBADPARAMETER_BTM);
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    e = edubtm_ReplaySideLog(root, kdesc, dlPool, dlHead);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* EduBtM_EndOnlineBuild() */
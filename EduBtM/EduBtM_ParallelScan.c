@@ -0,0 +1,582 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_ParallelScan.c
+ *
+ * Description :
+ *  Scan a range of a B+tree index with several threads. The range is split
+ *  into disjoint sub-ranges at the separator keys of the root, or of the
+ *  level below it when the root has too few of them in the range, and each
+ *  sub-range is read by a thread with a cursor of its own.
+ *
+ * Exports:
+ *  Four EduBtM_ParallelScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four,
+ *                        Four, Boolean, btm_ScanCallback, void*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_SplitScanRange(btm_ParallelScan*, KeyValue*, KeyValue*, Four);
+Four edubtm_CollectSplitKeys(PageID*, KeyDesc*, KeyValue*, KeyValue*, Boolean, Four, Four*, KeyValue*, Four*, Boolean*);
+void *edubtm_ScanWorker(void*);
+Four edubtm_DeliverBatches(btm_ScanPart*, BtreeCursor (*)[BTM_SCANBATCHSIZE], Four*, Four*, Boolean);
+void edubtm_StopScan(btm_ParallelScan*, Four);
+
+
+
+/*@================================
+ * EduBtM_ParallelScan()
+ *================================*/
+/*
+ * Function: Four EduBtM_ParallelScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four,
+ *                                 Four, Boolean, btm_ScanCallback, void*)
+ *
+ * Description :
+ *  Read the objects from the start condition up to the stop condition with
+ *  at most 'nWorkers' threads, and hand them to 'callback' in batches of
+ *  cursors. The scan goes forward: the start condition is one of SM_BOF,
+ *  SM_GE, and SM_GT, and the stop condition one of SM_EOF, SM_LT, and SM_LE.
+ *
+ *  The callback is called by the threads, but never by two of them at the
+ *  same time. If 'ordered' is TRUE, the batches come in the key order;
+ *  otherwise each sub-range delivers its batches as soon as they are full,
+ *  in its own key order. When the callback returns an error, the scan stops
+ *  and returns the error.
+ *
+ *  The index is latched as by EduBtM_Fetch(...) for the whole scan, so an
+ *  index buffering the updates has no writer meanwhile; with the other
+ *  indexes, the latch-coupled writers go on, and the cursors are adjusted
+ *  as those of EduBtM_FetchNext(...).
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eBADCOMPOP_BTM
+ *    some errors caused by function calls or by the callback
+ */
+Four EduBtM_ParallelScan(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *startKval,     /* IN key value of start condition */
+    Four                        startCompOp,    /* IN comparison operator of start condition */
+    KeyValue                    *stopKval,      /* IN key value of stop condition */
+    Four                        stopCompOp,     /* IN comparison operator of stop condition */
+    Four                        nWorkers,       /* IN # of threads at most */
+    Boolean                     ordered,        /* IN TRUE if the batches should come in the key order */
+    btm_ScanCallback            callback,       /* IN function receiving the batches */
+    void                        *arg)           /* IN argument of the callback */
+{
+    int                         i;
+    Four                        e;              /* error number */
+    Four                        mode;           /* mode of the tree latch */
+    KeyValue                    *low;           /* lower bound of the range, NULL if unbounded */
+    KeyValue                    *high;          /* upper bound of the range, NULL if unbounded */
+    btm_ParallelScan            scan;           /* state shared by the threads */
+
+
+    if (root == NULL || kdesc == NULL || callback == NULL) ERR(eBADPARAMETER_BTM);
+    if (nWorkers < 1 || nWorkers > BTM_MAXSCANWORKERS) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* Only the forward scans are split */
+    if (startCompOp != SM_BOF && startCompOp != SM_GE && startCompOp != SM_GT) ERR(eBADCOMPOP_BTM);
+    if (stopCompOp != SM_EOF && stopCompOp != SM_LT && stopCompOp != SM_LE) ERR(eBADCOMPOP_BTM);
+    if ((startCompOp != SM_BOF && startKval == NULL) || (stopCompOp != SM_EOF && stopKval == NULL))
+        ERR(eBADPARAMETER_BTM);
+
+    low = (startCompOp == SM_BOF) ? NULL : startKval;
+    high = (stopCompOp == SM_EOF) ? NULL : stopKval;
+
+    /* The pending messages of the range are pushed down under the exclusive latch, which is held to the end */
+    if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+    if (mode == BTM_LATCH_X) {
+        edubtm_EnterBfM();
+        if ((e = edubtm_FlushPendingMessages(root, kdesc, low, high, NULL, NULL)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+    }
+
+    scan.root = *root;
+    scan.kdesc = kdesc;
+    scan.ordered = ordered;
+    scan.callback = callback;
+    scan.arg = arg;
+    scan.turn = 0;
+    scan.stop = FALSE;
+    scan.error = eNOERROR;
+
+    /* Choose the sub-ranges */
+    if ((e = edubtm_SplitScanRange(&scan, low, high, nWorkers)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    for (i = 0; i < scan.nParts; i++) {
+        if (i == 0) {
+            scan.parts[i].lowCompOp = startCompOp;
+            if (low != NULL) scan.parts[i].low = *low;
+        }
+        else {
+            scan.parts[i].low = scan.parts[i-1].high;
+            scan.parts[i].lowCompOp = SM_GE;
+        }
+
+        if (i == scan.nParts-1) {
+            scan.parts[i].highCompOp = stopCompOp;
+            if (high != NULL) scan.parts[i].high = *high;
+            else scan.parts[i].high.len = 0;
+        }
+        else
+            scan.parts[i].highCompOp = SM_LT;
+
+        scan.parts[i].scan = &scan;
+        scan.parts[i].partNo = i;
+    }
+
+    pthread_mutex_init(&scan.mutex, NULL);
+    pthread_cond_init(&scan.turnChanged, NULL);
+
+    for (i = 0; i < scan.nParts; i++)
+        scan.parts[i].started = (pthread_create(&scan.parts[i].thread, NULL, edubtm_ScanWorker, &scan.parts[i]) == 0) ? TRUE : FALSE;
+
+    /* A sub-range without a thread is scanned here; the earlier ones do not depend on it */
+    for (i = 0; i < scan.nParts; i++)
+        if (!scan.parts[i].started) (void) edubtm_ScanWorker(&scan.parts[i]);
+
+    for (i = 0; i < scan.nParts; i++)
+        if (scan.parts[i].started) pthread_join(scan.parts[i].thread, NULL);
+
+    pthread_cond_destroy(&scan.turnChanged);
+    pthread_mutex_destroy(&scan.mutex);
+
+    (Four) edubtm_UnlatchTree(root);
+    if (scan.error < 0) ERR(scan.error);
+
+    return(eNOERROR);
+
+} /* EduBtM_ParallelScan() */
+
+
+
+/*@================================
+ * edubtm_SplitScanRange()
+ *================================*/
+/*
+ * Function: Four edubtm_SplitScanRange(btm_ParallelScan*, KeyValue*, KeyValue*, Four)
+ *
+ * Description :
+ *  Split the range (low, high) into at most 'nWorkers' sub-ranges. The split
+ *  points are taken evenly from the separator keys of the root in the range,
+ *  or from those of the root and of its children when the root alone has
+ *  fewer than 'nWorkers'-1 of them. The keys are counted first and copied in
+ *  a second pass, so that nothing but the split points is kept.
+ *
+ *  The pages may change between the passes; then fewer sub-ranges are made,
+ *  which is still correct as they are bounded by the keys themselves.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  scan->nParts, and the stop key values of the sub-ranges but the last
+ */
+Four edubtm_SplitScanRange(
+    btm_ParallelScan            *scan,          /* INOUT the scan */
+    KeyValue                    *low,           /* IN lower bound of the range, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the range, NULL if unbounded */
+    Four                        nWorkers)       /* IN # of sub-ranges at most */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index */
+    Four                        nKeys;          /* # of separator keys in the range */
+    Four                        nSplits;        /* # of split points */
+    Boolean                     deep;           /* TRUE if the children of the root are visited */
+    Four                        picks[BTM_MAXSCANWORKERS];  /* ordinals of the keys taken as split points */
+    KeyValue                    keys[BTM_MAXSCANWORKERS];   /* the split points */
+
+
+    scan->nParts = 1;
+    if (nWorkers == 1) return(eNOERROR);
+
+    /* Count the separators of the root, and those of the next level if they are too few */
+    deep = FALSE;
+    if ((e = edubtm_CollectSplitKeys(&scan->root, scan->kdesc, low, high, FALSE, 0, NULL, NULL, &nKeys, &deep)) < 0) ERR(e);
+
+    if (nKeys < nWorkers-1 && deep) {
+        if ((e = edubtm_CollectSplitKeys(&scan->root, scan->kdesc, low, high, TRUE, 0, NULL, NULL, &nKeys, &deep)) < 0) ERR(e);
+    }
+    else
+        deep = FALSE;
+
+    nSplits = MIN(nKeys, nWorkers-1);
+    if (nSplits == 0) return(eNOERROR);
+
+    /* Take the split points evenly from the keys */
+    for (i = 0; i < nSplits; i++)
+        picks[i] = ((i+1)*(nKeys+1))/(nSplits+1) - 1;
+
+    if ((e = edubtm_CollectSplitKeys(&scan->root, scan->kdesc, low, high, deep, nSplits, picks, keys, &nSplits, &deep)) < 0) ERR(e);
+
+    for (i = 0; i < nSplits; i++)
+        scan->parts[i].high = keys[i];
+    scan->nParts = nSplits + 1;
+
+    return(eNOERROR);
+
+} /* edubtm_SplitScanRange() */
+
+
+
+/*@================================
+ * edubtm_CollectSplitKeys()
+ *================================*/
+/*
+ * Function: Four edubtm_CollectSplitKeys(PageID*, KeyDesc*, KeyValue*, KeyValue*, Boolean,
+ *                                     Four, Four*, KeyValue*, Four*, Boolean*)
+ *
+ * Description :
+ *  Visit in the key order the separator keys lying strictly between 'low'
+ *  and 'high', in the root and, if 'deep' is TRUE, in the children of the
+ *  root covering the range. If 'picks' is NULL the keys are only counted;
+ *  otherwise the keys of the given ordinals, in ascending order, are copied
+ *  to 'keys' and their number is returned in 'nKeys'.
+ *
+ *  The root is latched in the shared mode while its children are read.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  hasChildren : TRUE if the children of the root are internal pages
+ */
+Four edubtm_CollectSplitKeys(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *low,           /* IN lower bound of the range, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the range, NULL if unbounded */
+    Boolean                     deep,           /* IN TRUE if the children of the root are visited */
+    Four                        nPicks,         /* IN # of keys to be copied */
+    Four                        *picks,         /* IN ordinals of the keys to be copied, NULL to count */
+    KeyValue                    *keys,          /* OUT the keys copied */
+    Four                        *nKeys,         /* OUT # of keys counted or copied */
+    Boolean                     *hasChildren)   /* OUT TRUE if the children of the root are internal */
+{
+    Four                        e;              /* error number */
+    Two                         first;          /* first child covering the range; -1 for p0 */
+    Two                         last;           /* last child covering the range */
+    Two                         j;              /* index of a child */
+    Two                         k;              /* index of an entry of a child */
+    Four                        count;          /* # of keys visited */
+    Four                        nCopied;        /* # of keys copied */
+    PageID                      child;          /* a child of the root */
+    KeyValue                    *kval;          /* key of the entry visited */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root */
+    BtreePage                   *cpage;         /* pointer to the buffer holding a child */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    count = nCopied = 0;
+    *hasChildren = FALSE;
+
+    if ((e = edubtm_FixPage(root, &rpage, BTM_LATCH_S)) < 0) ERR(e);
+
+    if (!(rpage->any.hdr.type & INTERNAL)) {
+        *nKeys = 0;
+        if ((e = edubtm_UnfixPage(root, FALSE)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    first = -1;
+    last = rpage->bi.hdr.nSlots - 1;
+    if (low != NULL) (void) edubtm_BinarySearchInternal(&(rpage->bi), kdesc, low, &first);
+    if (high != NULL) (void) edubtm_BinarySearchInternal(&(rpage->bi), kdesc, high, &last);
+
+    for (j = first; j <= last; j++) {
+
+        /* The separator of the child is beyond 'low' for all but the first child */
+        if (j > first) {
+            iEntry = (btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[-j]]);
+            kval = (KeyValue*)&(iEntry->klen);
+
+            if (high == NULL || edubtm_KeyCompare(kdesc, kval, high) == LESS) {
+                if (picks != NULL && nCopied < nPicks && picks[nCopied] == count)
+                    keys[nCopied++] = *kval;
+                count++;
+            }
+        }
+
+        /* Only the first child is read to know the level below, unless the children are visited */
+        if (!deep && j > first) continue;
+
+        MAKE_PAGEID(child, root->volNo, (j == -1) ? rpage->bi.hdr.p0 :
+                    ((btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[-j]]))->spid);
+
+        if ((e = edubtm_FixPage(&child, &cpage, BTM_LATCH_S)) < 0) {
+            (Four) edubtm_UnfixPage(root, FALSE);
+            ERR(e);
+        }
+
+        if (!(cpage->any.hdr.type & INTERNAL)) {
+            /* All the children are on the same level */
+            if ((e = edubtm_UnfixPage(&child, FALSE)) < 0) {
+                (Four) edubtm_UnfixPage(root, FALSE);
+                ERR(e);
+            }
+            deep = FALSE;
+            continue;
+        }
+        *hasChildren = TRUE;
+
+        for (k = 0; deep && k < cpage->bi.hdr.nSlots; k++) {
+            iEntry = (btm_InternalEntry*)&(cpage->bi.data[cpage->bi.slot[-k]]);
+            kval = (KeyValue*)&(iEntry->klen);
+
+            if (low != NULL && edubtm_KeyCompare(kdesc, kval, low) != GREATER) continue;
+            if (high != NULL && edubtm_KeyCompare(kdesc, kval, high) != LESS) break;
+
+            if (picks != NULL && nCopied < nPicks && picks[nCopied] == count)
+                keys[nCopied++] = *kval;
+            count++;
+        }
+
+        if ((e = edubtm_UnfixPage(&child, FALSE)) < 0) {
+            (Four) edubtm_UnfixPage(root, FALSE);
+            ERR(e);
+        }
+    }
+
+    if ((e = edubtm_UnfixPage(root, FALSE)) < 0) ERR(e);
+
+    *nKeys = (picks != NULL) ? nCopied : count;
+
+    return(eNOERROR);
+
+} /* edubtm_CollectSplitKeys() */
+
+
+
+/*@================================
+ * edubtm_ScanWorker()
+ *================================*/
+/*
+ * Function: void *edubtm_ScanWorker(void*)
+ *
+ * Description :
+ *  Body of the thread scanning a sub-range. The sub-range is read as by
+ *  EduBtM_Fetch(...) and EduBtM_FetchNext(...), and the cursors are gathered
+ *  into batches on the stack of the thread. No page is fixed while the
+ *  batches are delivered or while the thread waits for its turn.
+ *
+ * Returns:
+ *  NULL; the error is kept in the scan
+ */
+void *edubtm_ScanWorker(
+    void                        *arg)           /* IN the sub-range, btm_ScanPart* */
+{
+    Four                        e;              /* error number */
+    Four                        n;              /* # of cursors in the batch being filled */
+    Four                        nHeld;          /* # of full batches not delivered yet */
+    Four                        nCursors[BTM_SCANHELDBATCHES];  /* # of cursors of each batch */
+    btm_ScanPart                *part;          /* the sub-range */
+    btm_ParallelScan            *scan;          /* the scan */
+    BtreeCursor                 cursor;         /* cursor of the sub-range */
+    BtreeCursor                 next;           /* the next cursor */
+    BtreeCursor                 batches[BTM_SCANHELDBATCHES][BTM_SCANBATCHSIZE];    /* the batches */
+
+
+    part = (btm_ScanPart*)arg;
+    scan = part->scan;
+    n = nHeld = 0;
+
+    /* Find the first object of the sub-range */
+    if (part->lowCompOp == SM_BOF)
+        e = edubtm_FirstObject(&scan->root, scan->kdesc, &part->high, part->highCompOp, &cursor);
+    else
+        e = edubtm_Fetch(&scan->root, scan->kdesc, &part->low, part->lowCompOp, &part->high, part->highCompOp, &cursor);
+
+    while (e >= 0 && cursor.flag == CURSOR_ON) {
+        batches[nHeld][n++] = cursor;
+
+        if (n == BTM_SCANBATCHSIZE) {
+            nCursors[nHeld++] = n;
+            n = 0;
+
+            /* Stops if the scan has stopped */
+            if (edubtm_DeliverBatches(part, batches, nCursors, &nHeld, FALSE) != eNOERROR) break;
+        }
+
+        e = edubtm_FetchNext(&scan->root, scan->kdesc, &part->high, part->highCompOp, &cursor, &next);
+        cursor = next;
+    }
+
+    if (e < 0) edubtm_StopScan(scan, e);
+
+    if (n > 0) nCursors[nHeld++] = n;
+
+    /* Deliver the rest and pass the turn on */
+    (Four) edubtm_DeliverBatches(part, batches, nCursors, &nHeld, TRUE);
+
+    return(NULL);
+
+} /* edubtm_ScanWorker() */
+
+
+
+/*@================================
+ * edubtm_DeliverBatches()
+ *================================*/
+/*
+ * Function: Four edubtm_DeliverBatches(btm_ScanPart*, BtreeCursor (*)[BTM_SCANBATCHSIZE],
+ *                                   Four*, Four*, Boolean)
+ *
+ * Description :
+ *  Hand the batches held by a sub-range to the callback. In an ordered scan
+ *  they are delivered only when the turn of the sub-range has come; before
+ *  that, they are kept while there is room for another batch, and then the
+ *  thread waits. With 'last' TRUE, the thread waits for its turn in any case
+ *  and passes the turn on to the next sub-range after the delivery.
+ *
+ * Returns:
+ *  eNOERROR if the scan goes on, the error of the scan otherwise
+ *
+ * Side effects:
+ *  nHeld : 0 if the batches have been delivered or dropped
+ */
+Four edubtm_DeliverBatches(
+    btm_ScanPart                *part,          /* IN the sub-range */
+    BtreeCursor                 (*batches)[BTM_SCANBATCHSIZE],  /* IN the batches */
+    Four                        *nCursors,      /* IN # of cursors of each batch */
+    Four                        *nHeld,         /* INOUT # of batches held */
+    Boolean                     last)           /* IN TRUE if the sub-range has been read up */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of a batch */
+    btm_ParallelScan            *scan;          /* the scan */
+
+
+    scan = part->scan;
+
+    pthread_mutex_lock(&scan->mutex);
+
+    for (;;) {
+        if (scan->stop) {
+            *nHeld = 0;
+            break;
+        }
+
+        if (!scan->ordered || scan->turn == part->partNo) {
+            for (i = 0; i < *nHeld; i++)
+                if ((e = (*scan->callback)(scan->arg, part->partNo, nCursors[i], batches[i])) < 0) {
+                    if (scan->error == eNOERROR) scan->error = e;
+                    scan->stop = TRUE;
+                    pthread_cond_broadcast(&scan->turnChanged);
+                    break;
+                }
+            *nHeld = 0;
+            break;
+        }
+
+        if (!last && *nHeld < BTM_SCANHELDBATCHES) break;
+
+        pthread_cond_wait(&scan->turnChanged, &scan->mutex);
+    }
+
+    if (last && scan->ordered && scan->turn == part->partNo) {
+        scan->turn++;
+        pthread_cond_broadcast(&scan->turnChanged);
+    }
+
+    e = (scan->stop) ? scan->error : eNOERROR;
+
+    pthread_mutex_unlock(&scan->mutex);
+
+    return(e);
+
+} /* edubtm_DeliverBatches() */
+
+
+
+/*@================================
+ * edubtm_StopScan()
+ *================================*/
+/*
+ * Function: void edubtm_StopScan(btm_ParallelScan*, Four)
+ *
+ * Description :
+ *  Stop the scan because of the error 'e', waking up the threads waiting for
+ *  their turns. Only the first error is kept.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_StopScan(
+    btm_ParallelScan            *scan,          /* INOUT the scan */
+    Four                        e)              /* IN the error */
+{
+    pthread_mutex_lock(&scan->mutex);
+
+    if (scan->error == eNOERROR) scan->error = e;
+    scan->stop = TRUE;
+    pthread_cond_broadcast(&scan->turnChanged);
+
+    pthread_mutex_unlock(&scan->mutex);
+
+} /* edubtm_StopScan() */
@@ -0,0 +1,591 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_Reorganize.c
+ *
+ * Description :
+ *  Defragment the leaf page list of a B+ tree while the tree stays in use.
+ *
+ *  After many splits and deletes the leaves are sparse and lie scattered
+ *  over the extents of the file, so a range scan reads few entries per page
+ *  and moves the disk head on every page. The reorganization visits the
+ *  leaf parents one by one in the key order. Under each of them, adjacent
+ *  leaves which are less than half full are merged when the result fits in
+ *  one page, and then the leaves are copied into a run of freshly allocated
+ *  pages in ascending page order, placed after the run of the previous leaf
+ *  parent. The pointers in the leaf parent and the links of the leaf page
+ *  list are fixed up, and the old pages are given to the free page list.
+ *
+ *  Each leaf parent is done in a batch of its own, which holds the tree
+ *  latch only for that batch; the other operations run between batches.
+ *
+ * Exports:
+ *  Four EduBtM_Reorganize(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "RDsM.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_ReorganizeBatch(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Boolean*, PageID*, Pool*, DeallocListElem*);
+Four edubtm_MergeSparseLeaves(PhysicalFileID*, BtreeInternal*, Two, Boolean*, Pool*, DeallocListElem*);
+Four edubtm_RelocateLeaves(ObjectID*, BtreeInternal*, PageID*, Pool*, DeallocListElem*);
+Four edubtm_CopyLeaves(PhysicalFileID*, BtreeInternal*, PageID*, PageID*, Two, Pool*, DeallocListElem*);
+
+
+
+/*@================================
+ * EduBtM_Reorganize()
+ *================================*/
+/*
+ * Function: Four EduBtM_Reorganize(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Merge the sparse leaves of the B+ tree and lay the leaves out on the disk
+ *  in the key order. The leaf parents are processed from left to right, one
+ *  in a batch; between the batches the tree latch is released, and the next
+ *  batch finds its leaf parent again from the root by the key bounding the
+ *  previous one, since the tree may have changed in the meantime.
+ *
+ *  An open cursor on a moved leaf still works; EduBtM_FetchNext(...) sees
+ *  that the leaf has been freed and finds its entry again from the root.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_Reorganize(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the B+ tree */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    int                         i;
+    Four                        e;              /* error number */
+    Boolean                     started;        /* TRUE after the first batch */
+    Boolean                     done;           /* TRUE if the last leaf parent has been done */
+    KeyValue                    startKey;       /* key bounding the done leaf parents */
+    KeyValue                    highKey;        /* key bounding the leaf parent of a batch */
+    PageID                      nearPid;        /* last page of the relocated leaves */
+    DeallocListElem             *dlMark;        /* first element of the dealloc list before a batch */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* The first run of leaves is placed near the root */
+    nearPid = *root;
+    started = FALSE;
+
+    do {
+        if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+        /* The pages cannot be moved under a build which logs the changes */
+        if (edubtm_InOnlineBuild(root)) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(eNOTSUPPORTED_EDUBTM);
+        }
+
+        edubtm_EnterBfM();
+        dlMark = dlHead->next;
+
+        if ((e = edubtm_ReorganizeBatch(catObjForFile, root, kdesc, (started) ? &startKey : NULL,
+                                        &highKey, &done, &nearPid, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        /* The merged and the moved out pages are kept for the splits of the file */
+        if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+
+        startKey = highKey;
+        started = TRUE;
+    } while (!done);
+
+    return(eNOERROR);
+
+}   /* EduBtM_Reorganize() */
+
+
+
+/*@================================
+ * edubtm_ReorganizeBatch()
+ *================================*/
+/*
+ * Function: Four edubtm_ReorganizeBatch(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*,
+ *                                       Boolean*, PageID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Reorganize the leaves under one leaf parent. The leaf parent is the one
+ *  whose key range covers 'startKey', or the leftmost one if 'startKey' is
+ *  NULL. On the way down, the smallest key of the tree bounding the range
+ *  of the leaf parent from above is kept in 'highKey'; the next batch starts
+ *  from there. 'done' is set if there is no such key.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  'nearPid' is set to the last page of the relocated leaves.
+ */
+Four edubtm_ReorganizeBatch(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the B+ tree */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *startKey,      /* IN key in the range of the leaf parent, NULL for the leftmost */
+    KeyValue                    *highKey,       /* OUT key bounding the leaf parent from above */
+    Boolean                     *done,          /* OUT TRUE if the leaf parent is the rightmost one */
+    PageID                      *nearPid,       /* INOUT last page of the relocated leaves */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* slot of the child on the path */
+    Two                         i;              /* child No. */
+    Boolean                     merged;         /* TRUE if two leaves have been merged */
+    Boolean                     isLeaf;         /* TRUE if the children are leaves */
+    PageID                      pid;            /* page on the path */
+    PageID                      child;          /* child of 'pid' on the path */
+    BtreePage                   *apage;         /* pointer to the buffer holding 'pid' */
+    BtreePage                   *cpage;         /* pointer to the buffer holding 'child' */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+    PhysicalFileID              pFid;           /* FileID of the B+ tree file */
+    Two                         eff;            /* extent fill factor of the file (not used) */
+
+
+    *done = TRUE;
+
+    if ((e = edubtm_GetIndexFile(catObjForFile, &pFid, &eff)) < 0) ERR(e);
+
+    /* Go down to the leaf parent, narrowing the upper bound on the way */
+    pid = *root;
+    if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    /* A tree of one leaf has nothing to reorganize */
+    if (apage->any.hdr.type & LEAF) {
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    for (;;) {
+        if (startKey == NULL) idx = -1;
+        else (void) edubtm_BinarySearchInternal(&apage->bi, kdesc, startKey, &idx);
+
+        if (idx + 1 < apage->bi.hdr.nSlots) {
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(idx+1)]]);
+            highKey->len = iEntry->klen;
+            memcpy(highKey->val, iEntry->kval, iEntry->klen);
+            *done = FALSE;
+        }
+
+        if (idx == -1) MAKE_PAGEID(child, pid.volNo, apage->bi.hdr.p0);
+        else MAKE_PAGEID(child, pid.volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]))->spid);
+
+        if ((e = BfM_GetTrain((TrainID*)&child, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+        isLeaf = (cpage->any.hdr.type & LEAF) ? TRUE : FALSE;
+        if ((e = BfM_FreeTrain((TrainID*)&child, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+
+        if (isLeaf) break;
+
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+        pid = child;
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    /* Merge the sparse neighbors; a merged leaf may take its next neighbor too */
+    for (i = -1; i < apage->bi.hdr.nSlots; ) {
+        if ((e = edubtm_MergeSparseLeaves(&pFid, &apage->bi, i, &merged, dlPool, dlHead)) < 0)
+            ERRB1(e, &pid, PAGE_BUF);
+
+        if (!merged) i++;
+    }
+
+    /* Lay the leaves out in the key order */
+    if ((e = edubtm_RelocateLeaves(catObjForFile, &apage->bi, nearPid, dlPool, dlHead)) < 0)
+        ERRB1(e, &pid, PAGE_BUF);
+
+    if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ReorganizeBatch() */
+
+
+
+/*@================================
+ * edubtm_MergeSparseLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_MergeSparseLeaves(PhysicalFileID*, BtreeInternal*, Two, Boolean*,
+ *                                         Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Merge the child 'i'+1 of the leaf parent into the child 'i' if one of
+ *  them is less than half full and both of them fit in one page filled up
+ *  to BTM_REORG_FILL percent. The entries are rebuilt in key order without
+ *  holes, the right leaf is unlinked and put into the dealloc list, and its
+ *  entry is removed from the leaf parent.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for the leaf parent.
+ */
+Four edubtm_MergeSparseLeaves(
+    PhysicalFileID              *pFid,          /* IN FileID of the B+ tree file */
+    BtreeInternal               *ppage,         /* INOUT the leaf parent */
+    Two                         i,              /* IN the left child, -1 for 'p0' */
+    Boolean                     *merged,        /* OUT TRUE if the two leaves have been merged */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         j;              /* slot No. */
+    Two                         nSlots;         /* # of entries of the merged leaf */
+    Two                         offset;         /* end of the entries of the merged leaf */
+    Two                         entryLen;       /* length of a leaf entry */
+    Four                        lUsed;          /* used bytes of the left leaf */
+    Four                        rUsed;          /* used bytes of the right leaf */
+    PageID                      leftPid;        /* the left leaf */
+    PageID                      rightPid;       /* the right leaf */
+    PageID                      nextPid;        /* the leaf after the right leaf */
+    BtreeLeaf                   *lpage;         /* pointer to the buffer holding the left leaf */
+    BtreeLeaf                   *rpage;         /* pointer to the buffer holding the right leaf */
+    BtreeLeaf                   *npage;         /* pointer to the buffer holding 'nextPid' */
+    BtreeLeaf                   *spage;         /* the leaf whose entries are copied */
+    BtreeLeaf                   tpage;          /* the merged leaf being built */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+    DeallocListElem             *dlElem;        /* an element of the dealloc list */
+
+
+    *merged = FALSE;
+
+    if (i + 1 >= ppage->hdr.nSlots) return(eNOERROR);
+
+    if (i == -1) MAKE_PAGEID(leftPid, pFid->volNo, ppage->hdr.p0);
+    else MAKE_PAGEID(leftPid, pFid->volNo, ((btm_InternalEntry*)&(ppage->data[ppage->slot[-i]]))->spid);
+    MAKE_PAGEID(rightPid, pFid->volNo, ((btm_InternalEntry*)&(ppage->data[ppage->slot[-(i+1)]]))->spid);
+
+    if ((e = BfM_GetTrain((TrainID*)&leftPid, (char**)&lpage, PAGE_BUF)) < 0) ERR(e);
+    if ((e = BfM_GetTrain((TrainID*)&rightPid, (char**)&rpage, PAGE_BUF)) < 0) ERRB1(e, &leftPid, PAGE_BUF);
+
+    lUsed = (PAGESIZE - BL_FIXED) - BL_FREE(lpage);
+    rUsed = (PAGESIZE - BL_FIXED) - BL_FREE(rpage);
+
+    if ((lUsed >= BL_HALF && rUsed >= BL_HALF) ||
+        lUsed + rUsed > (PAGESIZE - BL_FIXED) * BTM_REORG_FILL / 100) {
+        if ((e = BfM_FreeTrain((TrainID*)&rightPid, PAGE_BUF)) < 0) ERRB1(e, &leftPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&leftPid, PAGE_BUF)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    /* Copy the entries of both leaves into a page without holes */
+    nSlots = 0;
+    offset = 0;
+    for (spage = lpage; spage != NULL; spage = (spage == lpage) ? rpage : NULL) {
+        for (j = 0; j < spage->hdr.nSlots; j++) {
+            lEntry = (btm_LeafEntry*)&(spage->data[spage->slot[-j]]);
+            entryLen = BTM_LEAFENTRY_LEN(lEntry);
+
+            memcpy(&(tpage.data[offset]), (char*)lEntry, entryLen);
+            tpage.slot[-nSlots] = offset;
+            offset += entryLen;
+            nSlots++;
+        }
+    }
+
+    memcpy(lpage->data, tpage.data, offset);
+    for (j = 0; j < nSlots; j++) lpage->slot[-j] = tpage.slot[-j];
+    lpage->hdr.nSlots = nSlots;
+    lpage->hdr.free = offset;
+    lpage->hdr.unused = 0;
+
+    /* Take the right leaf out of the leaf page list */
+    lpage->hdr.nextPage = rpage->hdr.nextPage;
+    if (rpage->hdr.nextPage != NIL) {
+        MAKE_PAGEID(nextPid, pFid->volNo, rpage->hdr.nextPage);
+        if ((e = BfM_GetTrain((TrainID*)&nextPid, (char**)&npage, PAGE_BUF)) < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+        npage->hdr.prevPage = leftPid.pageNo;
+        if ((e = BfM_SetDirty((TrainID*)&nextPid, PAGE_BUF)) < 0) { (Four) BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF); ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF); }
+        if ((e = BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF)) < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+    }
+
+    /* The right leaf is freed; a cursor on it finds its entries from the root */
+    rpage->hdr.type = FREEPAGE;
+
+    if ((e = Util_getElementFromPool(dlPool, &dlElem)) < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+    dlElem->type = DL_PAGE;
+    dlElem->elem.pid = rightPid;
+    dlElem->next = dlHead->next;
+    dlHead->next = dlElem;
+
+    if ((e = BfM_SetDirty((TrainID*)&rightPid, PAGE_BUF)) < 0) ERRB2(e, &leftPid, PAGE_BUF, &rightPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&rightPid, PAGE_BUF)) < 0) ERRB1(e, &leftPid, PAGE_BUF);
+    if ((e = BfM_SetDirty((TrainID*)&leftPid, PAGE_BUF)) < 0) ERRB1(e, &leftPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&leftPid, PAGE_BUF)) < 0) ERR(e);
+
+    edubtm_DeleteInternalEntries(ppage, i + 1, i + 1);
+    *merged = TRUE;
+
+    return(eNOERROR);
+
+}   /* edubtm_MergeSparseLeaves() */
+
+
+
+/*@================================
+ * edubtm_RelocateLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_RelocateLeaves(ObjectID*, BtreeInternal*, PageID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Move the children of the leaf parent into new pages allocated together
+ *  near 'nearPid', in the order of the page numbers. Nothing is moved when
+ *  the children already lie in consecutive pages in the key order.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  'nearPid' is set to the last page of the children.
+ */
+Four edubtm_RelocateLeaves(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeInternal               *ppage,         /* INOUT the leaf parent */
+    PageID                      *nearPid,       /* INOUT page near which the leaves are placed */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* child No. */
+    Two                         j;              /* index of the sorted pages */
+    Two                         nChildren;      /* # of children of the leaf parent */
+    Boolean                     inOrder;        /* TRUE if the children lie in consecutive pages */
+    ShortPageID                 spid;           /* page of a child */
+    ShortPageID                 prevSpid;       /* page of the child before */
+    Four                        firstExtNo;     /* first extent of the file */
+    Two                         eff;            /* extent fill factor of the file */
+    PhysicalFileID              pFid;           /* FileID of the B+ tree file */
+    PageID                      tPid;           /* temporary page for sorting */
+    PageID                      *newPids;       /* the new pages of the children */
+
+
+    nChildren = ppage->hdr.nSlots + 1;
+
+    /* Leave the children in place if they are laid out already */
+    inOrder = TRUE;
+    prevSpid = ppage->hdr.p0;
+    for (i = 0; i < ppage->hdr.nSlots && inOrder; i++) {
+        spid = ((btm_InternalEntry*)&(ppage->data[ppage->slot[-i]]))->spid;
+        if (spid != prevSpid + 1) inOrder = FALSE;
+        prevSpid = spid;
+    }
+
+    if (inOrder) {
+        nearPid->pageNo = prevSpid;
+        return(eNOERROR);
+    }
+
+    if ((e = edubtm_GetIndexFile(catObjForFile, &pFid, &eff)) < 0) ERR(e);
+
+    if ((newPids = (PageID*)malloc(sizeof(PageID)*nChildren)) == NULL) ERR(eMEMORYALLOCERR_BTM);
+
+    /* Allocate the pages together from the extents of the index file */
+    if ((e = RDsM_PageIdToExtNo((PageID*)&pFid, &firstExtNo)) < 0 ||
+        (e = RDsM_AllocTrains(pFid.volNo, firstExtNo, nearPid, eff, nChildren, PAGESIZE2, newPids)) < 0) {
+        free(newPids);
+        ERR(e);
+    }
+
+    /* The leaves go into the pages in ascending order */
+    for (i = 1; i < nChildren; i++) {
+        tPid = newPids[i];
+        for (j = i; j > 0 && newPids[j-1].pageNo > tPid.pageNo; j--) newPids[j] = newPids[j-1];
+        newPids[j] = tPid;
+    }
+
+    e = edubtm_CopyLeaves(&pFid, ppage, newPids, nearPid, nChildren, dlPool, dlHead);
+
+    free(newPids);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_RelocateLeaves() */
+
+
+
+/*@================================
+ * edubtm_CopyLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_CopyLeaves(PhysicalFileID*, BtreeInternal*, PageID*, PageID*, Two,
+ *                                  Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Copy the children of the leaf parent into the given pages, child 'i'
+ *  into 'newPids[i]', and chain the copies to each other and to the leaves
+ *  outside the leaf parent. The pointers of the leaf parent are replaced
+ *  and the old pages are freed into the dealloc list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  'nearPid' is set to the last of the new pages.
+ */
+Four edubtm_CopyLeaves(
+    PhysicalFileID              *pFid,          /* IN FileID of the B+ tree file */
+    BtreeInternal               *ppage,         /* INOUT the leaf parent */
+    PageID                      *newPids,       /* IN new pages of the children, ascending */
+    PageID                      *nearPid,       /* OUT last of the new pages */
+    Two                         nChildren,      /* IN # of children of the leaf parent */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* child No. */
+    ShortPageID                 *spidPtr;       /* pointer to the child in the leaf parent */
+    ShortPageID                 outerPrev;      /* leaf before the children */
+    ShortPageID                 outerNext;      /* leaf after the children */
+    PageID                      oldPid;         /* old page of a child */
+    PageID                      tPid;           /* a leaf outside the leaf parent */
+    BtreeLeaf                   *opage;         /* pointer to the buffer holding the old page */
+    BtreeLeaf                   *npage;         /* pointer to the buffer holding the new page */
+    DeallocListElem             *dlElem;        /* an element of the dealloc list */
+
+
+    outerPrev = outerNext = NIL;
+
+    for (i = 0; i < nChildren; i++) {
+        if (i == 0) spidPtr = &(ppage->hdr.p0);
+        else spidPtr = &(((btm_InternalEntry*)&(ppage->data[ppage->slot[-(i-1)]]))->spid);
+        MAKE_PAGEID(oldPid, pFid->volNo, *spidPtr);
+
+        if ((e = BfM_GetTrain((TrainID*)&oldPid, (char**)&opage, PAGE_BUF)) < 0) ERR(e);
+        if ((e = BfM_GetNewTrain((TrainID*)&newPids[i], (char**)&npage, PAGE_BUF)) < 0) ERRB1(e, &oldPid, PAGE_BUF);
+
+        if (i == 0) outerPrev = opage->hdr.prevPage;
+        if (i == nChildren - 1) outerNext = opage->hdr.nextPage;
+
+        memcpy((char*)npage, (char*)opage, PAGESIZE);
+        npage->hdr.pid = newPids[i];
+        if (i > 0) npage->hdr.prevPage = newPids[i-1].pageNo;
+        if (i < nChildren - 1) npage->hdr.nextPage = newPids[i+1].pageNo;
+
+        /* The old page is freed; a cursor on it finds its entry from the root */
+        opage->hdr.type = FREEPAGE;
+
+        if ((e = Util_getElementFromPool(dlPool, &dlElem)) < 0) ERRB2(e, &oldPid, PAGE_BUF, &newPids[i], PAGE_BUF);
+        dlElem->type = DL_PAGE;
+        dlElem->elem.pid = oldPid;
+        dlElem->next = dlHead->next;
+        dlHead->next = dlElem;
+
+        *spidPtr = newPids[i].pageNo;
+
+        if ((e = BfM_SetDirty((TrainID*)&newPids[i], PAGE_BUF)) < 0) ERRB2(e, &oldPid, PAGE_BUF, &newPids[i], PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&newPids[i], PAGE_BUF)) < 0) ERRB1(e, &oldPid, PAGE_BUF);
+        if ((e = BfM_SetDirty((TrainID*)&oldPid, PAGE_BUF)) < 0) ERRB1(e, &oldPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&oldPid, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    /* Link the leaves around the children to the new pages */
+    if (outerPrev != NIL) {
+        MAKE_PAGEID(tPid, pFid->volNo, outerPrev);
+        if ((e = BfM_GetTrain((TrainID*)&tPid, (char**)&opage, PAGE_BUF)) < 0) ERR(e);
+        opage->hdr.nextPage = newPids[0].pageNo;
+        if ((e = BfM_SetDirty((TrainID*)&tPid, PAGE_BUF)) < 0) ERRB1(e, &tPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&tPid, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    if (outerNext != NIL) {
+        MAKE_PAGEID(tPid, pFid->volNo, outerNext);
+        if ((e = BfM_GetTrain((TrainID*)&tPid, (char**)&opage, PAGE_BUF)) < 0) ERR(e);
+        opage->hdr.prevPage = newPids[nChildren-1].pageNo;
+        if ((e = BfM_SetDirty((TrainID*)&tPid, PAGE_BUF)) < 0) ERRB1(e, &tPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&tPid, PAGE_BUF)) < 0) ERR(e);
+    }
+
+    *nearPid = newPids[nChildren-1];
+
+    return(eNOERROR);
+
+}   /* edubtm_CopyLeaves() */
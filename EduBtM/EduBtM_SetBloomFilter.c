@@ -0,0 +1,138 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_SetBloomFilter.c
+ *
+ * Description :
+ *  Turn on or off the Bloom filter of a B+tree index.
+ *
+ * Exports:
+ *  Four EduBtM_SetBloomFilter(ObjectID*, PageID*, KeyDesc*, Boolean)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_SetBloomFilter()
+ *================================*/
+/*
+ * Function: Four EduBtM_SetBloomFilter(ObjectID*, PageID*, KeyDesc*, Boolean)
+ *
+ * Description :
+ *  Turn on or off the Bloom filter of the given index.
+ *
+ *  While it is on, EduBtM_Fetch() with SM_EQ probes the filter first and
+ *  returns CURSOR_EOS at once if the key value is surely absent, without
+ *  reading any page of the tree. It suits indexes probed mostly for key
+ *  values which do not exist, e.g. for existence checks. The inserts add
+ *  their key values to the filter; after many deletes the filter is built
+ *  again by a lookup. Turning it on for an index which has one builds the
+ *  filter again from the leaves.
+ *
+ *  Turning it off keeps the pages of the filter for a later build.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_SetBloomFilter(
+    ObjectID *catObjForFile,	/* IN catalog object of B+ tree file */
+    PageID   *root,		/* IN the root of Btree */
+    KeyDesc  *kdesc,		/* IN key descriptor */
+    Boolean  on)		/* IN TRUE to keep a Bloom filter of the key values */
+{
+    int i;
+    Four e;			/* error number */
+
+
+    /*@ check parameters */
+
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* The filter is built while nobody else uses the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    /* The inserts into the side log of a build do not reach the filter */
+    if (edubtm_InOnlineBuild(root)) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    edubtm_EnterBfM();
+
+    if (on) {
+        if ((e = edubtm_BuildBloomFilter(catObjForFile, root, kdesc)) < 0) ERRTL(e, root);
+    }
+    else {
+        if ((e = edubtm_DropBloomFilter(root, NULL, NULL)) < 0) ERRTL(e, root);
+    }
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_SetBloomFilter() */
@@ -0,0 +1,137 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_SetBufferMode.c
+ *
+ * Description :
+ *  Turn on or off the buffering of the updates of a B+tree index.
+ *
+ * Exports:
+ *  Four EduBtM_SetBufferMode(PageID*, KeyDesc*, Boolean)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_SetBufferMode()
+ *================================*/
+/*
+ * Function: Four EduBtM_SetBufferMode(PageID*, KeyDesc*, Boolean)
+ *
+ * Description :
+ *  Turn on or off the buffering of the updates of the given index.
+ *
+ *  In the buffered mode, EduBtM_InsertObject() and EduBtM_DeleteObject()
+ *  put the update as a message into the message buffer of the root, and the
+ *  messages are moved down to the leaves in batches when the buffers are
+ *  full or when the key range is read. It suits write-heavy indexes. The
+ *  updates fail as in the direct mode: the pending messages and the leaf of
+ *  the key value are searched before the message is put.
+ *
+ *  Turning off the mode pushes all the pending messages down to the leaves.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_SetBufferMode(
+    PageID   *root,		/* IN the root of Btree */
+    KeyDesc  *kdesc,		/* IN key descriptor */
+    Boolean  on)		/* IN TRUE to buffer the updates, FALSE to apply them directly */
+{
+    int i;
+    Four e;			/* error number */
+    BtreePage *rpage;		/* pointer to the buffer holding the root page */
+
+
+    /*@ check parameters */
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* The mode of the index changes only while nobody else uses the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    /* Apply the pending updates before the updates go to the leaves directly */
+    if (!on) {
+        if ((e = edubtm_FlushPendingMessages(root, kdesc, NULL, NULL, NULL, NULL)) < 0) ERRTL(e, root);
+    }
+    /* The changes kept in the change buffer are older than the messages to come */
+    else {
+        if ((e = edubtm_MergeChanges(root, kdesc, NULL, NULL, 0)) < 0) ERRTL(e, root);
+    }
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    if (on) rpage->any.hdr.flags |= BTM_BUFFEREDINDEX;
+    else rpage->any.hdr.flags &= ~BTM_BUFFEREDINDEX;
+
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) { (Four) BfM_FreeTrain((TrainID*)root, PAGE_BUF); ERRTL(e, root); }
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERRTL(e, root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_SetBufferMode() */
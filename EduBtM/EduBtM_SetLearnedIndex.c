@@ -0,0 +1,121 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_SetLearnedIndex.c
+ *
+ * Description :
+ *  Build or drop the learned model of the leaf level of an index.
+ *
+ * Exports:
+ *  Four EduBtM_SetLearnedIndex(PageID*, KeyDesc*, Boolean)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_SetLearnedIndex()
+ *================================*/
+/*
+ * Function: Four EduBtM_SetLearnedIndex(PageID*, KeyDesc*, Boolean)
+ *
+ * Description :
+ *  Build the model of the leaf level of the given index, or drop it.
+ *
+ *  With the model, EduBtM_Fetch() goes from the key value to its leaf
+ *  without reading the internal pages. It suits large read-mostly indexes
+ *  on a single SM_INT part whose key values are spread evenly, e.g. serial
+ *  IDs; the model then takes a few segments. The model is not updated by
+ *  the inserts: the lookups of the key values moved by the splits descend
+ *  the tree, and when they become frequent the model is given up until it
+ *  is built again by calling this function once more. Deleting pages of
+ *  the index drops the model.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_SetLearnedIndex(
+    PageID   *root,		/* IN the root of Btree */
+    KeyDesc  *kdesc,		/* IN key descriptor */
+    Boolean  on)		/* IN TRUE to build the model, FALSE to drop it */
+{
+    Four e;			/* error number */
+
+
+    /*@ check parameters */
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Only a single SM_INT part is modeled */
+    if (kdesc->nparts != 1 || kdesc->kpart[0].type != SM_INT) ERR(eNOTSUPPORTED_EDUBTM);
+
+    /* The leaves are read while nobody else changes the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    if (on) {
+        if ((e = edubtm_BuildLearnedIndex(root, kdesc)) < 0) ERRTL(e, root);
+    }
+    else
+        edubtm_DropLearnedIndex(root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_SetLearnedIndex() */
@@ -0,0 +1,116 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_SetResultCache.c
+ *
+ * Description :
+ *  Create or drop the cache of the SM_EQ lookup results of an index.
+ *
+ * Exports:
+ *  Four EduBtM_SetResultCache(PageID*, Boolean)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * EduBtM_SetResultCache()
+ *================================*/
+/*
+ * Function: Four EduBtM_SetResultCache(PageID*, Boolean)
+ *
+ * Description :
+ *  Give the given index a cache of the results of its SM_EQ lookups, or
+ *  drop the cache.
+ *
+ *  With the cache, EduBtM_Fetch() remembers the leaf, the slot and the
+ *  ObjectID found for a key value, together with the version of the leaf.
+ *  A repeated lookup of the key value checks the version and the slot
+ *  instead of searching the tree, so that it pins a single page. It suits
+ *  the indexes whose lookups go to a small set of hot key values. The
+ *  cache takes BTM_RESULTCACHESETS*BTM_RESULTCACHEWAYS entries, and the
+ *  key values longer than BTM_RESULTCACHEKEYLEN bytes are not cached. The
+ *  cache lives in memory only; it is dropped when pages of the index are
+ *  freed, and has to be set again after a restart.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_SetResultCache(
+    PageID   *root,		/* IN the root of Btree */
+    Boolean  on)		/* IN TRUE to create the cache, FALSE to drop it */
+{
+    Four e;			/* error number */
+
+
+    /*@ check parameters */
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Wait for the current lookups of the index */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    if (on) {
+        if ((e = edubtm_CreateResultCache(root)) < 0) ERRTL(e, root);
+    }
+    else
+        edubtm_DropResultCache(root);
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_SetResultCache() */
@@ -0,0 +1,453 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_SkipScan.c
+ *
+ * Description :
+ *  Scan an index on a composite key with a condition on the parts after
+ *  the first one only, e.g. an index on (tenant_id, created_at) searched
+ *  by created_at. Instead of reading every leaf, the scan visits each
+ *  distinct value of the first part and reads the range of the condition
+ *  under it; from the end of a range it goes on to the next distinct value
+ *  of the first part by a search, not by reading the entries in between.
+ *  It pays off when the first part has few distinct values.
+ *
+ * Exports:
+ *  Four EduBtM_SkipScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, btm_ScanCallback, void*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Two edubtm_LeadingPartLength(KeyDesc*, KeyValue*);
+Four edubtm_MakeSkipKey(KeyDesc*, char*, Two, KeyValue*, KeyValue*);
+Boolean edubtm_NextLeadingValue(KeyDesc*, char*, Two*);
+Four edubtm_SkipEmptyLeaves(PageID*, BtreePage**, Two*, Boolean*);
+
+
+
+/*@================================
+ * EduBtM_SkipScan()
+ *================================*/
+/*
+ * Function: Four EduBtM_SkipScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four,
+ *                                btm_ScanCallback, void*)
+ *
+ * Description :
+ *  Read forward the objects whose key values satisfy the given conditions
+ *  on the parts after the first one, whatever the first part is, and hand
+ *  them to 'callback' in batches of cursors. 'startKval' and 'stopKval'
+ *  hold the values of the parts 2 .. nparts laid out as in a key value;
+ *  the start condition is SM_BOF, SM_EQ, SM_GE, or SM_GT and the stop
+ *  condition SM_EOF, SM_EQ, SM_LT, or SM_LE. The second argument of the
+ *  callback numbers the distinct values of the first part in key order;
+ *  the batches come in the key order.
+ *
+ *  For each distinct value P of the first part, the range from P with the
+ *  start key value to P with the stop key value is read as a range of
+ *  EduBtM_FetchMulti(...). The next distinct value is the key value where
+ *  the range ends, if its first part is greater than P; otherwise the tree
+ *  is searched for the first key value greater than P in its first part,
+ *  which starts from the leaf at hand when it is close enough. The key
+ *  values longer than MAXKEYLEN which the search would need are not
+ *  supported.
+ *
+ *  The index is latched as by EduBtM_Fetch(...) for the whole scan, and
+ *  the leaf at hand stays latched in the shared mode while the callback is
+ *  called; the callback should not update the index.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eBADCOMPOP_BTM
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls or by the callback
+ */
+Four EduBtM_SkipScan(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *startKval,     /* IN parts 2 .. nparts of the start condition */
+    Four                        startCompOp,    /* IN comparison operator of start condition */
+    KeyValue                    *stopKval,      /* IN parts 2 .. nparts of the stop condition */
+    Four                        stopCompOp,     /* IN comparison operator of stop condition */
+    btm_ScanCallback            callback,       /* IN function receiving the batches */
+    void                        *arg)           /* IN argument of the callback */
+{
+    int                         i;
+    Four                        e;              /* error number */
+    Four                        mode;           /* mode of the tree latch */
+    Four                        valueNo;        /* # of the current value of the first part */
+    Two                         slotNo;         /* current slot in the leaf */
+    Two                         plen;           /* length of the first part of the current value */
+    Two                         nlen;           /* length of the first part after it */
+    Boolean                     held;           /* TRUE if a leaf is fixed and latched */
+    Boolean                     eos;            /* TRUE if there is no more leaf */
+    Boolean                     more;           /* TRUE if a greater first part can exist */
+    PageID                      leaf;           /* the leaf at hand */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+    btm_LeafEntry               *lEntry;        /* the current leaf entry */
+    btm_FetchRange              range;          /* range of the current value of the first part */
+    btm_FetchRange              skip;           /* range starting after the current value */
+    char                        prefix[MAXKEYLEN]; /* first part of the current value */
+    char                        next[MAXKEYLEN]; /* the least first part greater than 'prefix' */
+
+
+    if (root == NULL || kdesc == NULL || callback == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* Nothing to skip over with a single part */
+    if (kdesc->nparts < 2) ERR(eNOTSUPPORTED_EDUBTM);
+
+    if (startCompOp != SM_BOF && startCompOp != SM_EQ && startCompOp != SM_GE && startCompOp != SM_GT) ERR(eBADCOMPOP_BTM);
+    if (stopCompOp != SM_EOF && stopCompOp != SM_EQ && stopCompOp != SM_LT && stopCompOp != SM_LE) ERR(eBADCOMPOP_BTM);
+
+    if ((startCompOp != SM_BOF && startKval == NULL) || (stopCompOp != SM_EOF && stopKval == NULL)) ERR(eBADPARAMETER_BTM);
+
+    /* Only an index buffering the updates or the changes has pending ones; it is latched exclusively */
+    if ((e = edubtm_LatchIndex(root, &mode)) < 0) ERR(e);
+
+    /* The condition may hold under any first part; all the pending messages go down */
+    if (mode == BTM_LATCH_X) {
+        edubtm_EnterBfM();
+        if ((e = edubtm_FlushPendingMessages(root, kdesc, NULL, NULL, NULL, NULL)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+    }
+
+    /* The first key value of the index has the least first part */
+    held = FALSE;
+    skip.startCompOp = SM_BOF;
+    if ((e = edubtm_StartRange(root, kdesc, &skip, FALSE, &held, &leaf, &apage, &slotNo)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    for (valueNo = 0; ; valueNo++) {
+
+        if ((e = edubtm_SkipEmptyLeaves(&leaf, &apage, &slotNo, &eos)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+        if (eos) break;
+
+        /* The entry at hand has the next first part */
+        lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-slotNo]]);
+        plen = edubtm_LeadingPartLength(kdesc, (KeyValue*)&(lEntry->klen));
+        memcpy(prefix, lEntry->kval, plen);
+
+        nlen = plen;
+        memcpy(next, prefix, plen);
+        more = edubtm_NextLeadingValue(kdesc, next, &nlen);
+
+        /* The range of the condition under the first part */
+        e = eNOERROR;
+        if (startCompOp == SM_BOF) {
+            range.startCompOp = SM_GE;
+            e = edubtm_MakeSkipKey(kdesc, prefix, plen, NULL, &range.start);
+        }
+        else {
+            range.startCompOp = startCompOp;
+            e = edubtm_MakeSkipKey(kdesc, prefix, plen, startKval, &range.start);
+        }
+
+        if (e >= 0) {
+            if (stopCompOp != SM_EOF) {
+                range.stopCompOp = stopCompOp;
+                e = edubtm_MakeSkipKey(kdesc, prefix, plen, stopKval, &range.stop);
+            }
+            else if (more) {
+                range.stopCompOp = SM_LT;
+                e = edubtm_MakeSkipKey(kdesc, next, nlen, NULL, &range.stop);
+            }
+            else
+                range.stopCompOp = SM_EOF;
+        }
+
+        if (e >= 0) {
+            skip.startCompOp = SM_GE;
+            if (more) e = edubtm_MakeSkipKey(kdesc, next, nlen, NULL, &skip.start);
+        }
+
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&leaf, FALSE);
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+
+        /* No entry left of the one at hand has this first part */
+        if ((e = edubtm_StartRange(root, kdesc, &range, TRUE, &held, &leaf, &apage, &slotNo)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+
+        if ((e = edubtm_ReadRange(kdesc, &range, valueNo, &leaf, &apage, &slotNo, &eos, callback, arg)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+        if (eos || !more) break;
+
+        /* The range may end under the same first part; skip the rest of it */
+        lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-slotNo]]);
+        if (edubtm_KeyCompare(kdesc, (KeyValue*)&(lEntry->klen), &skip.start) == LESS) {
+            if ((e = edubtm_StartRange(root, kdesc, &skip, TRUE, &held, &leaf, &apage, &slotNo)) < 0) {
+                (Four) edubtm_UnlatchTree(root);
+                ERR(e);
+            }
+        }
+    }
+
+    if (held) {
+        if ((e = edubtm_UnfixPage(&leaf, FALSE)) < 0) {
+            (Four) edubtm_UnlatchTree(root);
+            ERR(e);
+        }
+    }
+
+    (Four) edubtm_UnlatchTree(root);
+
+    return(eNOERROR);
+
+}   /* EduBtM_SkipScan() */
+
+
+
+/*@================================
+ * edubtm_LeadingPartLength()
+ *================================*/
+/*
+ * Function: Two edubtm_LeadingPartLength(KeyDesc*, KeyValue*)
+ *
+ * Description:
+ *  Get the # of bytes the first part takes in the key value.
+ *
+ * Returns:
+ *  the length of the first part
+ */
+Two edubtm_LeadingPartLength(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *kval)          /* IN a key value */
+{
+    Two                         len;            /* length of a string part */
+
+
+    if (kdesc->kpart[0].type == SM_INT) return(sizeof(Four_Invariable));
+
+    memcpy(&len, kval->val, sizeof(Two));
+    return(sizeof(Two) + len);
+
+}   /* edubtm_LeadingPartLength() */
+
+
+
+/*@================================
+ * edubtm_MakeSkipKey()
+ *================================*/
+/*
+ * Function: Four edubtm_MakeSkipKey(KeyDesc*, char*, Two, KeyValue*, KeyValue*)
+ *
+ * Description:
+ *  Make a key value of the given first part followed by the given other
+ *  parts, or by the least values of the other parts if 'rest' is NULL: the
+ *  least SM_INT and the empty string.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBTM
+ *
+ * Side effects:
+ *  kval : the key value made
+ */
+Four edubtm_MakeSkipKey(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    char                        *prefix,        /* IN first part */
+    Two                         plen,           /* IN length of the first part */
+    KeyValue                    *rest,          /* IN parts 2 .. nparts, NULL for the least ones */
+    KeyValue                    *kval)          /* OUT the key value */
+{
+    Two                         i;              /* index of the parts */
+    Two                         len;            /* length of the key value */
+    Two                         zero;           /* length of the empty string */
+    Four_Invariable             least;          /* the least SM_INT */
+
+
+    len = plen;
+    if (rest != NULL) len += rest->len;
+    else
+        for (i = 1; i < kdesc->nparts; i++)
+            len += (kdesc->kpart[i].type == SM_INT) ? sizeof(Four_Invariable) : sizeof(Two);
+
+    if (len > MAXKEYLEN) ERR(eNOTSUPPORTED_EDUBTM);
+
+    memcpy(kval->val, prefix, plen);
+    kval->len = plen;
+
+    if (rest != NULL) {
+        memcpy(&(kval->val[kval->len]), rest->val, rest->len);
+        kval->len += rest->len;
+        return(eNOERROR);
+    }
+
+    zero = 0;
+    least = (Four_Invariable)(-2147483647 - 1);
+    for (i = 1; i < kdesc->nparts; i++) {
+        if (kdesc->kpart[i].type == SM_INT) {
+            memcpy(&(kval->val[kval->len]), &least, sizeof(Four_Invariable));
+            kval->len += sizeof(Four_Invariable);
+        }
+        else {
+            memcpy(&(kval->val[kval->len]), &zero, sizeof(Two));
+            kval->len += sizeof(Two);
+        }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_MakeSkipKey() */
+
+
+
+/*@================================
+ * edubtm_NextLeadingValue()
+ *================================*/
+/*
+ * Function: Boolean edubtm_NextLeadingValue(KeyDesc*, char*, Two*)
+ *
+ * Description:
+ *  Turn the first part into the least value greater than it: the next
+ *  integer, or the string followed by a zero byte, which comes right after
+ *  the string in the order of edubtm_KeyCompare(...).
+ *
+ * Returns:
+ *  FALSE if no value is greater; TRUE otherwise
+ *
+ * Side effects:
+ *  prefix : the next value
+ *  plen   : its length
+ */
+Boolean edubtm_NextLeadingValue(
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    char                        *prefix,        /* INOUT first part */
+    Two                         *plen)          /* INOUT length of the first part */
+{
+    Two                         len;            /* length of the string */
+    Four_Invariable             value;          /* value of the integer */
+
+
+    if (kdesc->kpart[0].type == SM_INT) {
+        memcpy(&value, prefix, sizeof(Four_Invariable));
+        if (value == 2147483647) return(FALSE);
+
+        value++;
+        memcpy(prefix, &value, sizeof(Four_Invariable));
+        return(TRUE);
+    }
+
+    if (*plen >= MAXKEYLEN) return(FALSE);
+
+    memcpy(&len, prefix, sizeof(Two));
+    len++;
+    memcpy(prefix, &len, sizeof(Two));
+    prefix[(*plen)++] = '\0';
+
+    return(TRUE);
+
+}   /* edubtm_NextLeadingValue() */
+
+
+
+/*@================================
+ * edubtm_SkipEmptyLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_SkipEmptyLeaves(PageID*, BtreePage**, Two*, Boolean*)
+ *
+ * Description:
+ *  Move right along the leaves, coupling the shared latches, until the
+ *  slot is in the leaf.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  eos : TRUE if there is no more entry; the last leaf is still fixed
+ *
+ * Note:
+ *  On an error, the leaf is released.
+ */
+Four edubtm_SkipEmptyLeaves(
+    PageID                      *leaf,          /* INOUT leaf fixed with a shared latch */
+    BtreePage                   **apage,        /* INOUT pointer to the buffer holding the leaf */
+    Two                         *slotNo,        /* INOUT current slot */
+    Boolean                     *eos)           /* OUT TRUE if there is no more entry */
+{
+    Four                        e;              /* error number */
+
+
+    *eos = FALSE;
+    while (*slotNo >= (*apage)->bl.hdr.nSlots) {
+        if ((e = edubtm_MoveToSibling(leaf, apage, TRUE, eos)) < 0) ERR(e);
+        if (*eos) break;
+
+        *slotNo = 0;
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_SkipEmptyLeaves() */
@@ -51,6 +51,8 @@
  *
  * Description : 
  *  Main routine of EduBtM Test Module
+ *  Compiled with EDUBTM_FEATURETEST, it runs EduBtM_FeatureTest() instead
+ *  of EduBtM_Test(), on a larger volume.
  *
  */
 
@@ -101,7 +103,11 @@ Four main()
 	title = "test";
 	volId = 1000;
 	extSize = 16;
+#ifdef EDUBTM_FEATURETEST
+	numPagesInDevices[0] = 4000;
+#else
 	numPagesInDevices[0] = 500;
+#endif
 	segmentSize = 16;
 
 	/*
@@ -135,9 +141,15 @@ Four main()
 	}
 	
 	/* Test miniBtM */
+#ifdef EDUBTM_FEATURETEST
+	e = EduBtM_FeatureTest(volId, handle);
+	if (e < eNOERROR){
+		printf("EduBtM_FeatureTest failed!!!\n");
+#else
 	e = EduBtM_Test(volId, handle);
 	if (e < eNOERROR){
 		printf("EduBtM_Test failed!!!\n");
+#endif
 		LRDS_AbortTransaction(&xactId);
 		LRDS_Dismount(volId);
 		LRDS_FreeHandle(handle);
@@ -0,0 +1,417 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: EduBtM_UpdateKey.c
+ *
+ * Description :
+ *  Change the key value of an ObjectID in a B+tree. The entry is moved
+ *  inside its leaf page when the new key value still belongs to the leaf.
+ *
+ * Exports:
+ *  Four EduBtM_UpdateKey(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_UpdateKey(PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*, KeyValue*, KeyValue*, Boolean*, Boolean*);
+Four edubtm_UpdateKeyInLeaf(BtreeLeaf*, KeyDesc*, KeyValue*, Two, Boolean*);
+
+
+
+/*@================================
+ * EduBtM_UpdateKey()
+ *================================*/
+/*
+ * Function: Four EduBtM_UpdateKey(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*,
+ *                                 Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Change the key value of the ObjectID 'oid' from 'oldKey' to 'newKey'.
+ *
+ *  The leaf holding 'oldKey' is searched in one descent, remembering the key
+ *  range of the leaf given by the separator keys of its ancestors. If
+ *  'newKey' is also in that range and the rewritten entry fits in the page,
+ *  the entry is rewritten and its slot is shifted to the new position
+ *  inside the leaf; no other page is touched.
+ *
+ *  Otherwise the entry has already been removed from the leaf during the
+ *  descent, and the ObjectID is inserted again with 'newKey', i.e. the
+ *  update falls back to a delete followed by an insert.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eNOTFOUND_BTM
+ *    eDUPLICATEDKEY_BTM
+ *    some errors caused by function calls
+ */
+Four EduBtM_UpdateKey(
+    ObjectID *catObjForFile,	/* IN catalog object of B+-tree file */
+    PageID   *root,		/* IN root Page IDentifier */
+    KeyDesc  *kdesc,		/* IN a key descriptor */
+    KeyValue *oldKey,		/* IN current key value */
+    KeyValue *newKey,		/* IN new key value */
+    ObjectID *oid,		/* IN Object IDentifier */
+    Pool     *dlPool,		/* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead) /* INOUT head of the dealloc list */
+{
+    int		i;
+    Four    e;			/* error number */
+    Four    e2;			/* error number while restoring the old key value */
+    Boolean moved;		/* TRUE if the entry is moved inside its leaf */
+    Boolean exists;		/* whether the key value already exists */
+    Boolean lf;			/* flag for merging */
+    Boolean lh;			/* flag for splitting */
+    InternalItem item;		/* Internal item */
+    DeallocListElem *dlMark;	/* first element of the dealloc list before the update */
+
+
+    /*@ check parameters */
+    if (catObjForFile == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (root == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (kdesc == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (oldKey == NULL || newKey == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (oid == NULL) ERR(eBADPARAMETER_BTM);
+
+    if (dlPool == NULL || dlHead == NULL) ERR(eBADPARAMETER_BTM);
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for(i=0; i<kdesc->nparts; i++)
+    {
+        if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    if (edubtm_KeyCompare(kdesc, oldKey, newKey) == EQUAL) return(eNOERROR);
+
+    /* The entry may leave its leaf, so no other operation runs on the tree */
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+
+    /* The entry to move may still be in the side log of a build */
+    if (edubtm_InOnlineBuild(root)) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    edubtm_EnterBfM();
+    dlMark = dlHead->next;
+
+    /* The new key value is in the Bloom filter before it can be found in the tree */
+    if ((e = edubtm_AddToBloomFilter(root, newKey)) < 0) ERRTL(e, root);
+
+    /* The pending messages of both key values should reach the leaves first */
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, oldKey, oldKey, dlPool, dlHead)) < 0) ERRTL(e, root);
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, newKey, newKey, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    /* Move the entry inside its leaf, or remove it from the leaf */
+    if ((e = edubtm_UpdateKey(root, kdesc, oldKey, newKey, oid, NULL, NULL, &moved, &lf)) < 0) ERRTL(e, root);
+
+    if (moved) {
+        /* The flushes above may have merged pages */
+        if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+        edubtm_LeaveBfM();
+        (Four) edubtm_UnlatchTree(root);
+        return(eNOERROR);
+    }
+
+    /* The leaf of 'oldKey' may not be half full after removing the entry */
+    if (lf) {
+        if ((e = edubtm_RepairUnderflow(catObjForFile, root, kdesc, oldKey, &lf, &lh, &item, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+        if (lh) {
+            if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
+        }
+        else if (lf) {
+            if ((e = edubtm_root_delete(catObjForFile, root, kdesc, dlPool, dlHead)) < 0) ERRTL(e, root);
+        }
+
+        /* A page freed by the merge may serve a split of the insert below */
+        if ((e = edubtm_RecyclePages(catObjForFile, root, dlMark, dlPool, dlHead)) < 0) ERRTL(e, root);
+    }
+
+    /* Insert the ObjectID again with the new key value */
+    e = edubtm_Insert(catObjForFile, root, kdesc, newKey, oid, BTM_INSERT, &exists, NULL, &lf, &lh, &item, dlPool, dlHead);
+    if (e == eDUPLICATEDKEY_BTM) {
+        /* Put the old key value back before reporting the error */
+        if ((e2 = edubtm_Insert(catObjForFile, root, kdesc, oldKey, oid, BTM_INSERT, &exists, NULL, &lf, &lh, &item, dlPool, dlHead)) < 0) ERRTL(e2, root);
+        if (lh) {
+            if ((e2 = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e2, root);
+        }
+    }
+    if (e < 0) ERRTL(e, root);
+
+    if (lh) {
+        if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
+    }
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+    return(eNOERROR);
+
+}   /* EduBtM_UpdateKey() */
+
+
+
+/*@================================
+ * edubtm_UpdateKey()
+ *================================*/
+/*
+ * Function: Four edubtm_UpdateKey(PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*,
+ *                                 KeyValue*, KeyValue*, Boolean*, Boolean*)
+ *
+ * Description:
+ *  Find the leaf holding 'oldKey' in the subtree whose root is 'root'. All
+ *  the key values belonging to the subtree are in [lowBound, highBound);
+ *  NULL bounds mean that the subtree is not bounded on that side.
+ *
+ *  In the leaf, the entry is moved to 'newKey' by edubtm_UpdateKeyInLeaf()
+ *  if 'newKey' is in the key range of the leaf. Otherwise the entry is
+ *  removed from the leaf and 'moved' is set to FALSE.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eNOTFOUND_BTM
+ *    eDUPLICATEDKEY_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) moved : TRUE if the entry is moved inside its leaf
+ *  2) f : TRUE if the leaf is not half full after removing the entry
+ */
+Four edubtm_UpdateKey(
+    PageID                      *root,          /* IN root of the subtree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *oldKey,        /* IN current key value */
+    KeyValue                    *newKey,        /* IN new key value */
+    ObjectID                    *oid,           /* IN Object IDentifier */
+    KeyValue                    *lowBound,      /* IN smallest possible key of the subtree, NULL if unbounded */
+    KeyValue                    *highBound,     /* IN every key of the subtree is less than this, NULL if unbounded */
+    Boolean                     *moved,         /* OUT whether the entry is moved inside its leaf */
+    Boolean                     *f)             /* OUT whether the leaf is not half full */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* the index by the binary search */
+    Boolean                     found;          /* search result */
+    Boolean                     inRange;        /* TRUE if 'newKey' belongs to the leaf */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+
+
+    *moved = *f = FALSE;
+
+    /* Fix the root page to the buffer */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    if (apage->any.hdr.type & INTERNAL) {
+
+        edubtm_BinarySearchInternal(&(apage->bi), kdesc, oldKey, &idx);
+
+        if (idx == -1) MAKE_PAGEID(child, root->volNo, apage->bi.hdr.p0);
+        else {
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]);
+            MAKE_PAGEID(child, root->volNo, iEntry->spid);
+            lowBound = (KeyValue*)&(iEntry->klen);
+        }
+
+        if (idx < apage->bi.hdr.nSlots - 1) {
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-(idx+1)]]);
+            highBound = (KeyValue*)&(iEntry->klen);
+        }
+
+        if ((e = edubtm_UpdateKey(&child, kdesc, oldKey, newKey, oid, lowBound, highBound, moved, f)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+
+        /* Unfix the root page from the buffer */
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (!(apage->any.hdr.type & LEAF)) ERRB1(eBADBTREEPAGE_BTM, root, PAGE_BUF);
+
+    /* Find the entry of 'oldKey' having the ObjectID 'oid' */
+    found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, oldKey, &idx);
+    if (!found) ERRB1(eNOTFOUND_BTM, root, PAGE_BUF);
+
+    /* A key value has only one ObjectID in EduBtM */
+    lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+    if (lEntry->nObjects != 1) ERRB1(eNOTSUPPORTED_EDUBTM, root, PAGE_BUF);
+
+    if (btm_ObjectIdComp(oid, (ObjectID*)&(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)])) != EQUAL)
+        ERRB1(eNOTFOUND_BTM, root, PAGE_BUF);
+
+    /* Does 'newKey' still belong to this leaf? */
+    inRange = TRUE;
+    if (lowBound != NULL && edubtm_KeyCompare(kdesc, newKey, lowBound) == LESS) inRange = FALSE;
+    if (highBound != NULL && edubtm_KeyCompare(kdesc, newKey, highBound) != LESS) inRange = FALSE;
+
+    if (inRange) {
+        if ((e = edubtm_UpdateKeyInLeaf(&(apage->bl), kdesc, newKey, idx, moved)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+
+    if (!*moved) {
+        /* Remove the entry; the caller inserts it again */
+        edubtm_DeleteLeafEntries(&(apage->bl), idx, idx);
+
+        if (!(apage->any.hdr.type & ROOT) && BL_FREE(&(apage->bl)) > BL_HALF) *f = TRUE;
+    }
+
+    /* The entry has changed its key value or left the leaf */
+    edubtm_BumpVersion(root);
+
+    /* Set the DIRTY bit */
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+
+    /* Unfix the root page from the buffer */
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_UpdateKey() */
+
+
+
+/*@================================
+ * edubtm_UpdateKeyInLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_UpdateKeyInLeaf(BtreeLeaf*, KeyDesc*, KeyValue*, Two, Boolean*)
+ *
+ * Description:
+ *  Rewrite the key value of the entry in the slot 'slotNo' of the given leaf
+ *  with 'newKey', and shift the slot to keep the slots sorted.
+ *
+ *  If the aligned key length does not change, the entry is rewritten where
+ *  it is. Otherwise the entry is rewritten in the free space of the page,
+ *  compacting the page if needed. If even that space is not enough, the page
+ *  is not changed and 'moved' is FALSE.
+ *
+ * Returns:
+ *  error code
+ *    eDUPLICATEDKEY_BTM
+ */
+Four edubtm_UpdateKeyInLeaf(
+    BtreeLeaf                   *page,          /* INOUT the leaf page */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *newKey,        /* IN new key value */
+    Two                         slotNo,         /* IN slot of the entry */
+    Boolean                     *moved)         /* OUT whether the entry is moved */
+{
+    Two                         i;              /* slot No. */
+    Two                         idx;            /* the index by the binary search */
+    Two                         pos;            /* new slot of the entry */
+    Two                         oldLen;         /* length of the old entry */
+    Two                         newLen;         /* length of the new entry */
+    Two                         entryOffset;    /* starting offset of the entry */
+    btm_LeafEntry               *entry;         /* the entry */
+    ObjectID                    oid;            /* the ObjectID of the entry */
+
+
+    *moved = FALSE;
+
+    /* The new slot, counted after the slot 'slotNo' is removed */
+    if (edubtm_BinarySearchLeaf(page, kdesc, newKey, &idx)) ERR(eDUPLICATEDKEY_BTM);
+    pos = (idx < slotNo) ? idx + 1 : idx;
+
+    entryOffset = page->slot[-slotNo];
+    entry = (btm_LeafEntry*)&(page->data[entryOffset]);
+    oldLen = BTM_LEAFENTRY_LEN(entry);
+    newLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(newKey->len) + OBJECTID_SIZE;
+
+    if (newLen != oldLen && newLen > (Four)BL_FREE(page) + oldLen) return(eNOERROR);
+
+    memcpy((char*)&oid, &(entry->kval[ALIGNED_LENGTH(entry->klen)]), OBJECTID_SIZE);
+
+    /* Remove the slot */
+    for (i = slotNo; i < page->hdr.nSlots - 1; i++)
+        page->slot[-i] = page->slot[-(i+1)];
+    page->hdr.nSlots--;
+
+    /* Place the entry of the new length */
+    if (newLen != oldLen) {
+        page->hdr.unused += oldLen;
+
+        /* The removed slot is placed again below */
+        if (newLen + (Four)sizeof(Two) > (Four)BL_CFREE(page)) edubtm_CompactLeafPage(page, NIL);
+
+        entryOffset = page->hdr.free;
+        page->hdr.free += newLen;
+        entry = (btm_LeafEntry*)&(page->data[entryOffset]);
+        entry->nObjects = 1;
+    }
+
+    /* Rewrite the key value and the ObjectID */
+    entry->klen = newKey->len;
+    memcpy(&(entry->kval[0]), &(newKey->val[0]), newKey->len);
+    memcpy(&(entry->kval[ALIGNED_LENGTH(newKey->len)]), (char*)&oid, OBJECTID_SIZE);
+
+    /* Insert the slot at the new position */
+    for (i = page->hdr.nSlots; i > pos; i--)
+        page->slot[-i] = page->slot[-(i-1)];
+    page->slot[-pos] = entryOffset;
+    page->hdr.nSlots++;
+
+    *moved = TRUE;
+
+    return(eNOERROR);
+
+}   /* edubtm_UpdateKeyInLeaf() */
@@ -57,6 +57,9 @@
 #define PAGE_BUF    0
 #define LOT_LEAF_BUF 1
 
+/* Return value of bfm_LookUp() when the train is not in the buffer pool */
+#define NOTFOUND_IN_HTABLE  -1
+
 
 /*@
  * Function Prototypes
@@ -66,6 +69,11 @@ Four BfM_FreeTrain(TrainID *, Four);
 Four BfM_GetTrain(TrainID *, char **, Four);
 Four BfM_GetNewTrain(TrainID *, char **, Four);
 Four BfM_SetDirty(TrainID *, Four);
+Four BfM_FlushAll(void);
+Four BfM_DiscardAll(void);
+
+/* Internal Function Prototypes used by the other managers */
+Four bfm_LookUp(TrainID *, Four);
 
 
 #endif /* _BFM_H_ */
@@ -59,12 +59,31 @@
  * Function Prototypes
  */
 /* Interface Function Prototypes */
+Four EduBtM_BeginOnlineBuild(ObjectID*, PageID*);
+Four EduBtM_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four, Pool*, DeallocListElem*);
 Four EduBtM_CreateIndex(ObjectID*, PageID*);
+Four EduBtM_DeleteBatch(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Pool*, DeallocListElem*);
 Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
 Four EduBtM_DropIndex(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
+Four EduBtM_EndOnlineBuild(PageID*, KeyDesc*, Pool*, DeallocListElem*);
 Four EduBtM_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four EduBtM_FetchBatch(PageID*, KeyDesc*, Four, BatchItem*, Boolean*);
+Four EduBtM_FetchMulti(PageID*, KeyDesc*, Four, btm_FetchRange*, btm_ScanCallback, void*);
 Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four EduBtM_InsertIfAbsent(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, ObjectID*, Pool*, DeallocListElem*);
 Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_MergeChangeBuffer(PageID*, KeyDesc*, Four);
+Four EduBtM_ParallelScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, Four, Boolean, btm_ScanCallback, void*);
+Four EduBtM_Reorganize(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*);
+Four EduBtM_SetBloomFilter(ObjectID*, PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetBufferMode(PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetChangeBuffering(ObjectID*, PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetLearnedIndex(PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetResultCache(PageID*, Boolean);
+Four EduBtM_SkipScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, btm_ScanCallback, void*);
+Four EduBtM_UpdateKey(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_Upsert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, ObjectID*, Pool*, DeallocListElem*);
 
 
 #endif /* _EDUBTM_H_ */
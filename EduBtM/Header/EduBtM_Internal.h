@@ -50,6 +50,7 @@
 #define _EDUBTM_INTERNAL_H_
 
 
+#include <pthread.h>
 #include "Util_pool.h"
 
 
@@ -73,6 +74,14 @@
 #define GREATER 1	/* added only for ODYSSEUS/EduCOSMOS */
 
 
+/*
+ * Insert mode: what to do when the key value already exists
+ */
+#define BTM_INSERT          0   /* fail with eDUPLICATEDKEY_BTM */
+#define BTM_INSERTIFABSENT  1   /* keep the existing ObjectID */
+#define BTM_UPSERT          2   /* replace the existing ObjectID */
+
+
 /*@
  * Type Definitions
  */
@@ -211,6 +220,92 @@ typedef struct {   /* Overflow page */
 #endif
 } BtreeOverflow;
 
+/*
+ * BtreeMeta:
+ *  Per-index page holding the information of the index which does not fit
+ *  in the root page. The root page keeps its page number in 'reserved'.
+ */
+typedef struct {
+	PageID pid;                 /* page id of this page, should be located on the beginning */
+	Four flags;                 /* flag to store page information */
+	Four reserved;              /* reserved space to store page information */
+	One     type;               /* META */
+	ObjectID catObjForFile;     /* catalog object of B+ tree file */
+	ShortPageID cbFirst;        /* first page of the change buffer */
+	ShortPageID cbCur;          /* page of the change buffer to which the changes are appended */
+	ShortPageID cbLast;         /* last page of the change buffer; the pages after 'cbCur' are spare */
+	Two     cbPages;            /* # of pages of the change buffer */
+	ShortPageID slFirst;        /* first page of the side log of an online build */
+	ShortPageID slLast;         /* page of the side log to which the changes are appended */
+	Two     nRunPages;          /* # of pages in 'runPages' */
+	Two     runNext;            /* index of the page of 'runPages' given out next */
+	Two     nFreePages;         /* # of pages in 'freePages' */
+	ShortPageID firstLeaf;      /* leftmost leaf known last, NIL if not known */
+	ShortPageID lastLeaf;       /* rightmost leaf known last, NIL if not known */
+	Four    bfBlocks;           /* # of blocks of the Bloom filter, 0 if none is built */
+	Four    bfKeys;             /* # of keys the Bloom filter was built for */
+	Two     bfNPages;           /* # of pages in 'bfPages' */
+} BtreeMetaHdr;
+
+#define BM_FIXED  sizeof(BtreeMetaHdr)
+#define BTM_LEAFRUN_PAGES   16      /* # of pages reserved at once for the leaves, the size of an extent */
+#define BM_RUNPAGES_SIZE    ((CONSTANT_CASTING_TYPE)(BTM_LEAFRUN_PAGES*sizeof(ShortPageID)))
+#define BTM_MAXFREEPAGES    128     /* # of freed pages kept in a meta page for reuse */
+#define BM_FREEPAGES_SIZE   ((CONSTANT_CASTING_TYPE)(BTM_MAXFREEPAGES*sizeof(ShortPageID)))
+#define BTM_BLOOMMAXPAGES   256     /* # of pages of a Bloom filter at most */
+#define BM_BLOOMPAGES_SIZE  ((CONSTANT_CASTING_TYPE)(BTM_BLOOMMAXPAGES*sizeof(ShortPageID)))
+
+typedef struct {   /* Meta page */
+	BtreeMetaHdr        hdr;       /* header of the btree meta page */
+	ShortPageID         runPages[BTM_LEAFRUN_PAGES]; /* leaf run of the file, in the order of the page numbers */
+	ShortPageID         freePages[BTM_MAXFREEPAGES]; /* pages freed in the file, reused by the splits */
+	ShortPageID         bfPages[BTM_BLOOMMAXPAGES];  /* pages of the Bloom filter, in block order */
+	char                data[PAGESIZE-BM_FIXED-BM_RUNPAGES_SIZE-BM_FREEPAGES_SIZE-BM_BLOOMPAGES_SIZE]; /* data area */
+} BtreeMeta;
+
+
+/*
+ * BtreeChangeBuffer:
+ *  Page of the change buffer of an index. It keeps the changes of the leaves
+ *  which were not in the buffer pool when the changes were made.
+ */
+typedef struct {
+	PageID pid;                 /* page id of this page, should be located on the beginning */
+	Four flags;                 /* flag to store page information */
+	Four reserved;              /* reserved space to store page information */
+	One     type;               /* CHANGEBUFFER */
+	ShortPageID nextPage;       /* Next Page */
+	Two     nRecords;           /* # of change records in this page */
+	Two     used;               /* # of bytes used by the change records */
+} BtreeChangeBufferHdr;
+
+#define BC_FIXED  sizeof(BtreeChangeBufferHdr)
+
+typedef struct {   /* Change buffer page */
+	BtreeChangeBufferHdr hdr;      /* header of the btree change buffer page */
+	char                data[PAGESIZE-BC_FIXED]; /* data area */
+} BtreeChangeBuffer;
+
+
+/*
+ * BtreeBloomFilter:
+ *  Page holding a part of the Bloom filter of an index. The meta page lists
+ *  the pages of the filter.
+ */
+typedef struct {
+	PageID pid;                 /* page id of this page, should be located on the beginning */
+	Four flags;                 /* flag to store page information */
+	Four reserved;              /* reserved space to store page information */
+	One     type;               /* BLOOMFILTER */
+} BtreeBloomFilterHdr;
+
+#define BF_FIXED  sizeof(BtreeBloomFilterHdr)
+
+typedef struct {   /* Bloom filter page */
+	BtreeBloomFilterHdr hdr;       /* header of the btree Bloom filter page */
+	char                data[PAGESIZE-BF_FIXED]; /* blocks of the filter */
+} BtreeBloomFilter;
+
 #define NO_OF_OBJECTS   BO_MAXOBJECTIDS
 #define HALF_OF_OBJECTS         ((CONSTANT_CASTING_TYPE)(NO_OF_OBJECTS/2))
 #define A_FOURTH_OF_OBJECTS     ((CONSTANT_CASTING_TYPE)(NO_OF_OBJECTS/4))
@@ -228,6 +323,9 @@ typedef union {
 	BtreeInternal bi;       /* btree internal page */
 	BtreeLeaf     bl;       /* btree leaf page */
 	BtreeOverflow bo;       /* btree overflow page */
+	BtreeMeta     bm;       /* btree meta page */
+	BtreeChangeBuffer bc;   /* btree change buffer page */
+	BtreeBloomFilter bf;    /* btree Bloom filter page */
 } BtreePage;
 
 /* Btree Page Type */
@@ -236,6 +334,23 @@ typedef union {
 #define LEAF        0x04
 #define OVERFLOW    0x08
 #define FREEPAGE    0x10
+#define META        0x20
+#define CHANGEBUFFER 0x40
+#define BLOOMFILTER 0x80
+
+/* Btree Page Flags: bits of 'flags' above the page type vector */
+#define BTM_MSGBUFFER       0x10    /* the internal page reserves a message buffer */
+#define BTM_BUFFEREDINDEX   0x20    /* (root page only) updates are buffered in the internal pages */
+#define BTM_CHANGEBUFFERED  0x40    /* (root page only) changes of non-resident leaves are buffered */
+#define BTM_LEAFPARENT      0x80    /* the children of the internal page are leaves */
+#define BTM_SPLITPENDING    0x100   /* the page has a right link which is not posted to its parent */
+#define BTM_BLOOMFILTERED   0x200   /* (root page only) the meta page holds a Bloom filter of the keys */
+
+/* flags kept by the root page when the root moves to another page */
+#define BTM_ROOTFLAGS       (BTM_BUFFEREDINDEX | BTM_CHANGEBUFFERED | BTM_BLOOMFILTERED)
+
+/* flags of the root page for which edubtm_LatchIndex() latches the tree exclusively */
+#define BTM_XLATCHFLAGS     (BTM_BUFFEREDINDEX | BTM_CHANGEBUFFERED)
 
 
 /****************************************************************
@@ -288,11 +403,602 @@ typedef struct {
 	char kval[MAXKEYLEN];   /* key value */
 } LeafItem;
 
+/*
+ * Message buffer of an internal page:
+ *  An internal page of a buffered index reserves the first BTM_MSGBUF_SIZE
+ *  bytes of its data area for the pending updates of its subtree. The buffer
+ *  begins with a 'btm_MsgBufferHdr' followed by the messages in the order of
+ *  their arrival, and the internal entries are stored after the buffer.
+ */
+typedef struct {
+	ObjectID catObjForFile;     /* catalog object of B+ tree file, used to flush the buffer */
+	Two      nMsgs;             /* # of messages */
+	Two      used;              /* # of bytes used by the messages */
+} btm_MsgBufferHdr;
+
+/* Data type of a message */
+typedef struct {
+	ObjectID oid;       /* ObjectID to insert or delete */
+	Two  op;            /* BTM_MSG_INSERT or BTM_MSG_DELETE */
+	/* 'klen' and 'kval' should be attached in this order */
+	/* to cast this variables the type KeyVlaue. */
+	Two  klen;          /* key length */
+	char kval[1];       /* key value */
+} btm_Message;
+
+#define BTM_MSG_INSERT  1
+#define BTM_MSG_DELETE  2
+
+#define BTM_MESSAGE_FIXED   OFFSET_OF(btm_Message, kval[0])
+#define BTM_MSGBUF_SIZE     ((CONSTANT_CASTING_TYPE)((PAGESIZE-BI_FIXED)/4))
+#define BTM_MSGBUF_DATA     ((CONSTANT_CASTING_TYPE)ALIGNED_LENGTH(sizeof(btm_MsgBufferHdr)))
+
+/* Data type of a record of the change buffer */
+typedef struct {
+	ShortPageID leaf;   /* the leaf to which the change was made */
+	btm_Message msg;    /* the change */
+} btm_ChangeRecord;
+
+#define BTM_CHANGERECORD_FIXED  OFFSET_OF(btm_ChangeRecord, msg)
+#define BTM_CHANGEBUF_MAXPAGES  8   /* # of pages of a change buffer to merge all the changes */
+
+/* upper bound of the # of children of an internal page; an entry and its slot take at least 8 bytes */
+#define BTM_MAXCHILDREN     ((CONSTANT_CASTING_TYPE)((PAGESIZE-BI_FIXED)/8 + 1))
+
+/* Data type for representing a (key value, ObjectID) pair of a batch operation */
+typedef struct {
+	KeyValue kval;      /* key value */
+	ObjectID oid;       /* an ObjectID */
+} BatchItem;
+
+
+/*****************************************************************
+ * Latches - reader/writer latches of the pages and of the trees *
+ *****************************************************************/
+
+/*
+ * A page latch protects the contents of a page between its fix and unfix;
+ * the link fields 'prevPage' and 'nextPage' of a leaf are protected by the
+ * buffer manager mutex instead. A tree latch, identified by the root, is
+ * held in the shared mode by the latch-coupled operations and in the
+ * exclusive mode by the other operations on the index.
+ *
+ * Each page also has a version word, shared by the pages of the same hash
+ * value. Its low bits count the exclusive latches held on those pages and
+ * the rest is bumped whenever such a latch is released, so a reader may
+ * read an internal page without latching it and validate the version
+ * afterwards.
+ */
+#define BTM_LATCH_S         1       /* shared mode */
+#define BTM_LATCH_X         2       /* exclusive mode */
+
+#define BTM_PAGELATCH       0       /* latch of a page */
+#define BTM_TREELATCH       1       /* latch of a whole index */
+
+#define BTM_MAXLATCHES      1024    /* # of latches which can be held or waited for at once */
+#define BTM_LATCH_HASHSIZE  509     /* size of the hash table of the latches */
+#define BTM_MAXTREEHEIGHT   32      /* max # of pages on the path of an operation */
+
+#define BTM_VERSION_HASHSIZE    4096    /* # of version words */
+#define BTM_VERSION_WRITERS     0xff    /* bits counting the exclusive latches */
+#define BTM_VERSION_STEP        0x100   /* increment of a version */
+#define BTM_OPTIMISTIC_RETRIES  8       /* # of optimistic descents before latch coupling */
+
+/* Data type of an entry of the latch table */
+typedef struct {
+	PageID pid;                 /* latched page, or the root of the latched tree */
+	One kind;                   /* BTM_PAGELATCH or BTM_TREELATCH */
+	Four nUsers;                /* # of threads holding or waiting for the latch */
+	Four next;                  /* next entry in the hash chain or in the free list */
+	Boolean exclusive;          /* TRUE if the latch is held in the exclusive mode */
+	pthread_rwlock_t rwlock;    /* the latch */
+} btm_LatchEntry;
+
+/* Data type of the latch table */
+typedef struct {
+	pthread_mutex_t mutex;              /* protects the hash chains and the free list */
+	pthread_mutex_t bfmMutex;           /* serializes the calls of the buffer manager */
+	Four freeList;                      /* first free entry */
+	Four hashTable[BTM_LATCH_HASHSIZE]; /* first entry of each hash chain */
+	btm_LatchEntry entries[BTM_MAXLATCHES];
+	UFour versions[BTM_VERSION_HASHSIZE]; /* version words of the pages */
+} btm_LatchTable;
+
+/* Data type of the internal pages visited by a descent, used to post the splits */
+typedef struct {
+	Two nPages;                         /* # of pages on the path */
+	PageID pid[BTM_MAXTREEHEIGHT];      /* the pages from the root down */
+} btm_TreePath;
+
+
+/*****************************************************************
+ * Right links - B-link links of the pages whose split is pending *
+ *****************************************************************/
+
+/*
+ * A latch-coupled insert releases a page as soon as it is split, and posts
+ * the separator to the parent afterwards. Until then the page is marked with
+ * BTM_SPLITPENDING and has a right link to the new page, with the separator
+ * as its high key; a search for a key value not less than the high key moves
+ * right. Splitting such a page again hands its link over to the new page.
+ * The links live in a table rather than in the page, whose layout is shared
+ * with the object code of the delete routines; they are gone before any
+ * operation latching the whole index starts.
+ */
+#define BTM_MAXRIGHTLINKS       256     /* # of splits which can be pending at once */
+#define BTM_RIGHTLINK_HASHSIZE  127     /* size of the hash table of the right links */
+
+/* Data type of a right link */
+typedef struct {
+	PageID pid;                 /* the page split */
+	ShortPageID rightPage;      /* the new page */
+	Four next;                  /* next entry in the hash chain or in the free list */
+	KeyValue highKey;           /* the separator of the new page */
+} btm_RightLink;
+
+/* Data type of the table of the right links */
+typedef struct {
+	pthread_mutex_t mutex;                  /* protects the table */
+	Four freeList;                          /* first free entry */
+	Four hashTable[BTM_RIGHTLINK_HASHSIZE]; /* first entry of each hash chain, by the page split */
+	btm_RightLink entries[BTM_MAXRIGHTLINKS];
+} btm_RightLinkTable;
+
+
+/*****************************************************************
+ * Parallel scans - sub-ranges of a range scan run by threads     *
+ *****************************************************************/
+
+/*
+ * A parallel scan splits its range at separator keys of the upper levels,
+ * and each sub-range is scanned by a thread of its own. The results are
+ * handed to a callback in batches of cursors, one call at a time. In an
+ * ordered scan the batches come in the key order; a thread whose turn has
+ * not come holds up to BTM_SCANHELDBATCHES batches and then waits.
+ */
+#define BTM_MAXSCANWORKERS      16      /* # of sub-ranges of a parallel scan at most */
+#define BTM_SCANBATCHSIZE       32      /* # of cursors delivered by a call of the callback */
+#define BTM_SCANHELDBATCHES     4       /* # of batches a thread holds until its turn */
+
+/*
+ * Data type of the callback of a parallel scan; it gets the argument given
+ * to the scan, the # of the sub-range, and the batch of cursors with its
+ * size. Returning an error stops the scan.
+ */
+typedef Four (*btm_ScanCallback)(void*, Four, Four, BtreeCursor*);
+
+struct btm_ParallelScan_tag;
+
+/* Data type of a sub-range of a parallel scan */
+typedef struct {
+	struct btm_ParallelScan_tag *scan;  /* the scan */
+	Four partNo;                /* # of the sub-range, in the key order */
+	KeyValue low;               /* key value of the start condition */
+	Four lowCompOp;             /* SM_BOF, SM_GE, or SM_GT */
+	KeyValue high;              /* key value of the stop condition */
+	Four highCompOp;            /* SM_EOF, SM_LT, or SM_LE */
+	pthread_t thread;           /* thread scanning the sub-range */
+	Boolean started;            /* TRUE if the thread has been created */
+} btm_ScanPart;
+
+/* Data type of a parallel scan */
+typedef struct btm_ParallelScan_tag {
+	PageID root;                /* root of the index */
+	KeyDesc *kdesc;             /* key descriptor of the index */
+	Boolean ordered;            /* TRUE if the batches are delivered in the key order */
+	btm_ScanCallback callback;  /* function receiving the batches */
+	void *arg;                  /* argument of the callback */
+	pthread_mutex_t mutex;      /* serializes the delivery of the batches */
+	pthread_cond_t turnChanged; /* signaled when 'turn' or 'stop' changes */
+	Four turn;                  /* sub-range whose batches are delivered now in an ordered scan */
+	Boolean stop;               /* TRUE if the scan should stop */
+	Four error;                 /* first error of the scan */
+	Four nParts;                /* # of the sub-ranges */
+	btm_ScanPart parts[BTM_MAXSCANWORKERS];
+} btm_ParallelScan;
+
+
+/*****************************************************************
+ * Multi-range fetches - several ranges read in one pass          *
+ *****************************************************************/
+
+/*
+ * A multi-range fetch reads a list of ranges, e.g. the values of an IN
+ * list, and hands the results of each range to a callback of the parallel
+ * scans in batches of BTM_SCANBATCHSIZE cursors. The leaf where a range
+ * ends is kept for the next one; the next range starts there, or up to
+ * BTM_MULTIHOPS leaves to the right, and descends the tree only when it
+ * starts farther away.
+ */
+#define BTM_MULTIHOPS           2       /* # of leaves to move right before descending again */
+
+/* Data type of a range of a multi-range fetch */
+typedef struct {
+	KeyValue start;             /* key value of the start condition */
+	Four startCompOp;           /* SM_BOF, SM_EQ, SM_GE, or SM_GT */
+	KeyValue stop;              /* key value of the stop condition */
+	Four stopCompOp;            /* SM_EOF, SM_EQ, SM_LT, or SM_LE */
+} btm_FetchRange;
+
+
+/*****************************************************************
+ * Bulk loads - building an index from sorted items by threads    *
+ *****************************************************************/
+
+/*
+ * A bulk load cuts the sorted items into chunks, one for each thread. The
+ * threads first plan the leaves of their chunks; then all the leaves are
+ * allocated at once, and the threads fill their ranges of them. The upper
+ * levels are built afterwards from the first key of each leaf.
+ */
+#define BTM_MAXBULKLOADWORKERS  16      /* # of threads of a bulk load at most */
+#define BTM_BULKLOAD_MINCHUNK   1024    /* # of items of a chunk at least */
+#define BTM_BULKLOAD_FILL       90      /* % of the data area of a page filled by a bulk load */
+
+/* Data type of a chunk of a bulk load */
+typedef struct {
+	KeyDesc *kdesc;             /* key descriptor of the index */
+	BatchItem *items;           /* all the items, sorted */
+	Four from;                  /* first item of the chunk */
+	Four to;                    /* the item after the last one of the chunk */
+	Four *leafStart;            /* first item of each leaf of all the chunks */
+	Four firstLeaf;             /* ordinal of the first leaf of the chunk */
+	Four nLeaves;               /* # of leaves of the chunk */
+	Four nAllLeaves;            /* # of leaves of all the chunks */
+	PageID *leaves;             /* the leaves of all the chunks */
+	pthread_t thread;           /* thread working on the chunk */
+	Boolean started;            /* TRUE if the thread has been created */
+	Four error;                 /* error of the thread */
+} btm_BulkChunk;
+
+
+/*****************************************************************
+ * Leaf runs - pages reserved for the new leaves of a file        *
+ *****************************************************************/
+
+/*
+ * A leaf split does not take its new right page from wherever the disk
+ * manager finds one. A run of BTM_LEAFRUN_PAGES pages is reserved from the
+ * extents of the B+ tree file at once, and the new leaves take the pages
+ * of the run in the order of the page numbers; so the leaves made one after
+ * another, e.g. by inserts in the key order, lie next to each other.
+ *
+ * The pages freed by the deletes of an index are not given back to the
+ * volume; they are kept in the free page list of the file, so that the
+ * splits of every index of the file take the freed pages first. Only the
+ * pages which do not fit in the list go through the dealloc list.
+ *
+ * The run and the list are kept in the meta page of the index whose root is
+ * the first page of the file, so that neither is lost on a restart. A table
+ * protected by the buffer manager mutex only caches where that meta page is
+ * for each file; it is found again from the first page when the entry of
+ * the file is made.
+ */
+#define BTM_MAXLEAFRUNS         16      /* # of files which have a leaf run at once */
+
+/* Data type of the entry of a B+ tree file in the table of the leaf runs */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	PhysicalFileID fid;         /* the B+ tree file */
+	PageID metaPid;             /* meta page keeping the leaf run and the free page list, NIL if not known */
+} btm_LeafRun;
+
+
+/*****************************************************************
+ * Reorganization - merging and laying out the leaves in order    *
+ *****************************************************************/
+
+/*
+ * EduBtM_Reorganize(...) merges two neighboring leaves only if one of them
+ * is less than half full and the merged leaf is filled up to at most
+ * BTM_REORG_FILL percent, so that the next few inserts into the merged leaf
+ * do not split it again at once.
+ */
+#define BTM_REORG_FILL          90      /* max. fill factor (%) of a merged leaf */
+
+
+/*****************************************************************
+ * Online builds - side logs of the indexes being built           *
+ *****************************************************************/
+
+/*
+ * While an index is built from a snapshot of its data file, the inserts and
+ * deletes of EduBtM_InsertObject(...) and EduBtM_DeleteObject(...) are not
+ * applied to the tree; they are appended, without latching the tree, to
+ * the side log hanging from the meta page, in the format of the change
+ * buffer. The side log is replayed into the tree when the build ends. The
+ * indexes being built are registered in a table shared by the threads.
+ */
+#define BTM_MAXONLINEBUILDS     16      /* # of indexes which can be built at once */
+
+/* Data type of an index being built */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	PageID root;                /* root of the index */
+	PageID metaPid;             /* meta page holding the side log */
+	ObjectID catObjForFile;     /* catalog object of B+ tree file */
+} btm_OnlineBuild;
+
+/* Data type of the table of the indexes being built */
+typedef struct {
+	pthread_mutex_t mutex;      /* protects the table and the side logs */
+	btm_OnlineBuild entries[BTM_MAXONLINEBUILDS];
+} btm_OnlineBuildTable;
+
+
+/*****************************************************************
+ * Upper-level cache - internal pages kept fixed per index        *
+ *****************************************************************/
+
+/*
+ * The internal pages of the top BTM_CACHEDLEVELS levels of an index are
+ * kept fixed in the buffer, so that they are never replaced, and the
+ * optimistic descents take them from the cache without asking the buffer
+ * manager. The caches are protected by the buffer manager mutex; a descent
+ * counts itself in 'nUsers' and reads the pages of the cache without the
+ * mutex, so a cache is changed only when no descent uses it. A split of a
+ * cached page or of the root makes the cache stale; it is built again by
+ * the next descent which finds no other user in it.
+ *
+ * The child references of a cached page whose children are cached too are
+ * swizzled beside the page: the reference of the child in slot 'i' (-1 for
+ * 'p0') tells where the child is in the cache, so a descent goes from the
+ * page to the child without searching. The page numbers in the pages are
+ * not replaced, since a ShortPageID cannot hold a pointer and the pages
+ * are written out as they are; the references are unswizzled by dropping
+ * them with the cache. A reference is used only if its page number is the
+ * one read from the validated page, so the slots moved by a split are
+ * never followed to a wrong child.
+ */
+#define BTM_MAXCACHEDINDEXES    16      /* # of indexes whose upper levels are cached */
+#define BTM_CACHEDLEVELS        2       /* # of levels cached, the root level included */
+#define BTM_MAXCACHEDPAGES      64      /* # of pages cached for an index */
+#define BTM_MAXSWIZZLEDREFS     2048    /* # of child references of the cached pages resolved */
+#define BTM_NOCHILDREF          (-2)    /* a page reached by a right link, not by a child reference */
+
+/* Data type of a cached page */
+typedef struct {
+	ShortPageID pageNo;         /* the page */
+	BtreePage *page;            /* the buffer holding the page */
+	Two firstRef;               /* first of the swizzled references of its children, the one of 'p0' */
+	Two nRefs;                  /* # of swizzled references of its children, 0 if none */
+} btm_CachedPage;
+
+/* Data type of a swizzled child reference: a child also in the cache */
+typedef struct {
+	ShortPageID pageNo;         /* the child as found in the parent when resolved */
+	Two cacheIdx;               /* index of the child in the cached pages, -1 if not cached */
+} btm_SwizzledRef;
+
+/* Data type of the cache of the upper levels of an index */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	Boolean stale;              /* TRUE if the pages should be read again */
+	PageID root;                /* root of the index */
+	Four nUsers;                /* # of descents using the cache */
+	Two nPages;                 /* # of pages cached */
+	btm_CachedPage pages[BTM_MAXCACHEDPAGES]; /* the pages, in ascending order of 'pageNo' */
+	Two nRefs;                  /* # of swizzled references */
+	btm_SwizzledRef refs[BTM_MAXSWIZZLEDREFS]; /* the child references of the cached pages */
+} btm_UpperCache;
+
+
+/*****************************************************************
+ * Learned index - model of the leaf level of an SM_INT index     *
+ *****************************************************************/
+
+/*
+ * A read-mostly index on a single SM_INT part may keep a model of its leaf
+ * level in memory: linear segments mapping a key value to the number of
+ * its leaf, in key order, within BTM_LEARNEDERROR leaves. The first key
+ * value and the page of each leaf are kept with the segments. A lookup
+ * checks the leaf it finds against the key value and descends the tree
+ * if the leaf does not cover it. The models are protected by the buffer
+ * manager mutex.
+ */
+#define BTM_MAXLEARNEDINDEXES   16      /* # of indexes which have a model */
+#define BTM_MAXLEARNEDSEGMENTS  256     /* # of segments of a model at most */
+#define BTM_LEARNEDERROR        2       /* max. distance, in leaves, of a guess from the leaf */
+#define BTM_LEARNEDMINMISSES    64      /* # of misses before the model may be given up */
+
+/* Data type of a segment of a model */
+typedef struct {
+	Four firstKey;              /* key value where the segment starts */
+	Four firstLeaf;             /* number of the leaf of 'firstKey' */
+	double slope;               /* # of leaves per unit of the key value */
+} btm_LearnedSegment;
+
+/* Data type of the model of an index */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	Boolean stale;              /* TRUE if the model misses too often to be used */
+	PageID root;                /* root of the index */
+	Four nLeaves;               /* # of leaves when the model was built */
+	Four *keys;                 /* first key value of each leaf */
+	ShortPageID *leaves;        /* page of each leaf */
+	Two nSegments;              /* # of segments */
+	btm_LearnedSegment segments[BTM_MAXLEARNEDSEGMENTS]; /* the segments, in key order */
+	Four nLookups;              /* # of lookups by the model */
+	Four nMisses;               /* # of lookups which found a wrong leaf */
+} btm_LearnedIndex;
+
+
+/*****************************************************************
+ * Bloom filter - keys of an index, for the lookups of absent keys *
+ *****************************************************************/
+
+/*
+ * An index may keep a blocked Bloom filter of its key values: a key value
+ * sets BTM_BLOOMHASHES bits in one block of BTM_BLOOMBLOCK bytes chosen by
+ * its hash, so a probe touches a single block. The filter is kept in the
+ * pages listed by the meta page and, while the index is used, in memory.
+ * Every key value inserted is added before it goes into the tree, whether
+ * it reaches a leaf or a buffer; the deleted ones stay until the filter is
+ * built again. The filters in memory are protected by the buffer manager
+ * mutex.
+ */
+#define BTM_MAXBLOOMFILTERS     16      /* # of Bloom filters in memory at once */
+#define BTM_BLOOMBLOCK          64      /* # of bytes of a block */
+#define BTM_BLOOMHASHES         6       /* # of bits set by a key value */
+#define BTM_BLOOMBITSPERKEY     10      /* # of bits of a filter per key value when built */
+#define BTM_BLOOMBLOCKSPERPAGE  ((CONSTANT_CASTING_TYPE)((PAGESIZE-BF_FIXED)/BTM_BLOOMBLOCK))
+#define BTM_BLOOMMINFALSE       64      /* # of false positives before the filter may be rebuilt */
+
+/* Data type of a Bloom filter in memory */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	Boolean rebuild;            /* TRUE if the filter should be built again */
+	PageID root;                /* root of the index */
+	Four nBlocks;               /* # of blocks */
+	char *bits;                 /* the blocks */
+	Two nPages;                 /* # of pages holding the blocks */
+	ShortPageID pages[BTM_BLOOMMAXPAGES]; /* the pages, in block order */
+	Four nKeys;                 /* # of key values added since the filter was sized */
+	Four nAbsent;               /* # of probes answered negatively */
+	Four nFalse;                /* # of probes answered positively for an absent key value */
+} btm_BloomFilter;
+
+
+/*****************************************************************
+ * Result cache - positions of the key values looked up often     *
+ *****************************************************************/
+
+/*
+ * An index may remember where SM_EQ lookups found their key values: the
+ * leaf, the slot, the ObjectID and the version of the leaf at that time.
+ * A repeated lookup then checks the version of the leaf and the entry in
+ * the slot instead of searching the tree. The cache of an index has a
+ * fixed number of sets of BTM_RESULTCACHEWAYS entries; an entry is chosen
+ * in the set of the key value by the second chance policy. Only the key
+ * values of a single ObjectID and of at most BTM_RESULTCACHEKEYLEN bytes
+ * are cached. The caches are protected by the buffer manager mutex.
+ */
+#define BTM_MAXRESULTCACHES     16      /* # of indexes which have a result cache */
+#define BTM_RESULTCACHESETS     256     /* # of sets of a cache */
+#define BTM_RESULTCACHEWAYS     4       /* # of entries of a set */
+#define BTM_RESULTCACHEKEYLEN   32      /* max. length of a cached key value */
+
+/* Data type of an entry of a result cache */
+typedef struct {
+	Boolean valid;              /* TRUE if the entry holds a result */
+	Boolean referenced;         /* TRUE if used since the clock hand passed it */
+	ShortPageID leaf;           /* leaf holding the key value */
+	Two slotNo;                 /* slot of the key value in the leaf */
+	UFour version;              /* version of the leaf when the result was cached */
+	ObjectID oid;               /* ObjectID of the key value */
+	Two klen;                   /* length of the key value */
+	char kval[BTM_RESULTCACHEKEYLEN]; /* the key value */
+} btm_ResultEntry;
+
+/* Data type of a set of a result cache */
+typedef struct {
+	Two hand;                   /* the next entry to be considered for replacement */
+	btm_ResultEntry ways[BTM_RESULTCACHEWAYS]; /* the entries */
+} btm_ResultSet;
+
+/* Data type of the result cache of an index */
+typedef struct {
+	Boolean inUse;              /* TRUE if the entry is used */
+	PageID root;                /* root of the index */
+	btm_ResultSet *sets;        /* the sets, BTM_RESULTCACHESETS of them */
+	Four nHits;                 /* # of lookups answered by the cache */
+	Four nMisses;               /* # of lookups which had to search the tree */
+} btm_ResultCache;
+
+
+/*****************************************************************
+ * Interleaved lookups - a batch of SM_EQ lookups in lock step    *
+ *****************************************************************/
+
+/*
+ * A batch of independent lookups is run BTM_INTERLEAVEGROUP at a time.
+ * Each lookup in flight is a probe which goes down one level per step:
+ * it pins the next page, prefetches its header and slot array, and gives
+ * way to the other probes, so the page has been brought to the CPU cache
+ * by the time the probe reads it in its next step.
+ */
+#define BTM_INTERLEAVEGROUP     8       /* # of probes in flight */
+
+/* Data type of a probe */
+typedef struct {
+	Four item;                  /* item being looked up, NIL if the probe is idle */
+	PageID pid;                 /* page to be read in the next step */
+	BtreePage *page;            /* pointer to the buffer holding the page, pinned */
+	btm_CachedPage *entry;      /* the page in the cache of the upper levels, NULL if not cached */
+	UFour version;              /* version of the page when it was pinned */
+} btm_Probe;
+
 
 /*@
 ** Macro Definitions
 */
 
+/* Macro: BTM_INTERNALENTRY_LEN(klen)
+ * Description: return the length of an internal entry whose key length is given as a parameter
+ * Parameter:
+ *  Two klen        : key length of the entry
+ * Returns: (Two) length of the internal entry
+ */
+#define BTM_INTERNALENTRY_LEN(klen) \
+    ((Two)(sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + (klen))))
+
+/* Macro: BTM_LEAFENTRY_LEN(entry)
+ * Description: return the length of the leaf entry given as a parameter
+ *              (a negative 'nObjects' means that the ObjectIDs are kept in an overflow page list)
+ * Parameter:
+ *  btm_LeafEntry *entry    : pointer to the leaf entry
+ * Returns: (Two) length of the leaf entry
+ */
+#define BTM_LEAFENTRY_LEN(entry) \
+    ((Two)(BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH((entry)->klen) + \
+           (((entry)->nObjects < 0) ? sizeof(ShortPageID) : (entry)->nObjects*OBJECTID_SIZE)))
+
+/* Macro: BI_DATA_START(p)
+ * Description: return the offset in the data area where the internal entries of the page begin
+ * Parameter:
+ *  BtreeInternal *p      : pointer to the internal page
+ * Returns: (Two) BTM_MSGBUF_SIZE if the page has a message buffer, 0 otherwise
+ */
+#define BI_DATA_START(p)    (((p)->hdr.flags & BTM_MSGBUFFER) ? BTM_MSGBUF_SIZE : 0)
+
+/* Macro: BTM_MSGBUF_HDR(p)
+ * Description: return the header of the message buffer of the internal page
+ * Parameter:
+ *  BtreeInternal *p      : pointer to the internal page having a message buffer
+ * Returns: (btm_MsgBufferHdr*) header of the message buffer
+ */
+#define BTM_MSGBUF_HDR(p)   ((btm_MsgBufferHdr*)&((p)->data[0]))
+
+/* Macro: BTM_MESSAGE_LEN(klen)
+ * Description: return the length of a message whose key length is given as a parameter
+ * Parameter:
+ *  Two klen        : key length of the message
+ * Returns: (Two) length of the message
+ */
+#define BTM_MESSAGE_LEN(klen)   ((Two)ALIGNED_LENGTH(BTM_MESSAGE_FIXED + (klen)))
+
+/* Macro: BTM_CHANGERECORD_LEN(klen)
+ * Description: return the length of a change record whose key length is given as a parameter
+ * Parameter:
+ *  Two klen        : key length of the change
+ * Returns: (Two) length of the change record
+ */
+#define BTM_CHANGERECORD_LEN(klen)  ((Two)(BTM_CHANGERECORD_FIXED + BTM_MESSAGE_LEN(klen)))
+
+/* Macro: ERRTL(e, root)
+ * Description: release the buffer manager mutex and the exclusive latch of the tree, and return the error
+ * Parameters:
+ *  Four e          : error code
+ *  PageID *root    : root of the tree latched by the operation
+ */
+#define ERRTL(e, root) \
+BEGIN_MACRO \
+    PRTERR(e); \
+    edubtm_LeaveBfM(); \
+    (Four) edubtm_UnlatchTree(root); \
+    if (1) return(e); \
+END_MACRO
+
 /* Macro: GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry)
  * Description: get the information about the index file(sm_CatOverlayForBtree) residing in the catalog object for index file
  * Parameters:
@@ -320,18 +1026,111 @@ void edubtm_CompactInternalPage(BtreeInternal*, Two);
 void edubtm_CompactLeafPage(BtreeLeaf*, Two);
 Four edubtm_KeyCompare(KeyDesc*, KeyValue*, KeyValue*);
 Four edubtm_Delete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
-Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
-Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, Boolean*, InternalItem*);
+void edubtm_DeleteInternalEntries(BtreeInternal*, Two, Two);
+void edubtm_DeleteLeafEntries(BtreeLeaf*, Two, Two);
+Four edubtm_RepairUnderflow(ObjectID*, PageID*, KeyDesc*, KeyValue*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_MergeChild(ObjectID*, BtreePage*, KeyDesc*, Two, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Four, Boolean*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_CoupledInsert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Four, Boolean*, ObjectID*, Pool*, DeallocListElem*);
+Four edubtm_InsertWithMode(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Four, Boolean*, ObjectID*, Pool*, DeallocListElem*);
+Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*, ObjectID*, Four, Boolean*, ObjectID*, Boolean*, Boolean*, InternalItem*);
 Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*, Two, Boolean*, InternalItem*);
+Four edubtm_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four edubtm_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
 Four edubtm_FirstObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*);
 Four edubtm_FreePages(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
+Four edubtm_FreeSubtrees(PhysicalFileID*, BtreeInternal*, Two, Two, Pool*, DeallocListElem*);
+Four edubtm_DropTree(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
 Four edubtm_InitInternal(PageID*, Boolean, Boolean);
 Four edubtm_InitLeaf(PageID*, Boolean, Boolean);
 Four edubtm_LastObject(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*);
+Four edubtm_IsBufferedIndex(PageID*, Boolean*);
+Boolean edubtm_InitMsgBuffer(BtreeInternal*, ObjectID*);
+Boolean edubtm_AppendMessage(BtreeInternal*, Two, KeyValue*, ObjectID*);
+void edubtm_RemoveMessage(BtreeInternal*, Two);
+Two edubtm_HeaviestChild(BtreeInternal*, KeyDesc*);
+Four edubtm_SplitMsgBuffer(BtreeInternal*, InternalItem*, KeyDesc*);
+Four edubtm_DeliverMessages(ObjectID*, PageID*, KeyDesc*, char*, Two, Boolean, Two*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_FlushChild(ObjectID*, BtreeInternal*, KeyDesc*, Two, KeyValue*, KeyValue*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_FlushRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*);
+Four edubtm_FlushPendingMessages(PageID*, KeyDesc*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
+Four edubtm_UnbufferPage(ObjectID*, BtreeInternal*, KeyDesc*, Boolean*, InternalItem*);
+Four edubtm_ReleaseMsgBuffers(ObjectID*, BtreeInternal*, KeyDesc*, Two, Boolean*, Boolean*, InternalItem*);
+Four edubtm_SearchPending(PageID*, KeyDesc*, KeyValue*, Boolean*, ObjectID*);
+Four edubtm_BufferUpdate(ObjectID*, PageID*, KeyDesc*, Two, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four edubtm_GetMetaPage(ObjectID*, PageID*, Boolean, PageID*);
+Four edubtm_BufferLeafDelete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*);
+Four edubtm_GetEndLeaf(PageID*, Boolean, PageID*, BtreePage**, Boolean*);
+Four edubtm_SetEndLeaf(PageID*, Boolean, PageID*, BtreePage*);
+Four edubtm_NoteEndLeaves(ObjectID*, PageID*, ShortPageID, ShortPageID);
+Four edubtm_ForgetEndLeaves(PageID*);
+Four edubtm_AppendChange(ObjectID*, PageID*, ShortPageID, btm_Message*, Boolean*);
+Four edubtm_NewChangeBufferPage(ObjectID*, PageID*, PageID*);
+Four edubtm_MergeChanges(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four);
 Four edubtm_SplitInternal(ObjectID*, BtreeInternal*, Two, InternalItem*, InternalItem*);
 Four edubtm_SplitLeaf(ObjectID*, PageID*, BtreeLeaf*, Two, LeafItem*, InternalItem*);
 Four edubtm_get_objectid_from_leaf(BtreeCursor*);
 Four edubtm_root_insert(ObjectID*, PageID*, InternalItem*);
+Four edubtm_root_delete(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*);
+Four edubtm_SearchLeaf(PageID*, KeyDesc*, KeyValue*, Boolean, Four, btm_TreePath*, PageID*, BtreePage**);
+Four edubtm_PositionCursor(PageID*, BtreePage*, Two, Boolean, KeyDesc*, KeyValue*, Four, BtreeCursor*);
+Four edubtm_MoveRightToLeaf(PageID*, BtreePage**, KeyDesc*, KeyValue*, Boolean, Four);
+Boolean edubtm_UnlatchedSearchInternal(BtreeInternal*, KeyDesc*, KeyValue*, Boolean, Two*, ShortPageID*);
+
+void edubtm_InitLatchTable(void);
+Four edubtm_LatchPage(PageID*, Four);
+Four edubtm_UnlatchPage(PageID*);
+Four edubtm_LatchTree(PageID*, Four);
+Four edubtm_UnlatchTree(PageID*);
+Four edubtm_LatchIndex(PageID*, Four*);
+void edubtm_EnterBfM(void);
+void edubtm_LeaveBfM(void);
+Four edubtm_FixPage(PageID*, BtreePage**, Four);
+Four edubtm_UnfixPage(PageID*, Boolean);
+Boolean edubtm_ReadVersion(PageID*, UFour*);
+Boolean edubtm_ValidateVersion(PageID*, UFour);
+void edubtm_BumpVersion(PageID*);
+Four edubtm_PinPage(PageID*, BtreePage**);
+Four edubtm_UnpinPage(PageID*);
+Four edubtm_MoveToSibling(PageID*, BtreePage**, Boolean, Boolean*);
+Four edubtm_EnterUpperCache(PageID*, btm_UpperCache**);
+void edubtm_LeaveUpperCache(btm_UpperCache*);
+Four edubtm_PinUpperPage(btm_UpperCache*, PageID*, BtreePage**, btm_CachedPage**);
+Four edubtm_PinUpperChild(btm_UpperCache*, btm_CachedPage*, Two, PageID*, BtreePage**, btm_CachedPage**);
+Four edubtm_UnpinUpperPage(PageID*, Boolean);
+void edubtm_StaleUpperCache(PageID*);
+Four edubtm_ReleaseUpperCache(PageID*);
+Four edubtm_BuildLearnedIndex(PageID*, KeyDesc*);
+void edubtm_DropLearnedIndex(PageID*);
+Four edubtm_LearnedSearchLeaf(PageID*, KeyDesc*, KeyValue*, Four, PageID*, BtreePage**, Boolean*);
+Four edubtm_IsBloomFiltered(PageID*, Boolean*);
+Four edubtm_BuildBloomFilter(ObjectID*, PageID*, KeyDesc*);
+Four edubtm_AddToBloomFilter(PageID*, KeyValue*);
+Four edubtm_BloomFilterMayContain(PageID*, KeyValue*, Boolean*);
+void edubtm_NoteBloomFalsePositive(PageID*);
+Four edubtm_RefreshBloomFilter(PageID*, KeyDesc*);
+Four edubtm_DropBloomFilter(PageID*, Pool*, DeallocListElem*);
+void edubtm_HashKey(KeyValue*, UFour*, UFour*);
+Four edubtm_CreateResultCache(PageID*);
+void edubtm_DropResultCache(PageID*);
+Four edubtm_ResultCacheFetch(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four, BtreeCursor*, Boolean*);
+void edubtm_FillResultCache(PageID*, KeyValue*, PageID*, BtreePage*, Two);
+Four edubtm_InterleavedLookup(PageID*, KeyDesc*, Four, BatchItem*, Boolean*);
+Four edubtm_StartRange(PageID*, KeyDesc*, btm_FetchRange*, Boolean, Boolean*, PageID*, BtreePage**, Two*);
+Four edubtm_ReadRange(KeyDesc*, btm_FetchRange*, Four, PageID*, BtreePage**, Two*, Boolean*, btm_ScanCallback, void*);
+Four edubtm_SetRightLink(PageID*, BtreePage*, InternalItem*);
+Four edubtm_ClearRightLink(PageID*);
+Boolean edubtm_FollowRightLink(PageID*, BtreePage*, KeyDesc*, KeyValue*, Boolean, PageID*);
+Boolean edubtm_ReachesRightLink(PageID*, PageID*);
+Four edubtm_AllocLeafPage(ObjectID*, PageID*, PageID*);
+Four edubtm_ReleaseLeafRun(PhysicalFileID*, PageID*);
+Four edubtm_AllocIndexPage(ObjectID*, PageID*, PageID*);
+Four edubtm_RecyclePages(ObjectID*, PageID*, DeallocListElem*, Pool*, DeallocListElem*);
+Four edubtm_GetIndexFile(ObjectID*, PhysicalFileID*, Two*);
+Four edubtm_RegisterOnlineBuild(ObjectID*, PageID*, PageID*);
+Boolean edubtm_InOnlineBuild(PageID*);
+Four edubtm_LogSideChange(PageID*, Two, KeyValue*, ObjectID*, Boolean*);
+Four edubtm_ReplaySideLog(PageID*, KeyDesc*, Pool*, DeallocListElem*);
 
 Four btm_AllocPage(ObjectID*, PageID*, PageID*);
 Boolean btm_BinarySearchOidArray(ObjectID[], ObjectID*, Two, Two*);
@@ -350,12 +1149,31 @@ Four btm_IsTemporary(ObjectID*, Boolean*);
  * B+tree Manager Interface function prototypes
  */
 /*
+Four EduBtM_BeginOnlineBuild(ObjectID*, PageID*);
+Four EduBtM_BulkLoad(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Four, Pool*, DeallocListElem*);
 Four EduBtM_CreateIndex(ObjectID*, PageID*);
+Four EduBtM_DeleteBatch(ObjectID*, PageID*, KeyDesc*, Four, BatchItem*, Pool*, DeallocListElem*);
 Four EduBtM_DeleteObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_DeleteRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Pool*, DeallocListElem*);
 Four EduBtM_DropIndex(PhysicalFileID*, PageID*, Pool*, DeallocListElem*);
+Four EduBtM_EndOnlineBuild(PageID*, KeyDesc*, Pool*, DeallocListElem*);
 Four EduBtM_Fetch(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, BtreeCursor*);
+Four EduBtM_FetchBatch(PageID*, KeyDesc*, Four, BatchItem*, Boolean*);
+Four EduBtM_FetchMulti(PageID*, KeyDesc*, Four, btm_FetchRange*, btm_ScanCallback, void*);
 Four EduBtM_FetchNext(PageID*, KeyDesc*, KeyValue*, Four, BtreeCursor*, BtreeCursor*);
+Four EduBtM_InsertIfAbsent(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, ObjectID*, Pool*, DeallocListElem*);
 Four EduBtM_InsertObject(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_MergeChangeBuffer(PageID*, KeyDesc*, Four);
+Four EduBtM_ParallelScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, Four, Boolean, btm_ScanCallback, void*);
+Four EduBtM_Reorganize(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*);
+Four EduBtM_SetBloomFilter(ObjectID*, PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetBufferMode(PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetChangeBuffering(ObjectID*, PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetLearnedIndex(PageID*, KeyDesc*, Boolean);
+Four EduBtM_SetResultCache(PageID*, Boolean);
+Four EduBtM_SkipScan(PageID*, KeyDesc*, KeyValue*, Four, KeyValue*, Four, btm_ScanCallback, void*);
+Four EduBtM_UpdateKey(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, ObjectID*, Pool*, DeallocListElem*);
+Four EduBtM_Upsert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*, ObjectID*, Pool*, DeallocListElem*);
 */
 
 
@@ -71,7 +71,7 @@
 #define _EDUBTM_CREATEINDEX_	TRUE
 #define _EDUBTM_DROPINDEX_		TRUE
 #define _EDUBTM_INSERTOBJECT_	TRUE
-#define _EDUBTM_DELETEOBJECT_	FALSE
+#define _EDUBTM_DELETEOBJECT_	TRUE
 #define _EDUBTM_FETCH_			TRUE
 #define _EDUBTM_FETCHNEXT_		TRUE
 
@@ -143,6 +143,7 @@ Four LRDS_FreeHandle(Four);
 Four LRDS_Final(void);
 
 Four EduBtM_Test(Four, Four);
+Four EduBtM_FeatureTest(Four, Four);
 
 
 #endif /* _EDUBTM_TESTMODULE_H_ */
@@ -60,7 +60,7 @@
  */
 #define PRTERR(e) \
 BEGIN_MACRO \
-Util_ErrorLog_Printf("Error : %d(%s) in %s:%d\n", ((Four_Invariable)(e)), Err_GetErrName(e), __FILE__, __LINE__); \
+Util_ErrorLog_Printf("Error : %d(%s) in %s:%d\n", ((Four_Invariable)(e)), edubtm_GetErrName(e), __FILE__, __LINE__); \
 END_MACRO
 
 #define ERR(e) \
@@ -87,6 +87,7 @@ END_MACRO
  * Function Prototypes
  */
 char *Err_GetErrName(Four);
+char *edubtm_GetErrName(Four);
 
 
 #endif /* __EDUBTM_ERROR_H__ */
@@ -78,5 +78,15 @@
 #define eNOSUCHTREELATCH_BTM                     ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,10)
 #define eDELETEOBJECTFAILED_BTM                  ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,11)
 #define eBADCACHETREELATCHCELLPTR_BTM            ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,12)
-#define NUM_ERRORS_BTM_ERR_BASE                  13
+#define NUM_COSMOS_ERRORS_BTM_ERR_BASE           13
+
+/*
+ * Error Definitions of EduBtM for BTM_ERR_BASE
+ * (their names are given by edubtm_GetErrName(), not by the COSMOS library)
+ */
 #define eNOTSUPPORTED_EDUBTM                     ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,14)
+#define eMEMORYALLOCERR_BTM                      ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,15)
+#define eLATCHTABLEFULL_BTM                      ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,16)
+#define eRIGHTLINKTABLEFULL_BTM                  ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,17)
+#define eONLINEBUILDTABLEFULL_BTM                ERR_ENCODE_ERROR_CODE(BTM_ERR_BASE,18)
+#define NUM_ERRORS_BTM_ERR_BASE                  19
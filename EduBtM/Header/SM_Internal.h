@@ -60,4 +60,12 @@
 extern VarArray smTmpFileIdTable;         /* temporary file ID table */
 
 
+/*@
+** Function Prototypes
+*/
+Four SM_CreateFile(Four, FileID*, Boolean, void*);
+Four SM_DestroyFile(FileID*, void*);
+Four sm_GetCatalogEntryFromDataFileId(Four, FileID*, ObjectID*);
+
+
 #endif /* _SM_INTERNAL_H_ */
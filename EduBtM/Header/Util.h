@@ -54,6 +54,7 @@
 
 
 Four Util_getElementFromPool(Pool*, void*);
+Four Util_freeElementToPool(Pool*, void*);
 
 
 #endif /* _UTIL_H_ */
@@ -0,0 +1,439 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_BLink.c
+ *
+ * Description :
+ *  B-link right links of the pages split by the latch-coupled inserts.
+ *  A split page keeps the link to its new right page, with the separator as
+ *  the high key, until the separator is posted to the parent; meanwhile a
+ *  search which lands on the page for a key value not less than the high
+ *  key moves right instead of restarting. The links are kept in a table
+ *  keyed by the page split, and the page is marked with BTM_SPLITPENDING so
+ *  that the table is looked up only for such pages.
+ *
+ * Exports:
+ *  Four edubtm_SetRightLink(PageID*, BtreePage*, InternalItem*)
+ *  Four edubtm_ClearRightLink(PageID*)
+ *  Boolean edubtm_FollowRightLink(PageID*, BtreePage*, KeyDesc*, KeyValue*, Boolean, PageID*)
+ *  Boolean edubtm_ReachesRightLink(PageID*, PageID*)
+ */
+
+
+#include <string.h>
+#include <pthread.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_RightLinkTable btm_rightLinkTable;                          /* the right link table */
+pthread_once_t btm_rightLinkTableOnce = PTHREAD_ONCE_INIT;      /* initializes the table once */
+
+
+/*@ Internal Function Prototypes */
+void edubtm_InitRightLinkTable(void);
+Four edubtm_LookupRightLink(PageID*, Four*);
+
+
+/*@ Macro: BTM_RIGHTLINK_HASH(pid)
+ * Description: return the hash value of the right link of a page
+ */
+#define BTM_RIGHTLINK_HASH(pid) \
+    ((Four)(((unsigned)(pid)->volNo*31 + (unsigned)(pid)->pageNo) % BTM_RIGHTLINK_HASHSIZE))
+
+
+
+/*@================================
+ * edubtm_InitRightLinkTable()
+ *================================*/
+/*
+ * Function: void edubtm_InitRightLinkTable(void)
+ *
+ * Description:
+ *  Initialize the right link table. It is called once through
+ *  pthread_once(), before the table is used first.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_InitRightLinkTable(void)
+{
+    Four                        i;              /* index */
+
+
+    pthread_mutex_init(&btm_rightLinkTable.mutex, NULL);
+
+    for (i = 0; i < BTM_RIGHTLINK_HASHSIZE; i++)
+        btm_rightLinkTable.hashTable[i] = NIL;
+
+    for (i = 0; i < BTM_MAXRIGHTLINKS; i++)
+        btm_rightLinkTable.entries[i].next = (i < BTM_MAXRIGHTLINKS-1) ? i+1 : NIL;
+    btm_rightLinkTable.freeList = 0;
+
+}   /* edubtm_InitRightLinkTable() */
+
+
+
+/*@================================
+ * edubtm_LookupRightLink()
+ *================================*/
+/*
+ * Function: Four edubtm_LookupRightLink(PageID*, Four*)
+ *
+ * Description:
+ *  Find the right link of the given page. The caller should be in the
+ *  mutex of the table.
+ *
+ * Returns:
+ *  index of the entry, NIL if the page has no right link
+ *
+ * Side effects:
+ *  prev : index of the previous entry in the hash chain, NIL if none
+ */
+Four edubtm_LookupRightLink(
+    PageID                      *pid,           /* IN page split */
+    Four                        *prev)          /* OUT previous entry in the hash chain */
+{
+    Four                        i;              /* index of the entry */
+    btm_RightLink               *link;          /* entry of the right link */
+
+
+    *prev = NIL;
+    for (i = btm_rightLinkTable.hashTable[BTM_RIGHTLINK_HASH(pid)]; i != NIL; *prev = i, i = link->next) {
+        link = &btm_rightLinkTable.entries[i];
+        if (link->pid.pageNo == pid->pageNo && link->pid.volNo == pid->volNo) break;
+    }
+
+    return(i);
+
+}   /* edubtm_LookupRightLink() */
+
+
+
+/*@================================
+ * edubtm_SetRightLink()
+ *================================*/
+/*
+ * Function: Four edubtm_SetRightLink(PageID*, BtreePage*, InternalItem*)
+ *
+ * Description:
+ *  Link the given page, which has just been split, to its new right page
+ *  given by 'item'. The caller holds the exclusive latch of the page and has
+ *  not released it since the split, so no one else knows the new page yet.
+ *  If the split of the page was already pending, the new page lies between
+ *  the page and its old right page; the old link is handed over to the new
+ *  page.
+ *
+ * Returns:
+ *  error code
+ *    eRIGHTLINKTABLEFULL_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_SetRightLink(
+    PageID                      *pid,           /* IN page split, latched exclusively */
+    BtreePage                   *apage,         /* INOUT pointer to the buffer holding the page */
+    InternalItem                *item)          /* IN entry of the new page for the parent */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of the entry */
+    Four                        prev;           /* previous entry in the hash chain */
+    Four                        hashValue;      /* hash value of the right link */
+    PageID                      right;          /* the new page */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the new page */
+    btm_RightLink               *link;          /* entry of the right link */
+
+
+    pthread_once(&btm_rightLinkTableOnce, edubtm_InitRightLinkTable);
+
+    MAKE_PAGEID(right, pid->volNo, item->spid);
+
+    if (apage->any.hdr.flags & BTM_SPLITPENDING) {
+        /* The new page takes over the pending split of the page */
+        if ((e = edubtm_FixPage(&right, &rpage, BTM_LATCH_X)) < 0) ERR(e);
+        rpage->any.hdr.flags |= BTM_SPLITPENDING;
+        if ((e = edubtm_UnfixPage(&right, TRUE)) < 0) ERR(e);
+
+        pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+        i = edubtm_LookupRightLink(pid, &prev);
+        if (i != NIL) {
+            link = &btm_rightLinkTable.entries[i];
+            if (prev == NIL)
+                btm_rightLinkTable.hashTable[BTM_RIGHTLINK_HASH(pid)] = link->next;
+            else
+                btm_rightLinkTable.entries[prev].next = link->next;
+
+            hashValue = BTM_RIGHTLINK_HASH(&right);
+            link->pid = right;
+            link->next = btm_rightLinkTable.hashTable[hashValue];
+            btm_rightLinkTable.hashTable[hashValue] = i;
+        }
+
+        pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+    }
+
+    pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+    if (btm_rightLinkTable.freeList == NIL) {
+        pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+        ERR(eRIGHTLINKTABLEFULL_BTM);
+    }
+
+    i = btm_rightLinkTable.freeList;
+    link = &btm_rightLinkTable.entries[i];
+    btm_rightLinkTable.freeList = link->next;
+
+    link->pid = *pid;
+    link->rightPage = item->spid;
+    link->highKey.len = item->klen;
+    memcpy(link->highKey.val, item->kval, item->klen);
+
+    hashValue = BTM_RIGHTLINK_HASH(pid);
+    link->next = btm_rightLinkTable.hashTable[hashValue];
+    btm_rightLinkTable.hashTable[hashValue] = i;
+
+    apage->any.hdr.flags |= BTM_SPLITPENDING;
+
+    pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+    return(eNOERROR);
+
+}   /* edubtm_SetRightLink() */
+
+
+
+/*@================================
+ * edubtm_ClearRightLink()
+ *================================*/
+/*
+ * Function: Four edubtm_ClearRightLink(PageID*)
+ *
+ * Description:
+ *  Remove the right link to the given page after its separator has been
+ *  posted to the parent. The page linking to it may change meanwhile by
+ *  another split handing the link over, so it is looked up again after
+ *  the page is latched. The caller should hold no page latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ClearRightLink(
+    PageID                      *right)         /* IN page whose separator is posted */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of the entry */
+    Four                        prev;           /* previous entry in the hash chain */
+    Four                        h;              /* index of the hash chain */
+    PageID                      pid;            /* page linking to 'right' */
+    BtreePage                   *apage;         /* pointer to the buffer holding the page */
+    btm_RightLink               *link;          /* entry of the right link */
+
+
+    pthread_once(&btm_rightLinkTableOnce, edubtm_InitRightLinkTable);
+
+    for (;;) {
+        /* Which page links to 'right' now? */
+        pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+        for (h = 0, i = NIL; h < BTM_RIGHTLINK_HASHSIZE && i == NIL; h++)
+            for (i = btm_rightLinkTable.hashTable[h]; i != NIL; i = btm_rightLinkTable.entries[i].next)
+                if (btm_rightLinkTable.entries[i].rightPage == right->pageNo &&
+                    btm_rightLinkTable.entries[i].pid.volNo == right->volNo) break;
+
+        if (i == NIL) {
+            pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+            return(eNOERROR);
+        }
+
+        pid = btm_rightLinkTable.entries[i].pid;
+
+        pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+        if ((e = edubtm_FixPage(&pid, &apage, BTM_LATCH_X)) < 0) ERR(e);
+
+        pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+        i = edubtm_LookupRightLink(&pid, &prev);
+        link = (i != NIL) ? &btm_rightLinkTable.entries[i] : NULL;
+
+        if (link != NULL && link->rightPage == right->pageNo) {
+            if (prev == NIL)
+                btm_rightLinkTable.hashTable[BTM_RIGHTLINK_HASH(&pid)] = link->next;
+            else
+                btm_rightLinkTable.entries[prev].next = link->next;
+
+            link->next = btm_rightLinkTable.freeList;
+            btm_rightLinkTable.freeList = i;
+
+            apage->any.hdr.flags &= ~BTM_SPLITPENDING;
+
+            pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+            if ((e = edubtm_UnfixPage(&pid, TRUE)) < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+
+        /* The link has moved to another page */
+        pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+    }
+
+}   /* edubtm_ClearRightLink() */
+
+
+
+/*@================================
+ * edubtm_FollowRightLink()
+ *================================*/
+/*
+ * Function: Boolean edubtm_FollowRightLink(PageID*, BtreePage*, KeyDesc*,
+ *                                          KeyValue*, Boolean, PageID*)
+ *
+ * Description:
+ *  Decide whether a search for the given key value which has landed on the
+ *  given page should move right. If 'kval' is NULL, the search for the last
+ *  leaf moves right ('last' is TRUE) and the search for the first one does
+ *  not. The page may be read optimistically; then the caller validates the
+ *  version of the page before it uses the result.
+ *
+ * Returns:
+ *  TRUE if the search should move to 'right'; FALSE otherwise
+ *
+ * Side effects:
+ *  right : the right page when TRUE is returned
+ */
+Boolean edubtm_FollowRightLink(
+    PageID                      *pid,           /* IN page where the search is */
+    BtreePage                   *apage,         /* IN pointer to the buffer holding the page */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last leaf */
+    Boolean                     last,           /* IN TRUE for the last leaf when 'kval' is NULL */
+    PageID                      *right)         /* OUT the right page */
+{
+    Four                        i;              /* index of the entry */
+    Four                        prev;           /* previous entry in the hash chain */
+    Boolean                     move;           /* TRUE if the search moves right */
+    btm_RightLink               *link;          /* entry of the right link */
+
+
+    if (!(apage->any.hdr.flags & BTM_SPLITPENDING)) return(FALSE);
+
+    pthread_once(&btm_rightLinkTableOnce, edubtm_InitRightLinkTable);
+
+    pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+    move = FALSE;
+    if ((i = edubtm_LookupRightLink(pid, &prev)) != NIL) {
+        link = &btm_rightLinkTable.entries[i];
+
+        if (kval == NULL) move = last;
+        else move = (edubtm_KeyCompare(kdesc, kval, &(link->highKey)) != LESS) ? TRUE : FALSE;
+
+        if (move) MAKE_PAGEID(*right, pid->volNo, link->rightPage);
+    }
+
+    pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+    return(move);
+
+}   /* edubtm_FollowRightLink() */
+
+
+
+/*@================================
+ * edubtm_ReachesRightLink()
+ *================================*/
+/*
+ * Function: Boolean edubtm_ReachesRightLink(PageID*, PageID*)
+ *
+ * Description:
+ *  Check whether the chain of the right links starting at the given page
+ *  reaches the page 'right'. The separator of 'right' belongs to the parent
+ *  in which the key of the separator leads to such a page.
+ *
+ * Returns:
+ *  TRUE if 'right' is reached; FALSE otherwise
+ */
+Boolean edubtm_ReachesRightLink(
+    PageID                      *pid,           /* IN first page of the chain */
+    PageID                      *right)         /* IN page to be reached */
+{
+    Four                        i;              /* index of the entry */
+    Four                        n;              /* # of links followed */
+    Four                        prev;           /* previous entry in the hash chain */
+    Boolean                     reached;        /* TRUE if 'right' is reached */
+    PageID                      cur;            /* current page of the chain */
+
+
+    pthread_once(&btm_rightLinkTableOnce, edubtm_InitRightLinkTable);
+
+    pthread_mutex_lock(&btm_rightLinkTable.mutex);
+
+    reached = FALSE;
+    cur = *pid;
+    for (n = 0; n < BTM_MAXRIGHTLINKS; n++) {
+        if ((i = edubtm_LookupRightLink(&cur, &prev)) == NIL) break;
+
+        cur.pageNo = btm_rightLinkTable.entries[i].rightPage;
+        if (cur.pageNo == right->pageNo) {
+            reached = TRUE;
+            break;
+        }
+    }
+
+    pthread_mutex_unlock(&btm_rightLinkTable.mutex);
+
+    return(reached);
+
+}   /* edubtm_ReachesRightLink() */
@@ -115,61 +115,24 @@ Boolean edubtm_BinarySearchInternal(
     /**/
     *idx = -1;
     low = 0;
-    high = ipage->hdr.nSlots;
-    if( high == 0 ) return FALSE;
-    mid = (high+low)/2; 
+    high = ipage->hdr.nSlots - 1;
 
-    do{        
-        entry = (btm_InternalEntry *)((char*)(ipage->data) + ipage->slot[-mid]);
-//        printf("\nkey1 : %d, CompareKey : %d\n", *(Four *)&(kval->val), *(Four *)&(entry->kval));        
-        cmp = btm_KeyCompare(kdesc, kval, (KeyValue *)(&(entry->klen)));
+    /* key(0 .. low-1) < key < key(high+1 .. nSlots-1) */
+    while (low <= high) {
+        mid = (low + high) / 2;
+        entry = (btm_InternalEntry *)&(ipage->data[ipage->slot[-mid]]);
+        cmp = edubtm_KeyCompare(kdesc, kval, (KeyValue *)(&(entry->klen)));
 
-        if(cmp == EQUAL){
+        if (cmp == EQUAL) {
             *idx = mid;
             return TRUE;
         }
-
-        else if (cmp == GREATER) low = mid;        
-        else if (cmp == LESS) high = mid;
-        mid = (high+low)/2;      
-
-    } while(low < mid);
-
-    if (cmp == GREATER) *idx = mid;
-
-    else{
-        entry = (btm_InternalEntry *)((char*)(ipage->data) + ipage->slot[-mid]);
-        cmp = btm_KeyCompare(kdesc, kval, (KeyValue *)(&(entry->klen)));
-        if (cmp == GREATER)
-            *idx = mid;
-        else if (cmp == LESS)
-            *idx = -1;
+        else if (cmp == GREATER) low = mid + 1;
+        else high = mid - 1;
     }
-/*
-    printf("DBG : key = ");
-    for (int i = 0; i < kval->len; i++){
-        printf("%c", *(char *)(kval->val + i));
-    }
-    printf("\n");
-    if (cmp == GREATER){
-        printf(", cmp = ");
-            for (int i = 0; i < ((KeyValue *)(&(entry->klen)))->len; i++){
-                printf("%c", *(char *)(((KeyValue *)(&(entry->klen)))->val + i));
-            }
-        printf("\n");
 
-        entry = (btm_InternalEntry *)((char*)(ipage->data) + ipage->slot[-(mid+1)]);
-        printf(", cmp = ");
-            for (int i = 0; i < ((KeyValue *)(&(entry->klen)))->len; i++){
-                printf("%c", *(char *)(((KeyValue *)(&(entry->klen)))->val + i));
-            }
-        printf("\n");
-
-    }
-    
-    if (cmp == LESS)
-        printf(" is the smllest\n");*/
-    //printf("low : %d, mid : %d, high : %d, idx : %d, cmp : %d\n",low,mid,high,*idx,cmp);
+    /* 'high' is the last slot whose key is less than the given key, -1 if none */
+    *idx = high;
 
     return FALSE;
     /**/    
@@ -219,51 +182,26 @@ Boolean edubtm_BinarySearchLeaf(
             ERR(eNOTSUPPORTED_EDUBTM);
     }
     /**/
-    /*  Integrity Constraints
-
-    mid = (high+low)/2 (=low when high=low+1)
-    low <= mid < high
-    key(low) < key < key(high)
-    if( key(mid) < key ) low = mid,
-    if( key(mid) > key ) high = mid 
-    key(mid) <= key < key(high)
-    if high = low + 1 = mid + 1, break & return high
-    */
-
     *idx = -1;
     low = 0;
-    high = lpage->hdr.nSlots;
-    if( high == 0 ) return FALSE;
-    mid = (high+low)/2; 
+    high = lpage->hdr.nSlots - 1;
 
-    do{        
-        entry = (btm_LeafEntry *)(&(lpage->data[lpage->slot[-mid]]));
-//        printf("\nkey1 : %d, CompareKey : %d\n", *(Four *)&(kval->val), *(Four *)&(entry->kval));        
-        cmp = btm_KeyCompare(kdesc,kval,(KeyValue *)(&(entry->klen)));
+    /* key(0 .. low-1) < key < key(high+1 .. nSlots-1) */
+    while (low <= high) {
+        mid = (low + high) / 2;
+        entry = (btm_LeafEntry *)&(lpage->data[lpage->slot[-mid]]);
+        cmp = edubtm_KeyCompare(kdesc, kval, (KeyValue *)(&(entry->klen)));
 
-        if(cmp == EQUAL){
+        if (cmp == EQUAL) {
             *idx = mid;
             return TRUE;
         }
-
-        else if (cmp == GREATER) low = mid;        
-        else if (cmp == LESS) high = mid;
-        mid = (high+low)/2;      
-
-    }while(low < mid);
-
-    if (cmp == GREATER) *idx = mid;
-
-    else{
-        entry = (btm_LeafEntry *)((char*)(lpage->data) + lpage->slot[-mid]);
-        cmp = btm_KeyCompare(kdesc, kval, (KeyValue *)(&(entry->klen)));
-        if (cmp == GREATER)
-            *idx = mid;
-        else if (cmp == LESS)
-            *idx = -1;
+        else if (cmp == GREATER) low = mid + 1;
+        else high = mid - 1;
     }
 
-//    printf("low : %d, mid : %d, high : %d, idx : %d, cmp : %d\n",low,mid,high,*idx,cmp);
+    /* 'high' is the last slot whose key is less than the given key, -1 if none */
+    *idx = high;
 
     return FALSE;
     /**/    
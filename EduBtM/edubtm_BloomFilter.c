@@ -0,0 +1,890 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_BloomFilter.c
+ *
+ * Description :
+ *  Bloom filter of the key values of an index. Many lookups are for key
+ *  values which do not exist, and each of them used to go down to a leaf,
+ *  often reading it from the disk. With a filter, EduBtM_Fetch() answers
+ *  most of them from memory.
+ *
+ *  The filter is blocked: the hash of a key value chooses a block of
+ *  BTM_BLOOMBLOCK bytes and BTM_BLOOMHASHES bits in it. The blocks are
+ *  stored in the pages listed by the meta page, and each insert sets its
+ *  bits in the page as well as in memory, so the filter survives restarts.
+ *  It is read into memory by the first operation which needs it.
+ *
+ *  The bits of the deleted key values are never cleared; together with
+ *  the inserts beyond the size the filter was built for, they raise the
+ *  rate of false positives. When the lookups see too many of them, the
+ *  filter is marked, and the next lookup builds it again from the leaves.
+ *
+ * Exports:
+ *  Four edubtm_IsBloomFiltered(PageID*, Boolean*)
+ *  Four edubtm_BuildBloomFilter(ObjectID*, PageID*, KeyDesc*)
+ *  Four edubtm_AddToBloomFilter(PageID*, KeyValue*)
+ *  Four edubtm_BloomFilterMayContain(PageID*, KeyValue*, Boolean*)
+ *  void edubtm_NoteBloomFalsePositive(PageID*)
+ *  Four edubtm_RefreshBloomFilter(PageID*, KeyDesc*)
+ *  Four edubtm_DropBloomFilter(PageID*, Pool*, DeallocListElem*)
+ *  void edubtm_HashKey(KeyValue*, UFour*, UFour*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_BloomFilter btm_bloomFilters[BTM_MAXBLOOMFILTERS];  /* the filters in memory, in the buffer manager mutex */
+
+
+/*@ Internal Function Prototypes */
+btm_BloomFilter *edubtm_LookupBloomFilter(PageID*);
+Four edubtm_LoadBloomFilter(PageID*, btm_BloomFilter**);
+void edubtm_SetBloomBits(char*, UFour);
+Boolean edubtm_TestBloomBits(char*, UFour);
+Four edubtm_ReadKeyHashes(PageID*, Four*, UFour**);
+Four edubtm_WriteBloomFilter(ObjectID*, PageID*, btm_BloomFilter*);
+
+
+
+/*@================================
+ * edubtm_LookupBloomFilter()
+ *================================*/
+/*
+ * Function: btm_BloomFilter *edubtm_LookupBloomFilter(PageID*)
+ *
+ * Description:
+ *  Find the filter of the index in memory. The caller should be in the
+ *  buffer manager mutex.
+ *
+ * Returns:
+ *  the filter, or NULL if it is not in memory
+ */
+btm_BloomFilter *edubtm_LookupBloomFilter(
+    PageID                      *root)          /* IN root of the index */
+{
+    Two                         i;              /* index of the table */
+
+
+    for (i = 0; i < BTM_MAXBLOOMFILTERS; i++) {
+        if (btm_bloomFilters[i].inUse &&
+            btm_bloomFilters[i].root.volNo == root->volNo && btm_bloomFilters[i].root.pageNo == root->pageNo)
+            return(&btm_bloomFilters[i]);
+    }
+
+    return(NULL);
+
+}   /* edubtm_LookupBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_IsBloomFiltered()
+ *================================*/
+/*
+ * Function: Four edubtm_IsBloomFiltered(PageID*, Boolean*)
+ *
+ * Description:
+ *  Check whether the index keeps a Bloom filter. The caller should be in
+ *  the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_IsBloomFiltered(
+    PageID                      *root,          /* IN root of the Btree */
+    Boolean                     *filtered)      /* OUT TRUE if the index has a filter */
+{
+    Four                        e;              /* error number */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    *filtered = (apage->any.hdr.flags & BTM_BLOOMFILTERED) ? TRUE : FALSE;
+
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_IsBloomFiltered() */
+
+
+
+/*@================================
+ * edubtm_LoadBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_LoadBloomFilter(PageID*, btm_BloomFilter**)
+ *
+ * Description:
+ *  Get the filter of the index in memory, reading it from its pages if it
+ *  is not there yet. The caller should be in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  bf : the filter, NULL if the index has none or the table is full
+ */
+Four edubtm_LoadBloomFilter(
+    PageID                      *root,          /* IN root of the index */
+    btm_BloomFilter             **bf)           /* OUT the filter in memory */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the table or of the pages */
+    Four                        nBlocks;        /* # of blocks in a page */
+    Boolean                     filtered;       /* TRUE if the index has a filter */
+    PageID                      metaPid;        /* meta page of the index */
+    PageID                      pid;            /* a page of the filter */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreePage                   *apage;         /* pointer to the buffer holding a page of the filter */
+    btm_BloomFilter             *freeFilter;    /* an unused entry */
+
+
+    if ((*bf = edubtm_LookupBloomFilter(root)) != NULL) return(eNOERROR);
+
+    if ((e = edubtm_IsBloomFiltered(root, &filtered)) < 0) ERR(e);
+    if (!filtered) return(eNOERROR);
+
+    freeFilter = NULL;
+    for (i = 0; i < BTM_MAXBLOOMFILTERS; i++)
+        if (!btm_bloomFilters[i].inUse) { freeFilter = &btm_bloomFilters[i]; break; }
+
+    /* The lookups go to the tree; the inserts update the pages */
+    if (freeFilter == NULL) return(eNOERROR);
+
+    if ((e = edubtm_GetMetaPage(NULL, root, FALSE, &metaPid)) < 0) ERR(e);
+    if (metaPid.pageNo == NIL) return(eNOERROR);
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    freeFilter->nBlocks = mpage->hdr.bfBlocks;
+    freeFilter->nKeys = mpage->hdr.bfKeys;
+    freeFilter->nPages = mpage->hdr.bfNPages;
+    memcpy(freeFilter->pages, mpage->bfPages, sizeof(ShortPageID)*mpage->hdr.bfNPages);
+
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    if (freeFilter->nBlocks == 0) return(eNOERROR);
+
+    if ((freeFilter->bits = (char*)malloc(freeFilter->nBlocks*BTM_BLOOMBLOCK)) == NULL) ERR(eMEMORYALLOCERR_BTM);
+
+    for (i = 0; i*BTM_BLOOMBLOCKSPERPAGE < freeFilter->nBlocks; i++) {
+        MAKE_PAGEID(pid, root->volNo, freeFilter->pages[i]);
+        nBlocks = MIN(BTM_BLOOMBLOCKSPERPAGE, freeFilter->nBlocks - i*BTM_BLOOMBLOCKSPERPAGE);
+
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) {
+            free(freeFilter->bits);
+            ERR(e);
+        }
+        memcpy(&(freeFilter->bits[i*BTM_BLOOMBLOCKSPERPAGE*BTM_BLOOMBLOCK]), apage->bf.data, nBlocks*BTM_BLOOMBLOCK);
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) {
+            free(freeFilter->bits);
+            ERR(e);
+        }
+    }
+
+    freeFilter->inUse = TRUE;
+    freeFilter->rebuild = FALSE;
+    freeFilter->root = *root;
+    freeFilter->nAbsent = 0;
+    freeFilter->nFalse = 0;
+    *bf = freeFilter;
+
+    return(eNOERROR);
+
+}   /* edubtm_LoadBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_HashKey()
+ *================================*/
+/*
+ * Function: void edubtm_HashKey(KeyValue*, UFour*, UFour*)
+ *
+ * Description:
+ *  Hash the bytes of the key value twice: 'h1' chooses the block, and 'h2'
+ *  the bits in the block.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_HashKey(
+    KeyValue                    *kval,          /* IN key value */
+    UFour                       *h1,            /* OUT hash choosing the block */
+    UFour                       *h2)            /* OUT hash choosing the bits */
+{
+    Two                         i;              /* index of the bytes */
+
+
+    /* FNV-1a, and the same bytes with another basis and a final mix */
+    *h1 = 2166136261U;
+    *h2 = 0x9747b28cU;
+    for (i = 0; i < kval->len; i++) {
+        *h1 = (*h1 ^ (unsigned char)kval->val[i]) * 16777619U;
+        *h2 = (*h2 ^ (unsigned char)kval->val[i]) * 0x5bd1e995U;
+        *h2 ^= *h2 >> 15;
+    }
+    *h2 ^= *h2 >> 13;
+    *h2 *= 0xc2b2ae35U;
+    *h2 ^= *h2 >> 16;
+
+}   /* edubtm_HashKey() */
+
+
+
+/*@================================
+ * edubtm_SetBloomBits()
+ *================================*/
+/*
+ * Function: void edubtm_SetBloomBits(char*, UFour)
+ *
+ * Description:
+ *  Set the bits of the key value in the block. The bits are taken by
+ *  double hashing from the two halves of 'h2'.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SetBloomBits(
+    char                        *block,         /* INOUT the block */
+    UFour                       h2)             /* IN hash choosing the bits */
+{
+    Two                         i;              /* # of bits set */
+    UFour                       bit;            /* a bit of the block */
+
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++) {
+        bit = ((h2 & 0xffff) + i*((h2 >> 16) | 1)) % (BTM_BLOOMBLOCK*8);
+        block[bit/8] |= (char)(1 << (bit%8));
+    }
+
+}   /* edubtm_SetBloomBits() */
+
+
+
+/*@================================
+ * edubtm_TestBloomBits()
+ *================================*/
+/*
+ * Function: Boolean edubtm_TestBloomBits(char*, UFour)
+ *
+ * Description:
+ *  Check the bits of the key value in the block, chosen as by
+ *  edubtm_SetBloomBits(...).
+ *
+ * Returns:
+ *  TRUE if all the bits are set
+ */
+Boolean edubtm_TestBloomBits(
+    char                        *block,         /* IN the block */
+    UFour                       h2)             /* IN hash choosing the bits */
+{
+    Two                         i;              /* # of bits tested */
+    UFour                       bit;            /* a bit of the block */
+
+
+    for (i = 0; i < BTM_BLOOMHASHES; i++) {
+        bit = ((h2 & 0xffff) + i*((h2 >> 16) | 1)) % (BTM_BLOOMBLOCK*8);
+        if (!(block[bit/8] & (char)(1 << (bit%8)))) return(FALSE);
+    }
+
+    return(TRUE);
+
+}   /* edubtm_TestBloomBits() */
+
+
+
+/*@================================
+ * edubtm_AddToBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_AddToBloomFilter(PageID*, KeyValue*)
+ *
+ * Description:
+ *  Add the key value to the filter of the index, if any, in memory and in
+ *  the page holding its block. An insert calls this under the tree latch
+ *  before the key value goes into the tree, so a lookup never misses it.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_AddToBloomFilter(
+    PageID                      *root,          /* IN root of the index */
+    KeyValue                    *kval)          /* IN key value inserted */
+{
+    Four                        e;              /* error number */
+    Four                        blk;            /* block of the key value */
+    UFour                       h1, h2;         /* hashes of the key value */
+    PageID                      metaPid;        /* meta page of the index */
+    PageID                      pid;            /* page holding the block */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the page of the block */
+    btm_BloomFilter             *bf;            /* the filter in memory */
+
+
+    edubtm_EnterBfM();
+
+    if ((e = edubtm_LoadBloomFilter(root, &bf)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    edubtm_HashKey(kval, &h1, &h2);
+
+    if (bf != NULL) {
+        if (bf->nBlocks == 0) { edubtm_LeaveBfM(); return(eNOERROR); }
+
+        blk = h1 % bf->nBlocks;
+        edubtm_SetBloomBits(&(bf->bits[blk*BTM_BLOOMBLOCK]), h2);
+        bf->nKeys++;
+        MAKE_PAGEID(pid, root->volNo, bf->pages[blk/BTM_BLOOMBLOCKSPERPAGE]);
+    }
+    else {
+        /* The filter could not be kept in memory; only its page is updated */
+        if ((e = edubtm_GetMetaPage(NULL, root, FALSE, &metaPid)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+        if (metaPid.pageNo == NIL) { edubtm_LeaveBfM(); return(eNOERROR); }
+
+        if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+        if (mpage->hdr.bfBlocks == 0) {
+            e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF);
+            edubtm_LeaveBfM();
+            if (e < 0) ERR(e);
+            return(eNOERROR);
+        }
+        blk = h1 % mpage->hdr.bfBlocks;
+        MAKE_PAGEID(pid, root->volNo, mpage->bfPages[blk/BTM_BLOOMBLOCKSPERPAGE]);
+        if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    }
+
+    if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    edubtm_SetBloomBits(&(apage->bf.data[(blk%BTM_BLOOMBLOCKSPERPAGE)*BTM_BLOOMBLOCK]), h2);
+
+    if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) {
+        (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+        edubtm_LeaveBfM();
+        ERR(e);
+    }
+    e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+
+    edubtm_LeaveBfM();
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_AddToBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_BloomFilterMayContain()
+ *================================*/
+/*
+ * Function: Four edubtm_BloomFilterMayContain(PageID*, KeyValue*, Boolean*)
+ *
+ * Description:
+ *  Probe the filter of the index for the key value. The caller holds the
+ *  tree latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  maybe : FALSE if the key value is surely not in the index; TRUE if it
+ *          may be, or if the index has no filter in memory
+ */
+Four edubtm_BloomFilterMayContain(
+    PageID                      *root,          /* IN root of the index */
+    KeyValue                    *kval,          /* IN key value to look up */
+    Boolean                     *maybe)         /* OUT FALSE if the key value is absent */
+{
+    Four                        e;              /* error number */
+    UFour                       h1, h2;         /* hashes of the key value */
+    btm_BloomFilter             *bf;            /* the filter in memory */
+
+
+    *maybe = TRUE;
+
+    edubtm_EnterBfM();
+
+    if ((e = edubtm_LoadBloomFilter(root, &bf)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    if (bf != NULL && bf->nBlocks > 0) {
+        edubtm_HashKey(kval, &h1, &h2);
+        *maybe = edubtm_TestBloomBits(&(bf->bits[(h1 % bf->nBlocks)*BTM_BLOOMBLOCK]), h2);
+        if (!(*maybe)) bf->nAbsent++;
+    }
+
+    edubtm_LeaveBfM();
+
+    return(eNOERROR);
+
+}   /* edubtm_BloomFilterMayContain() */
+
+
+
+/*@================================
+ * edubtm_NoteBloomFalsePositive()
+ *================================*/
+/*
+ * Function: void edubtm_NoteBloomFalsePositive(PageID*)
+ *
+ * Description:
+ *  Count a lookup which the filter let through but which found nothing.
+ *  If the false positives are more than a tenth of the probes for absent
+ *  key values, or the filter holds twice the key values it was built for,
+ *  the filter is marked to be built again.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_NoteBloomFalsePositive(
+    PageID                      *root)          /* IN root of the index */
+{
+    btm_BloomFilter             *bf;            /* the filter in memory */
+
+
+    edubtm_EnterBfM();
+
+    if ((bf = edubtm_LookupBloomFilter(root)) != NULL) {
+        bf->nFalse++;
+        if (bf->nFalse >= BTM_BLOOMMINFALSE &&
+            (bf->nFalse * 10 > bf->nFalse + bf->nAbsent ||
+             bf->nKeys > 2 * (bf->nBlocks * BTM_BLOOMBLOCK * 8 / BTM_BLOOMBITSPERKEY)))
+            bf->rebuild = TRUE;
+    }
+
+    edubtm_LeaveBfM();
+
+}   /* edubtm_NoteBloomFalsePositive() */
+
+
+
+/*@================================
+ * edubtm_RefreshBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_RefreshBloomFilter(PageID*, KeyDesc*)
+ *
+ * Description:
+ *  Build the filter of the index again if it is marked so. The tree is
+ *  latched exclusively for it; the caller should hold no latch of it.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_RefreshBloomFilter(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc)         /* IN key descriptor of the index */
+{
+    Four                        e;              /* error number */
+    btm_BloomFilter             *bf;            /* the filter in memory */
+
+
+    edubtm_EnterBfM();
+    bf = edubtm_LookupBloomFilter(root);
+    if (bf == NULL || !bf->rebuild) {
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+    edubtm_LeaveBfM();
+
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    edubtm_EnterBfM();
+
+    /* Another lookup may have built it meanwhile */
+    bf = edubtm_LookupBloomFilter(root);
+    if (bf != NULL && bf->rebuild) {
+        if ((e = edubtm_BuildBloomFilter(NULL, root, kdesc)) < 0) ERRTL(e, root);
+    }
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+
+    return(eNOERROR);
+
+}   /* edubtm_RefreshBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_ReadKeyHashes()
+ *================================*/
+/*
+ * Function: Four edubtm_ReadKeyHashes(PageID*, Four*, UFour**)
+ *
+ * Description:
+ *  Go through the leaves from the leftmost one and hash every key value.
+ *  The array, holding the two hashes of each key value in turn, is
+ *  allocated here; the caller frees it.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_ReadKeyHashes(
+    PageID                      *root,          /* IN root of the index */
+    Four                        *nKeys,         /* OUT # of key values */
+    UFour                       **hashes)       /* OUT the hashes */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the entries */
+    Four                        size;           /* # of key values the array can hold */
+    PageID                      pid;            /* current page */
+    PageID                      nextPid;        /* next page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the current page */
+    btm_LeafEntry               *lEntry;        /* an entry of a leaf */
+    UFour                       *newHashes;     /* the array reallocated */
+
+
+    *nKeys = 0;
+    size = 1024;
+    if ((*hashes = (UFour*)malloc(sizeof(UFour)*2*size)) == NULL) ERR(eMEMORYALLOCERR_BTM);
+
+    pid = *root;
+    for (;;) {
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) { free(*hashes); ERR(e); }
+
+        if (apage->any.hdr.type & LEAF) break;
+
+        if (!(apage->any.hdr.type & INTERNAL)) {
+            (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+            free(*hashes);
+            ERR(eBADBTREEPAGE_BTM);
+        }
+
+        MAKE_PAGEID(nextPid, pid.volNo, apage->bi.hdr.p0);
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) { free(*hashes); ERR(e); }
+        pid = nextPid;
+    }
+
+    for (;;) {
+        for (i = 0; i < apage->bl.hdr.nSlots; i++) {
+            if (*nKeys == size) {
+                size *= 2;
+                if ((newHashes = (UFour*)realloc(*hashes, sizeof(UFour)*2*size)) == NULL) {
+                    (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+                    free(*hashes);
+                    ERR(eMEMORYALLOCERR_BTM);
+                }
+                *hashes = newHashes;
+            }
+
+            lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-i]]);
+            edubtm_HashKey((KeyValue*)&(lEntry->klen), &((*hashes)[2*(*nKeys)]), &((*hashes)[2*(*nKeys)+1]));
+            (*nKeys)++;
+        }
+
+        MAKE_PAGEID(nextPid, pid.volNo, apage->bl.hdr.nextPage);
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) { free(*hashes); ERR(e); }
+        if (nextPid.pageNo == NIL) break;
+
+        pid = nextPid;
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) { free(*hashes); ERR(e); }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_ReadKeyHashes() */
+
+
+
+/*@================================
+ * edubtm_BuildBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_BuildBloomFilter(ObjectID*, PageID*, KeyDesc*)
+ *
+ * Description:
+ *  Build the filter of the index from the key values in its leaves, sized
+ *  at BTM_BLOOMBITSPERKEY bits per key value, and store it in the pages of
+ *  the meta page. The pending messages and changes of the index are pushed
+ *  to the leaves first, so that every key value is there.
+ *
+ *  The caller holds the exclusive latch of the tree and is in the buffer
+ *  manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  'catObjForFile' may be NULL if the index has a meta page already.
+ */
+Four edubtm_BuildBloomFilter(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc)         /* IN key descriptor of the index */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the table */
+    Four                        k;              /* index of the key values */
+    Four                        nKeys;          /* # of key values */
+    Four                        blk;            /* block of a key value */
+    UFour                       *hashes;        /* hashes of the key values */
+    btm_BloomFilter             *bf;            /* the filter in memory */
+    btm_BloomFilter             tFilter;        /* the filter, if the table is full */
+
+
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, NULL, NULL, NULL, NULL)) < 0) ERR(e);
+
+    if ((e = edubtm_ReadKeyHashes(root, &nKeys, &hashes)) < 0) ERR(e);
+
+    /* Take the entry of the index, or a free one */
+    if ((bf = edubtm_LookupBloomFilter(root)) != NULL) {
+        free(bf->bits);
+        bf->inUse = FALSE;
+    }
+    else {
+        for (i = 0; i < BTM_MAXBLOOMFILTERS; i++)
+            if (!btm_bloomFilters[i].inUse) { bf = &btm_bloomFilters[i]; break; }
+    }
+
+    /* The filter is only written to its pages if the table is full */
+    if (bf == NULL) bf = &tFilter;
+
+    bf->nBlocks = (nKeys * BTM_BLOOMBITSPERKEY + BTM_BLOOMBLOCK*8 - 1) / (BTM_BLOOMBLOCK*8);
+    if (bf->nBlocks == 0) bf->nBlocks = 1;
+    bf->nBlocks = MIN(bf->nBlocks, BTM_BLOOMMAXPAGES * BTM_BLOOMBLOCKSPERPAGE);
+
+    if ((bf->bits = (char*)calloc(bf->nBlocks, BTM_BLOOMBLOCK)) == NULL) { free(hashes); ERR(eMEMORYALLOCERR_BTM); }
+
+    for (k = 0; k < nKeys; k++) {
+        blk = hashes[2*k] % bf->nBlocks;
+        edubtm_SetBloomBits(&(bf->bits[blk*BTM_BLOOMBLOCK]), hashes[2*k+1]);
+    }
+    free(hashes);
+
+    bf->root = *root;
+    bf->nKeys = nKeys;
+
+    if ((e = edubtm_WriteBloomFilter(catObjForFile, root, bf)) < 0) {
+        free(bf->bits);
+        ERR(e);
+    }
+
+    if (bf == &tFilter) {
+        free(bf->bits);
+        return(eNOERROR);
+    }
+
+    bf->inUse = TRUE;
+    bf->rebuild = FALSE;
+    bf->nAbsent = 0;
+    bf->nFalse = 0;
+
+    return(eNOERROR);
+
+}   /* edubtm_BuildBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_WriteBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_WriteBloomFilter(ObjectID*, PageID*, btm_BloomFilter*)
+ *
+ * Description:
+ *  Store the blocks of the filter into the pages listed by the meta page,
+ *  allocating the pages still missing, and mark the root as filtered. The
+ *  pages of a larger filter built before are kept for the next build.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_WriteBloomFilter(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file, may be NULL */
+    PageID                      *root,          /* IN root of the index */
+    btm_BloomFilter             *bf)            /* INOUT the filter; its pages are set */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the pages */
+    Two                         nPages;         /* # of pages needed */
+    Four                        nBlocks;        /* # of blocks in a page */
+    ObjectID                    catObj;         /* catalog object of B+ tree file */
+    PageID                      metaPid;        /* meta page of the index */
+    PageID                      pid;            /* a page of the filter */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreePage                   *apage;         /* pointer to the buffer holding a page */
+
+
+    if ((e = edubtm_GetMetaPage(catObjForFile, root, TRUE, &metaPid)) < 0) ERR(e);
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    catObj = mpage->hdr.catObjForFile;
+    nPages = (bf->nBlocks + BTM_BLOOMBLOCKSPERPAGE - 1) / BTM_BLOOMBLOCKSPERPAGE;
+
+    /* New pages are allocated near the meta page */
+    while (mpage->hdr.bfNPages < nPages) {
+        if ((e = btm_AllocPage(&catObj, &metaPid, &pid)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+        if ((e = BfM_GetNewTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        apage->bf.hdr.pid = pid;
+        apage->bf.hdr.flags = BTREE_PAGE_TYPE;
+        apage->bf.hdr.reserved = NIL;
+        apage->bf.hdr.type = BLOOMFILTER;
+
+        if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) { (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF); ERRB1(e, &metaPid, PAGE_BUF); }
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        mpage->bfPages[mpage->hdr.bfNPages++] = pid.pageNo;
+    }
+
+    for (i = 0; i < nPages; i++) {
+        MAKE_PAGEID(pid, root->volNo, mpage->bfPages[i]);
+        nBlocks = MIN(BTM_BLOOMBLOCKSPERPAGE, bf->nBlocks - i*BTM_BLOOMBLOCKSPERPAGE);
+
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+        memcpy(apage->bf.data, &(bf->bits[i*BTM_BLOOMBLOCKSPERPAGE*BTM_BLOOMBLOCK]), nBlocks*BTM_BLOOMBLOCK);
+        if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) { (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF); ERRB1(e, &metaPid, PAGE_BUF); }
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    }
+
+    mpage->hdr.bfBlocks = bf->nBlocks;
+    mpage->hdr.bfKeys = bf->nKeys;
+    bf->nPages = mpage->hdr.bfNPages;
+    memcpy(bf->pages, mpage->bfPages, sizeof(ShortPageID)*mpage->hdr.bfNPages);
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+    apage->any.hdr.flags |= BTM_BLOOMFILTERED;
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_WriteBloomFilter() */
+
+
+
+/*@================================
+ * edubtm_DropBloomFilter()
+ *================================*/
+/*
+ * Function: Four edubtm_DropBloomFilter(PageID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Stop keeping the filter of the index. If 'dlHead' is given, the pages
+ *  of the filter are put into the dealloc list; otherwise they stay listed
+ *  in the meta page for a later build. The caller holds the exclusive
+ *  latch of the tree and is in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_DropBloomFilter(
+    PageID                      *root,          /* IN root of the index */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements, may be NULL */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list, may be NULL */
+{
+    Four                        e;              /* error number */
+    PageID                      metaPid;        /* meta page of the index */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root page */
+    btm_BloomFilter             *bf;            /* the filter in memory */
+    DeallocListElem             *dlElem;        /* an element of dealloc list */
+
+
+    if ((bf = edubtm_LookupBloomFilter(root)) != NULL) {
+        free(bf->bits);
+        bf->bits = NULL;
+        bf->inUse = FALSE;
+    }
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERR(e);
+    if (rpage->any.hdr.flags & BTM_BLOOMFILTERED) {
+        rpage->any.hdr.flags &= ~BTM_BLOOMFILTERED;
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    if ((e = edubtm_GetMetaPage(NULL, root, FALSE, &metaPid)) < 0) ERR(e);
+    if (metaPid.pageNo == NIL) return(eNOERROR);
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    mpage->hdr.bfBlocks = mpage->hdr.bfKeys = 0;
+
+    if (dlHead != NULL) {
+        while (mpage->hdr.bfNPages > 0) {
+            if ((e = Util_getElementFromPool(dlPool, &dlElem)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+            dlElem->type = DL_PAGE;
+            MAKE_PAGEID(dlElem->elem.pid, metaPid.volNo, mpage->bfPages[--mpage->hdr.bfNPages]);
+            dlElem->next = dlHead->next;
+            dlHead->next = dlElem;
+        }
+    }
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_DropBloomFilter() */
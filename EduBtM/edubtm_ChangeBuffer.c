@@ -0,0 +1,471 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_ChangeBuffer.c
+ *
+ * Description :
+ *  Change buffer of an index.
+ *
+ *  When the root page has BTM_CHANGEBUFFERED set, a delete whose leaf is not
+ *  in the buffer pool is not applied to the leaf; it is appended as a change
+ *  record to the change buffer, a list of pages hanging from the meta page
+ *  of the index. So the leaf is not read synchronously. The records are
+ *  merged into the leaves in the order they were made when the key range is
+ *  read or changed directly, when the change buffer becomes full, or when
+ *  EduBtM_MergeChangeBuffer() is called.
+ *
+ *  An insert is not buffered: the index has unique key values, and only the
+ *  leaf tells whether the key value already exists.
+ *
+ *  The pages emptied by merging are kept after the page to which the records
+ *  are appended ('cbCur'), and are used again.
+ *
+ * Exports:
+ *  Four edubtm_BufferLeafDelete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*)
+ *  Four edubtm_AppendChange(ObjectID*, PageID*, ShortPageID, btm_Message*, Boolean*)
+ *  Four edubtm_MergeChanges(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four)
+ *  Four edubtm_NewChangeBufferPage(ObjectID*, PageID*, PageID*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+
+/*@================================
+ * edubtm_BufferLeafDelete()
+ *================================*/
+/*
+ * Function: Four edubtm_BufferLeafDelete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Boolean*)
+ *
+ * Description:
+ *  If the index buffers the changes and the leaf on the path of the key
+ *  value is not in the buffer pool, append the delete to the change buffer
+ *  instead of applying it. The internal pages are read to find the leaf.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  buffered : TRUE if the delete is appended to the change buffer
+ */
+Four edubtm_BufferLeafDelete(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID */
+    Boolean                     *buffered)      /* OUT TRUE if the delete is buffered */
+{
+    Four                        e;              /* error number */
+    Four                        msgArea[(BTM_MESSAGE_FIXED + MAXKEYLEN)/sizeof(Four) + 1]; /* space for the change */
+    Two                         idx;            /* index by the binary search */
+    Boolean                     leafParent;     /* TRUE if the children of the page are leaves */
+    Boolean                     appended;       /* TRUE if the change is appended */
+    PageID                      pid;            /* the current page */
+    PageID                      child;          /* child of the current page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the current page */
+    btm_Message                 *msg;           /* the change */
+
+
+    *buffered = FALSE;
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    /* The updates of a buffered index go to the message buffers */
+    if (!(apage->any.hdr.flags & BTM_CHANGEBUFFERED) || (apage->any.hdr.flags & BTM_BUFFEREDINDEX) ||
+        !(apage->any.hdr.type & INTERNAL)) {
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    /* Find the leaf through the internal pages */
+    pid = *root;
+    for (;;) {
+        edubtm_BinarySearchInternal(&(apage->bi), kdesc, kval, &idx);
+        if (idx == -1) MAKE_PAGEID(child, pid.volNo, apage->bi.hdr.p0);
+        else MAKE_PAGEID(child, pid.volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]))->spid);
+
+        leafParent = (apage->bi.hdr.flags & BTM_LEAFPARENT) ? TRUE : FALSE;
+
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+
+        if (leafParent) break;
+
+        pid = child;
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+        /* A page made before the levels were marked; the leaf has been read anyway */
+        if (!(apage->any.hdr.type & INTERNAL)) {
+            if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+            return(eNOERROR);
+        }
+    }
+
+    /* The change of a resident leaf is applied directly */
+    e = bfm_LookUp((TrainID*)&child, PAGE_BUF);
+    if (e != NOTFOUND_IN_HTABLE) {
+        if (e < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    msg = (btm_Message*)msgArea;
+    msg->oid = *oid;
+    msg->op = BTM_MSG_DELETE;
+    msg->klen = kval->len;
+    memcpy(&(msg->kval[0]), &(kval->val[0]), kval->len);
+
+    if ((e = edubtm_AppendChange(catObjForFile, root, child.pageNo, msg, &appended)) < 0) ERR(e);
+
+    /* A full change buffer is merged at once, which makes room for the change */
+    if (!appended) {
+        if ((e = edubtm_MergeChanges(root, kdesc, NULL, NULL, 0)) < 0) ERR(e);
+        if ((e = edubtm_AppendChange(catObjForFile, root, child.pageNo, msg, &appended)) < 0) ERR(e);
+    }
+
+    *buffered = appended;
+
+    return(eNOERROR);
+
+}   /* edubtm_BufferLeafDelete() */
+
+
+
+/*@================================
+ * edubtm_AppendChange()
+ *================================*/
+/*
+ * Function: Four edubtm_AppendChange(ObjectID*, PageID*, ShortPageID, btm_Message*, Boolean*)
+ *
+ * Description:
+ *  Append a change record to the change buffer of the index. A spare page
+ *  is used, or a new page is allocated, when the current page is full; if
+ *  the change buffer already has BTM_CHANGEBUF_MAXPAGES pages, the change
+ *  is not appended.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  appended : TRUE if the change is appended
+ */
+Four edubtm_AppendChange(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    ShortPageID                 leaf,           /* IN the leaf to which the change was made */
+    btm_Message                 *msg,           /* IN the change */
+    Boolean                     *appended)      /* OUT TRUE if the change is appended */
+{
+    Four                        e;              /* error number */
+    Two                         len;            /* length of the change record */
+    PageID                      metaPid;        /* PageID of the meta page */
+    PageID                      curPid;         /* PageID of the page to which the change is appended */
+    PageID                      newPid;         /* PageID of a new page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreeChangeBuffer           *cpage;         /* pointer to the buffer holding a change buffer page */
+    btm_ChangeRecord            *rec;           /* the new change record */
+
+
+    *appended = FALSE;
+
+    len = BTM_CHANGERECORD_LEN(msg->klen);
+
+    if ((e = edubtm_GetMetaPage(catObjForFile, root, TRUE, &metaPid)) < 0) ERR(e);
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    /* The first page of the change buffer */
+    if (mpage->hdr.cbCur == NIL) {
+        if ((e = edubtm_NewChangeBufferPage(catObjForFile, root, &newPid)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        mpage->hdr.cbFirst = mpage->hdr.cbCur = mpage->hdr.cbLast = newPid.pageNo;
+        mpage->hdr.cbPages = 1;
+    }
+
+    MAKE_PAGEID(curPid, metaPid.volNo, mpage->hdr.cbCur);
+    if ((e = BfM_GetTrain((TrainID*)&curPid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+    if (cpage->hdr.used + len > PAGESIZE - BC_FIXED) {
+
+        if (cpage->hdr.nextPage == NIL && mpage->hdr.cbPages >= BTM_CHANGEBUF_MAXPAGES) {
+            /* The change buffer is full */
+            if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+            if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+            if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+
+        if (cpage->hdr.nextPage == NIL) {
+            if ((e = edubtm_NewChangeBufferPage(catObjForFile, &curPid, &newPid)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+
+            cpage->hdr.nextPage = newPid.pageNo;
+            if ((e = BfM_SetDirty((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+
+            mpage->hdr.cbLast = newPid.pageNo;
+            mpage->hdr.cbPages++;
+        }
+
+        /* Move to the next page */
+        mpage->hdr.cbCur = cpage->hdr.nextPage;
+
+        if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        MAKE_PAGEID(curPid, metaPid.volNo, mpage->hdr.cbCur);
+        if ((e = BfM_GetTrain((TrainID*)&curPid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    }
+
+    rec = (btm_ChangeRecord*)&(cpage->data[cpage->hdr.used]);
+    rec->leaf = leaf;
+    memcpy((char*)&(rec->msg), (char*)msg, BTM_MESSAGE_FIXED + msg->klen);
+
+    cpage->hdr.used += len;
+    cpage->hdr.nRecords++;
+
+    *appended = TRUE;
+
+    if ((e = BfM_SetDirty((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_AppendChange() */
+
+
+
+/*@================================
+ * edubtm_MergeChanges()
+ *================================*/
+/*
+ * Function: Four edubtm_MergeChanges(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four)
+ *
+ * Description:
+ *  Merge the change records whose key values are in [low, high] (NULL bounds
+ *  are unbounded) into the leaves, in the order the changes were made. At
+ *  most 'maxChanges' records are merged if it is positive.
+ *
+ *  A delete removes the entry if it has the ObjectID. The leaves are not
+ *  merged with their siblings; the callers may give no dealloc list.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_MergeChanges(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *low,           /* IN lower bound of the key values, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the key values, NULL if unbounded */
+    Four                        maxChanges)     /* IN max # of changes to merge, 0 if unlimited */
+{
+    Four                        e;              /* error number */
+    Four                        nMerged;        /* # of merged changes */
+    Two                         offset;         /* offset of a change record */
+    Two                         len;            /* length of a change record */
+    Two                         n;              /* # of delivered messages */
+    Boolean                     f;              /* TRUE if the root is not half full */
+    Boolean                     h;              /* TRUE if the root is split */
+    Boolean                     isCur;          /* TRUE if the page is the current page */
+    Boolean                     changed;        /* TRUE if the page is changed */
+    InternalItem                item;           /* Internal item for the new root */
+    ObjectID                    catObjForFile;  /* catalog object of B+ tree file */
+    PageID                      metaPid;        /* PageID of the meta page */
+    PageID                      pid;            /* PageID of a change buffer page */
+    PageID                      prevPid;        /* PageID of the previous page of 'pid' */
+    PageID                      tPid;           /* a temporary PageID */
+    ShortPageID                 next;           /* next page of 'pid' */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreeChangeBuffer           *cpage;         /* pointer to the buffer holding a change buffer page */
+    BtreeChangeBuffer           *tpage;         /* pointer to the buffer holding another change buffer page */
+    btm_ChangeRecord            *rec;           /* a change record */
+    KeyValue                    *kval;          /* key value of a change record */
+
+
+    if ((e = edubtm_GetMetaPage(NULL, root, FALSE, &metaPid)) < 0) ERR(e);
+    if (metaPid.pageNo == NIL) return(eNOERROR);
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    catObjForFile = mpage->hdr.catObjForFile;
+
+    nMerged = 0;
+    prevPid.pageNo = NIL;
+    MAKE_PAGEID(pid, metaPid.volNo, mpage->hdr.cbFirst);
+
+    /* The pages after the current page are spare */
+    while (pid.pageNo != NIL) {
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        changed = FALSE;
+        offset = 0;
+        while (offset < cpage->hdr.used && (maxChanges <= 0 || nMerged < maxChanges)) {
+            rec = (btm_ChangeRecord*)&(cpage->data[offset]);
+            kval = (KeyValue*)&(rec->msg.klen);
+            len = BTM_CHANGERECORD_LEN(rec->msg.klen);
+
+            if ((low != NULL && edubtm_KeyCompare(kdesc, kval, low) == LESS) ||
+                (high != NULL && edubtm_KeyCompare(kdesc, kval, high) == GREATER)) {
+                offset += len;
+                continue;
+            }
+
+            /* Apply the change through the internal pages; a split of the root stops the delivery */
+            do {
+                if ((e = edubtm_DeliverMessages(&catObjForFile, root, kdesc, (char*)&(rec->msg), 1, FALSE, &n,
+                                                &f, &h, &item, NULL, NULL)) < 0)
+                    ERRB1(e, &pid, PAGE_BUF);
+
+                if (h) {
+                    if ((e = edubtm_root_insert(&catObjForFile, root, &item)) < 0) ERRB1(e, &pid, PAGE_BUF);
+                }
+            } while (n == 0);
+
+            memmove(&(cpage->data[offset]), &(cpage->data[offset+len]), cpage->hdr.used - (offset + len));
+            cpage->hdr.used -= len;
+            cpage->hdr.nRecords--;
+
+            changed = TRUE;
+            nMerged++;
+        }
+
+        next = cpage->hdr.nextPage;
+        isCur = (pid.pageNo == mpage->hdr.cbCur) ? TRUE : FALSE;
+
+        if (cpage->hdr.nRecords == 0 && !isCur) {
+            /* Move the empty page to the end of the list as a spare page */
+            if (prevPid.pageNo == NIL)
+                mpage->hdr.cbFirst = next;
+            else {
+                if ((e = BfM_GetTrain((TrainID*)&prevPid, (char**)&tpage, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+                tpage->hdr.nextPage = next;
+                if ((e = BfM_SetDirty((TrainID*)&prevPid, PAGE_BUF)) < 0) ERRB1(e, &prevPid, PAGE_BUF);
+                if ((e = BfM_FreeTrain((TrainID*)&prevPid, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+            }
+
+            MAKE_PAGEID(tPid, metaPid.volNo, mpage->hdr.cbLast);
+            if ((e = BfM_GetTrain((TrainID*)&tPid, (char**)&tpage, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+            tpage->hdr.nextPage = pid.pageNo;
+            if ((e = BfM_SetDirty((TrainID*)&tPid, PAGE_BUF)) < 0) ERRB1(e, &tPid, PAGE_BUF);
+            if ((e = BfM_FreeTrain((TrainID*)&tPid, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+
+            cpage->hdr.nextPage = NIL;
+            mpage->hdr.cbLast = pid.pageNo;
+
+            changed = TRUE;
+        }
+        else
+            prevPid = pid;
+
+        if (changed) {
+            if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &pid, PAGE_BUF);
+        }
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+
+        if (isCur || (maxChanges > 0 && nMerged >= maxChanges)) break;
+
+        MAKE_PAGEID(pid, metaPid.volNo, next);
+    }
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_MergeChanges() */
+
+
+
+/*@================================
+ * edubtm_NewChangeBufferPage()
+ *================================*/
+/*
+ * Function: Four edubtm_NewChangeBufferPage(ObjectID*, PageID*, PageID*)
+ *
+ * Description:
+ *  Allocate and initialize an empty page of the change buffer. The side log
+ *  of an online build is made of the same pages.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_NewChangeBufferPage(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *nearPid,       /* IN the new page is allocated near this page */
+    PageID                      *newPid)        /* OUT PageID of the new page */
+{
+    Four                        e;              /* error number */
+    BtreeChangeBuffer           *cpage;         /* pointer to the buffer holding the new page */
+
+
+    if ((e = btm_AllocPage(catObjForFile, nearPid, newPid)) < 0) ERR(e);
+    if ((e = BfM_GetNewTrain((TrainID*)newPid, (char**)&cpage, PAGE_BUF)) < 0) ERR(e);
+
+    cpage->hdr.pid = *newPid;
+    cpage->hdr.flags = BTREE_PAGE_TYPE;
+    cpage->hdr.reserved = NIL;
+    cpage->hdr.type = CHANGEBUFFER;
+    cpage->hdr.nextPage = NIL;
+    cpage->hdr.nRecords = 0;
+    cpage->hdr.used = 0;
+
+    if ((e = BfM_SetDirty((TrainID*)newPid, PAGE_BUF)) < 0) ERRB1(e, newPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)newPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_NewChangeBufferPage() */
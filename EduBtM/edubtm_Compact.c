@@ -97,7 +97,8 @@ void edubtm_CompactInternalPage(
     Two                 i;                      /* index variable */
     btm_InternalEntry   *entry;                 /* an entry in leaf page */
     /**/
-    apageDataOffset = 0;
+    /* The entries are placed after the message buffer, if any */
+    apageDataOffset = BI_DATA_START(apage);
     int j = 0;
 
     /* Copy apage data[] to tpage data[] */    
@@ -122,7 +123,7 @@ void edubtm_CompactInternalPage(
         if(i == slotNo)
             continue;
 
-        entry = (btm_InternalEntry *)((char*)(tpage.data) + tpage.slot[-i]);
+        entry = (btm_InternalEntry *)((char*)(tpage.data) + apage->slot[-i]);
         len = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + entry->klen);     
         ((btm_InternalEntry *)((char*)(apage->data) + apageDataOffset))->spid = entry->spid;
         ((btm_InternalEntry *)((char*)(apage->data) + apageDataOffset))->klen = entry->klen;
@@ -134,14 +135,14 @@ void edubtm_CompactInternalPage(
     }
 
     if(slotNo != NIL){
-        entry = (btm_InternalEntry *)((char*)(tpage.data) + tpage.slot[-slotNo]);
+        entry = (btm_InternalEntry *)((char*)(tpage.data) + apage->slot[-slotNo]);
         len = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + entry->klen);     
         ((btm_InternalEntry *)((char*)(apage->data) + apageDataOffset))->spid = entry->spid;
         ((btm_InternalEntry *)((char*)(apage->data) + apageDataOffset))->klen = entry->klen;
         for (j = 0; j < entry->klen; j++){
             *((char *)((btm_InternalEntry *)((char*)(apage->data) + apageDataOffset))->kval + j) = *((char *)(entry->kval) + j);
         }
-        apage->slot[-i] = apageDataOffset;              
+        apage->slot[-slotNo] = apageDataOffset;              
         apageDataOffset = apageDataOffset + len; 
     }   
 
@@ -199,7 +200,7 @@ void edubtm_CompactLeafPage(
         if(i == slotNo)
             continue;
 
-        entry = (btm_LeafEntry *)((char*)(tpage.data) + tpage.slot[-i]);
+        entry = (btm_LeafEntry *)((char*)(tpage.data) + apage->slot[-i]);
         alignedKlen = ALIGNED_LENGTH(entry->klen);
         len = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
         ((btm_LeafEntry *)((char*)(apage->data) + apageDataOffset))->nObjects = entry->nObjects;    
@@ -212,7 +213,7 @@ void edubtm_CompactLeafPage(
     }
 
     if(slotNo != NIL){
-        entry = (btm_LeafEntry *)((char*)(tpage.data) + tpage.slot[-slotNo]);
+        entry = (btm_LeafEntry *)((char*)(tpage.data) + apage->slot[-slotNo]);
         alignedKlen = ALIGNED_LENGTH(entry->klen);
         len = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;     
         ((btm_LeafEntry *)((char*)(apage->data) + apageDataOffset))->nObjects = entry->nObjects; 
@@ -220,7 +221,7 @@ void edubtm_CompactLeafPage(
         for (j = 0; j < alignedKlen + OBJECTID_SIZE; j++){
             *((char *)((btm_LeafEntry *)((char*)(apage->data) + apageDataOffset))->kval + j) = *((char *)(entry->kval) + j);
         }
-        apage->slot[-i] = apageDataOffset;              
+        apage->slot[-slotNo] = apageDataOffset;              
         apageDataOffset = apageDataOffset + len; 
     }   
 
@@ -118,37 +118,46 @@ Four edubtm_KeyCompare(
     }
 
     /**/
+    /* The parts are laid out one after another; a string part carries its length */
+    left = (unsigned char*)key1->val;
+    right = (unsigned char*)key2->val;
     for(i = 0; i < kdesc->nparts; i++){
-        left = &(key1->val[i]);
-        //printf("%d\n", left);
-        right = &(key2->val[i]);
-        //printf( "%d\n", right);
         if(kdesc->kpart[i].type == SM_VARSTRING){       
-            len1 = *(Two *)left;     
-            len2 = *(Two *)right;     
-            left += 2;
-            right += 2;
-            for(j = 0; j < len1 ; j++){
-                if(*left > *right)
+            memcpy(&len1, left, sizeof(Two));
+            memcpy(&len2, right, sizeof(Two));
+            left += sizeof(Two);
+            right += sizeof(Two);
+            for(j = 0; j < len1 && j < len2; j++){
+                if(left[j] > right[j])
                     return GREATER;
 
-                else if(*left < *right)
+                else if(left[j] < right[j])
                     return LESS; 
-                left++;
-                right++;
             }             
+
+            /* A string is less than the longer ones it is a prefix of */
+            if(len1 > len2)
+                return GREATER;
+            else if(len1 < len2)
+                return LESS;
+
+            left += len1;
+            right += len2;
         }
 
         else if(kdesc->kpart[i].type == SM_INT)
         {
-            i1 = *(Four_Invariable *)left;
-            i2 = *(Four_Invariable *)right;
+            memcpy(&i1, left, sizeof(Four_Invariable));
+            memcpy(&i2, right, sizeof(Four_Invariable));
 
             if(i1 > i2)
                 return GREATER;
 
             else if(i1 < i2)
                 return LESS;            
+
+            left += sizeof(Four_Invariable);
+            right += sizeof(Four_Invariable);
         }        
     }
     /**/
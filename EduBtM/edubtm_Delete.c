@@ -75,6 +75,12 @@
  * Exports:
  *  Four edubtm_Delete(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
  *                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  void edubtm_DeleteInternalEntries(BtreeInternal*, Two, Two)
+ *  void edubtm_DeleteLeafEntries(BtreeLeaf*, Two, Two)
+ *  Four edubtm_RepairUnderflow(ObjectID*, PageID*, KeyDesc*, KeyValue*,
+ *                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_MergeChild(ObjectID*, BtreePage*, KeyDesc*, Two, Boolean*, InternalItem*,
+ *                  Pool*, DeallocListElem*)
  *
  */
 
@@ -131,6 +137,7 @@ Four edubtm_Delete(
     Four                        e;              /* error number */
     Boolean                     lf;             /* TRUE if a page is not half full */
     Boolean                     lh;             /* TRUE if a page is splitted */
+    Boolean                     split;          /* TRUE if the children are changed by the flushes */
     Two                         idx;            /* the index by the binary search */
     PageID                      child;          /* a child page when the root is an internal page */
     KeyValue                    tKey;           /* a temporary key */
@@ -150,26 +157,74 @@ Four edubtm_Delete(
             ERR(eNOTSUPPORTED_EDUBTM);
     }
 
-        
+
     *h = *f = FALSE;
-    
+
     /**/
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERR(e);
 
-    
+    /* Fix the root page to the buffer */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (rpage->any.hdr.type & LEAF) {
+        if ((e = edubtm_DeleteLeaf(&pFid, root, &(rpage->bl), kdesc, kval, oid, f, h, item, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
 
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (!(rpage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, root, PAGE_BUF);
+
+    /* Search the child on the path of the given key */
+    edubtm_BinarySearchInternal(&(rpage->bi), kdesc, kval, &idx);
+    if (idx == -1) {
+        MAKE_PAGEID(child, root->volNo, rpage->bi.hdr.p0);
+    }
+    else {
+        iEntry = (btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[-idx]]);
+        MAKE_PAGEID(child, root->volNo, iEntry->spid);
+    }
 
+    /* Recursive Call */
+    if ((e = edubtm_Delete(catObjForFile, &child, kdesc, kval, oid, &lf, &lh, &litem, dlPool, dlHead)) < 0)
+        ERRB1(e, root, PAGE_BUF);
 
     /* Merge or Redistribute the page with the sibling page */
-    if(lf){
-        if((e = btm_Underflow(&pFid, rpage, &child, idx, f, &lh, &litem, dlPool, dlHead))<0) ERRB1(e, root, PAGE_BUF);
+    if (lf && rpage->bi.hdr.nSlots > 0) {
+        /* The pages of a buffered index push their messages down first */
+        if ((e = edubtm_ReleaseMsgBuffers(catObjForFile, &(rpage->bi), kdesc, idx, &split, h, item)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+
+        if (!split) {
+            if ((e = btm_Underflow(&pFid, rpage, &child, idx, f, &lh, &litem, dlPool, dlHead)) < 0)
+                ERRB1(e, root, PAGE_BUF);
+        }
     }
 
-    /**/
-    /* Delete following 2 lines before implement this function */
-    printf("Implementation of delete operation is optional (not compulsory),\n");
-    printf("and delete operation has not been implemented yet.\n");
+    /* A redistribution may return a new discriminator key of the child */
+    if (lh) {
+        edubtm_BinarySearchInternal(&(rpage->bi), kdesc, (KeyValue*)&(litem.klen), &idx);
+        if ((e = edubtm_InsertInternal(catObjForFile, &(rpage->bi), &litem, idx, h, item)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+    }
+
+    if (!*h)
+        *f = (BI_FREE(&(rpage->bi)) > BI_HALF || rpage->bi.hdr.nSlots == 0) ? TRUE : FALSE;
+
+    if (lf || lh) {
+        /* Set the DIRTY bit */
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
 
+    /* Unfix the root page from the buffer */
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
 
+    /**/
     return(eNOERROR);
     
 }   /* edubtm_Delete() */
@@ -239,11 +294,339 @@ Four edubtm_DeleteLeaf(
     }
 
 
-    /* Delete following 2 lines before implement this function */
-    printf("Implementation of delete operation is optional (not compulsory),\n");
-    printf("and delete operation has not been implemented yet.\n");
+    *h = *f = FALSE;
+
+    /**/
+    found = edubtm_BinarySearchLeaf(apage, kdesc, kval, &idx);
+    if (!found) ERR(eNOTFOUND_BTM);
+
+    lEntryOffset = apage->slot[-idx];
+    lEntry = (btm_LeafEntry*)&(apage->data[lEntryOffset]);
+
+    /* A key value has only one ObjectID in EduBtM */
+    if (lEntry->nObjects != 1) ERR(eNOTSUPPORTED_EDUBTM);
+
+    alignedKlen = ALIGNED_LENGTH(lEntry->klen);
+    oidArray = (ObjectID*)&(lEntry->kval[alignedKlen]);
+    if (btm_ObjectIdComp(oid, &oidArray[0]) != EQUAL) ERR(eNOTFOUND_BTM);
+
+    edubtm_DeleteLeafEntries(apage, idx, idx);
+
+    /* The slots after the entry moved */
+    edubtm_BumpVersion(pid);
+
+    /* The parent merges or redistributes the leaf if it is not half full */
+    *f = (BL_FREE(apage) > BL_HALF) ? TRUE : FALSE;
+
+    if ((e = BfM_SetDirty((TrainID*)pid, PAGE_BUF)) < 0) ERR(e);
 
-	      
+    /**/
     return(eNOERROR);
     
 } /* edubtm_DeleteLeaf() */
+
+
+
+/*@================================
+ * edubtm_DeleteInternalEntries()
+ *================================*/
+/*
+ * Function: void edubtm_DeleteInternalEntries(BtreeInternal*, Two, Two)
+ *
+ * Description:
+ *  Remove the entries in the slots 'first' ... 'last' from the given internal
+ *  page. The space of the removed entries is counted as unused space and the
+ *  slots after 'last' are shifted to fill the hole in the slot array.
+ *  The pointer 'p0' is not touched; the caller should replace it when the
+ *  first child is removed.
+ *
+ * Returns:
+ *  None
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for the page.
+ */
+void edubtm_DeleteInternalEntries(
+    BtreeInternal       *apage,         /* INOUT internal page */
+    Two                 first,          /* IN first slot to be removed */
+    Two                 last)           /* IN last slot to be removed */
+{
+    Two                 i;              /* slot No. */
+    Two                 nDeleted;       /* # of removed entries */
+    btm_InternalEntry   *entry;         /* an internal entry */
+
+
+    nDeleted = last - first + 1;
+    if (nDeleted <= 0) return;
+
+    for (i = first; i <= last; i++) {
+        entry = (btm_InternalEntry*)&(apage->data[apage->slot[-i]]);
+        apage->hdr.unused += BTM_INTERNALENTRY_LEN(entry->klen);
+    }
+
+    for (i = last + 1; i < apage->hdr.nSlots; i++)
+        apage->slot[-(i - nDeleted)] = apage->slot[-i];
+
+    apage->hdr.nSlots -= nDeleted;
+
+} /* edubtm_DeleteInternalEntries() */
+
+
+
+/*@================================
+ * edubtm_DeleteLeafEntries()
+ *================================*/
+/*
+ * Function: void edubtm_DeleteLeafEntries(BtreeLeaf*, Two, Two)
+ *
+ * Description:
+ *  Remove the entries in the slots 'first' ... 'last' from the given leaf
+ *  page. The space of the removed entries is counted as unused space.
+ *
+ * Returns:
+ *  None
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for the page.
+ */
+void edubtm_DeleteLeafEntries(
+    BtreeLeaf           *apage,         /* INOUT leaf page */
+    Two                 first,          /* IN first slot to be removed */
+    Two                 last)           /* IN last slot to be removed */
+{
+    Two                 i;              /* slot No. */
+    Two                 nDeleted;       /* # of removed entries */
+    btm_LeafEntry       *entry;         /* a leaf entry */
+
+
+    nDeleted = last - first + 1;
+    if (nDeleted <= 0) return;
+
+    for (i = first; i <= last; i++) {
+        entry = (btm_LeafEntry*)&(apage->data[apage->slot[-i]]);
+        apage->hdr.unused += BTM_LEAFENTRY_LEN(entry);
+    }
+
+    for (i = last + 1; i < apage->hdr.nSlots; i++)
+        apage->slot[-(i - nDeleted)] = apage->slot[-i];
+
+    apage->hdr.nSlots -= nDeleted;
+
+} /* edubtm_DeleteLeafEntries() */
+
+
+
+/*@================================
+ * edubtm_RepairUnderflow()
+ *================================*/
+/*
+ * Function: Four edubtm_RepairUnderflow(ObjectID*, PageID*, KeyDesc*, KeyValue*,
+ *                      Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Bulk delete operations remove many entries without merging pages on the
+ *  way; this function repairs the tree afterwards. It descends along the
+ *  path of the given key value exactly as edubtm_Delete(...) does and, on the
+ *  way back, merges or redistributes every page on the path which is not
+ *  half full with its sibling by btm_Underflow(...).
+ *
+ *  A page having only 'p0' cannot repair its child because the child has no
+ *  sibling; such a page is reported as not half full so that it is merged by
+ *  its own parent. The child is repaired by edubtm_MergeChild(...).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  f    : TRUE if the given root page is not half full.
+ *  h    : TRUE if the given page is splitted.
+ *  item : The internal item to be inserted into the parent if 'h' is TRUE.
+ */
+Four edubtm_RepairUnderflow(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root page */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *kval,          /* IN key value on the path to be repaired */
+    Boolean                     *f,             /* OUT whether the root page is half full */
+    Boolean                     *h,             /* OUT TRUE if it is spiltted. */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Boolean                     lf;             /* TRUE if a page is not half full */
+    Boolean                     lh;             /* TRUE if a page is splitted */
+    Two                         idx;            /* the index by the binary search */
+    PageID                      child;          /* a child page when the root is an internal page */
+    BtreePage                   *rpage;         /* for a root page */
+    InternalItem                litem;          /* local internal item */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    *h = *f = FALSE;
+
+    /* Fix the root page to the buffer */
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (rpage->any.hdr.type & LEAF) {
+        /* The parent merges the leaf if it is not half full */
+        *f = (BL_FREE(&(rpage->bl)) > BL_HALF) ? TRUE : FALSE;
+
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (!(rpage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, root, PAGE_BUF);
+
+    /* Search the child on the path of the given key */
+    edubtm_BinarySearchInternal(&(rpage->bi), kdesc, kval, &idx);
+    if (idx == -1) {
+        MAKE_PAGEID(child, root->volNo, rpage->bi.hdr.p0);
+    }
+    else {
+        iEntry = (btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[-idx]]);
+        MAKE_PAGEID(child, root->volNo, iEntry->spid);
+    }
+
+    /* Recursive Call */
+    if ((e = edubtm_RepairUnderflow(catObjForFile, &child, kdesc, kval, &lf, &lh, &litem, dlPool, dlHead)) < 0)
+        ERRB1(e, root, PAGE_BUF);
+
+    /* Merge or Redistribute the child with its sibling page */
+    if (lf && rpage->bi.hdr.nSlots > 0) {
+        if ((e = edubtm_MergeChild(catObjForFile, rpage, kdesc, idx, h, item, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+    }
+
+    /* Insert the internal item returned by the child into the root */
+    if (lh) {
+        edubtm_BinarySearchInternal(&(rpage->bi), kdesc, (KeyValue*)&(litem.klen), &idx);
+        if ((e = edubtm_InsertInternal(catObjForFile, &(rpage->bi), &litem, idx, h, item)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+
+        /* The pending messages of the new page go with it */
+        if (*h)
+            if ((e = edubtm_SplitMsgBuffer(&(rpage->bi), item, kdesc)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+
+    if (!*h)
+        *f = (BI_FREE(&(rpage->bi)) > BI_HALF || rpage->bi.hdr.nSlots == 0) ? TRUE : FALSE;
+
+    if (lf || lh) {
+        /* Set the DIRTY bit */
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+
+    /* Unfix the root page from the buffer */
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_RepairUnderflow() */
+
+
+
+/*@================================
+ * edubtm_MergeChild()
+ *================================*/
+/*
+ * Function: Four edubtm_MergeChild(ObjectID*, BtreePage*, KeyDesc*, Two, Boolean*, InternalItem*,
+ *                                  Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Repair the child 'idx' of the given internal page which is not half full.
+ *
+ *  A leaf left empty is freed and its entry is removed from the page, since
+ *  btm_Underflow(...) never merges two empty leaves. Otherwise the child is
+ *  merged or redistributed with its sibling by btm_Underflow(...), after the
+ *  pages of a buffered index have pushed their messages down. If the pushed
+ *  messages split a child, the child is left as it is.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  h    : TRUE if the given page is splitted.
+ *  item : The internal item to be inserted into the parent if 'h' is TRUE.
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'rpage'.
+ */
+Four edubtm_MergeChild(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreePage                   *rpage,         /* INOUT the internal page having the child */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Two                         idx,            /* IN the child to repair (-1 denotes 'p0') */
+    Boolean                     *h,             /* OUT TRUE if it is spiltted. */
+    InternalItem                *item,          /* OUT The internal item to be returned */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Boolean                     lf;             /* TRUE if a page is not half full */
+    Boolean                     lh;             /* TRUE if a page is splitted */
+    Boolean                     split;          /* TRUE if the children are changed by the flushes */
+    Boolean                     empty;          /* TRUE if the child is an empty leaf */
+    PageID                      child;          /* the child page */
+    BtreePage                   *cpage;         /* for the child page */
+    InternalItem                litem;          /* local internal item */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+    SlottedPage                 *catPage;       /* buffer page containing the catalog object */
+    sm_CatOverlayForBtree       *catEntry;      /* pointer to Btree file catalog information */
+    PhysicalFileID              pFid;           /* B+-tree file's FileID */
+
+
+    *h = FALSE;
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERR(e);
+
+    /* The pages to be merged should have no pending messages */
+    if ((e = edubtm_ReleaseMsgBuffers(catObjForFile, &(rpage->bi), kdesc, idx, &split, h, item)) < 0) ERR(e);
+    if (split) return(eNOERROR);
+
+    if (idx == -1) {
+        MAKE_PAGEID(child, rpage->bi.hdr.pid.volNo, rpage->bi.hdr.p0);
+    }
+    else {
+        iEntry = (btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[-idx]]);
+        MAKE_PAGEID(child, rpage->bi.hdr.pid.volNo, iEntry->spid);
+    }
+
+    /* Is the child an empty leaf? */
+    if ((e = BfM_GetTrain((TrainID*)&child, (char**)&cpage, PAGE_BUF)) < 0) ERR(e);
+    empty = ((cpage->any.hdr.type & LEAF) && cpage->bl.hdr.nSlots == 0) ? TRUE : FALSE;
+    if ((e = BfM_FreeTrain((TrainID*)&child, PAGE_BUF)) < 0) ERR(e);
+
+    if (empty) {
+        /* Free the empty leaf and remove its entry */
+        if ((e = edubtm_FreeSubtrees(&pFid, &(rpage->bi), idx, idx, dlPool, dlHead)) < 0) ERR(e);
+
+        if (idx == -1) {
+            /* the first remaining child becomes 'p0' */
+            iEntry = (btm_InternalEntry*)&(rpage->bi.data[rpage->bi.slot[0]]);
+            rpage->bi.hdr.p0 = iEntry->spid;
+            edubtm_DeleteInternalEntries(&(rpage->bi), 0, 0);
+        }
+        else
+            edubtm_DeleteInternalEntries(&(rpage->bi), idx, idx);
+
+        return(eNOERROR);
+    }
+
+    if ((e = btm_Underflow(&pFid, rpage, &child, idx, &lf, &lh, &litem, dlPool, dlHead)) < 0) ERR(e);
+
+    /* A redistribution may return a new discriminator key of the child */
+    if (lh) {
+        edubtm_BinarySearchInternal(&(rpage->bi), kdesc, (KeyValue*)&(litem.klen), &idx);
+        if ((e = edubtm_InsertInternal(catObjForFile, &(rpage->bi), &litem, idx, h, item)) < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+} /* edubtm_MergeChild() */
@@ -0,0 +1,107 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_ErrName.c
+ *
+ * Description : 
+ *  This file gives the names of the error codes which EduBtM defines on top
+ *  of the error codes of the COSMOS library.
+ *
+ * Exports: 
+ *  char *edubtm_GetErrName(Four)
+ */
+
+
+#include "EduBtM_common.h"
+
+
+
+/* Names of the error codes of EduBtM, indexed from NUM_COSMOS_ERRORS_BTM_ERR_BASE */
+static char *edubtm_errNames[NUM_ERRORS_BTM_ERR_BASE - NUM_COSMOS_ERRORS_BTM_ERR_BASE] = {
+    "(unused error code)",
+    "eNOTSUPPORTED_EDUBTM: the operation is not supported by EduBtM",
+    "eMEMORYALLOCERR_BTM: memory allocation error",
+    "eLATCHTABLEFULL_BTM: no more latch can be held on the pages of the indexes",
+    "eRIGHTLINKTABLEFULL_BTM: no more split can wait to be posted to its parent",
+    "eONLINEBUILDTABLEFULL_BTM: no more index can be built online at the same time"
+};
+
+
+
+/*@================================
+ * edubtm_GetErrName()
+ *================================*/
+/*
+ * Function: char *edubtm_GetErrName(Four)
+ *
+ * Description:
+ *  Return the name of the error code 'e'. The codes of BTM_ERR_BASE from
+ *  NUM_COSMOS_ERRORS_BTM_ERR_BASE on are named here, since the error table
+ *  of the COSMOS library ends before them; the other codes are named by
+ *  Err_GetErrName().
+ *
+ * Returns:
+ *  the name of the error code
+ */
+char *edubtm_GetErrName(
+    Four                        e)              /* IN error code */
+{
+    Four                        base;           /* error base of 'e' */
+    Four                        no;             /* number of 'e' in its error base */
+
+
+    base = (-e) >> 16;
+    no = (-e) & 0xFFFF;
+
+    if (base == BTM_ERR_BASE && no >= NUM_COSMOS_ERRORS_BTM_ERR_BASE && no < NUM_ERRORS_BTM_ERR_BASE)
+        return(edubtm_errNames[no - NUM_COSMOS_ERRORS_BTM_ERR_BASE]);
+
+    return(Err_GetErrName(e));
+
+}   /* edubtm_GetErrName() */
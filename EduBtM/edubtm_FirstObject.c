@@ -97,13 +97,9 @@ Four edubtm_FirstObject(
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     int			i;
     Four 		e;		/* error */
-    Four 		cmp;		/* result of comparison */
-    PageID 		curPid;		/* PageID of the current page */
-    PageID 		child;		/* PageID of the child page */
+    PageID 		leaf;		/* PageID of the leftmost leaf */
     BtreePage 		*apage;		/* a page pointer */
-    Two                 lEntryOffset;   /* starting offset of a leaf entry */
-    btm_LeafEntry 	*lEntry;	/* a leaf entry */
-    Two                 alignedKlen;    /* aligned length of the key length */    
+    Boolean		found;		/* TRUE if the leaf is known by the meta page */
 
     if (root == NULL) ERR(eBADPAGE_BTM);
 
@@ -115,27 +111,18 @@ Four edubtm_FirstObject(
     }
 
     /**/
-    curPid = *root;
-    while(TRUE){        
-        if((e = BfM_GetTrain((TrainID*)&curPid, (char**)&apage, PAGE_BUF)) < 0) ERR(e); 
-        if(apage->any.hdr.type == LEAF) break;
-        if(apage->bi.hdr.p0 != NIL) MAKE_PAGEID(child, root->volNo, apage->bi.hdr.p0);
-        if((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF))<0) ERR(e);
-        curPid = child;
+    /* The meta page usually knows the leftmost leaf */
+    if ((e = edubtm_GetEndLeaf(root, FALSE, &leaf, &apage, &found)) < 0) ERR(e);
+
+    if (!found) {
+        /* Descend along the leftmost children, validating their versions */
+        if ((e = edubtm_SearchLeaf(root, kdesc, NULL, FALSE, BTM_LATCH_S, NULL, &leaf, &apage)) < 0) ERR(e);
+        if ((e = edubtm_SetEndLeaf(root, FALSE, &leaf, apage)) < 0) { (Four) edubtm_UnfixPage(&leaf, FALSE); ERR(e); }
     }
-    
-    lEntryOffset = apage->bl.slot[0];
-    printf("%d",lEntryOffset);
-    lEntry = (btm_LeafEntry *)(&(apage->bl.data[lEntryOffset]));
 
-    cursor->flag = CURSOR_ON;
-    alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-    cursor->oid = *((ObjectID *)(&(lEntry->kval[0]) + alignedKlen));
-    cursor->key = *((KeyValue *)(&(lEntry->klen)));
-    cursor->leaf = curPid;
-    cursor->slotNo = 0;
-    cursor->oidArrayElemNo = 1;    
-    
+    /* An empty leaf is skipped over; the leaf is released here */
+    if ((e = edubtm_PositionCursor(&leaf, apage, 0, TRUE, kdesc, stopKval, stopCompOp, cursor)) < 0) ERR(e);
+
     /**/
     return(eNOERROR);
     
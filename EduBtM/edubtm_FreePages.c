@@ -54,6 +54,7 @@
  *
  * Exports:
  *  Four edubtm_FreePages(FileID*, PageID*, Pool*, DeallocListElem*)
+ *  Four edubtm_DropTree(FileID*, PageID*, Pool*, DeallocListElem*)
  */
 
 #include "EduBtM_common.h"
@@ -78,6 +79,13 @@
  *  overflow page. In an overflow page, it recursively calls itself if the
  *  'nextPage' exist.
  *
+ *  EduBtM keeps every ObjectID of a key in its leaf entry and never makes an
+ *  overflow page list, so a leaf is freed without looking into its entries.
+ *
+ *  The meta page of the index is freed with the root page, and the pages of
+ *  the change buffer and of the side log are freed with the meta page, as
+ *  well as the freed pages it keeps for reuse and the rest of the leaf run.
+ *
  * Returns:
  *  error code
  *    eBADBTREEPAGE_BTM
@@ -103,42 +111,180 @@ Four edubtm_FreePages(
     btm_LeafEntry       *lEntry;        /* a leaf entry */
     DeallocListElem     *dlElem;        /* an element of dealloc list */
     /**/
-    /* Fix the page that has been newly allocated on the disk to the buffer */
-    if((e = BfM_GetNewTrain(curPid, (char**)&apage, PAGE_BUF))<0) ERR(e);    
+    /* Fix the page to the buffer */
+    if((e = BfM_GetTrain((TrainID*)curPid, (char**)&apage, PAGE_BUF))<0) ERR(e);
+
+    /* The meta page of the index hangs from the root */
+    if((apage->any.hdr.type & ROOT) && apage->any.hdr.reserved != NIL){
+        MAKE_PAGEID(tPid, pFid->volNo, apage->any.hdr.reserved);
+        if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+    }
 
     /* Recursive call of edubtm_FreePages */
-    if(apage->any.hdr.type == INTERNAL){
+    if(apage->any.hdr.type & INTERNAL){
         /* First child page (pid = p0) */
         MAKE_PAGEID(tPid, pFid->volNo, apage->bi.hdr.p0);
-        if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERR(e);   
+        if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
 
         /* Child pages (pid stored in internal entries) */
         for(i = 0; i < apage->bi.hdr.nSlots; i++){
             iEntryOffset = apage->bi.slot[-i];
-            iEntry = (btm_InternalEntry*)apage->bi.data[iEntryOffset];
+            iEntry = (btm_InternalEntry*)&(apage->bi.data[iEntryOffset]);
             MAKE_PAGEID(tPid, pFid->volNo, iEntry->spid);
-            if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERR(e);
+            if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
         }
 
     }
+    else if(apage->any.hdr.type & META){
+        /* The pages of the change buffer */
+        if(apage->bm.hdr.cbFirst != NIL){
+            MAKE_PAGEID(tPid, pFid->volNo, apage->bm.hdr.cbFirst);
+            if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+        }
+
+        /* The side log of an online build which did not end */
+        if(apage->bm.hdr.slFirst != NIL){
+            MAKE_PAGEID(tPid, pFid->volNo, apage->bm.hdr.slFirst);
+            if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+        }
+
+        /* The freed pages kept for reuse are free already; they only go to the dealloc list */
+        for(i = 0; i < apage->bm.hdr.nFreePages; i++){
+            if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERRB1(e, curPid, PAGE_BUF);
+            dlElem->type = DL_PAGE;
+            MAKE_PAGEID(dlElem->elem.pid, pFid->volNo, apage->bm.freePages[i]);
+            dlElem->next = dlHead->next;
+            dlHead->next = dlElem;
+        }
+        apage->bm.hdr.nFreePages = 0;
+
+        /* So are the pages of the leaf run of the file not given out yet */
+        for(i = apage->bm.hdr.runNext; i < apage->bm.hdr.nRunPages; i++){
+            if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERRB1(e, curPid, PAGE_BUF);
+            dlElem->type = DL_PAGE;
+            MAKE_PAGEID(dlElem->elem.pid, pFid->volNo, apage->bm.runPages[i]);
+            dlElem->next = dlHead->next;
+            dlHead->next = dlElem;
+        }
+        apage->bm.hdr.nRunPages = apage->bm.hdr.runNext = 0;
+    }
+    else if(apage->any.hdr.type & CHANGEBUFFER){
+        /* The rest of the change buffer pages */
+        if(apage->bc.hdr.nextPage != NIL){
+            MAKE_PAGEID(tPid, pFid->volNo, apage->bc.hdr.nextPage);
+            if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+        }
+    }
+
     /* Set the type of the page to FREEPAGE */
     apage->any.hdr.type = FREEPAGE;
 
     /* Deallocate the page */
     /* Insert the deallocated page into the dealloc list */
-    if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERR(e); 
+    if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERRB1(e, curPid, PAGE_BUF);
     dlElem->type = DL_PAGE;    
     dlElem->elem.pid = *curPid;
     dlElem->next = dlHead->next;
     dlHead->next = dlElem;
 
     /* Set the DIRTY bit */
-    if((e = BfM_SetDirty(apage, PAGE_BUF))<0) ERRB1(e, apage, PAGE_BUF);
+    if((e = BfM_SetDirty((TrainID*)curPid, PAGE_BUF))<0) ERRB1(e, curPid, PAGE_BUF);
 
     /* Unfix the page from the buffer*/
-    if((e = BfM_FreeTrain(apage, PAGE_BUF))<0) ERR(e);
+    if((e = BfM_FreeTrain((TrainID*)curPid, PAGE_BUF))<0) ERR(e);
 
     /**/        
     return(eNOERROR);
     
 }   /* edubtm_FreePages() */
+
+
+
+/*@================================
+ * edubtm_DropTree()
+ *================================*/
+/*
+ * Function: Four edubtm_DropTree(FileID*, PageID*, Pool*, DeallocListElem*)
+ *
+ * Description :
+ *  Free all pages of the tree whose root is 'curPid', reading only the
+ *  internal pages. The children of a page marked BTM_LEAFPARENT are put
+ *  into the dealloc list without being fixed: the leaves made by EduBtM
+ *  keep all of their ObjectIDs in the entries, so no overflow page list
+ *  hangs from them, and nothing in a leaf has to be looked at. The leaves
+ *  are about 99% of the pages of a tree, so dropping a tree costs the
+ *  reads of its internal levels only.
+ *
+ *  The pages of other kinds, and the children of the internal pages made
+ *  before the levels were marked, are freed by edubtm_FreePages(...).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  The leaves are not marked FREEPAGE, so this is only for a tree no cursor
+ *  may go on with, i.e. a dropped index.
+ */
+Four edubtm_DropTree(
+    PhysicalFileID      *pFid,          /* IN FileID of the Btree file */
+    PageID              *curPid,        /* IN root of the tree to be freed */
+    Pool                *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem     *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                e;              /* error number */
+    Two                 i;              /* child No. */
+    Boolean             leafParent;     /* TRUE if the children are leaves */
+    PageID              tPid;           /* a child page */
+    BtreePage           *apage;         /* a page pointer */
+    DeallocListElem     *dlElem;        /* an element of dealloc list */
+
+
+    if((e = BfM_GetTrain((TrainID*)curPid, (char**)&apage, PAGE_BUF))<0) ERR(e);
+
+    /* A leaf root has nothing below it to skip */
+    if(!(apage->any.hdr.type & INTERNAL)){
+        if((e = BfM_FreeTrain((TrainID*)curPid, PAGE_BUF))<0) ERR(e);
+        return(edubtm_FreePages(pFid, curPid, dlPool, dlHead));
+    }
+
+    /* The meta page of the index hangs from the root */
+    if((apage->any.hdr.type & ROOT) && apage->any.hdr.reserved != NIL){
+        MAKE_PAGEID(tPid, pFid->volNo, apage->any.hdr.reserved);
+        if((e = edubtm_FreePages(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+    }
+
+    leafParent = (apage->bi.hdr.flags & BTM_LEAFPARENT) ? TRUE : FALSE;
+
+    for(i = -1; i < apage->bi.hdr.nSlots; i++){
+        if(i == -1) MAKE_PAGEID(tPid, pFid->volNo, apage->bi.hdr.p0);
+        else MAKE_PAGEID(tPid, pFid->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-i]]))->spid);
+
+        if(leafParent){
+            /* The leaf goes to the dealloc list unread */
+            if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERRB1(e, curPid, PAGE_BUF);
+            dlElem->type = DL_PAGE;
+            dlElem->elem.pid = tPid;
+            dlElem->next = dlHead->next;
+            dlHead->next = dlElem;
+        }
+        else{
+            if((e = edubtm_DropTree(pFid, &tPid, dlPool, dlHead))<0) ERRB1(e, curPid, PAGE_BUF);
+        }
+    }
+
+    /* Set the type of the page to FREEPAGE and deallocate it */
+    apage->any.hdr.type = FREEPAGE;
+
+    if((e = Util_getElementFromPool(dlPool, &dlElem))<0) ERRB1(e, curPid, PAGE_BUF);
+    dlElem->type = DL_PAGE;
+    dlElem->elem.pid = *curPid;
+    dlElem->next = dlHead->next;
+    dlHead->next = dlElem;
+
+    if((e = BfM_SetDirty((TrainID*)curPid, PAGE_BUF))<0) ERRB1(e, curPid, PAGE_BUF);
+    if((e = BfM_FreeTrain((TrainID*)curPid, PAGE_BUF))<0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_DropTree() */
@@ -101,7 +101,8 @@ Four edubtm_InitInternal(
     apage = &(bpage->bi);
 
     page->hdr.pid = *internal;
-    page->hdr.flags |= BTREE_PAGE_TYPE;
+    page->hdr.flags = BTREE_PAGE_TYPE;
+    page->hdr.reserved = NIL;
     page->hdr.type = INTERNAL;
     if(root)
         page->hdr.type |= ROOT;
@@ -163,8 +164,9 @@ Four edubtm_InitLeaf(
     apage = &(bpage->bi);
 
     page->hdr.pid = *leaf;
-    page->hdr.flags |= BTREE_PAGE_TYPE;
-    page->hdr.type |= LEAF;
+    page->hdr.flags = BTREE_PAGE_TYPE;
+    page->hdr.reserved = NIL;
+    page->hdr.type = LEAF;
     if(root)
         page->hdr.type |= ROOT;
     page->hdr.nSlots = 0;    
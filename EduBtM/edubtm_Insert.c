@@ -59,10 +59,14 @@
  *  return values.
  *
  * Exports:
- *  Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
- *                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*, Four,
+ *                  Boolean*, ObjectID*, Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_CoupledInsert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *                          Four, Boolean*, ObjectID*, Pool*, DeallocListElem*)
+ *  Four edubtm_InsertWithMode(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *                          Four, Boolean*, ObjectID*, Pool*, DeallocListElem*)
  *  Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*, KeyValue*,
- *                      ObjectID*, Boolean*, Boolean*, InternalItem*)
+ *                      ObjectID*, Four, Boolean*, ObjectID*, Boolean*, Boolean*, InternalItem*)
  *  Four edubtm_InsertInternal(ObjectID*, BtreeInternal*, InternalItem*,
  *                          Two, Boolean*, InternalItem*)
  */
@@ -75,14 +79,18 @@
 #include "EduBtM_Internal.h"
 
 
+/*@ Internal Function Prototypes */
+Four edubtm_FindParent(PageID*, KeyDesc*, PageID*, InternalItem*, PageID*, BtreePage**);
+
+
 
 /*@================================
  * edubtm_Insert()
  *================================*/
 /*
  * Function: Four edubtm_Insert(ObjectID*, PageID*, KeyDesc*, KeyValue*,
- *                           ObjectID*, Boolean*, Boolean*, InternalItem*,
- *                           Pool*, DeallocListElem*)
+ *                           ObjectID*, Four, Boolean*, ObjectID*, Boolean*,
+ *                           Boolean*, InternalItem*, Pool*, DeallocListElem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -100,6 +108,15 @@
  *  inserted into the parent page.  'f' is TRUE if the given page is not half
  *  full because of creating a new overflow page.
  *
+ *  'mode' decides what to do when the key value already exists in the leaf:
+ *  BTM_INSERT fails with eDUPLICATEDKEY_BTM, BTM_INSERTIFABSENT leaves the
+ *  entry as it is, and BTM_UPSERT replaces its ObjectID. In the latter two
+ *  cases 'exists' is set and the ObjectID found is returned in 'oldOid', so
+ *  that the caller need not search the key value beforehand.
+ *
+ *  The caller holds the tree latch exclusively and is in the buffer manager
+ *  mutex; the latch-coupled insert is edubtm_CoupledInsert(...).
+ *
  * Returns:
  *  Error code
  *    eBADBTREEPAGE_BTM
@@ -111,6 +128,9 @@ Four edubtm_Insert(
     KeyDesc                     *kdesc,                 /* IN Btree key descriptor */
     KeyValue                    *kval,                  /* IN key value */
     ObjectID                    *oid,                   /* IN ObjectID which will be inserted */
+    Four                        mode,                   /* IN BTM_INSERT, BTM_INSERTIFABSENT, or BTM_UPSERT */
+    Boolean                     *exists,                /* OUT TRUE if the key value already exists */
+    ObjectID                    *oldOid,                /* OUT ObjectID of the existing key value, may be NULL */
     Boolean                     *f,                     /* OUT whether it is merged by creating a new overflow page */
     Boolean                     *h,                     /* OUT whether it is splitted */
     InternalItem                *item,                  /* OUT Internal Item which will be inserted */
@@ -122,9 +142,9 @@ Four edubtm_Insert(
     Four                        e;                      /* error number */
     Boolean                     lh;                     /* local 'h' */
     Boolean                     lf;                     /* local 'f' */
+    Boolean                     changed;                /* whether the root page is changed */
     Two                         idx;                    /* index for the given key value */
     PageID                      newPid;                 /* a new PageID */
-    KeyValue                    tKey;                   /* a temporary key */
     InternalItem                litem;                  /* a local internal item */
     BtreePage                   *apage;                 /* a pointer to the root page */
     btm_InternalEntry           *iEntry;                /* an internal entry */
@@ -143,19 +163,23 @@ Four edubtm_Insert(
     /**/    
     /*@ Initially the flags are FALSE */
     *h = *f = FALSE;
+    *exists = FALSE;
 
     if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
     GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
     MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERR(e);
 
     /* Fix the root page to the buffer */    
     if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
 
-    //printf("DBG : type = %d ", (apage->any.hdr.type)/*|(apage->bl.hdr.type)*/);
     if (apage->any.hdr.type & LEAF){
         /* Insert <key, oid> pair into the page, return the split information */
-        if ((e = edubtm_InsertLeaf(catObjForFile, root, (BtreeLeaf *)&(apage->bl), kdesc, kval, oid, f, h, item)) < 0) ERR(e);
-        if (*h) printf("Leaf Split\n");
+        if ((e = edubtm_InsertLeaf(catObjForFile, root, (BtreeLeaf *)&(apage->bl), kdesc, kval, oid, mode, exists, oldOid, f, h, item)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+
+        /* The leaf is left as it is if the key value exists and should not be replaced */
+        changed = (*exists && mode != BTM_UPSERT) ? FALSE : TRUE;
     }
 
     else if (apage->any.hdr.type & INTERNAL){
@@ -174,37 +198,32 @@ Four edubtm_Insert(
         }
         
         /* Recursive Call of edubtm_Insert */
-        printf("DBG : newPid = %d\n", newPid);    
-        if ((e = edubtm_Insert(catObjForFile, &newPid, kdesc, kval, oid, &lf, &lh, &litem, dlPool, dlHead)) < 0) ERR(e);
+        if ((e = edubtm_Insert(catObjForFile, &newPid, kdesc, kval, oid, mode, exists, oldOid, &lf, &lh, &litem, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
 
-        if (lh){
-            //printf("DBG : split case ");
+        /* The internal page is changed only by the split of the child */
+        changed = lh;
 
+        if (lh){
             /* Search the internal entry next to which the index entry for new page will be inserted */
-            if (edubtm_BinarySearchInternal((BtreeInternal *)&(apage->bi), kdesc, (KeyValue *)&(litem.klen), &idx) == TRUE) ERR(e);
-            printf("DBG : kval = ");
-            for (int i = 0; i < litem.klen; i++){
-                printf("%c", *(char *)(litem.kval + i));
-            }
-            printf("\n");
-            printf("DBG : idx = %d\n", idx);
+            edubtm_BinarySearchInternal((BtreeInternal *)&(apage->bi), kdesc, (KeyValue *)&(litem.klen), &idx);
 
             /* Insert the index entry for new page, return the split information */
-            if ((e = edubtm_InsertInternal(catObjForFile, (BtreeInternal *)&(apage->bi), &litem, idx, h, item)) < 0) ERR(e);
-            if (*h) printf("Internal Split\n");
-            
-        
+            if ((e = edubtm_InsertInternal(catObjForFile, (BtreeInternal *)&(apage->bi), &litem, idx, h, item)) < 0)
+                ERRB1(e, root, PAGE_BUF);
+
+            /* The pending messages of the new page go with it */
+            if (*h)
+                if ((e = edubtm_SplitMsgBuffer(&(apage->bi), item, kdesc)) < 0) ERRB1(e, root, PAGE_BUF);
         }
     }
 
     /* Set the DIRTY bit */
-    if((e = BfM_SetDirty((TrainID*)root, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
+    if (changed)
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
     
     /* Unfix the root page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
-
-    /* Unfix the root page from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF))<0) ERR(e);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
     
     /**/    
     return(eNOERROR);    
@@ -212,13 +231,329 @@ Four edubtm_Insert(
 
 
 
+/*@================================
+ * edubtm_CoupledInsert()
+ *================================*/
+/*
+ * Function: Four edubtm_CoupledInsert(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *                                  Four, Boolean*, ObjectID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Insert <kval, oid> into an index which does not buffer the updates, as
+ *  in a B-link tree. The caller should hold the tree latch in the shared
+ *  mode. The leaf is found by edubtm_SearchLeaf(...) and latched
+ *  exclusively; no latch is held on the internal pages meanwhile.
+ *
+ *  When a page is split, it gets a right link to the new page and is
+ *  released at once. Then the separator is posted to the parent in a step
+ *  of its own, which latches only the parent, and the right link is removed
+ *  after the parent is released. So no latch is held across the levels.
+ *  A split of the root is the exception: the new root is made under the
+ *  latch of the root, as the root page never moves.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_CoupledInsert(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+-tree file */
+    PageID                      *root,          /* IN the root of a Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Four                        mode,           /* IN BTM_INSERT, BTM_INSERTIFABSENT, or BTM_UPSERT */
+    Boolean                     *exists,        /* OUT TRUE if the key value already exists */
+    ObjectID                    *oldOid,        /* OUT ObjectID of the existing key value, may be NULL */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* index for the separator */
+    Two                         level;          /* # of pages on the path above the current page */
+    Boolean                     f;              /* TRUE if the leaf is not half full */
+    Boolean                     h;              /* TRUE if the current page is split */
+    Boolean                     changed;        /* TRUE if the current page is changed */
+    Boolean                     posted;         /* TRUE if a separator has been posted to the current page */
+    Boolean                     isRoot;         /* TRUE if the current page is the root */
+    PageID                      pid;            /* the current page */
+    PageID                      right;          /* the page whose separator is posted */
+    InternalItem                item;           /* entry of the new page for the parent */
+    InternalItem                ritem;          /* entry of the new page of the parent */
+    BtreePage                   *apage;         /* pointer to the buffer holding the current page */
+    btm_TreePath                path;           /* internal pages visited by the descent */
+
+
+    /* Descend to the leaf which covers the key value, latching only the leaf */
+    if ((e = edubtm_SearchLeaf(root, kdesc, kval, FALSE, BTM_LATCH_X, &path, &pid, &apage)) < 0) ERR(e);
+
+    edubtm_EnterBfM();
+    e = edubtm_InsertLeaf(catObjForFile, &pid, &(apage->bl), kdesc, kval, oid, mode, exists, oldOid, &f, &h, &item);
+    edubtm_LeaveBfM();
+    if (e < 0) {
+        (Four) edubtm_UnfixPage(&pid, FALSE);
+        ERR(e);
+    }
+
+    /* The leaf is left as it is if the key value exists and should not be replaced */
+    changed = (*exists && mode != BTM_UPSERT) ? FALSE : TRUE;
+
+    posted = FALSE;
+    level = path.nPages;
+
+    for (;;) {
+        isRoot = (pid.pageNo == root->pageNo && pid.volNo == root->volNo) ? TRUE : FALSE;
+
+        if (h) {
+            if (isRoot) {
+                /* Make a new root under the latch of the root */
+                edubtm_EnterBfM();
+                e = edubtm_root_insert(catObjForFile, root, &item);
+                edubtm_LeaveBfM();
+            }
+            else
+                e = edubtm_SetRightLink(&pid, apage, &item);
+
+            if (e < 0) {
+                (Four) edubtm_UnfixPage(&pid, TRUE);
+                ERR(e);
+            }
+        }
+
+        if ((e = edubtm_UnfixPage(&pid, changed)) < 0) ERR(e);
+
+        /* The parent knows the page split below; its right link is not needed any more */
+        if (posted)
+            if ((e = edubtm_ClearRightLink(&right)) < 0) ERR(e);
+
+        if (!h || isRoot) break;
+
+        /* Post the separator of the new page to the parent */
+        MAKE_PAGEID(right, root->volNo, item.spid);
+        level--;
+
+        if ((e = edubtm_FindParent(root, kdesc, (level >= 0) ? &(path.pid[level]) : NULL, &item, &pid, &apage)) < 0) ERR(e);
+
+        edubtm_BinarySearchInternal(&(apage->bi), kdesc, (KeyValue*)&(item.klen), &idx);
+
+        edubtm_EnterBfM();
+        e = edubtm_InsertInternal(catObjForFile, &(apage->bi), &item, idx, &h, &ritem);
+        edubtm_LeaveBfM();
+        if (e < 0) {
+            (Four) edubtm_UnfixPage(&pid, FALSE);
+            ERR(e);
+        }
+
+        if (h) item = ritem;
+        changed = TRUE;
+        posted = TRUE;
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_CoupledInsert() */
+
+
+
+/*@================================
+ * edubtm_InsertWithMode()
+ *================================*/
+/*
+ * Function: Four edubtm_InsertWithMode(ObjectID*, PageID*, KeyDesc*, KeyValue*, ObjectID*,
+ *                                   Four, Boolean*, ObjectID*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Insert an ObjectID 'oid' whose key value is 'kval' into a Btree in one
+ *  descent, 'mode' deciding what to do when the key value already exists
+ *  (see edubtm_Insert(...)). The tree is latched as EduBtM_InsertObject(...)
+ *  does: a split is done with the tree latch held exclusively if the index
+ *  buffers its updates, and by latch coupling otherwise.
+ *
+ *  This is the body of EduBtM_InsertIfAbsent(...) and EduBtM_Upsert(...),
+ *  which check their parameters and call this with their mode.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  exists : TRUE if the key value already exists
+ *  oldOid : the ObjectID of the existing key value if not NULL
+ */
+Four edubtm_InsertWithMode(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN the root of Btree */
+    KeyDesc                     *kdesc,         /* IN key descriptor */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Four                        mode,           /* IN BTM_INSERTIFABSENT or BTM_UPSERT */
+    Boolean                     *exists,        /* OUT whether the key value already exists */
+    ObjectID                    *oldOid,        /* OUT ObjectID of the existing key value, may be NULL */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the key parts */
+    Boolean                     lh;             /* for spliting */
+    Boolean                     lf;             /* for merging */
+    Four                        latchMode;      /* mode of the tree latch */
+    InternalItem                item;           /* Internal Item */
+
+
+    /* Error check whether using not supported functionality by EduBtM */
+    for (i = 0; i < kdesc->nparts; i++) {
+        if (kdesc->kpart[i].type != SM_INT && kdesc->kpart[i].type != SM_VARSTRING)
+            ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* An index buffering the updates is latched exclusively; otherwise the pages are latched on the way down */
+    if ((e = edubtm_LatchIndex(root, &latchMode)) < 0) ERR(e);
+
+    /* Whether the key value exists cannot be told while the index is being built */
+    if (edubtm_InOnlineBuild(root)) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(eNOTSUPPORTED_EDUBTM);
+    }
+
+    /* The key value is in the Bloom filter before it can be found in the tree */
+    if ((e = edubtm_AddToBloomFilter(root, kval)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    if (latchMode == BTM_LATCH_S) {
+        e = edubtm_CoupledInsert(catObjForFile, root, kdesc, kval, oid, mode, exists, oldOid, dlPool, dlHead);
+
+        (Four) edubtm_UnlatchTree(root);
+        if (e < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    edubtm_EnterBfM();
+
+    /* The pending messages of the key value should reach the leaf first */
+    if ((e = edubtm_FlushPendingMessages(root, kdesc, kval, kval, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    if ((e = edubtm_Insert(catObjForFile, root, kdesc, kval, oid, mode, exists, oldOid,
+                           &lf, &lh, &item, dlPool, dlHead)) < 0) ERRTL(e, root);
+
+    /* If root page is splitted */
+    if (lh) {
+        if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERRTL(e, root);
+    }
+
+    edubtm_LeaveBfM();
+    (Four) edubtm_UnlatchTree(root);
+
+    return(eNOERROR);
+
+}   /* edubtm_InsertWithMode() */
+
+
+
+/*@================================
+ * edubtm_FindParent()
+ *================================*/
+/*
+ * Function: Four edubtm_FindParent(PageID*, KeyDesc*, PageID*, InternalItem*, PageID*, BtreePage**)
+ *
+ * Description:
+ *  Find and latch exclusively the internal page into which the separator
+ *  'item' of a split page should be posted. It is the page in which the key
+ *  of the separator leads to a child whose right links reach the new page.
+ *  The search starts at 'hint', the parent seen on the way down; if that
+ *  page has been split meanwhile, it moves right, and if the page does not
+ *  lead to the new page at all (e.g. the root has grown), it descends again
+ *  from the root. Only one page is latched at a time.
+ *
+ * Returns:
+ *  error code
+ *    eTRAVERSEPATH_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  parent : the page found
+ *  apage  : pointer to the buffer holding the page, fixed with an exclusive latch
+ */
+Four edubtm_FindParent(
+    PageID                      *root,          /* IN the root of a Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    PageID                      *hint,          /* IN parent seen by the descent, NULL if none */
+    InternalItem                *item,          /* IN separator to be posted */
+    PageID                      *parent,        /* OUT the parent */
+    BtreePage                   **apage)        /* OUT pointer to the buffer holding the parent */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* index of the child */
+    Boolean                     descending;     /* TRUE if the search has started over from the root */
+    PageID                      pid;            /* current page */
+    PageID                      child;          /* child for the separator */
+    PageID                      next;           /* right page of the current page */
+    PageID                      right;          /* the new page */
+    BtreePage                   *page;          /* pointer to the buffer holding the current page */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    MAKE_PAGEID(right, root->volNo, item->spid);
+
+    descending = (hint == NULL) ? TRUE : FALSE;
+    pid = (hint == NULL) ? *root : *hint;
+
+    for (;;) {
+        if ((e = edubtm_FixPage(&pid, &page, BTM_LATCH_X)) < 0) ERR(e);
+
+        if (!(page->any.hdr.type & INTERNAL)) {
+            if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+            if (descending) ERR(eTRAVERSEPATH_BTM);
+
+            descending = TRUE;
+            pid = *root;
+            continue;
+        }
+
+        edubtm_BinarySearchInternal(&(page->bi), kdesc, (KeyValue*)&(item->klen), &idx);
+        if (idx == -1) {
+            MAKE_PAGEID(child, root->volNo, page->bi.hdr.p0);
+        }
+        else {
+            iEntry = (btm_InternalEntry*)&(page->bi.data[page->bi.slot[-idx]]);
+            MAKE_PAGEID(child, root->volNo, iEntry->spid);
+        }
+
+        if (edubtm_ReachesRightLink(&child, &right)) break;
+
+        if (edubtm_FollowRightLink(&pid, page, kdesc, (KeyValue*)&(item->klen), FALSE, &next)) {
+            if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+            pid = next;
+            continue;
+        }
+
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+
+        if (descending) pid = child;
+        else {
+            descending = TRUE;
+            pid = *root;
+        }
+    }
+
+    *parent = pid;
+    *apage = page;
+
+    return(eNOERROR);
+
+}   /* edubtm_FindParent() */
+
+
+
 /*@================================
  * edubtm_InsertLeaf()
  *================================*/
 /*
  * Function: Four edubtm_InsertLeaf(ObjectID*, PageID*, BtreeLeaf*, KeyDesc*,
- *                               KeyValue*, ObjectID*, Boolean*, Boolean*,
- *                               InternalItem*)
+ *                               KeyValue*, ObjectID*, Four, Boolean*, ObjectID*,
+ *                               Boolean*, Boolean*, InternalItem*)
  *
  * Description:
  * (Following description is for original ODYSSEUS/COSMOS BtM.
@@ -226,13 +561,19 @@ Four edubtm_Insert(
  *
  *  Insert into the given leaf page an ObjectID with the given key.
  *
+ *  If the key value is already in the page, BTM_INSERT fails, while
+ *  BTM_INSERTIFABSENT and BTM_UPSERT return the ObjectID of the entry; the
+ *  latter also overwrites it with the given ObjectID in place.
+ *
  * Returns:
  *  Error code
  *    eDUPLICATEDKEY_BTM
  *    eDUPLICATEDOBJECTID_BTM
+ *    eNOTSUPPORTED_EDUBTM
  *    some errors causd by function calls
  *
  * Side effects:
+ *  0) exists : TRUE if the key value is already in the leaf page
  *  1) f : TRUE if the leaf page is underflowed by creating an overflow page
  *  2) h : TRUE if the leaf page is splitted by inserting the given ObjectID
  *  3) item : item to be inserted into the parent
@@ -244,6 +585,9 @@ Four edubtm_InsertLeaf(
     KeyDesc                     *kdesc,         /* IN Btree key descriptor */
     KeyValue                    *kval,          /* IN key value */
     ObjectID                    *oid,           /* IN ObjectID which will be inserted */
+    Four                        mode,           /* IN BTM_INSERT, BTM_INSERTIFABSENT, or BTM_UPSERT */
+    Boolean                     *exists,        /* OUT TRUE if the key value already exists */
+    ObjectID                    *oldOid,        /* OUT ObjectID of the existing key value, may be NULL */
     Boolean                     *f,             /* OUT whether it is merged by creating */
                                                 /*     a new overflow page */
     Boolean                     *h,             /* OUT whether it is splitted */
@@ -271,6 +615,7 @@ Four edubtm_InsertLeaf(
     }
     /*@ Initially the flags are FALSE */
     *h = *f = FALSE;
+    *exists = FALSE;
     
     /**/
     oidArrayElemNo = 1;
@@ -279,12 +624,29 @@ Four edubtm_InsertLeaf(
 
     /* Search the index entry next to which the new index entry will be inserted, return ERR if the key already exists */
     //printf("%d", *(Four *)(&(kval->val)));
-    if (edubtm_BinarySearchLeaf(page, kdesc, kval, &idx) == TRUE) ERR(eDUPLICATEDKEY_BTM);
+    if (edubtm_BinarySearchLeaf(page, kdesc, kval, &idx) == TRUE){
+        if (mode == BTM_INSERT) ERR(eDUPLICATEDKEY_BTM);
+
+        /* A key value has only one ObjectID in EduBtM */
+        entry = (btm_LeafEntry *)((char*)(page->data) + page->slot[-idx]);
+        if (entry->nObjects != 1) ERR(eNOTSUPPORTED_EDUBTM);
+
+        oidArray = (ObjectID *)&(entry->kval[ALIGNED_LENGTH(entry->klen)]);
+        if (oldOid != NULL) *oldOid = oidArray[0];
+        if (mode == BTM_UPSERT) {
+            oidArray[0] = *oid;
+            edubtm_BumpVersion(pid);
+        }
+
+        *exists = TRUE;
+        return(eNOERROR);
+    }
  
-    if(entryLen <= BL_FREE(page)){
+    /* The new entry needs a slot as well; the free space may be negative */
+    if(entryLen + (Four)sizeof(Two) <= (Four)BL_FREE(page)){
 
         /* Compact the page if needed */
-        if(entryLen > BL_CFREE(page)){
+        if(entryLen + (Four)sizeof(Two) > (Four)BL_CFREE(page)){
             edubtm_CompactLeafPage(page, NIL);
             //if ((e = edubtm_CompactLeafPage(page, NIL)) < 0) ERR(e);
         }
@@ -313,9 +675,12 @@ Four edubtm_InsertLeaf(
         /* Update page header */
         page->hdr.nSlots++;
         page->hdr.free = page->hdr.free + entryLen;  
+
+        /* The cached positions of the moved slots are no longer valid */
+        edubtm_BumpVersion(pid);
     }
 
-    else if(entryLen > BL_FREE(page)){        
+    else{        
         leaf.oid = *oid;        
         leaf.nObjects = oidArrayElemNo;
         leaf.klen = kval->len;
@@ -376,12 +741,13 @@ Four edubtm_InsertInternal(
     *h = FALSE;
 
     /**/
-    entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + entry->klen);    
+    entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + item->klen);    
 
-    if(entryLen <= BI_FREE(page)){
+    /* The new entry needs a slot as well; the free space may be negative */
+    if(entryLen + (Four)sizeof(Two) <= (Four)BI_FREE(page)){
 
         /* Compact the page if needed */
-        if(entryLen > BI_CFREE(page)){
+        if(entryLen + (Four)sizeof(Two) > (Four)BI_CFREE(page)){
             edubtm_CompactInternalPage(page, NIL);
             //if ((e = edubtm_CompactInternalPage(page, NIL)) < 0) ERR(e);
         }
@@ -409,9 +775,12 @@ Four edubtm_InsertInternal(
         page->hdr.free = page->hdr.free + entryLen;   
     }
 
-    else if(entryLen > BI_FREE(page)){
+    else{
         if ((e = edubtm_SplitInternal(catObjForFile, page, high, item, ritem)) < 0) ERR(e);
         *h = TRUE;
+
+        /* The new page may belong to the cached upper levels */
+        edubtm_StaleUpperCache(&(page->hdr.pid));
     }
     
     /**/
@@ -0,0 +1,454 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Interleave.c
+ *
+ * Description :
+ *  Run a batch of independent SM_EQ lookups interleaved with each other.
+ *  A single lookup waits for the memory at every level: the page it goes
+ *  to next is read as soon as it is known. Here each lookup is a probe in
+ *  a small state machine which goes down one level per step; a step pins
+ *  the next page, prefetches the parts of it the binary search reads
+ *  first, and passes on to the next probe. While the other probes take
+ *  their steps, the page is brought into the CPU cache, so the misses of
+ *  the probes overlap instead of adding up.
+ *
+ *  A probe reads the pages as edubtm_OptimisticSearchLeaf(...) does: the
+ *  internal pages are only pinned, searched by
+ *  edubtm_UnlatchedSearchInternal(...) and their versions are validated,
+ *  and the leaf is latched in the shared mode. A probe which a writer gets in
+ *  the way of is finished alone by edubtm_SearchLeaf(...).
+ *
+ * Exports:
+ *  Four edubtm_InterleavedLookup(PageID*, KeyDesc*, Four, BatchItem*, Boolean*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_StartProbe(PageID*, btm_UpperCache*, KeyDesc*, BatchItem*, Boolean*, btm_Probe*, Four);
+Four edubtm_StepProbe(PageID*, btm_UpperCache*, KeyDesc*, BatchItem*, Boolean*, btm_Probe*, Boolean*);
+Four edubtm_ProbeLeaf(PageID*, BtreePage*, KeyDesc*, BatchItem*, Boolean*);
+Four edubtm_SearchProbeAlone(PageID*, KeyDesc*, BatchItem*, Boolean*);
+
+
+/*@ Constant Definitions */
+#define BTM_CACHELINE   64      /* # of bytes of a CPU cache line */
+
+
+/*@ Macro: BTM_PREFETCH_PAGE(p)
+ *  Prefetch the header of the page, which tells its type and # of slots,
+ *  and the end of the page, where the slot array starts.
+ */
+#define BTM_PREFETCH_PAGE(p) \
+BEGIN_MACRO \
+    __builtin_prefetch((char*)(p), 0, 3); \
+    __builtin_prefetch((char*)(p) + PAGESIZE - BTM_CACHELINE, 0, 3); \
+END_MACRO
+
+
+
+/*@================================
+ * edubtm_InterleavedLookup()
+ *================================*/
+/*
+ * Function: Four edubtm_InterleavedLookup(PageID*, KeyDesc*, Four, BatchItem*, Boolean*)
+ *
+ * Description:
+ *  Look up the key values of the items, BTM_INTERLEAVEGROUP of them at a
+ *  time. When a probe finishes, it starts on the next item, so the group
+ *  stays full until the items run out. The order of the items does not
+ *  matter.
+ *
+ *  The caller holds the tree latch, and the pending updates of the keys,
+ *  if any, have been pushed down to the leaves.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  items : the ObjectID of each item whose key value is found
+ *  found : TRUE for each item whose key value is found
+ */
+Four edubtm_InterleavedLookup(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    Four                        nItems,         /* IN # of items */
+    BatchItem                   *items,         /* INOUT key values to look up */
+    Boolean                     *found)         /* OUT TRUE if the key value of the item is found */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the probes */
+    Two                         j;              /* index of the probes */
+    Four                        nextItem;       /* the next item to be given to a probe */
+    Two                         nActive;        /* # of probes in flight */
+    Boolean                     done;           /* TRUE if the probe has finished its item */
+    btm_UpperCache              *cache;         /* cache of the upper levels of the index */
+    btm_Probe                   probes[BTM_INTERLEAVEGROUP]; /* the probes */
+
+
+    if ((e = edubtm_EnterUpperCache(root, &cache)) < 0) ERR(e);
+
+    nextItem = 0;
+    nActive = 0;
+    for (i = 0; i < BTM_INTERLEAVEGROUP; i++) probes[i].item = NIL;
+
+    e = eNOERROR;
+    for (i = 0; i < BTM_INTERLEAVEGROUP; i++) {
+        /* An item finished at once leaves the probe free for the next one */
+        while (probes[i].item == NIL && nextItem < nItems) {
+            if ((e = edubtm_StartProbe(root, cache, kdesc, items, found, &probes[i], nextItem++)) < 0) break;
+        }
+        if (e < 0) break;
+        if (probes[i].item != NIL) nActive++;
+    }
+
+    /* Round robin over the probes; each step ends with the next page being prefetched */
+    while (e >= 0 && nActive > 0) {
+        for (i = 0; i < BTM_INTERLEAVEGROUP; i++) {
+            if (probes[i].item == NIL) continue;
+
+            if ((e = edubtm_StepProbe(root, cache, kdesc, items, found, &probes[i], &done)) < 0) break;
+            if (!done) continue;
+
+            /* The probe takes the next item, or retires */
+            probes[i].item = NIL;
+            nActive--;
+            while (probes[i].item == NIL && nextItem < nItems) {
+                if ((e = edubtm_StartProbe(root, cache, kdesc, items, found, &probes[i], nextItem++)) < 0) break;
+            }
+            if (e < 0) break;
+            if (probes[i].item != NIL) nActive++;
+        }
+    }
+
+    if (e < 0) {
+        /* The failed probe has released its page; the others still hold theirs */
+        for (j = 0; j < BTM_INTERLEAVEGROUP; j++)
+            if (probes[j].item != NIL && j != i)
+                (Four) edubtm_UnpinUpperPage(&probes[j].pid, probes[j].entry != NULL);
+
+        edubtm_LeaveUpperCache(cache);
+        ERR(e);
+    }
+
+    edubtm_LeaveUpperCache(cache);
+
+    return(eNOERROR);
+
+}   /* edubtm_InterleavedLookup() */
+
+
+
+/*@================================
+ * edubtm_StartProbe()
+ *================================*/
+/*
+ * Function: Four edubtm_StartProbe(PageID*, btm_UpperCache*, KeyDesc*, BatchItem*, Boolean*, btm_Probe*, Four)
+ *
+ * Description:
+ *  Give the item to the probe: pin the root and prefetch it. If a writer
+ *  holds the root, the item is looked up alone at once and the probe
+ *  stays idle.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  probe : the probe, with 'item' set to NIL if the item is done already
+ *
+ * Note:
+ *  On an error, the probe holds no page and 'item' is NIL.
+ */
+Four edubtm_StartProbe(
+    PageID                      *root,          /* IN root of the Btree */
+    btm_UpperCache              *cache,         /* IN cache of the upper levels, may be NULL */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    BatchItem                   *items,         /* INOUT key values to look up */
+    Boolean                     *found,         /* OUT TRUE if the key value of the item is found */
+    btm_Probe                   *probe,         /* INOUT the probe */
+    Four                        item)           /* IN item to be looked up */
+{
+    Four                        e;              /* error number */
+
+
+    probe->item = NIL;
+    found[item] = FALSE;
+
+    probe->pid = *root;
+    if (!edubtm_ReadVersion(&probe->pid, &probe->version)) {
+        if ((e = edubtm_SearchProbeAlone(root, kdesc, &items[item], &found[item])) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if ((e = edubtm_PinUpperPage(cache, &probe->pid, &probe->page, &probe->entry)) < 0) ERR(e);
+    BTM_PREFETCH_PAGE(probe->page);
+
+    probe->item = item;
+
+    return(eNOERROR);
+
+}   /* edubtm_StartProbe() */
+
+
+
+/*@================================
+ * edubtm_StepProbe()
+ *================================*/
+/*
+ * Function: Four edubtm_StepProbe(PageID*, btm_UpperCache*, KeyDesc*, BatchItem*, Boolean*, btm_Probe*, Boolean*)
+ *
+ * Description:
+ *  Read the page pinned by the probe. From an internal page the probe goes
+ *  to the child covering its key value, or to the right page if a split
+ *  is pending, and prefetches it; the next page is followed only if the
+ *  version of the page is unchanged after the next page's version is
+ *  read. A leaf is latched, validated and searched, which finishes the
+ *  item. If a validation fails, the item is looked up alone.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  probe : the probe, moved to the next page
+ *  done  : TRUE if the item of the probe is finished
+ *
+ * Note:
+ *  On an error, the probe holds no page.
+ */
+Four edubtm_StepProbe(
+    PageID                      *root,          /* IN root of the Btree */
+    btm_UpperCache              *cache,         /* IN cache of the upper levels, may be NULL */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    BatchItem                   *items,         /* INOUT key values to look up */
+    Boolean                     *found,         /* OUT TRUE if the key value of the item is found */
+    btm_Probe                   *probe,         /* INOUT the probe */
+    Boolean                     *done)          /* OUT TRUE if the item is finished */
+{
+    Four                        e;              /* error number */
+    One                         type;           /* type of the page */
+    Two                         slot;           /* slot of the child followed, BTM_NOCHILDREF if none */
+    UFour                       nVersion;       /* version of the next page */
+    Boolean                     right;          /* TRUE if the probe moves right */
+    Boolean                     consistent;     /* FALSE if the page is being written */
+    ShortPageID                 childNo;        /* page number of the child */
+    PageID                      next;           /* the child or the right page */
+    BtreePage                   *npage;         /* pointer to the buffer holding the next page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+    btm_CachedPage              *nEntry;        /* the next page in the cache, NULL if not cached */
+    KeyValue                    *kval;          /* key value of the probe */
+
+
+    *done = FALSE;
+    kval = &items[probe->item].kval;
+    type = probe->page->any.hdr.type;
+
+    if (type & INTERNAL) {
+
+        right = edubtm_FollowRightLink(&probe->pid, probe->page, kdesc, kval, FALSE, &next);
+        slot = BTM_NOCHILDREF;
+        consistent = TRUE;
+        if (!right) {
+            /* A page which does not look like an internal page is being written */
+            consistent = edubtm_UnlatchedSearchInternal(&(probe->page->bi), kdesc, kval, FALSE, &slot, &childNo);
+            if (consistent) MAKE_PAGEID(next, root->volNo, childNo);
+        }
+
+        /* The page changed under the probe */
+        if (!consistent || !edubtm_ValidateVersion(&probe->pid, probe->version) ||
+            !edubtm_ReadVersion(&next, &nVersion) || !edubtm_ValidateVersion(&probe->pid, probe->version)) {
+            if ((e = edubtm_UnpinUpperPage(&probe->pid, probe->entry != NULL)) < 0) ERR(e);
+            if ((e = edubtm_SearchProbeAlone(root, kdesc, &items[probe->item], &found[probe->item])) < 0) ERR(e);
+            *done = TRUE;
+            return(eNOERROR);
+        }
+
+        if ((e = edubtm_PinUpperChild(cache, probe->entry, slot, &next, &npage, &nEntry)) < 0) {
+            (Four) edubtm_UnpinUpperPage(&probe->pid, probe->entry != NULL);
+            ERR(e);
+        }
+        if ((e = edubtm_UnpinUpperPage(&probe->pid, probe->entry != NULL)) < 0) {
+            (Four) edubtm_UnpinUpperPage(&next, nEntry != NULL);
+            ERR(e);
+        }
+
+        /* The next page comes in while the other probes take their steps */
+        BTM_PREFETCH_PAGE(npage);
+
+        probe->pid = next;
+        probe->page = npage;
+        probe->entry = nEntry;
+        probe->version = nVersion;
+
+        return(eNOERROR);
+    }
+
+    /* Latch the leaf; its pin is kept until the latched fix is done */
+    if ((e = edubtm_FixPage(&probe->pid, &apage, BTM_LATCH_S)) < 0) {
+        (Four) edubtm_UnpinUpperPage(&probe->pid, probe->entry != NULL);
+        ERR(e);
+    }
+    if ((e = edubtm_UnpinUpperPage(&probe->pid, probe->entry != NULL)) < 0) {
+        (Four) edubtm_UnfixPage(&probe->pid, FALSE);
+        ERR(e);
+    }
+
+    *done = TRUE;
+
+    if (!edubtm_ValidateVersion(&probe->pid, probe->version)) {
+        if ((e = edubtm_UnfixPage(&probe->pid, FALSE)) < 0) ERR(e);
+        if ((e = edubtm_SearchProbeAlone(root, kdesc, &items[probe->item], &found[probe->item])) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if (!(type & LEAF)) {
+        (Four) edubtm_UnfixPage(&probe->pid, FALSE);
+        ERR(eBADBTREEPAGE_BTM);
+    }
+
+    if ((e = edubtm_MoveRightToLeaf(&probe->pid, &apage, kdesc, kval, FALSE, BTM_LATCH_S)) < 0) ERR(e);
+
+    if ((e = edubtm_ProbeLeaf(&probe->pid, apage, kdesc, &items[probe->item], &found[probe->item])) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_StepProbe() */
+
+
+
+/*@================================
+ * edubtm_ProbeLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_ProbeLeaf(PageID*, BtreePage*, KeyDesc*, BatchItem*, Boolean*)
+ *
+ * Description:
+ *  Search the leaf, fixed with a shared latch, for the key value of the
+ *  item, and release the leaf.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  item  : its ObjectID if the key value is found
+ *  found : TRUE if the key value is found
+ */
+Four edubtm_ProbeLeaf(
+    PageID                      *leaf,          /* IN leaf fixed with a shared latch */
+    BtreePage                   *apage,         /* IN pointer to the buffer holding the leaf */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    BatchItem                   *item,          /* INOUT item looked up */
+    Boolean                     *found)         /* OUT TRUE if the key value is found */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* slot of the key value */
+    btm_LeafEntry               *lEntry;        /* the entry of the key value */
+
+
+    *found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, &(item->kval), &idx);
+    if (*found) {
+        lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+        memcpy(&(item->oid), &(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)]), OBJECTID_SIZE);
+    }
+
+    if ((e = edubtm_UnfixPage(leaf, FALSE)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ProbeLeaf() */
+
+
+
+/*@================================
+ * edubtm_SearchProbeAlone()
+ *================================*/
+/*
+ * Function: Four edubtm_SearchProbeAlone(PageID*, KeyDesc*, BatchItem*, Boolean*)
+ *
+ * Description:
+ *  Look up the key value of the item by itself with edubtm_SearchLeaf(...),
+ *  which retries and falls back on latch coupling as needed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  item  : its ObjectID if the key value is found
+ *  found : TRUE if the key value is found
+ */
+Four edubtm_SearchProbeAlone(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    BatchItem                   *item,          /* INOUT item looked up */
+    Boolean                     *found)         /* OUT TRUE if the key value is found */
+{
+    Four                        e;              /* error number */
+    PageID                      leaf;           /* leaf covering the key value */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+
+
+    if ((e = edubtm_SearchLeaf(root, kdesc, &(item->kval), FALSE, BTM_LATCH_S, NULL, &leaf, &apage)) < 0) ERR(e);
+
+    if ((e = edubtm_ProbeLeaf(&leaf, apage, kdesc, item, found)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_SearchProbeAlone() */
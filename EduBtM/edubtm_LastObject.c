@@ -95,20 +95,10 @@ Four edubtm_LastObject(
 {
 	/* These local variables are used in the solution code. However, you don��t have to use all these variables in your code, and you may also declare and use additional local variables if needed. */
     int			i;
-    Four 		e;		/* error number */
-    Four 		cmp;		/* result of comparison */
-    BtreePage 		*apage;		/* pointer to the buffer holding current page */
-    BtreeOverflow 	*opage;		/* pointer to the buffer holding overflow page */
-    PageID 		curPid;		/* PageID of the current page */
-    PageID 		child;		/* PageID of the child page */
-    PageID 		ovPid;		/* PageID of the current overflow page */
-    PageID 		nextOvPid;	/* PageID of the next overflow page */
-    Two 		lEntryOffset;	/* starting offset of a leaf entry */
-    Two 		iEntryOffset;	/* starting offset of an internal entry */
-    btm_LeafEntry 	*lEntry;	/* a leaf entry */
-    btm_InternalEntry 	*iEntry;	/* an internal entry */
-    Four 		alignedKlen;	/* aligned length of the key length */
-        
+    Four 		e;		/* error */
+    PageID 		leaf;		/* PageID of the rightmost leaf */
+    BtreePage 		*apage;		/* a page pointer */
+    Boolean		found;		/* TRUE if the leaf is known by the meta page */
 
     if (root == NULL) ERR(eBADPAGE_BTM);
 
@@ -118,28 +108,20 @@ Four edubtm_LastObject(
         if(kdesc->kpart[i].type!=SM_INT && kdesc->kpart[i].type!=SM_VARSTRING)
             ERR(eNOTSUPPORTED_EDUBTM);
     }
+
     /**/
-    curPid = *root;
-    while(TRUE){        
-        if((e = BfM_GetTrain((TrainID*)&curPid, (char**)&apage, PAGE_BUF)) < 0) ERR(e); 
-        if(apage->any.hdr.type == LEAF) break;
-        iEntryOffset = apage->bi.slot[-(apage->bi.hdr.nSlots-1)];
-        iEntry = (btm_LeafEntry *)(&(apage->bi.data[iEntryOffset]));
-        MAKE_PAGEID(child, root->volNo, iEntry->spid);
-        if((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF))<0) ERR(e);
-        curPid = child;
+    /* The meta page usually knows the rightmost leaf */
+    if ((e = edubtm_GetEndLeaf(root, TRUE, &leaf, &apage, &found)) < 0) ERR(e);
+
+    if (!found) {
+        /* Descend along the rightmost children, validating their versions */
+        if ((e = edubtm_SearchLeaf(root, kdesc, NULL, TRUE, BTM_LATCH_S, NULL, &leaf, &apage)) < 0) ERR(e);
+        if ((e = edubtm_SetEndLeaf(root, TRUE, &leaf, apage)) < 0) { (Four) edubtm_UnfixPage(&leaf, FALSE); ERR(e); }
     }
-    
-    lEntryOffset = apage->bl.slot[-(apage->bl.hdr.nSlots-1)];
-    lEntry = (btm_LeafEntry *)(&(apage->bl.data[lEntryOffset]));
 
-    cursor->flag = CURSOR_ON;
-    alignedKlen = ALIGNED_LENGTH(lEntry->klen);
-    cursor->oid = *((ObjectID *)(&(lEntry->kval[0]) + alignedKlen));
-    cursor->key = *((KeyValue *)(&(lEntry->klen)));
-    cursor->leaf = curPid;
-    cursor->slotNo = apage->bl.hdr.nSlots-1;
-    cursor->oidArrayElemNo = 1;     
+    /* An empty leaf is skipped over; the leaf is released here */
+    if ((e = edubtm_PositionCursor(&leaf, apage, apage->bl.hdr.nSlots-1, FALSE, kdesc, stopKval, stopCompOp, cursor)) < 0) ERR(e);
+
     /**/
     return(eNOERROR);
     
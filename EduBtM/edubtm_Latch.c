@@ -0,0 +1,780 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Latch.c
+ *
+ * Description :
+ *  Reader/writer latches for the concurrent operations on an index.
+ *  The buffer manager does not latch the pages, so the latches are kept in
+ *  a table of this module keyed by the PageID; an entry is used only while
+ *  some thread holds or waits for the latch. The buffer manager is not
+ *  thread-safe either, so every call of it is made in the buffer manager
+ *  mutex of the table. No thread waits for a latch in the mutex.
+ *
+ *  Fetch and FetchNext couple the shared latches along the leaf chain.
+ *  InsertObject into an index which does not buffer the updates latches
+ *  one page at a time: a split page is released at once with a right link
+ *  to its new page, and the separator is posted to the parent afterwards.
+ *  The other operations latch the whole index exclusively.
+ *
+ *  A search reads the internal pages optimistically: it only pins them and
+ *  checks afterwards that their version words did not change meanwhile.
+ *
+ * Exports:
+ *  void edubtm_InitLatchTable(void)
+ *  Four edubtm_LatchPage(PageID*, Four)
+ *  Four edubtm_UnlatchPage(PageID*)
+ *  Four edubtm_LatchTree(PageID*, Four)
+ *  Four edubtm_UnlatchTree(PageID*)
+ *  Four edubtm_LatchIndex(PageID*, Four*)
+ *  void edubtm_EnterBfM(void)
+ *  void edubtm_LeaveBfM(void)
+ *  Four edubtm_FixPage(PageID*, BtreePage**, Four)
+ *  Four edubtm_UnfixPage(PageID*, Boolean)
+ *  Boolean edubtm_ReadVersion(PageID*, UFour*)
+ *  Boolean edubtm_ValidateVersion(PageID*, UFour)
+ *  void edubtm_BumpVersion(PageID*)
+ *  Four edubtm_PinPage(PageID*, BtreePage**)
+ *  Four edubtm_UnpinPage(PageID*)
+ *  Four edubtm_MoveToSibling(PageID*, BtreePage**, Boolean, Boolean*)
+ */
+
+
+#include <pthread.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_LatchTable btm_latchTable;                          /* the latch table */
+pthread_once_t btm_latchTableOnce = PTHREAD_ONCE_INIT;  /* initializes the latch table once */
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_AcquireLatch(PageID*, One, Four);
+Four edubtm_ReleaseLatch(PageID*, One);
+
+
+/*@ Macro: BTM_LATCH_HASH(pid, kind)
+ * Description: return the hash value of a latch
+ */
+#define BTM_LATCH_HASH(pid, kind) \
+    ((Four)((((unsigned)(pid)->volNo*31 + (unsigned)(pid)->pageNo)*2 + (kind)) % BTM_LATCH_HASHSIZE))
+
+/*@ Macro: BTM_VERSION_WORD(pid)
+ * Description: return the version word of a page
+ */
+#define BTM_VERSION_WORD(pid) \
+    (&btm_latchTable.versions[((unsigned)(pid)->volNo*31 + (unsigned)(pid)->pageNo) % BTM_VERSION_HASHSIZE])
+
+
+
+/*@================================
+ * edubtm_InitLatchTable()
+ *================================*/
+/*
+ * Function: void edubtm_InitLatchTable(void)
+ *
+ * Description:
+ *  Initialize the latch table. It is called once through pthread_once(),
+ *  before the first latch is acquired.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_InitLatchTable(void)
+{
+    Four                        i;              /* index */
+    pthread_mutexattr_t         attr;           /* attribute of the buffer manager mutex */
+
+
+    pthread_mutex_init(&btm_latchTable.mutex, NULL);
+
+    /* An operation latching the index exclusively enters the mutex again in its callees */
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&btm_latchTable.bfmMutex, &attr);
+    pthread_mutexattr_destroy(&attr);
+
+    for (i = 0; i < BTM_LATCH_HASHSIZE; i++)
+        btm_latchTable.hashTable[i] = NIL;
+
+    for (i = 0; i < BTM_VERSION_HASHSIZE; i++)
+        btm_latchTable.versions[i] = 0;
+
+    for (i = 0; i < BTM_MAXLATCHES; i++) {
+        pthread_rwlock_init(&btm_latchTable.entries[i].rwlock, NULL);
+        btm_latchTable.entries[i].nUsers = 0;
+        btm_latchTable.entries[i].exclusive = FALSE;
+        btm_latchTable.entries[i].next = (i < BTM_MAXLATCHES-1) ? i+1 : NIL;
+    }
+    btm_latchTable.freeList = 0;
+
+}   /* edubtm_InitLatchTable() */
+
+
+
+/*@================================
+ * edubtm_AcquireLatch()
+ *================================*/
+/*
+ * Function: Four edubtm_AcquireLatch(PageID*, One, Four)
+ *
+ * Description:
+ *  Acquire the latch of the given page or tree in the given mode, waiting
+ *  until it is granted. The exclusive latch of a page is counted in the
+ *  version word of the page. The entry of the latch is taken from the free list
+ *  if no thread uses the latch.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eLATCHTABLEFULL_BTM
+ */
+Four edubtm_AcquireLatch(
+    PageID                      *pid,           /* IN page, or root of the tree */
+    One                         kind,           /* IN BTM_PAGELATCH or BTM_TREELATCH */
+    Four                        mode)           /* IN BTM_LATCH_S or BTM_LATCH_X */
+{
+    Four                        hashValue;      /* hash value of the latch */
+    Four                        i;              /* index of the entry */
+    btm_LatchEntry              *entry;         /* entry of the latch */
+
+
+    if (mode != BTM_LATCH_S && mode != BTM_LATCH_X) ERR(eBADPARAMETER_BTM);
+
+    pthread_once(&btm_latchTableOnce, edubtm_InitLatchTable);
+
+    hashValue = BTM_LATCH_HASH(pid, kind);
+
+    pthread_mutex_lock(&btm_latchTable.mutex);
+
+    for (i = btm_latchTable.hashTable[hashValue]; i != NIL; i = btm_latchTable.entries[i].next) {
+        entry = &btm_latchTable.entries[i];
+        if (entry->kind == kind && entry->pid.pageNo == pid->pageNo && entry->pid.volNo == pid->volNo) break;
+    }
+
+    if (i == NIL) {
+        if (btm_latchTable.freeList == NIL) {
+            pthread_mutex_unlock(&btm_latchTable.mutex);
+            ERR(eLATCHTABLEFULL_BTM);
+        }
+
+        i = btm_latchTable.freeList;
+        entry = &btm_latchTable.entries[i];
+        btm_latchTable.freeList = entry->next;
+
+        entry->pid = *pid;
+        entry->kind = kind;
+        entry->next = btm_latchTable.hashTable[hashValue];
+        btm_latchTable.hashTable[hashValue] = i;
+    }
+
+    /* The entry is not reused while it has a user */
+    entry->nUsers++;
+
+    pthread_mutex_unlock(&btm_latchTable.mutex);
+
+    if (mode == BTM_LATCH_S)
+        pthread_rwlock_rdlock(&entry->rwlock);
+    else {
+        pthread_rwlock_wrlock(&entry->rwlock);
+        entry->exclusive = TRUE;
+
+        /* The optimistic readers of the page see the writer from now on */
+        if (kind == BTM_PAGELATCH) (void) __atomic_fetch_add(BTM_VERSION_WORD(pid), 1, __ATOMIC_SEQ_CST);
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_AcquireLatch() */
+
+
+
+/*@================================
+ * edubtm_ReleaseLatch()
+ *================================*/
+/*
+ * Function: Four edubtm_ReleaseLatch(PageID*, One)
+ *
+ * Description:
+ *  Release the latch of the given page or tree held by the calling thread.
+ *  Releasing the exclusive latch of a page bumps the version of the page.
+ *  The entry goes back to the free list when it has no user.
+ *
+ * Returns:
+ *  error code
+ *    eNOSUCHTREELATCH_BTM
+ */
+Four edubtm_ReleaseLatch(
+    PageID                      *pid,           /* IN page, or root of the tree */
+    One                         kind)           /* IN BTM_PAGELATCH or BTM_TREELATCH */
+{
+    Four                        hashValue;      /* hash value of the latch */
+    Four                        i;              /* index of the entry */
+    Four                        prev;           /* index of the previous entry in the hash chain */
+    btm_LatchEntry              *entry;         /* entry of the latch */
+
+
+    hashValue = BTM_LATCH_HASH(pid, kind);
+
+    pthread_mutex_lock(&btm_latchTable.mutex);
+
+    for (prev = NIL, i = btm_latchTable.hashTable[hashValue]; i != NIL; prev = i, i = btm_latchTable.entries[i].next) {
+        entry = &btm_latchTable.entries[i];
+        if (entry->kind == kind && entry->pid.pageNo == pid->pageNo && entry->pid.volNo == pid->volNo) break;
+    }
+
+    if (i == NIL) {
+        pthread_mutex_unlock(&btm_latchTable.mutex);
+        ERR(eNOSUCHTREELATCH_BTM);
+    }
+
+    /* A new version of the page is visible when the writer leaves it */
+    if (entry->exclusive) {
+        entry->exclusive = FALSE;
+        if (kind == BTM_PAGELATCH) (void) __atomic_fetch_add(BTM_VERSION_WORD(pid), BTM_VERSION_STEP-1, __ATOMIC_SEQ_CST);
+    }
+
+    pthread_rwlock_unlock(&entry->rwlock);
+
+    if (--entry->nUsers == 0) {
+        if (prev == NIL)
+            btm_latchTable.hashTable[hashValue] = entry->next;
+        else
+            btm_latchTable.entries[prev].next = entry->next;
+
+        entry->next = btm_latchTable.freeList;
+        btm_latchTable.freeList = i;
+    }
+
+    pthread_mutex_unlock(&btm_latchTable.mutex);
+
+    return(eNOERROR);
+
+}   /* edubtm_ReleaseLatch() */
+
+
+
+/*@================================
+ * edubtm_LatchPage()
+ *================================*/
+/*
+ * Function: Four edubtm_LatchPage(PageID*, Four)
+ *
+ * Description:
+ *  Acquire the latch of the page in the given mode.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_LatchPage(
+    PageID                      *pid,           /* IN page to be latched */
+    Four                        mode)           /* IN BTM_LATCH_S or BTM_LATCH_X */
+{
+    return(edubtm_AcquireLatch(pid, BTM_PAGELATCH, mode));
+
+}   /* edubtm_LatchPage() */
+
+
+
+/*@================================
+ * edubtm_UnlatchPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnlatchPage(PageID*)
+ *
+ * Description:
+ *  Release the latch of the page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnlatchPage(
+    PageID                      *pid)           /* IN latched page */
+{
+    return(edubtm_ReleaseLatch(pid, BTM_PAGELATCH));
+
+}   /* edubtm_UnlatchPage() */
+
+
+
+/*@================================
+ * edubtm_LatchTree()
+ *================================*/
+/*
+ * Function: Four edubtm_LatchTree(PageID*, Four)
+ *
+ * Description:
+ *  Acquire the latch of the whole index given by its root in the given mode.
+ *  The tree latch is acquired before any page latch of the index.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_LatchTree(
+    PageID                      *root,          /* IN root of the Btree */
+    Four                        mode)           /* IN BTM_LATCH_S or BTM_LATCH_X */
+{
+    return(edubtm_AcquireLatch(root, BTM_TREELATCH, mode));
+
+}   /* edubtm_LatchTree() */
+
+
+
+/*@================================
+ * edubtm_UnlatchTree()
+ *================================*/
+/*
+ * Function: Four edubtm_UnlatchTree(PageID*)
+ *
+ * Description:
+ *  Release the latch of the whole index given by its root.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnlatchTree(
+    PageID                      *root)          /* IN root of the Btree */
+{
+    return(edubtm_ReleaseLatch(root, BTM_TREELATCH));
+
+}   /* edubtm_UnlatchTree() */
+
+
+
+/*@================================
+ * edubtm_LatchIndex()
+ *================================*/
+/*
+ * Function: Four edubtm_LatchIndex(PageID*, Four*)
+ *
+ * Description:
+ *  Latch the index for an operation which can couple the page latches.
+ *  The tree is latched in the shared mode if the index does not buffer the
+ *  updates; otherwise the pending updates of the index may move anywhere,
+ *  so the tree is latched in the exclusive mode. A Bloom filter does not
+ *  need it: its bits are set in the buffer manager mutex, and a rebuild
+ *  latches the tree by itself.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  mode : BTM_LATCH_S or BTM_LATCH_X, the mode of the tree latch acquired
+ */
+Four edubtm_LatchIndex(
+    PageID                      *root,          /* IN root of the Btree */
+    Four                        *mode)          /* OUT mode of the tree latch */
+{
+    Four                        e;              /* error number */
+    Four                        flags;          /* flags of the root page */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root page */
+
+
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_S)) < 0) ERR(e);
+
+    if ((e = edubtm_FixPage(root, &rpage, BTM_LATCH_S)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+    flags = rpage->any.hdr.flags;
+    if ((e = edubtm_UnfixPage(root, FALSE)) < 0) {
+        (Four) edubtm_UnlatchTree(root);
+        ERR(e);
+    }
+
+    *mode = BTM_LATCH_S;
+    if (!(flags & BTM_XLATCHFLAGS)) return(eNOERROR);
+
+    /* The index buffers the updates */
+    if ((e = edubtm_UnlatchTree(root)) < 0) ERR(e);
+    if ((e = edubtm_LatchTree(root, BTM_LATCH_X)) < 0) ERR(e);
+    *mode = BTM_LATCH_X;
+
+    return(eNOERROR);
+
+}   /* edubtm_LatchIndex() */
+
+
+
+/*@================================
+ * edubtm_EnterBfM()
+ *================================*/
+/*
+ * Function: void edubtm_EnterBfM(void)
+ *
+ * Description:
+ *  Enter the buffer manager mutex. The mutex is recursive, and the calling
+ *  thread should not wait for any latch until it leaves the mutex.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_EnterBfM(void)
+{
+    pthread_once(&btm_latchTableOnce, edubtm_InitLatchTable);
+
+    pthread_mutex_lock(&btm_latchTable.bfmMutex);
+
+}   /* edubtm_EnterBfM() */
+
+
+
+/*@================================
+ * edubtm_LeaveBfM()
+ *================================*/
+/*
+ * Function: void edubtm_LeaveBfM(void)
+ *
+ * Description:
+ *  Leave the buffer manager mutex.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_LeaveBfM(void)
+{
+    pthread_mutex_unlock(&btm_latchTable.bfmMutex);
+
+}   /* edubtm_LeaveBfM() */
+
+
+
+/*@================================
+ * edubtm_FixPage()
+ *================================*/
+/*
+ * Function: Four edubtm_FixPage(PageID*, BtreePage**, Four)
+ *
+ * Description:
+ *  Latch the page in the given mode and fix it to the buffer.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FixPage(
+    PageID                      *pid,           /* IN page to be fixed */
+    BtreePage                   **apage,        /* OUT pointer to the buffer holding the page */
+    Four                        mode)           /* IN BTM_LATCH_S or BTM_LATCH_X */
+{
+    Four                        e;              /* error number */
+
+
+    if ((e = edubtm_LatchPage(pid, mode)) < 0) ERR(e);
+
+    edubtm_EnterBfM();
+    e = BfM_GetTrain((TrainID*)pid, (char**)apage, PAGE_BUF);
+    edubtm_LeaveBfM();
+
+    if (e < 0) {
+        (Four) edubtm_UnlatchPage(pid);
+        ERR(e);
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_FixPage() */
+
+
+
+/*@================================
+ * edubtm_UnfixPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnfixPage(PageID*, Boolean)
+ *
+ * Description:
+ *  Unfix the page fixed by edubtm_FixPage(...) and release its latch.
+ *  The page is set dirty first if 'dirty' is TRUE.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnfixPage(
+    PageID                      *pid,           /* IN page to be unfixed */
+    Boolean                     dirty)          /* IN TRUE if the page is updated */
+{
+    Four                        e;              /* error number */
+    Four                        e2;             /* error number of the unfix */
+
+
+    edubtm_EnterBfM();
+    e = (dirty) ? BfM_SetDirty((TrainID*)pid, PAGE_BUF) : eNOERROR;
+    e2 = BfM_FreeTrain((TrainID*)pid, PAGE_BUF);
+    edubtm_LeaveBfM();
+
+    (Four) edubtm_UnlatchPage(pid);
+
+    if (e < 0) ERR(e);
+    if (e2 < 0) ERR(e2);
+
+    return(eNOERROR);
+
+}   /* edubtm_UnfixPage() */
+
+
+/*@================================
+ * edubtm_ReadVersion()
+ *================================*/
+/*
+ * Function: Boolean edubtm_ReadVersion(PageID*, UFour*)
+ *
+ * Description:
+ *  Read the version of the page before reading the page optimistically.
+ *
+ * Returns:
+ *  FALSE if some writer holds the exclusive latch of the page (or of a
+ *  page of the same version word); TRUE otherwise
+ *
+ * Side effects:
+ *  version : the version read
+ */
+Boolean edubtm_ReadVersion(
+    PageID                      *pid,           /* IN page to be read */
+    UFour                       *version)       /* OUT version of the page */
+{
+    pthread_once(&btm_latchTableOnce, edubtm_InitLatchTable);
+
+    *version = __atomic_load_n(BTM_VERSION_WORD(pid), __ATOMIC_ACQUIRE);
+
+    return((*version & BTM_VERSION_WRITERS) ? FALSE : TRUE);
+
+}   /* edubtm_ReadVersion() */
+
+
+
+/*@================================
+ * edubtm_ValidateVersion()
+ *================================*/
+/*
+ * Function: Boolean edubtm_ValidateVersion(PageID*, UFour)
+ *
+ * Description:
+ *  Check that the page has not been latched exclusively since its version
+ *  was read by edubtm_ReadVersion(...). What has been read from the page
+ *  in between is consistent only if it is TRUE.
+ *
+ * Returns:
+ *  TRUE if the version is unchanged; FALSE otherwise
+ */
+Boolean edubtm_ValidateVersion(
+    PageID                      *pid,           /* IN page read optimistically */
+    UFour                       version)        /* IN version read before */
+{
+    /* The reads of the page may not be moved after the check */
+    __atomic_thread_fence(__ATOMIC_ACQUIRE);
+
+    return((__atomic_load_n(BTM_VERSION_WORD(pid), __ATOMIC_RELAXED) == version) ? TRUE : FALSE);
+
+}   /* edubtm_ValidateVersion() */
+
+
+
+/*@================================
+ * edubtm_BumpVersion()
+ *================================*/
+/*
+ * Function: void edubtm_BumpVersion(PageID*)
+ *
+ * Description:
+ *  Advance the version of a page changed under the exclusive tree latch,
+ *  i.e. without latching the page itself, so that the readers which keep
+ *  the version of the page see the change.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_BumpVersion(
+    PageID                      *pid)           /* IN page changed */
+{
+    pthread_once(&btm_latchTableOnce, edubtm_InitLatchTable);
+
+    (void) __atomic_fetch_add(BTM_VERSION_WORD(pid), BTM_VERSION_STEP, __ATOMIC_SEQ_CST);
+
+}   /* edubtm_BumpVersion() */
+
+
+
+/*@================================
+ * edubtm_PinPage()
+ *================================*/
+/*
+ * Function: Four edubtm_PinPage(PageID*, BtreePage**)
+ *
+ * Description:
+ *  Fix the page to the buffer without latching it, for an optimistic read.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_PinPage(
+    PageID                      *pid,           /* IN page to be pinned */
+    BtreePage                   **apage)        /* OUT pointer to the buffer holding the page */
+{
+    Four                        e;              /* error number */
+
+
+    edubtm_EnterBfM();
+    e = BfM_GetTrain((TrainID*)pid, (char**)apage, PAGE_BUF);
+    edubtm_LeaveBfM();
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_PinPage() */
+
+
+
+/*@================================
+ * edubtm_UnpinPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnpinPage(PageID*)
+ *
+ * Description:
+ *  Unfix the page fixed by edubtm_PinPage(...).
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnpinPage(
+    PageID                      *pid)           /* IN page to be unpinned */
+{
+    Four                        e;              /* error number */
+
+
+    edubtm_EnterBfM();
+    e = BfM_FreeTrain((TrainID*)pid, PAGE_BUF);
+    edubtm_LeaveBfM();
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_UnpinPage() */
+
+
+
+/*@================================
+ * edubtm_MoveToSibling()
+ *================================*/
+/*
+ * Function: Four edubtm_MoveToSibling(PageID*, BtreePage**, Boolean, Boolean*)
+ *
+ * Description:
+ *  Move from the given leaf, fixed with a shared latch, to its next leaf if
+ *  'forward' is TRUE or to its previous leaf otherwise. The sibling is
+ *  latched and fixed before the given leaf is released, so no update can
+ *  slip in between. Writers never wait for a latch while holding a leaf,
+ *  except for a new page no one else knows yet, so the coupling along the
+ *  leaf chain in either direction is safe.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  pid   : PageID of the sibling
+ *  apage : pointer to the buffer holding the sibling
+ *  eos   : TRUE if the leaf has no sibling in the direction; then the
+ *          given leaf is still fixed and latched
+ *
+ * Note:
+ *  On an error, the given leaf is released as well.
+ */
+Four edubtm_MoveToSibling(
+    PageID                      *pid,           /* INOUT current leaf */
+    BtreePage                   **apage,        /* INOUT pointer to the buffer holding the leaf */
+    Boolean                     forward,        /* IN TRUE to move to the next leaf */
+    Boolean                     *eos)           /* OUT TRUE if there is no sibling */
+{
+    Four                        e;              /* error number */
+    PageNo                      pageNo;         /* page number of the sibling */
+    PageID                      sibling;        /* PageID of the sibling */
+    BtreePage                   *spage;         /* pointer to the buffer holding the sibling */
+
+
+    /* The link fields are protected by the buffer manager mutex */
+    edubtm_EnterBfM();
+    pageNo = (forward) ? (*apage)->bl.hdr.nextPage : (*apage)->bl.hdr.prevPage;
+    edubtm_LeaveBfM();
+
+    *eos = (pageNo == NIL) ? TRUE : FALSE;
+    if (*eos) return(eNOERROR);
+
+    MAKE_PAGEID(sibling, pid->volNo, pageNo);
+
+    if ((e = edubtm_FixPage(&sibling, &spage, BTM_LATCH_S)) < 0) {
+        (Four) edubtm_UnfixPage(pid, FALSE);
+        ERR(e);
+    }
+    if ((e = edubtm_UnfixPage(pid, FALSE)) < 0) {
+        (Four) edubtm_UnfixPage(&sibling, FALSE);
+        ERR(e);
+    }
+
+    *pid = sibling;
+    *apage = spage;
+
+    return(eNOERROR);
+
+}   /* edubtm_MoveToSibling() */
+
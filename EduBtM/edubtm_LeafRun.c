@@ -0,0 +1,594 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_LeafRun.c
+ *
+ * Description :
+ *  Allocation of the pages of an index from runs of reserved pages and
+ *  from the pages freed in the index file.
+ *
+ *  A split asks for a page near the split leaf, but one page at a time the
+ *  disk manager scatters the leaves over the extents, and a scan along the
+ *  leaf chain reads the disk at random. Here a run of pages is reserved
+ *  from the extents of the B+ tree file at once, and the new leaves take
+ *  its pages in ascending order. The pages come from the extents of the
+ *  index file, so they never mix with the pages of the data file.
+ *
+ *  The pages freed by the deletes are kept in a free page list in a meta
+ *  page of the file instead of going back to the volume, and the splits
+ *  take them before the leaf run or the disk manager. The run and the list
+ *  are kept in the meta page of the index whose root is the first page of
+ *  the file, so that they are found again from the disk after a restart.
+ *
+ * Exports:
+ *  Four edubtm_GetIndexFile(ObjectID*, PhysicalFileID*, Two*)
+ *  Four edubtm_AllocLeafPage(ObjectID*, PageID*, PageID*)
+ *  Four edubtm_AllocIndexPage(ObjectID*, PageID*, PageID*)
+ *  Four edubtm_RecyclePages(ObjectID*, PageID*, DeallocListElem*, Pool*, DeallocListElem*)
+ *  Four edubtm_ReleaseLeafRun(PhysicalFileID*, PageID*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "RDsM.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+#include "OM_Internal.h"
+
+
+/*@ Global Variables */
+btm_LeafRun btm_leafRuns[BTM_MAXLEAFRUNS];     /* the leaf runs of the files */
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_LookupLeafRun(PhysicalFileID*, Boolean, btm_LeafRun**);
+Four edubtm_FindLeafRunMeta(ObjectID*, PhysicalFileID*, PageID*);
+Four edubtm_TakeFreePage(btm_LeafRun*, PageID*, PageID*, Boolean*);
+Four edubtm_ReserveLeafRun(PhysicalFileID*, BtreeMeta*, PageID*, Two);
+
+
+
+/*@================================
+ * edubtm_GetIndexFile()
+ *================================*/
+/*
+ * Function: Four edubtm_GetIndexFile(ObjectID*, PhysicalFileID*, Two*)
+ *
+ * Description:
+ *  Read the physical file ID and the extent fill factor of the B+ tree file
+ *  from its catalog object.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_GetIndexFile(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PhysicalFileID              *pFid,          /* OUT physical file ID of the index file */
+    Two                         *eff)           /* OUT extent fill factor of the index file */
+{
+    Four                        e;              /* error number */
+    SlottedPage                 *catPage;       /* buffer page containing the catalog object */
+    sm_CatOverlayForBtree       *catEntry;      /* B+ tree file catalog information */
+
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(*pFid, catEntry->fid.volNo, catEntry->firstPage);
+    *eff = catEntry->eff;
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_GetIndexFile() */
+
+
+
+/*@================================
+ * edubtm_LookupLeafRun()
+ *================================*/
+/*
+ * Function: Four edubtm_LookupLeafRun(PhysicalFileID*, Boolean, btm_LeafRun**)
+ *
+ * Description:
+ *  Find the entry of the file in the table of the leaf runs. A new entry
+ *  is made if 'create' is TRUE and the file has none; the meta page keeping
+ *  the leaf run and the free page list of the file is looked up again from
+ *  the first page of the file, as the table does not outlive the process.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  run : the entry of the file, NULL if not found or the table is full
+ */
+Four edubtm_LookupLeafRun(
+    PhysicalFileID              *pFid,          /* IN the B+ tree file */
+    Boolean                     create,         /* IN TRUE to make an entry if not exists */
+    btm_LeafRun                 **run)          /* OUT the entry of the file */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of an entry */
+    btm_LeafRun                 *freeRun;       /* an unused entry */
+
+
+    *run = NULL;
+
+    freeRun = NULL;
+    for (i = 0; i < BTM_MAXLEAFRUNS; i++) {
+        if (!btm_leafRuns[i].inUse) {
+            if (freeRun == NULL) freeRun = &btm_leafRuns[i];
+        }
+        else if (btm_leafRuns[i].fid.pageNo == pFid->pageNo && btm_leafRuns[i].fid.volNo == pFid->volNo) {
+            *run = &btm_leafRuns[i];
+            return(eNOERROR);
+        }
+    }
+
+    if (!create || freeRun == NULL) return(eNOERROR);
+
+    if ((e = edubtm_FindLeafRunMeta(NULL, pFid, &freeRun->metaPid)) < 0) ERR(e);
+
+    freeRun->inUse = TRUE;
+    freeRun->fid = *pFid;
+
+    *run = freeRun;
+
+    return(eNOERROR);
+
+}   /* edubtm_LookupLeafRun() */
+
+
+
+/*@================================
+ * edubtm_FindLeafRunMeta()
+ *================================*/
+/*
+ * Function: Four edubtm_FindLeafRunMeta(ObjectID*, PhysicalFileID*, PageID*)
+ *
+ * Description:
+ *  Find the meta page keeping the leaf run and the free page list of the
+ *  file, i.e. the meta page of the index whose root is the first page of the
+ *  file. If that index has no meta page yet, one is allocated when
+ *  'catObjForFile' is given. 'metaPid' gets NIL as its page number if the
+ *  first page is not the root of an index, e.g. after that index was
+ *  dropped, or has no meta page.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FindLeafRunMeta(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file, NULL not to allocate */
+    PhysicalFileID              *pFid,          /* IN the B+ tree file */
+    PageID                      *metaPid)       /* OUT meta page keeping the leaf run and the free page list */
+{
+    Four                        e;              /* error number */
+    Boolean                     isRoot;         /* TRUE if the first page is the root of an index */
+    PageID                      firstPid;       /* the first page of the file */
+    BtreePage                   *apage;         /* pointer to the buffer holding the first page */
+
+
+    MAKE_PAGEID(firstPid, pFid->volNo, pFid->pageNo);
+    MAKE_PAGEID(*metaPid, pFid->volNo, NIL);
+
+    if ((e = BfM_GetTrain((TrainID*)&firstPid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+    isRoot = ((apage->any.hdr.type & ROOT) && apage->any.hdr.pid.pageNo == firstPid.pageNo &&
+              apage->any.hdr.pid.volNo == firstPid.volNo) ? TRUE : FALSE;
+    if ((e = BfM_FreeTrain((TrainID*)&firstPid, PAGE_BUF)) < 0) ERR(e);
+
+    if (!isRoot) return(eNOERROR);
+
+    if ((e = edubtm_GetMetaPage(catObjForFile, &firstPid, (catObjForFile != NULL), metaPid)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_FindLeafRunMeta() */
+
+
+
+/*@================================
+ * edubtm_AllocLeafPage()
+ *================================*/
+/*
+ * Function: Four edubtm_AllocLeafPage(ObjectID*, PageID*, PageID*)
+ *
+ * Description:
+ *  Allocate a page for the new right sibling of a split leaf. A page freed
+ *  in the file is taken first; otherwise the page is the next one of the
+ *  leaf run of the file, and a new run is reserved near the split leaf when
+ *  the run is used up. If the file has no meta page to keep the run, i.e.
+ *  the first page of the file is not a root, or every entry of the table is
+ *  used by other files, the page is allocated alone as before.
+ *
+ *  The caller should be in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_AllocLeafPage(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *nearPid,       /* IN the split leaf */
+    PageID                      *newPid)        /* OUT PageID of the new page */
+{
+    Four                        e;              /* error number */
+    Two                         eff;            /* extent fill factor of the index file */
+    Boolean                     taken;          /* TRUE if a freed page is taken */
+    PhysicalFileID              pFid;           /* physical file ID of the index file */
+    PageID                      metaPid;        /* meta page keeping the leaf run */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    btm_LeafRun                 *run;           /* the entry of the file */
+
+
+    if ((e = edubtm_GetIndexFile(catObjForFile, &pFid, &eff)) < 0) ERR(e);
+
+    if ((e = edubtm_LookupLeafRun(&pFid, TRUE, &run)) < 0) ERR(e);
+    if (run != NULL && run->metaPid.pageNo == NIL) {
+        if ((e = edubtm_FindLeafRunMeta(catObjForFile, &pFid, &run->metaPid)) < 0) ERR(e);
+    }
+
+    /* No room to keep a run for the file */
+    if (run == NULL || run->metaPid.pageNo == NIL) {
+        if ((e = btm_AllocPage(catObjForFile, nearPid, newPid)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if ((e = edubtm_TakeFreePage(run, nearPid, newPid, &taken)) < 0) ERR(e);
+    if (taken) return(eNOERROR);
+
+    metaPid = run->metaPid;
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (mpage->hdr.runNext >= mpage->hdr.nRunPages) {
+        if ((e = edubtm_ReserveLeafRun(&pFid, mpage, nearPid, eff)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    }
+
+    MAKE_PAGEID(*newPid, pFid.volNo, mpage->runPages[mpage->hdr.runNext]);
+    mpage->hdr.runNext++;
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_AllocLeafPage() */
+
+
+
+/*@================================
+ * edubtm_AllocIndexPage()
+ *================================*/
+/*
+ * Function: Four edubtm_AllocIndexPage(ObjectID*, PageID*, PageID*)
+ *
+ * Description:
+ *  Allocate a page other than a leaf, e.g. the new page of a split internal
+ *  page or a new root. A page freed in the file is taken if any; the leaf
+ *  run is left to the leaves. The caller should be in the buffer manager
+ *  mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_AllocIndexPage(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *nearPid,       /* IN the new page is allocated near this page */
+    PageID                      *newPid)        /* OUT PageID of the new page */
+{
+    Four                        e;              /* error number */
+    Two                         eff;            /* extent fill factor of the index file */
+    Boolean                     taken;          /* TRUE if a freed page is taken */
+    PhysicalFileID              pFid;           /* physical file ID of the index file */
+    btm_LeafRun                 *run;           /* the entry of the file */
+
+
+    if ((e = edubtm_GetIndexFile(catObjForFile, &pFid, &eff)) < 0) ERR(e);
+
+    if ((e = edubtm_LookupLeafRun(&pFid, TRUE, &run)) < 0) ERR(e);
+    if (run != NULL) {
+        if ((e = edubtm_TakeFreePage(run, nearPid, newPid, &taken)) < 0) ERR(e);
+        if (taken) return(eNOERROR);
+    }
+
+    if ((e = btm_AllocPage(catObjForFile, nearPid, newPid)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_AllocIndexPage() */
+
+
+
+/*@================================
+ * edubtm_TakeFreePage()
+ *================================*/
+/*
+ * Function: Four edubtm_TakeFreePage(btm_LeafRun*, PageID*, PageID*, Boolean*)
+ *
+ * Description:
+ *  Take a page from the free page list of the file. The first page after
+ *  'nearPid' is preferred, so that a new right sibling follows its leaf;
+ *  if there is none, the last page of the list is taken.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  taken : TRUE if a page is taken
+ */
+Four edubtm_TakeFreePage(
+    btm_LeafRun                 *run,           /* IN the entry of the file */
+    PageID                      *nearPid,       /* IN the page is taken near this page */
+    PageID                      *newPid,        /* OUT PageID of the page taken */
+    Boolean                     *taken)         /* OUT TRUE if a page is taken */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index */
+    Two                         best;           /* index of the page taken */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    *taken = FALSE;
+
+    if (run->metaPid.pageNo == NIL) return(eNOERROR);
+
+    if ((e = BfM_GetTrain((TrainID*)&run->metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (mpage->hdr.nFreePages == 0) {
+        if ((e = BfM_FreeTrain((TrainID*)&run->metaPid, PAGE_BUF)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    best = mpage->hdr.nFreePages - 1;
+    for (i = 0; i < mpage->hdr.nFreePages; i++) {
+        if (mpage->freePages[i] > nearPid->pageNo &&
+            (mpage->freePages[best] <= nearPid->pageNo || mpage->freePages[i] < mpage->freePages[best]))
+            best = i;
+    }
+
+    MAKE_PAGEID(*newPid, run->metaPid.volNo, mpage->freePages[best]);
+    mpage->freePages[best] = mpage->freePages[--mpage->hdr.nFreePages];
+
+    *taken = TRUE;
+
+    if ((e = BfM_SetDirty((TrainID*)&run->metaPid, PAGE_BUF)) < 0) ERRB1(e, &run->metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&run->metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_TakeFreePage() */
+
+
+
+/*@================================
+ * edubtm_ReserveLeafRun()
+ *================================*/
+/*
+ * Function: Four edubtm_ReserveLeafRun(PhysicalFileID*, BtreeMeta*, PageID*, Two)
+ *
+ * Description:
+ *  Reserve a new run of pages for the file by one call of the disk manager,
+ *  and keep them in the meta page sorted by the page number so that they
+ *  are given out forward. The caller sets the meta page dirty.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ReserveLeafRun(
+    PhysicalFileID              *pFid,          /* IN the B+ tree file */
+    BtreeMeta                   *mpage,         /* INOUT meta page keeping the leaf run */
+    PageID                      *nearPid,       /* IN the run is reserved near this page */
+    Two                         eff)            /* IN extent fill factor of the index file */
+{
+    Four                        e;              /* error number */
+    Four                        firstExtNo;     /* first extent of the index file */
+    Two                         i;              /* index */
+    Two                         j;              /* index */
+    ShortPageID                 tPageNo;        /* a temporary page number */
+    PageID                      pages[BTM_LEAFRUN_PAGES]; /* the pages reserved */
+
+
+    if ((e = RDsM_PageIdToExtNo((PageID*)pFid, &firstExtNo)) < 0) ERR(e);
+    if ((e = RDsM_AllocTrains(pFid->volNo, firstExtNo, nearPid, eff, BTM_LEAFRUN_PAGES, PAGESIZE2, pages)) < 0)
+        ERR(e);
+
+    for (i = 0; i < BTM_LEAFRUN_PAGES; i++) {
+        tPageNo = pages[i].pageNo;
+        for (j = i; j > 0 && mpage->runPages[j-1] > tPageNo; j--)
+            mpage->runPages[j] = mpage->runPages[j-1];
+        mpage->runPages[j] = tPageNo;
+    }
+
+    mpage->hdr.nRunPages = BTM_LEAFRUN_PAGES;
+    mpage->hdr.runNext = 0;
+
+    return(eNOERROR);
+
+}   /* edubtm_ReserveLeafRun() */
+
+
+
+/*@================================
+ * edubtm_RecyclePages()
+ *================================*/
+/*
+ * Function: Four edubtm_RecyclePages(ObjectID*, PageID*, DeallocListElem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Take back the pages which an operation on the index put into the dealloc
+ *  list, i.e. the elements before 'mark', into the free page list of the
+ *  file. The list is kept in the meta page of the index whose root is the
+ *  first page of the file, which is allocated if it does not exist yet. The
+ *  pages which do not fit, or all of them if the first page is not a root
+ *  any more, stay in the dealloc list and go back to the volume with it.
+ *  The end leaves remembered by the meta page of the index are cleared, and
+ *  the cache of its upper levels, the model of its leaves and its result
+ *  cache are dropped.
+ *
+ *  The caller holds the exclusive latch of the tree and is in the buffer
+ *  manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_RecyclePages(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    DeallocListElem             *mark,          /* IN first element of the list before the operation */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         eff;            /* extent fill factor of the index file */
+    PhysicalFileID              pFid;           /* physical file ID of the index file */
+    PageID                      metaPid;        /* meta page keeping the free page list */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    btm_LeafRun                 *run;           /* the entry of the file */
+    DeallocListElem             *prev;          /* the element before 'dlElem' */
+    DeallocListElem             *dlElem;        /* an element of dealloc list */
+
+
+    /* Nothing was freed */
+    for (dlElem = dlHead->next; dlElem != mark; dlElem = dlElem->next)
+        if (dlElem->type == DL_PAGE) break;
+    if (dlElem == mark) return(eNOERROR);
+
+    /* A freed page may have been an end leaf, and may become a leaf of another index */
+    if ((e = edubtm_ForgetEndLeaves(root)) < 0) ERR(e);
+
+    /* A freed page may be held by the cache of the upper levels */
+    if ((e = edubtm_ReleaseUpperCache(root)) < 0) ERR(e);
+
+    /* The model of the leaves and the cached results may point to a page of another index later */
+    edubtm_DropLearnedIndex(root);
+    edubtm_DropResultCache(root);
+
+    if ((e = edubtm_GetIndexFile(catObjForFile, &pFid, &eff)) < 0) ERR(e);
+
+    /* The splits could not find the list; the pages go back to the volume */
+    if ((e = edubtm_LookupLeafRun(&pFid, TRUE, &run)) < 0) ERR(e);
+    if (run == NULL) return(eNOERROR);
+
+    if (run->metaPid.pageNo == NIL) {
+        if ((e = edubtm_FindLeafRunMeta(catObjForFile, &pFid, &run->metaPid)) < 0) ERR(e);
+        if (run->metaPid.pageNo == NIL) return(eNOERROR);
+    }
+    metaPid = run->metaPid;
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    prev = dlHead;
+    dlElem = dlHead->next;
+    while (dlElem != mark && mpage->hdr.nFreePages < BTM_MAXFREEPAGES) {
+        if (dlElem->type != DL_PAGE || dlElem->elem.pid.volNo != metaPid.volNo) {
+            prev = dlElem;
+            dlElem = dlElem->next;
+            continue;
+        }
+
+        mpage->freePages[mpage->hdr.nFreePages++] = dlElem->elem.pid.pageNo;
+
+        prev->next = dlElem->next;
+        if ((e = Util_freeElementToPool(dlPool, dlElem)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+        dlElem = prev->next;
+    }
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_RecyclePages() */
+
+
+
+/*@================================
+ * edubtm_ReleaseLeafRun()
+ *================================*/
+/*
+ * Function: Four edubtm_ReleaseLeafRun(PhysicalFileID*, PageID*)
+ *
+ * Description:
+ *  Drop the entry of the file when the index whose meta page keeps the leaf
+ *  run and the free page list of the file, i.e. the index whose root is the
+ *  first page of the file, is dropped. The pages of the run not given out
+ *  yet and the pages of the list are freed with the meta page; the entry is
+ *  looked up again when the first page is a root again. The entry is kept
+ *  when another index of the file is dropped. The caller should be in the
+ *  buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ReleaseLeafRun(
+    PhysicalFileID              *pFid,          /* IN the B+ tree file */
+    PageID                      *metaPid)       /* IN meta page of the dropped index, NIL if none */
+{
+    Four                        e;              /* error number */
+    btm_LeafRun                 *run;           /* the entry of the file */
+
+
+    if ((e = edubtm_LookupLeafRun(pFid, FALSE, &run)) < 0) ERR(e);
+    if (run == NULL) return(eNOERROR);
+
+    if (run->metaPid.pageNo == NIL ||
+        (run->metaPid.pageNo == metaPid->pageNo && run->metaPid.volNo == metaPid->volNo))
+        run->inUse = FALSE;
+
+    return(eNOERROR);
+
+}   /* edubtm_ReleaseLeafRun() */
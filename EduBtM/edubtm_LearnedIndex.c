@@ -0,0 +1,534 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_LearnedIndex.c
+ *
+ * Description :
+ *  Learned model over the leaf level of a read-mostly index whose key is a
+ *  single SM_INT part. The leaves are numbered in key order when the model
+ *  is built, and a few linear segments map a key value to the number of
+ *  the leaf covering it within BTM_LEARNEDERROR leaves; the first keys of
+ *  the leaves kept with the model correct the guess. A lookup thus goes to
+ *  the leaf directly, without reading the internal pages.
+ *
+ *  The model is not changed by the updates. A leaf found through it is
+ *  checked against the key value under its latch, and a lookup whose key
+ *  value has moved to another leaf (by a split) goes down the tree as
+ *  usual. When such misses become frequent, the model is no longer used
+ *  until it is built again. The operations freeing pages of the index drop
+ *  the model, since a freed leaf may become a page of another index.
+ *
+ * Exports:
+ *  Four edubtm_BuildLearnedIndex(PageID*, KeyDesc*)
+ *  void edubtm_DropLearnedIndex(PageID*)
+ *  Four edubtm_LearnedSearchLeaf(PageID*, KeyDesc*, KeyValue*, Four, PageID*, BtreePage**, Boolean*)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_LearnedIndex btm_learnedIndexes[BTM_MAXLEARNEDINDEXES];  /* the models, in the buffer manager mutex */
+
+
+/*@ Internal Function Prototypes */
+btm_LearnedIndex *edubtm_LookupLearnedIndex(PageID*);
+Four edubtm_ReadLeafLevel(PageID*, Four*, Four**, ShortPageID**);
+Boolean edubtm_FitSegments(btm_LearnedIndex*);
+Four edubtm_PredictLeaf(btm_LearnedIndex*, Four);
+
+
+
+/*@================================
+ * edubtm_LookupLearnedIndex()
+ *================================*/
+/*
+ * Function: btm_LearnedIndex *edubtm_LookupLearnedIndex(PageID*)
+ *
+ * Description:
+ *  Find the model of the index. The caller should be in the buffer manager
+ *  mutex.
+ *
+ * Returns:
+ *  the model, or NULL if the index has none
+ */
+btm_LearnedIndex *edubtm_LookupLearnedIndex(
+    PageID                      *root)          /* IN root of the index */
+{
+    Two                         i;              /* index of the table */
+
+
+    for (i = 0; i < BTM_MAXLEARNEDINDEXES; i++) {
+        if (btm_learnedIndexes[i].inUse &&
+            btm_learnedIndexes[i].root.volNo == root->volNo && btm_learnedIndexes[i].root.pageNo == root->pageNo)
+            return(&btm_learnedIndexes[i]);
+    }
+
+    return(NULL);
+
+}   /* edubtm_LookupLearnedIndex() */
+
+
+
+/*@================================
+ * edubtm_BuildLearnedIndex()
+ *================================*/
+/*
+ * Function: Four edubtm_BuildLearnedIndex(PageID*, KeyDesc*)
+ *
+ * Description:
+ *  Build the model of the index from its leaves, replacing the old one. No
+ *  model is kept if the key values are spread so unevenly that they need
+ *  more than BTM_MAXLEARNEDSEGMENTS segments, or if the table is full.
+ *
+ *  The caller holds the exclusive latch of the tree and is in the buffer
+ *  manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    eNOTSUPPORTED_EDUBTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_BuildLearnedIndex(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc)         /* IN key descriptor of the index */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the table */
+    btm_LearnedIndex            *model;         /* the model of the index */
+
+
+    if (kdesc->nparts != 1 || kdesc->kpart[0].type != SM_INT) ERR(eNOTSUPPORTED_EDUBTM);
+
+    edubtm_DropLearnedIndex(root);
+
+    model = NULL;
+    for (i = 0; i < BTM_MAXLEARNEDINDEXES; i++)
+        if (!btm_learnedIndexes[i].inUse) { model = &btm_learnedIndexes[i]; break; }
+
+    if (model == NULL) return(eNOERROR);
+
+    if ((e = edubtm_ReadLeafLevel(root, &model->nLeaves, &model->keys, &model->leaves)) < 0) ERR(e);
+
+    /* The model is not worth keeping */
+    if (model->nLeaves == 0 || !edubtm_FitSegments(model)) {
+        free(model->keys);
+        free(model->leaves);
+        return(eNOERROR);
+    }
+
+    model->inUse = TRUE;
+    model->stale = FALSE;
+    model->root = *root;
+    model->nLookups = 0;
+    model->nMisses = 0;
+
+    return(eNOERROR);
+
+}   /* edubtm_BuildLearnedIndex() */
+
+
+
+/*@================================
+ * edubtm_ReadLeafLevel()
+ *================================*/
+/*
+ * Function: Four edubtm_ReadLeafLevel(PageID*, Four*, Four**, ShortPageID**)
+ *
+ * Description:
+ *  Go down to the leftmost leaf and follow the leaves to the right, noting
+ *  the first key value and the page of each leaf which is not empty. The
+ *  arrays are allocated here; the caller frees them.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eMEMORYALLOCERR_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_ReadLeafLevel(
+    PageID                      *root,          /* IN root of the index */
+    Four                        *nLeaves,       /* OUT # of leaves noted */
+    Four                        **keys,         /* OUT first key value of each leaf */
+    ShortPageID                 **leaves)       /* OUT page of each leaf */
+{
+    Four                        e;              /* error number */
+    Four                        size;           /* # of leaves the arrays can hold */
+    Four                        key;            /* first key value of a leaf */
+    PageID                      pid;            /* current page */
+    PageID                      nextPid;        /* next page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the current page */
+    btm_LeafEntry               *lEntry;        /* the first entry of a leaf */
+    Four                        *newKeys;       /* the keys reallocated */
+    ShortPageID                 *newLeaves;     /* the leaves reallocated */
+
+
+    *nLeaves = 0;
+    size = BTM_MAXLEARNEDSEGMENTS;
+    *keys = (Four*)malloc(sizeof(Four)*size);
+    *leaves = (ShortPageID*)malloc(sizeof(ShortPageID)*size);
+    if (*keys == NULL || *leaves == NULL) {
+        free(*keys); free(*leaves);
+        ERR(eMEMORYALLOCERR_BTM);
+    }
+
+    pid = *root;
+    for (;;) {
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) {
+            free(*keys); free(*leaves);
+            ERR(e);
+        }
+
+        if (apage->any.hdr.type & LEAF) break;
+
+        if (!(apage->any.hdr.type & INTERNAL)) {
+            (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+            free(*keys); free(*leaves);
+            ERR(eBADBTREEPAGE_BTM);
+        }
+
+        MAKE_PAGEID(nextPid, pid.volNo, apage->bi.hdr.p0);
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) {
+            free(*keys); free(*leaves);
+            ERR(e);
+        }
+        pid = nextPid;
+    }
+
+    for (;;) {
+        if (apage->bl.hdr.nSlots > 0) {
+            if (*nLeaves == size) {
+                size *= 2;
+                newKeys = (Four*)realloc(*keys, sizeof(Four)*size);
+                if (newKeys != NULL) *keys = newKeys;
+                newLeaves = (ShortPageID*)realloc(*leaves, sizeof(ShortPageID)*size);
+                if (newLeaves != NULL) *leaves = newLeaves;
+                if (newKeys == NULL || newLeaves == NULL) {
+                    (Four) BfM_FreeTrain((TrainID*)&pid, PAGE_BUF);
+                    free(*keys); free(*leaves);
+                    ERR(eMEMORYALLOCERR_BTM);
+                }
+            }
+
+            lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[0]]);
+            memcpy((char*)&key, lEntry->kval, sizeof(Four));
+            (*keys)[*nLeaves] = key;
+            (*leaves)[*nLeaves] = pid.pageNo;
+            (*nLeaves)++;
+        }
+
+        MAKE_PAGEID(nextPid, pid.volNo, apage->bl.hdr.nextPage);
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) {
+            free(*keys); free(*leaves);
+            ERR(e);
+        }
+        if (nextPid.pageNo == NIL) break;
+
+        pid = nextPid;
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) {
+            free(*keys); free(*leaves);
+            ERR(e);
+        }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_ReadLeafLevel() */
+
+
+
+/*@================================
+ * edubtm_FitSegments()
+ *================================*/
+/*
+ * Function: Boolean edubtm_FitSegments(btm_LearnedIndex*)
+ *
+ * Description:
+ *  Cover the leaves of the model by linear segments in one pass. A segment
+ *  starts at a leaf and keeps the range of slopes which place every leaf
+ *  taken so far within BTM_LEARNEDERROR of its number; the range narrows
+ *  with each leaf, and the segment ends when it becomes empty.
+ *
+ * Returns:
+ *  FALSE if the leaves need more than BTM_MAXLEARNEDSEGMENTS segments
+ */
+Boolean edubtm_FitSegments(
+    btm_LearnedIndex            *model)         /* INOUT the model; 'keys' and 'nLeaves' are set */
+{
+    Four                        i;              /* number of a leaf */
+    Four                        first;          /* first leaf of the current segment */
+    double                      dk;             /* distance of the key value from the start */
+    double                      low;            /* least slope of the current segment */
+    double                      high;           /* greatest slope of the current segment */
+    double                      l;              /* least slope placing the leaf */
+    double                      h;              /* greatest slope placing the leaf */
+    Boolean                     open;           /* TRUE if the slope range is still unbounded */
+
+
+    model->nSegments = 0;
+    first = 0;
+    open = TRUE;
+    low = high = 0.0;
+
+    for (i = 1; i <= model->nLeaves; i++) {
+
+        if (i < model->nLeaves) {
+            dk = (double)model->keys[i] - (double)model->keys[first];
+
+            if (dk > 0.0) {
+                l = (double)(i - first - BTM_LEARNEDERROR) / dk;
+                h = (double)(i - first + BTM_LEARNEDERROR) / dk;
+
+                if (open) { low = l; high = h; open = FALSE; continue; }
+                if (l <= high && h >= low) {
+                    if (l > low) low = l;
+                    if (h < high) high = h;
+                    continue;
+                }
+            }
+            else if (i - first <= BTM_LEARNEDERROR) continue;
+        }
+
+        /* The leaf does not fit; the segment ends before it */
+        if (model->nSegments == BTM_MAXLEARNEDSEGMENTS) return(FALSE);
+
+        model->segments[model->nSegments].firstKey = model->keys[first];
+        model->segments[model->nSegments].firstLeaf = first;
+        model->segments[model->nSegments].slope = (open) ? 0.0 : (low + high) / 2;
+        model->nSegments++;
+
+        first = i;
+        open = TRUE;
+    }
+
+    return(TRUE);
+
+}   /* edubtm_FitSegments() */
+
+
+
+/*@================================
+ * edubtm_PredictLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_PredictLeaf(btm_LearnedIndex*, Four)
+ *
+ * Description:
+ *  Guess the leaf by the segment covering the key value, and correct the
+ *  guess by the first key values of the leaves; the correction moves over
+ *  at most BTM_LEARNEDERROR+1 leaves for a key value between two leaves.
+ *
+ * Returns:
+ *  number of the last leaf whose first key value is not greater than 'key',
+ *  0 if there is none
+ */
+Four edubtm_PredictLeaf(
+    btm_LearnedIndex            *model,         /* IN the model */
+    Four                        key)            /* IN key value to search */
+{
+    Two                         low;            /* lower end of the binary search */
+    Two                         high;           /* upper end of the binary search */
+    Two                         mid;            /* middle of the binary search */
+    Four                        pos;            /* the leaf guessed */
+    btm_LearnedSegment          *seg;           /* segment covering the key value */
+
+
+    /* The last segment starting at or before the key value */
+    low = 0;
+    high = model->nSegments - 1;
+    while (low < high) {
+        mid = (low + high + 1) / 2;
+        if (model->segments[mid].firstKey <= key) low = mid;
+        else high = mid - 1;
+    }
+    seg = &(model->segments[low]);
+
+    if (key <= seg->firstKey) pos = seg->firstLeaf;
+    else pos = seg->firstLeaf + (Four)(seg->slope * ((double)key - (double)seg->firstKey) + 0.5);
+
+    if (pos >= model->nLeaves) pos = model->nLeaves - 1;
+
+    while (pos > 0 && model->keys[pos] > key) pos--;
+    while (pos < model->nLeaves - 1 && model->keys[pos+1] <= key) pos++;
+
+    return(pos);
+
+}   /* edubtm_PredictLeaf() */
+
+
+
+/*@================================
+ * edubtm_LearnedSearchLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_LearnedSearchLeaf(PageID*, KeyDesc*, KeyValue*, Four,
+ *                                         PageID*, BtreePage**, Boolean*)
+ *
+ * Description:
+ *  Find the leaf covering the key value by the model of the index, and
+ *  latch it in the given mode. The leaf is taken only if its entries span
+ *  the key value, or if it is the end leaf on the side of the key value;
+ *  otherwise the model missed, and the caller should descend the tree.
+ *
+ *  The caller holds the tree latch, so the leaves of the model are not
+ *  freed meanwhile.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  leaf  : PageID of the leaf found
+ *  apage : pointer to the buffer holding the leaf, fixed with the latch
+ *  found : FALSE if the index has no usable model or the model missed;
+ *          then nothing is left fixed
+ */
+Four edubtm_LearnedSearchLeaf(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN key descriptor of the index */
+    KeyValue                    *kval,          /* IN key value to search */
+    Four                        mode,           /* IN BTM_LATCH_S or BTM_LATCH_X for the leaf */
+    PageID                      *leaf,          /* OUT the leaf found */
+    BtreePage                   **apage,        /* OUT pointer to the buffer holding the leaf */
+    Boolean                     *found)         /* OUT TRUE if the leaf is found by the model */
+{
+    Four                        e;              /* error number */
+    Four                        key;            /* the key value searched */
+    Four                        firstKey;       /* first key value of the leaf */
+    Four                        lastKey;        /* last key value of the leaf */
+    Two                         nSlots;         /* # of entries of the leaf */
+    btm_LeafEntry               *lEntry;        /* an entry of the leaf */
+    btm_LearnedIndex            *model;         /* the model of the index */
+
+
+    *found = FALSE;
+
+    if (kdesc->nparts != 1 || kdesc->kpart[0].type != SM_INT) return(eNOERROR);
+    memcpy((char*)&key, &(kval->val[0]), sizeof(Four));
+
+    edubtm_EnterBfM();
+    model = edubtm_LookupLearnedIndex(root);
+    if (model == NULL || model->stale) {
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+    model->nLookups++;
+    MAKE_PAGEID(*leaf, root->volNo, model->leaves[edubtm_PredictLeaf(model, key)]);
+    edubtm_LeaveBfM();
+
+    if ((e = edubtm_FixPage(leaf, apage, mode)) < 0) ERR(e);
+
+    nSlots = (*apage)->bl.hdr.nSlots;
+    if (((*apage)->any.hdr.type & LEAF) && nSlots > 0) {
+        lEntry = (btm_LeafEntry*)&((*apage)->bl.data[(*apage)->bl.slot[0]]);
+        memcpy((char*)&firstKey, lEntry->kval, sizeof(Four));
+        lEntry = (btm_LeafEntry*)&((*apage)->bl.data[(*apage)->bl.slot[-(nSlots-1)]]);
+        memcpy((char*)&lastKey, lEntry->kval, sizeof(Four));
+
+        if ((key >= firstKey || (*apage)->bl.hdr.prevPage == NIL) &&
+            (key <= lastKey || (*apage)->bl.hdr.nextPage == NIL)) {
+            *found = TRUE;
+            return(eNOERROR);
+        }
+    }
+
+    if ((e = edubtm_UnfixPage(leaf, FALSE)) < 0) ERR(e);
+
+    /* Too many keys have moved since the model was built */
+    edubtm_EnterBfM();
+    model = edubtm_LookupLearnedIndex(root);
+    if (model != NULL) {
+        model->nMisses++;
+        if (model->nMisses >= BTM_LEARNEDMINMISSES && model->nMisses * 4 > model->nLookups)
+            model->stale = TRUE;
+    }
+    edubtm_LeaveBfM();
+
+    return(eNOERROR);
+
+}   /* edubtm_LearnedSearchLeaf() */
+
+
+
+/*@================================
+ * edubtm_DropLearnedIndex()
+ *================================*/
+/*
+ * Function: void edubtm_DropLearnedIndex(PageID*)
+ *
+ * Description:
+ *  Drop the model of the index, if any. The caller holds the exclusive
+ *  latch of the tree and is in the buffer manager mutex.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_DropLearnedIndex(
+    PageID                      *root)          /* IN root of the index */
+{
+    btm_LearnedIndex            *model;         /* the model of the index */
+
+
+    if ((model = edubtm_LookupLearnedIndex(root)) == NULL) return;
+
+    free(model->keys);
+    free(model->leaves);
+    model->keys = NULL;
+    model->leaves = NULL;
+    model->nLeaves = 0;
+    model->nSegments = 0;
+    model->inUse = FALSE;
+
+}   /* edubtm_DropLearnedIndex() */
@@ -0,0 +1,372 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_MetaPage.c
+ *
+ * Description :
+ *  The meta page of an index keeps the information of the index which does
+ *  not fit in the root page. It is allocated when it is needed first, and
+ *  the root page keeps its page number in the 'reserved' field of the header.
+ *
+ *  The meta page also remembers the leftmost and the rightmost leaves, so
+ *  that a cursor opened at either end of the index fixes the leaf at once
+ *  instead of going down from the root. They are hints checked on use: the
+ *  leftmost leaf has no previous page and the rightmost one has no next
+ *  page. A split only makes the rightmost hint fail the check; every
+ *  operation freeing the pages of the index clears the hints, so a hint
+ *  never points to a page which is freed and used again.
+ *
+ * Exports:
+ *  Four edubtm_GetMetaPage(ObjectID*, PageID*, Boolean, PageID*)
+ *  Four edubtm_GetEndLeaf(PageID*, Boolean, PageID*, BtreePage**, Boolean*)
+ *  Four edubtm_SetEndLeaf(PageID*, Boolean, PageID*, BtreePage*)
+ *  Four edubtm_NoteEndLeaves(ObjectID*, PageID*, ShortPageID, ShortPageID)
+ *  Four edubtm_ForgetEndLeaves(PageID*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_GetMetaPage()
+ *================================*/
+/*
+ * Function: Four edubtm_GetMetaPage(ObjectID*, PageID*, Boolean, PageID*)
+ *
+ * Description:
+ *  Get the PageID of the meta page of the index. If the index has no meta
+ *  page, a new one is allocated when 'create' is TRUE; otherwise 'metaPid'
+ *  gets NIL as its page number.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    some errors caused by function calls
+ *
+ * Note:
+ *  'catObjForFile' is used only when a new meta page is allocated.
+ */
+Four edubtm_GetMetaPage(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    Boolean                     create,         /* IN TRUE to allocate the meta page if not exists */
+    PageID                      *metaPid)       /* OUT PageID of the meta page */
+{
+    Four                        e;              /* error number */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (rpage->any.hdr.reserved != NIL || !create) {
+        MAKE_PAGEID(*metaPid, root->volNo, rpage->any.hdr.reserved);
+
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+        return(eNOERROR);
+    }
+
+    if (catObjForFile == NULL) ERRB1(eBADPARAMETER_BTM, root, PAGE_BUF);
+
+    /* Allocate the meta page near the root */
+    if ((e = btm_AllocPage(catObjForFile, root, metaPid)) < 0) ERRB1(e, root, PAGE_BUF);
+    if ((e = BfM_GetNewTrain((TrainID*)metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+
+    mpage->hdr.pid = *metaPid;
+    mpage->hdr.flags = BTREE_PAGE_TYPE;
+    mpage->hdr.reserved = NIL;
+    mpage->hdr.type = META;
+    mpage->hdr.catObjForFile = *catObjForFile;
+    mpage->hdr.cbFirst = mpage->hdr.cbCur = mpage->hdr.cbLast = NIL;
+    mpage->hdr.cbPages = 0;
+    mpage->hdr.slFirst = mpage->hdr.slLast = NIL;
+    mpage->hdr.nRunPages = mpage->hdr.runNext = 0;
+    mpage->hdr.nFreePages = 0;
+    mpage->hdr.firstLeaf = mpage->hdr.lastLeaf = NIL;
+    mpage->hdr.bfBlocks = mpage->hdr.bfKeys = 0;
+    mpage->hdr.bfNPages = 0;
+
+    if ((e = BfM_SetDirty((TrainID*)metaPid, PAGE_BUF)) < 0) ERRB1(e, metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    /* Anchor the meta page in the root */
+    rpage->any.hdr.reserved = metaPid->pageNo;
+
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_GetMetaPage() */
+
+
+
+/*@================================
+ * edubtm_GetEndLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_GetEndLeaf(PageID*, Boolean, PageID*, BtreePage**, Boolean*)
+ *
+ * Description:
+ *  Fix the leftmost leaf of the index, or the rightmost one if 'last' is
+ *  TRUE, as remembered by the meta page. The leaf is latched in the shared
+ *  mode and checked to be still at that end of the leaf page list; 'found'
+ *  is FALSE and nothing is left fixed if there is no hint or the check
+ *  fails. The caller should hold the tree latch.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  leaf  : PageID of the leaf found
+ *  apage : pointer to the buffer holding the leaf, to be released by
+ *          edubtm_UnfixPage(...)
+ */
+Four edubtm_GetEndLeaf(
+    PageID                      *root,          /* IN root of the Btree */
+    Boolean                     last,           /* IN TRUE for the rightmost leaf */
+    PageID                      *leaf,          /* OUT the leaf */
+    BtreePage                   **apage,        /* OUT pointer to the buffer holding the leaf */
+    Boolean                     *found)         /* OUT TRUE if the leaf is fixed */
+{
+    Four                        e;              /* error number */
+    PageID                      metaPid;        /* meta page of the index */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    *found = FALSE;
+
+    edubtm_EnterBfM();
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    /* A leaf root is as near as the hint */
+    MAKE_PAGEID(metaPid, root->volNo, rpage->any.hdr.reserved);
+    if (!(rpage->any.hdr.type & INTERNAL)) metaPid.pageNo = NIL;
+
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    if (metaPid.pageNo == NIL) {
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    MAKE_PAGEID(*leaf, root->volNo, (last) ? mpage->hdr.lastLeaf : mpage->hdr.firstLeaf);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    edubtm_LeaveBfM();
+
+    if (leaf->pageNo == NIL) return(eNOERROR);
+
+    if ((e = edubtm_FixPage(leaf, apage, BTM_LATCH_S)) < 0) ERR(e);
+
+    /* A split may have put a new leaf after the rightmost one */
+    if (!((*apage)->any.hdr.type & LEAF) ||
+        ((last) ? (*apage)->bl.hdr.nextPage : (*apage)->bl.hdr.prevPage) != NIL) {
+        if ((e = edubtm_UnfixPage(leaf, FALSE)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    *found = TRUE;
+
+    return(eNOERROR);
+
+}   /* edubtm_GetEndLeaf() */
+
+
+
+/*@================================
+ * edubtm_SetEndLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_SetEndLeaf(PageID*, Boolean, PageID*, BtreePage*)
+ *
+ * Description:
+ *  Remember the given leaf in the meta page as the leftmost leaf, or as the
+ *  rightmost one if 'last' is TRUE. Nothing is done if the leaf is not at
+ *  that end of the leaf page list, or if the index has no meta page. The
+ *  caller should hold the latch of the leaf, so that the leaf cannot be
+ *  split meanwhile.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_SetEndLeaf(
+    PageID                      *root,          /* IN root of the Btree */
+    Boolean                     last,           /* IN TRUE for the rightmost leaf */
+    PageID                      *leaf,          /* IN the leaf */
+    BtreePage                   *apage)         /* IN pointer to the buffer holding the leaf */
+{
+    Four                        e;              /* error number */
+    PageID                      metaPid;        /* meta page of the index */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the root page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    if (leaf->volNo == root->volNo && leaf->pageNo == root->pageNo) return(eNOERROR);
+    if (((last) ? apage->bl.hdr.nextPage : apage->bl.hdr.prevPage) != NIL) return(eNOERROR);
+
+    edubtm_EnterBfM();
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rpage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    MAKE_PAGEID(metaPid, root->volNo, rpage->any.hdr.reserved);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+    if (metaPid.pageNo != NIL) {
+        if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+
+        if (last) mpage->hdr.lastLeaf = leaf->pageNo;
+        else mpage->hdr.firstLeaf = leaf->pageNo;
+
+        if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) {
+            (Four) BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF);
+            edubtm_LeaveBfM();
+            ERR(e);
+        }
+        if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) { edubtm_LeaveBfM(); ERR(e); }
+    }
+
+    edubtm_LeaveBfM();
+
+    return(eNOERROR);
+
+}   /* edubtm_SetEndLeaf() */
+
+
+
+/*@================================
+ * edubtm_NoteEndLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_NoteEndLeaves(ObjectID*, PageID*, ShortPageID, ShortPageID)
+ *
+ * Description:
+ *  Remember both end leaves of an index whose leaves have just been made,
+ *  allocating the meta page of the index if it has none. It is called when
+ *  the root leaf splits and when the index is bulk loaded, so that every
+ *  index of more than one leaf can find its end leaves from the meta page.
+ *  The caller should be in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_NoteEndLeaves(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    ShortPageID                 firstLeaf,      /* IN the leftmost leaf */
+    ShortPageID                 lastLeaf)       /* IN the rightmost leaf */
+{
+    Four                        e;              /* error number */
+    PageID                      metaPid;        /* meta page of the index */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    if ((e = edubtm_GetMetaPage(catObjForFile, root, TRUE, &metaPid)) < 0) ERR(e);
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    mpage->hdr.firstLeaf = firstLeaf;
+    mpage->hdr.lastLeaf = lastLeaf;
+
+    if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_NoteEndLeaves() */
+
+
+
+/*@================================
+ * edubtm_ForgetEndLeaves()
+ *================================*/
+/*
+ * Function: Four edubtm_ForgetEndLeaves(PageID*)
+ *
+ * Description:
+ *  Clear the leftmost and the rightmost leaves remembered by the meta page.
+ *  It is called by the operations which free pages of the index, under the
+ *  exclusive tree latch and in the buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ForgetEndLeaves(
+    PageID                      *root)          /* IN root of the Btree */
+{
+    Four                        e;              /* error number */
+    PageID                      metaPid;        /* meta page of the index */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+
+
+    if ((e = edubtm_GetMetaPage(NULL, root, FALSE, &metaPid)) < 0) ERR(e);
+    if (metaPid.pageNo == NIL) return(eNOERROR);
+
+    if ((e = BfM_GetTrain((TrainID*)&metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    if (mpage->hdr.firstLeaf != NIL || mpage->hdr.lastLeaf != NIL) {
+        mpage->hdr.firstLeaf = mpage->hdr.lastLeaf = NIL;
+        if ((e = BfM_SetDirty((TrainID*)&metaPid, PAGE_BUF)) < 0) ERRB1(e, &metaPid, PAGE_BUF);
+    }
+
+    if ((e = BfM_FreeTrain((TrainID*)&metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ForgetEndLeaves() */
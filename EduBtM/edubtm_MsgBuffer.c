@@ -0,0 +1,1126 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_MsgBuffer.c
+ *
+ * Description :
+ *  Message buffers of the internal pages of a buffered index.
+ *
+ *  When the root page has BTM_BUFFEREDINDEX set, an insert or a delete does
+ *  not descend to a leaf. It is appended as a message to the buffer of the
+ *  root; when a buffer is full, the messages routed to the child having the
+ *  most pending messages are moved to that child in a batch. Messages reach
+ *  the leaves only by these flushes, so one leaf write absorbs many updates.
+ *
+ *  Readers call edubtm_FlushPendingMessages() for the key range they read,
+ *  which pushes the pending messages of that range down to the leaves before
+ *  the leaves are read.
+ *
+ *  A page which is not half full after a delivery is merged with its sibling
+ *  when the caller gives a dealloc list. The library's btm_Underflow() does
+ *  not know the message buffers, so the pages to be merged first push their
+ *  messages down and release their buffers; a page reserves a buffer again
+ *  when the next messages arrive.
+ *
+ * Exports:
+ *  Four edubtm_IsBufferedIndex(PageID*, Boolean*)
+ *  Boolean edubtm_InitMsgBuffer(BtreeInternal*, ObjectID*)
+ *  Boolean edubtm_AppendMessage(BtreeInternal*, Two, KeyValue*, ObjectID*)
+ *  void edubtm_RemoveMessage(BtreeInternal*, Two)
+ *  Two edubtm_HeaviestChild(BtreeInternal*, KeyDesc*)
+ *  Four edubtm_SplitMsgBuffer(BtreeInternal*, InternalItem*, KeyDesc*)
+ *  Four edubtm_DeliverMessages(ObjectID*, PageID*, KeyDesc*, char*, Two, Boolean, Two*, Boolean*,
+ *                              Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_FlushChild(ObjectID*, BtreeInternal*, KeyDesc*, Two, KeyValue*, KeyValue*,
+ *                         Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_FlushRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*, Boolean*, Boolean*,
+ *                         InternalItem*, Pool*, DeallocListElem*)
+ *  Four edubtm_FlushPendingMessages(PageID*, KeyDesc*, KeyValue*, KeyValue*, Pool*, DeallocListElem*)
+ *  Four edubtm_UnbufferPage(ObjectID*, BtreeInternal*, KeyDesc*, Boolean*, InternalItem*)
+ *  Four edubtm_ReleaseMsgBuffers(ObjectID*, BtreeInternal*, KeyDesc*, Two, Boolean*, Boolean*, InternalItem*)
+ *  Four edubtm_SearchPending(PageID*, KeyDesc*, KeyValue*, Boolean*, ObjectID*)
+ *  Four edubtm_BufferUpdate(ObjectID*, PageID*, KeyDesc*, Two, KeyValue*, ObjectID*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+
+/*@================================
+ * edubtm_IsBufferedIndex()
+ *================================*/
+/*
+ * Function: Four edubtm_IsBufferedIndex(PageID*, Boolean*)
+ *
+ * Description:
+ *  Check whether the updates of the index are buffered.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_IsBufferedIndex(
+    PageID                      *root,          /* IN root of the Btree */
+    Boolean                     *buffered)      /* OUT TRUE if the index is buffered */
+{
+    Four                        e;              /* error number */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    *buffered = (apage->any.hdr.flags & BTM_BUFFEREDINDEX) ? TRUE : FALSE;
+
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_IsBufferedIndex() */
+
+
+
+/*@================================
+ * edubtm_InitMsgBuffer()
+ *================================*/
+/*
+ * Function: Boolean edubtm_InitMsgBuffer(BtreeInternal*, ObjectID*)
+ *
+ * Description:
+ *  Reserve an empty message buffer at the beginning of the data area of the
+ *  given internal page. The internal entries are moved behind the buffer.
+ *
+ * Returns:
+ *  TRUE if the page has a message buffer; FALSE if there is no room for it
+ */
+Boolean edubtm_InitMsgBuffer(
+    BtreeInternal               *page,          /* INOUT the internal page */
+    ObjectID                    *catObjForFile) /* IN catalog object of B+ tree file */
+{
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer */
+
+
+    if (page->hdr.flags & BTM_MSGBUFFER) return(TRUE);
+
+    if ((Four)BI_FREE(page) < BTM_MSGBUF_SIZE) return(FALSE);
+
+    /* The compaction places the entries from BI_DATA_START(page) */
+    page->hdr.flags |= BTM_MSGBUFFER;
+    edubtm_CompactInternalPage(page, NIL);
+
+    hdr = BTM_MSGBUF_HDR(page);
+    hdr->catObjForFile = *catObjForFile;
+    hdr->nMsgs = 0;
+    hdr->used = 0;
+
+    return(TRUE);
+
+}   /* edubtm_InitMsgBuffer() */
+
+
+
+/*@================================
+ * edubtm_AppendMessage()
+ *================================*/
+/*
+ * Function: Boolean edubtm_AppendMessage(BtreeInternal*, Two, KeyValue*, ObjectID*)
+ *
+ * Description:
+ *  Append a message at the end of the message buffer of the given page.
+ *
+ * Returns:
+ *  TRUE if the message is appended; FALSE if the buffer is full
+ */
+Boolean edubtm_AppendMessage(
+    BtreeInternal               *page,          /* INOUT the internal page having a message buffer */
+    Two                         op,             /* IN BTM_MSG_INSERT or BTM_MSG_DELETE */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid)           /* IN ObjectID */
+{
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer */
+    btm_Message                 *msg;           /* the new message */
+    Two                         len;            /* length of the new message */
+
+
+    hdr = BTM_MSGBUF_HDR(page);
+    len = BTM_MESSAGE_LEN(kval->len);
+
+    if (BTM_MSGBUF_DATA + hdr->used + len > BTM_MSGBUF_SIZE) return(FALSE);
+
+    msg = (btm_Message*)&(page->data[BTM_MSGBUF_DATA + hdr->used]);
+    msg->oid = *oid;
+    msg->op = op;
+    msg->klen = kval->len;
+    memcpy(&(msg->kval[0]), &(kval->val[0]), kval->len);
+
+    hdr->used += len;
+    hdr->nMsgs++;
+
+    return(TRUE);
+
+}   /* edubtm_AppendMessage() */
+
+
+
+/*@================================
+ * edubtm_RemoveMessage()
+ *================================*/
+/*
+ * Function: void edubtm_RemoveMessage(BtreeInternal*, Two)
+ *
+ * Description:
+ *  Remove the message at the given offset of the data area; the following
+ *  messages are shifted so that the messages stay contiguous and in order.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_RemoveMessage(
+    BtreeInternal               *page,          /* INOUT the internal page having a message buffer */
+    Two                         offset)         /* IN offset of the message in the data area */
+{
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer */
+    btm_Message                 *msg;           /* the message to remove */
+    Two                         len;            /* length of the message */
+
+
+    hdr = BTM_MSGBUF_HDR(page);
+    msg = (btm_Message*)&(page->data[offset]);
+    len = BTM_MESSAGE_LEN(msg->klen);
+
+    memmove(&(page->data[offset]), &(page->data[offset+len]), BTM_MSGBUF_DATA + hdr->used - (offset + len));
+
+    hdr->used -= len;
+    hdr->nMsgs--;
+
+}   /* edubtm_RemoveMessage() */
+
+
+
+/*@================================
+ * edubtm_HeaviestChild()
+ *================================*/
+/*
+ * Function: Two edubtm_HeaviestChild(BtreeInternal*, KeyDesc*)
+ *
+ * Description:
+ *  Find the child to which the most bytes of messages are routed.
+ *
+ * Returns:
+ *  index of the child (-1 denotes 'p0')
+ */
+Two edubtm_HeaviestChild(
+    BtreeInternal               *page,          /* IN the internal page having a message buffer */
+    KeyDesc                     *kdesc)         /* IN a key descriptor */
+{
+    Four                        pending[BTM_MAXCHILDREN]; /* bytes of messages routed to each child */
+    Two                         offset;         /* offset of a message */
+    Two                         idx;            /* index of a child */
+    Two                         best;           /* the child having the most messages */
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer */
+    btm_Message                 *msg;           /* a message */
+
+
+    hdr = BTM_MSGBUF_HDR(page);
+
+    for (idx = -1; idx < page->hdr.nSlots; idx++) pending[idx+1] = 0;
+
+    for (offset = BTM_MSGBUF_DATA; offset < BTM_MSGBUF_DATA + hdr->used; offset += BTM_MESSAGE_LEN(msg->klen)) {
+        msg = (btm_Message*)&(page->data[offset]);
+        edubtm_BinarySearchInternal(page, kdesc, (KeyValue*)&(msg->klen), &idx);
+        pending[idx+1] += BTM_MESSAGE_LEN(msg->klen);
+    }
+
+    best = -1;
+    for (idx = 0; idx < page->hdr.nSlots; idx++)
+        if (pending[idx+1] > pending[best+1]) best = idx;
+
+    return(best);
+
+}   /* edubtm_HeaviestChild() */
+
+
+
+/*@================================
+ * edubtm_SplitMsgBuffer()
+ *================================*/
+/*
+ * Function: Four edubtm_SplitMsgBuffer(BtreeInternal*, InternalItem*, KeyDesc*)
+ *
+ * Description:
+ *  After the given internal page has been split, move the messages whose key
+ *  values are not less than the key of 'ritem' to the message buffer of the
+ *  new page 'ritem->spid'.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_SplitMsgBuffer(
+    BtreeInternal               *fpage,         /* INOUT the split page */
+    InternalItem                *ritem,         /* IN the item of the new page */
+    KeyDesc                     *kdesc)         /* IN a key descriptor */
+{
+    Four                        e;              /* error number */
+    Two                         offset;         /* offset of a message */
+    PageID                      newPid;         /* PageID of the new page */
+    BtreePage                   *npage;         /* pointer to the buffer holding the new page */
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer of 'fpage' */
+    btm_Message                 *msg;           /* a message */
+
+
+    if (!(fpage->hdr.flags & BTM_MSGBUFFER)) return(eNOERROR);
+
+    hdr = BTM_MSGBUF_HDR(fpage);
+
+    MAKE_PAGEID(newPid, fpage->hdr.pid.volNo, ritem->spid);
+    if ((e = BfM_GetTrain((TrainID*)&newPid, (char**)&npage, PAGE_BUF)) < 0) ERR(e);
+
+    if (!edubtm_InitMsgBuffer(&(npage->bi), &(hdr->catObjForFile))) ERRB1(eBADBTREEPAGE_BTM, &newPid, PAGE_BUF);
+
+    offset = BTM_MSGBUF_DATA;
+    while (offset < BTM_MSGBUF_DATA + hdr->used) {
+        msg = (btm_Message*)&(fpage->data[offset]);
+
+        if (edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), (KeyValue*)&(ritem->klen)) != LESS) {
+            /* The new buffer is never smaller than the moved messages */
+            edubtm_AppendMessage(&(npage->bi), msg->op, (KeyValue*)&(msg->klen), &(msg->oid));
+            edubtm_RemoveMessage(fpage, offset);
+        }
+        else
+            offset += BTM_MESSAGE_LEN(msg->klen);
+    }
+
+    if ((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF)) < 0) ERRB1(e, &newPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&newPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_SplitMsgBuffer() */
+
+
+
+/*@================================
+ * edubtm_DeliverMessages()
+ *================================*/
+/*
+ * Function: Four edubtm_DeliverMessages(ObjectID*, PageID*, KeyDesc*, char*, Two, Boolean, Two*,
+ *                                       Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Deliver the 'nMsgs' contiguous messages in 'msgs', in their order, to the
+ *  page 'pid'.
+ *
+ *  A leaf applies the messages: an insert adds a new key value, and a delete
+ *  removes the entry if it has the ObjectID. The inserts have been checked
+ *  against the index when they were buffered. An internal page appends the
+ *  messages to its message buffer, flushing its heaviest child whenever the
+ *  buffer is full; an internal page without room for a buffer passes each
+ *  message on to the proper child, and so do all the internal pages if
+ *  'useBuffers' is FALSE.
+ *
+ *  The delivery stops when the page 'pid' is split; the remaining messages
+ *  should be routed again by the caller.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) nDelivered : # of messages delivered from the beginning of 'msgs'
+ *  2) f : TRUE if the page is not half full
+ *  3) h : TRUE if the page is split
+ *  4) item : item to be inserted into the parent
+ */
+Four edubtm_DeliverMessages(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *pid,           /* IN the page receiving the messages */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    char                        *msgs,          /* IN contiguous messages */
+    Two                         nMsgs,          /* IN # of messages */
+    Boolean                     useBuffers,     /* IN TRUE to keep the messages in the message buffers */
+    Two                         *nDelivered,    /* OUT # of delivered messages */
+    Boolean                     *f,             /* OUT whether the page is not half full */
+    Boolean                     *h,             /* OUT whether the page is split */
+    InternalItem                *item,          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements, NULL not to merge */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         offset;         /* offset of the current message in 'msgs' */
+    Two                         idx;            /* index by the binary search */
+    Two                         k;              /* the child to flush */
+    Two                         n;              /* # of messages delivered to a child */
+    Boolean                     delivered;      /* TRUE if the current message is delivered */
+    Boolean                     split;          /* TRUE if a child is split */
+    Boolean                     exists;         /* whether the key value already exists */
+    Boolean                     lf;             /* local 'f' */
+    Boolean                     lh;             /* local 'h' */
+    InternalItem                litem;          /* a local internal item */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the page */
+    btm_Message                 *msg;           /* the current message */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+    KeyValue                    *kval;          /* key value of the current message */
+
+
+    *f = *h = FALSE;
+    *nDelivered = 0;
+
+    if ((e = BfM_GetTrain((TrainID*)pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    if (apage->any.hdr.type & LEAF) {
+
+        for (offset = 0; *nDelivered < nMsgs && !*h; (*nDelivered)++) {
+            msg = (btm_Message*)&(msgs[offset]);
+            kval = (KeyValue*)&(msg->klen);
+            offset += BTM_MESSAGE_LEN(msg->klen);
+
+            if (msg->op == BTM_MSG_INSERT) {
+                if ((e = edubtm_InsertLeaf(catObjForFile, pid, &(apage->bl), kdesc, kval, &(msg->oid),
+                                           BTM_INSERT, &exists, NULL, &lf, h, item)) < 0) ERRB1(e, pid, PAGE_BUF);
+            }
+            else if (edubtm_BinarySearchLeaf(&(apage->bl), kdesc, kval, &idx)) {
+                lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+                if (lEntry->nObjects == 1 &&
+                    btm_ObjectIdComp(&(msg->oid), (ObjectID*)&(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)])) == EQUAL) {
+                    edubtm_DeleteLeafEntries(&(apage->bl), idx, idx);
+                    edubtm_BumpVersion(pid);
+                }
+            }
+        }
+
+        if (!*h) *f = (BL_FREE(&(apage->bl)) > BL_HALF) ? TRUE : FALSE;
+    }
+    else if (apage->any.hdr.type & INTERNAL) {
+
+        /* Without room for a buffer, the messages are passed on to the children */
+        if (useBuffers) edubtm_InitMsgBuffer(&(apage->bi), catObjForFile);
+
+        for (offset = 0; *nDelivered < nMsgs && !*h; ) {
+            msg = (btm_Message*)&(msgs[offset]);
+            kval = (KeyValue*)&(msg->klen);
+
+            if (useBuffers && (apage->bi.hdr.flags & BTM_MSGBUFFER)) {
+                delivered = edubtm_AppendMessage(&(apage->bi), msg->op, kval, &(msg->oid));
+
+                if (!delivered) {
+                    /* Make room by flushing the child having the most pending messages */
+                    k = edubtm_HeaviestChild(&(apage->bi), kdesc);
+                    if ((e = edubtm_FlushChild(catObjForFile, &(apage->bi), kdesc, k, NULL, NULL,
+                                               &split, h, item, dlPool, dlHead)) < 0)
+                        ERRB1(e, pid, PAGE_BUF);
+                }
+            }
+            else {
+                edubtm_BinarySearchInternal(&(apage->bi), kdesc, kval, &idx);
+                if (idx == -1) MAKE_PAGEID(child, pid->volNo, apage->bi.hdr.p0);
+                else MAKE_PAGEID(child, pid->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]))->spid);
+
+                if ((e = edubtm_DeliverMessages(catObjForFile, &child, kdesc, (char*)msg, 1, useBuffers, &n,
+                                                &lf, &lh, &litem, dlPool, dlHead)) < 0)
+                    ERRB1(e, pid, PAGE_BUF);
+
+                if (lh) {
+                    edubtm_BinarySearchInternal(&(apage->bi), kdesc, (KeyValue*)&(litem.klen), &idx);
+                    if ((e = edubtm_InsertInternal(catObjForFile, &(apage->bi), &litem, idx, h, item)) < 0)
+                        ERRB1(e, pid, PAGE_BUF);
+                }
+                else if (lf && dlPool != NULL && apage->bi.hdr.nSlots > 0) {
+                    if ((e = edubtm_MergeChild(catObjForFile, apage, kdesc, idx, h, item, dlPool, dlHead)) < 0)
+                        ERRB1(e, pid, PAGE_BUF);
+                }
+
+                delivered = (n == 1) ? TRUE : FALSE;
+            }
+
+            if (delivered) {
+                (*nDelivered)++;
+                offset += BTM_MESSAGE_LEN(msg->klen);
+            }
+        }
+
+        if (!*h) *f = (BI_FREE(&(apage->bi)) > BI_HALF || apage->bi.hdr.nSlots == 0) ? TRUE : FALSE;
+    }
+    else
+        ERRB1(eBADBTREEPAGE_BTM, pid, PAGE_BUF);
+
+    if ((e = BfM_SetDirty((TrainID*)pid, PAGE_BUF)) < 0) ERRB1(e, pid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)pid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_DeliverMessages() */
+
+
+
+/*@================================
+ * edubtm_FlushChild()
+ *================================*/
+/*
+ * Function: Four edubtm_FlushChild(ObjectID*, BtreeInternal*, KeyDesc*, Two, KeyValue*, KeyValue*,
+ *                                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Move the messages of the given page which are routed to the child 'k'
+ *  and whose key values are in [low, high] (NULL bounds are unbounded) to
+ *  the child in a batch. If the child is split, the new entry is inserted
+ *  into the given page, which may split the page in turn. If the child is
+ *  not half full any more and a dealloc list is given, it is merged with its
+ *  sibling.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) split : TRUE if the child is split or merged, i.e. the indexes of the children are changed
+ *  2) h : TRUE if the given page is split
+ *  3) item : item to be inserted into the parent
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'page'.
+ */
+Four edubtm_FlushChild(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeInternal               *page,          /* INOUT the internal page having a message buffer */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Two                         k,              /* IN the child to flush (-1 denotes 'p0') */
+    KeyValue                    *low,           /* IN lower bound of the key values, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the key values, NULL if unbounded */
+    Boolean                     *split,         /* OUT whether the child is split or merged */
+    Boolean                     *h,             /* OUT whether the page is split */
+    InternalItem                *item,          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements, NULL not to merge */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Four                        gathered[BTM_MSGBUF_SIZE/sizeof(Four)]; /* messages routed to the child */
+    Two                         gLen;           /* # of bytes in 'gathered' */
+    Two                         n;              /* # of messages in 'gathered' */
+    Two                         nDelivered;     /* # of messages delivered to the child */
+    Two                         offset;         /* offset of a message */
+    Two                         idx;            /* index by the binary search */
+    Boolean                     selected;       /* TRUE if the message is routed to the child */
+    Boolean                     lf;             /* local 'f' */
+    Boolean                     lh;             /* local 'h' */
+    InternalItem                litem;          /* a local internal item */
+    PageID                      child;          /* the child page */
+    btm_MsgBufferHdr            *hdr;           /* header of the message buffer */
+    btm_Message                 *msg;           /* a message */
+
+
+    *split = *h = FALSE;
+
+    hdr = BTM_MSGBUF_HDR(page);
+
+    /* Gather the messages for the child in their order */
+    n = 0;
+    gLen = 0;
+    for (offset = BTM_MSGBUF_DATA; offset < BTM_MSGBUF_DATA + hdr->used; offset += BTM_MESSAGE_LEN(msg->klen)) {
+        msg = (btm_Message*)&(page->data[offset]);
+
+        edubtm_BinarySearchInternal(page, kdesc, (KeyValue*)&(msg->klen), &idx);
+        selected = (idx == k &&
+                    (low == NULL || edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), low) != LESS) &&
+                    (high == NULL || edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), high) != GREATER)) ? TRUE : FALSE;
+
+        if (selected) {
+            memcpy((char*)gathered + gLen, (char*)msg, BTM_MESSAGE_LEN(msg->klen));
+            gLen += BTM_MESSAGE_LEN(msg->klen);
+            n++;
+        }
+    }
+
+    if (n == 0) return(eNOERROR);
+
+    if (k == -1) MAKE_PAGEID(child, page->hdr.pid.volNo, page->hdr.p0);
+    else MAKE_PAGEID(child, page->hdr.pid.volNo, ((btm_InternalEntry*)&(page->data[page->slot[-k]]))->spid);
+
+    if ((e = edubtm_DeliverMessages(catObjForFile, &child, kdesc, (char*)gathered, n, TRUE, &nDelivered,
+                                    &lf, &lh, &litem, dlPool, dlHead)) < 0) ERR(e);
+
+    /* Remove the delivered messages, which are the first ones gathered */
+    offset = BTM_MSGBUF_DATA;
+    while (nDelivered > 0) {
+        msg = (btm_Message*)&(page->data[offset]);
+
+        edubtm_BinarySearchInternal(page, kdesc, (KeyValue*)&(msg->klen), &idx);
+        selected = (idx == k &&
+                    (low == NULL || edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), low) != LESS) &&
+                    (high == NULL || edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), high) != GREATER)) ? TRUE : FALSE;
+
+        if (selected) {
+            edubtm_RemoveMessage(page, offset);
+            nDelivered--;
+        }
+        else
+            offset += BTM_MESSAGE_LEN(msg->klen);
+    }
+
+    /* Insert the entry of the new child */
+    if (lh) {
+        *split = TRUE;
+
+        edubtm_BinarySearchInternal(page, kdesc, (KeyValue*)&(litem.klen), &idx);
+        if ((e = edubtm_InsertInternal(catObjForFile, page, &litem, idx, h, item)) < 0) ERR(e);
+
+        if (*h) {
+            if ((e = edubtm_SplitMsgBuffer(page, item, kdesc)) < 0) ERR(e);
+        }
+    }
+    /* The readers give no dealloc list; a later delivery to the child merges it */
+    else if (lf && dlPool != NULL && page->hdr.nSlots > 0) {
+        *split = TRUE;
+
+        if ((e = edubtm_MergeChild(catObjForFile, (BtreePage*)page, kdesc, k, h, item, dlPool, dlHead)) < 0) ERR(e);
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_FlushChild() */
+
+
+
+/*@================================
+ * edubtm_FlushRange()
+ *================================*/
+/*
+ * Function: Four edubtm_FlushRange(ObjectID*, PageID*, KeyDesc*, KeyValue*, KeyValue*,
+ *                                  Boolean*, Boolean*, InternalItem*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Push all the pending messages in [low, high] (NULL bounds are unbounded)
+ *  of the subtree 'root' down to the leaves. If a dealloc list is given, the
+ *  children which are not half full are merged on the way back.
+ *
+ *  The catalog object is not given by the readers; it is taken from the
+ *  header of the first message buffer met. It is needed only when messages
+ *  are delivered, i.e. after a message buffer has been met.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) catObjForFile : the catalog object found in a message buffer
+ *  2) f : TRUE if the root of the subtree is not half full
+ *  3) h : TRUE if the root of the subtree is split
+ *  4) item : item to be inserted into the parent
+ */
+Four edubtm_FlushRange(
+    ObjectID                    *catObjForFile, /* INOUT catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the subtree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *low,           /* IN lower bound of the key values, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the key values, NULL if unbounded */
+    Boolean                     *f,             /* OUT whether the root is not half full */
+    Boolean                     *h,             /* OUT whether the root is split */
+    InternalItem                *item,          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements, NULL not to merge */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         k;              /* index of a child */
+    Two                         cHigh;          /* the last child covering the range */
+    Two                         idx;            /* index by the binary search */
+    Boolean                     split;          /* TRUE if a child is split or merged */
+    Boolean                     lf;             /* local 'f' */
+    Boolean                     lh;             /* local 'h' */
+    Boolean                     changed;        /* TRUE if the page is changed */
+    InternalItem                litem;          /* a local internal item */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the root */
+
+
+    *f = *h = FALSE;
+    changed = FALSE;
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+    if (!(apage->any.hdr.type & INTERNAL)) {
+        if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if (apage->bi.hdr.flags & BTM_MSGBUFFER)
+        *catObjForFile = BTM_MSGBUF_HDR(&(apage->bi))->catObjForFile;
+
+    if (low == NULL) k = -1;
+    else edubtm_BinarySearchInternal(&(apage->bi), kdesc, low, &k);
+
+    /*
+     * A child split inserts an entry here; the same child is then visited again.
+     * A merge may move the entries of the child to its left sibling, so the
+     * left sibling is visited again.
+     */
+    while (!*h) {
+        if (high == NULL) cHigh = apage->bi.hdr.nSlots - 1;
+        else edubtm_BinarySearchInternal(&(apage->bi), kdesc, high, &cHigh);
+
+        if (k > cHigh) break;
+
+        if (apage->bi.hdr.flags & BTM_MSGBUFFER) {
+            if ((e = edubtm_FlushChild(catObjForFile, &(apage->bi), kdesc, k, low, high,
+                                       &split, h, item, dlPool, dlHead)) < 0)
+                ERRB1(e, root, PAGE_BUF);
+
+            changed = TRUE;
+            if (split) {
+                if (dlPool != NULL && k > -1) k--;
+                continue;
+            }
+        }
+
+        if (k == -1) MAKE_PAGEID(child, root->volNo, apage->bi.hdr.p0);
+        else MAKE_PAGEID(child, root->volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-k]]))->spid);
+
+        if ((e = edubtm_FlushRange(catObjForFile, &child, kdesc, low, high, &lf, &lh, &litem, dlPool, dlHead)) < 0)
+            ERRB1(e, root, PAGE_BUF);
+
+        if (lh) {
+            edubtm_BinarySearchInternal(&(apage->bi), kdesc, (KeyValue*)&(litem.klen), &idx);
+            if ((e = edubtm_InsertInternal(catObjForFile, &(apage->bi), &litem, idx, h, item)) < 0) ERRB1(e, root, PAGE_BUF);
+
+            if (*h) {
+                if ((e = edubtm_SplitMsgBuffer(&(apage->bi), item, kdesc)) < 0) ERRB1(e, root, PAGE_BUF);
+            }
+
+            changed = TRUE;
+            continue;
+        }
+
+        if (lf && dlPool != NULL && apage->bi.hdr.nSlots > 0) {
+            if ((e = edubtm_MergeChild(catObjForFile, apage, kdesc, k, h, item, dlPool, dlHead)) < 0)
+                ERRB1(e, root, PAGE_BUF);
+
+            changed = TRUE;
+            if (k > -1) k--;
+            continue;
+        }
+
+        k++;
+    }
+
+    if (!*h) *f = (BI_FREE(&(apage->bi)) > BI_HALF || apage->bi.hdr.nSlots == 0) ? TRUE : FALSE;
+
+    if (changed) {
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_FlushRange() */
+
+
+
+/*@================================
+ * edubtm_FlushPendingMessages()
+ *================================*/
+/*
+ * Function: Four edubtm_FlushPendingMessages(PageID*, KeyDesc*, KeyValue*, KeyValue*,
+ *                                            Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  If the index is buffered, push the pending messages in [low, high]
+ *  (NULL bounds are unbounded) down to the leaves, so that the leaves of
+ *  the range can be read or changed directly. The readers give no dealloc
+ *  list; then no page is merged. The changes of the range kept in the
+ *  change buffer of the index are merged as well.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_FlushPendingMessages(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *low,           /* IN lower bound of the key values, NULL if unbounded */
+    KeyValue                    *high,          /* IN upper bound of the key values, NULL if unbounded */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements, NULL not to merge */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Boolean                     buffered;       /* TRUE if the index is buffered */
+    Boolean                     f;              /* TRUE if the root is not half full */
+    Boolean                     h;              /* TRUE if the root is split */
+    InternalItem                item;           /* Internal item for the new root */
+    ObjectID                    catObjForFile;  /* catalog object of B+ tree file */
+
+
+    if ((e = edubtm_IsBufferedIndex(root, &buffered)) < 0) ERR(e);
+
+    if (buffered) {
+        do {
+            if ((e = edubtm_FlushRange(&catObjForFile, root, kdesc, low, high, &f, &h, &item, dlPool, dlHead)) < 0)
+                ERR(e);
+
+            if (h) {
+                if ((e = edubtm_root_insert(&catObjForFile, root, &item)) < 0) ERR(e);
+            }
+            else if (f && dlPool != NULL) {
+                if ((e = edubtm_root_delete(&catObjForFile, root, kdesc, dlPool, dlHead)) < 0) ERR(e);
+            }
+        } while (h);
+    }
+
+    if ((e = edubtm_MergeChanges(root, kdesc, low, high, 0)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_FlushPendingMessages() */
+
+
+
+/*@================================
+ * edubtm_UnbufferPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnbufferPage(ObjectID*, BtreeInternal*, KeyDesc*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Push all the messages of the given page down to its children and release
+ *  its message buffer, so that btm_Underflow(...) can merge or redistribute
+ *  the page. No page is merged here. If the page is split by the flushes,
+ *  both halves keep their buffers.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) h : TRUE if the given page is split
+ *  2) item : item to be inserted into the parent
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'page'.
+ */
+Four edubtm_UnbufferPage(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeInternal               *page,          /* INOUT the internal page */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Boolean                     *h,             /* OUT whether the page is split */
+    InternalItem                *item)          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+{
+    Four                        e;              /* error number */
+    Two                         k;              /* the child to flush */
+    Boolean                     split;          /* TRUE if a child is split */
+
+
+    *h = FALSE;
+
+    if (!(page->hdr.flags & BTM_MSGBUFFER)) return(eNOERROR);
+
+    while (BTM_MSGBUF_HDR(page)->nMsgs > 0) {
+        k = edubtm_HeaviestChild(page, kdesc);
+        if ((e = edubtm_FlushChild(catObjForFile, page, kdesc, k, NULL, NULL, &split, h, item, NULL, NULL)) < 0) ERR(e);
+
+        if (*h) return(eNOERROR);
+    }
+
+    /* The compaction places the entries from the beginning of the data area */
+    page->hdr.flags &= ~BTM_MSGBUFFER;
+    edubtm_CompactInternalPage(page, NIL);
+
+    return(eNOERROR);
+
+}   /* edubtm_UnbufferPage() */
+
+
+
+/*@================================
+ * edubtm_ReleaseMsgBuffers()
+ *================================*/
+/*
+ * Function: Four edubtm_ReleaseMsgBuffers(ObjectID*, BtreeInternal*, KeyDesc*, Two,
+ *                                         Boolean*, Boolean*, InternalItem*)
+ *
+ * Description:
+ *  Before the child 'idx' of the given page is merged or redistributed with
+ *  a sibling, release the message buffers of the page, of the child and of
+ *  its siblings. Their messages are pushed down one level.
+ *
+ *  The flushes may split a child; then the indexes of the children are
+ *  changed and the merge should be given up.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) split : TRUE if the children of the page are changed
+ *  2) h : TRUE if the given page is split
+ *  3) item : item to be inserted into the parent
+ *
+ * Note:
+ *  The caller should call BfM_SetDirty() for 'page'.
+ */
+Four edubtm_ReleaseMsgBuffers(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    BtreeInternal               *page,          /* INOUT the parent page */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Two                         idx,            /* IN the child to be merged (-1 denotes 'p0') */
+    Boolean                     *split,         /* OUT whether the children are changed */
+    Boolean                     *h,             /* OUT whether the page is split */
+    InternalItem                *item)          /* OUT Internal Item which will be inserted */
+                                                /*     into its parent when 'h' is TRUE */
+{
+    Four                        e;              /* error number */
+    Two                         nSlots;         /* # of children of the page before the flushes */
+    Two                         k;              /* index of a child */
+    Boolean                     buffered;       /* TRUE if the child has a message buffer */
+    Boolean                     lh;             /* local 'h' */
+    InternalItem                litem;          /* a local internal item */
+    PageID                      child;          /* a child page */
+    BtreePage                   *cpage;         /* pointer to the buffer holding a child */
+
+
+    *split = *h = FALSE;
+
+    nSlots = page->hdr.nSlots;
+    if ((e = edubtm_UnbufferPage(catObjForFile, page, kdesc, h, item)) < 0) ERR(e);
+
+    if (*h || page->hdr.nSlots != nSlots) {
+        *split = TRUE;
+        return(eNOERROR);
+    }
+
+    /* The sibling is the right one, or the left one for the last child */
+    for (k = (idx > -1) ? idx - 1 : -1; k <= idx + 1 && k < page->hdr.nSlots; k++) {
+        if (k == -1) MAKE_PAGEID(child, page->hdr.pid.volNo, page->hdr.p0);
+        else MAKE_PAGEID(child, page->hdr.pid.volNo, ((btm_InternalEntry*)&(page->data[page->slot[-k]]))->spid);
+
+        if ((e = BfM_GetTrain((TrainID*)&child, (char**)&cpage, PAGE_BUF)) < 0) ERR(e);
+
+        buffered = ((cpage->any.hdr.type & INTERNAL) && (cpage->bi.hdr.flags & BTM_MSGBUFFER)) ? TRUE : FALSE;
+        lh = FALSE;
+
+        if (buffered) {
+            if ((e = edubtm_UnbufferPage(catObjForFile, &(cpage->bi), kdesc, &lh, &litem)) < 0)
+                ERRB1(e, &child, PAGE_BUF);
+            if ((e = BfM_SetDirty((TrainID*)&child, PAGE_BUF)) < 0) ERRB1(e, &child, PAGE_BUF);
+        }
+
+        if ((e = BfM_FreeTrain((TrainID*)&child, PAGE_BUF)) < 0) ERR(e);
+
+        if (lh) {
+            *split = TRUE;
+
+            edubtm_BinarySearchInternal(page, kdesc, (KeyValue*)&(litem.klen), &k);
+            if ((e = edubtm_InsertInternal(catObjForFile, page, &litem, k, h, item)) < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_ReleaseMsgBuffers() */
+
+
+
+/*@================================
+ * edubtm_SearchPending()
+ *================================*/
+/*
+ * Function: Four edubtm_SearchPending(PageID*, KeyDesc*, KeyValue*, Boolean*, ObjectID*)
+ *
+ * Description:
+ *  Find the key value in a buffered index without moving any message. The
+ *  messages of a buffer are newer than those below it, and the later ones of
+ *  a buffer are the newer; so the last message of the key value in the
+ *  highest buffer having one decides, and the leaf decides otherwise.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  1) found : TRUE if the key value is in the index
+ *  2) oid : ObjectID of the key value when 'found' is TRUE
+ */
+Four edubtm_SearchPending(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    KeyValue                    *kval,          /* IN key value to find */
+    Boolean                     *found,         /* OUT TRUE if the key value is in the index */
+    ObjectID                    *oid)           /* OUT ObjectID of the key value */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* index by the binary search */
+    Two                         offset;         /* offset of a message */
+    Boolean                     pending;        /* TRUE if a message of the key value is found */
+    PageID                      pid;            /* the current page */
+    PageID                      child;          /* a child page */
+    BtreePage                   *apage;         /* pointer to the buffer holding the current page */
+    btm_MsgBufferHdr            *hdr;           /* header of a message buffer */
+    btm_Message                 *msg;           /* a message */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+
+
+    *found = FALSE;
+    pid = *root;
+
+    for (;;) {
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+
+        if (apage->any.hdr.type & LEAF) {
+            *found = edubtm_BinarySearchLeaf(&(apage->bl), kdesc, kval, &idx);
+            if (*found) {
+                lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-idx]]);
+                *oid = *((ObjectID*)&(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)]));
+            }
+
+            if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+
+            return(eNOERROR);
+        }
+
+        if (!(apage->any.hdr.type & INTERNAL)) ERRB1(eBADBTREEPAGE_BTM, &pid, PAGE_BUF);
+
+        pending = FALSE;
+        if (apage->bi.hdr.flags & BTM_MSGBUFFER) {
+            hdr = BTM_MSGBUF_HDR(&(apage->bi));
+            for (offset = BTM_MSGBUF_DATA; offset < BTM_MSGBUF_DATA + hdr->used; offset += BTM_MESSAGE_LEN(msg->klen)) {
+                msg = (btm_Message*)&(apage->bi.data[offset]);
+
+                if (edubtm_KeyCompare(kdesc, (KeyValue*)&(msg->klen), kval) == EQUAL) {
+                    pending = TRUE;
+                    *found = (msg->op == BTM_MSG_INSERT) ? TRUE : FALSE;
+                    *oid = msg->oid;
+                }
+            }
+        }
+
+        if (!pending) {
+            edubtm_BinarySearchInternal(&(apage->bi), kdesc, kval, &idx);
+            if (idx == -1) MAKE_PAGEID(child, pid.volNo, apage->bi.hdr.p0);
+            else MAKE_PAGEID(child, pid.volNo, ((btm_InternalEntry*)&(apage->bi.data[apage->bi.slot[-idx]]))->spid);
+        }
+
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+
+        if (pending) return(eNOERROR);
+
+        pid = child;
+    }
+
+}   /* edubtm_SearchPending() */
+
+
+
+/*@================================
+ * edubtm_BufferUpdate()
+ *================================*/
+/*
+ * Function: Four edubtm_BufferUpdate(ObjectID*, PageID*, KeyDesc*, Two, KeyValue*, ObjectID*,
+ *                                    Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Put an insert or a delete of a buffered index into the message buffer of
+ *  the root. If the root is a leaf, the update is applied directly. The
+ *  caller has checked the update by edubtm_SearchPending().
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_BufferUpdate(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Two                         op,             /* IN BTM_MSG_INSERT or BTM_MSG_DELETE */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Four                        msgArea[(BTM_MESSAGE_FIXED + MAXKEYLEN)/sizeof(Four) + 1]; /* space for a message */
+    Two                         n;              /* # of delivered messages */
+    Boolean                     f;              /* TRUE if the root is not half full */
+    Boolean                     h;              /* TRUE if the root is split */
+    InternalItem                item;           /* Internal item for the new root */
+    btm_Message                 *msg;           /* the message */
+
+
+    msg = (btm_Message*)msgArea;
+    msg->oid = *oid;
+    msg->op = op;
+    msg->klen = kval->len;
+    memcpy(&(msg->kval[0]), &(kval->val[0]), kval->len);
+
+    /* A split of the root stops the delivery; deliver it again to the new root */
+    do {
+        if ((e = edubtm_DeliverMessages(catObjForFile, root, kdesc, (char*)msg, 1, TRUE, &n, &f, &h, &item,
+                                        dlPool, dlHead)) < 0)
+            ERR(e);
+
+        if (h) {
+            if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERR(e);
+        }
+        else if (f) {
+            if ((e = edubtm_root_delete(catObjForFile, root, kdesc, dlPool, dlHead)) < 0) ERR(e);
+        }
+    } while (n == 0);
+
+    return(eNOERROR);
+
+}   /* edubtm_BufferUpdate() */
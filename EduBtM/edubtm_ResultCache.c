@@ -0,0 +1,449 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_ResultCache.c
+ *
+ * Description :
+ *  Cache of the results of the SM_EQ lookups of an index. An entry maps a
+ *  key value to the leaf and the slot where it was found, its ObjectID and
+ *  the version of the leaf at that time. A repeated lookup compares the
+ *  version of the leaf and the entry in the slot with the cached ones,
+ *  which costs one pin of the leaf instead of a descent and a binary
+ *  search.
+ *
+ *  The leaves changed under their exclusive latch get a new version from
+ *  the latch itself; the inserts, splits and deletes done under the
+ *  exclusive tree latch advance the version by edubtm_BumpVersion(...).
+ *  A cached result is used only if the slot still holds the same key
+ *  value and ObjectID, so a change which left the version alone cannot
+ *  give a wrong answer either. The operations freeing pages of the index
+ *  drop the cache, since a freed leaf may become a page of another index.
+ *
+ * Exports:
+ *  Four edubtm_CreateResultCache(PageID*)
+ *  void edubtm_DropResultCache(PageID*)
+ *  Four edubtm_ResultCacheFetch(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four, BtreeCursor*, Boolean*)
+ *  void edubtm_FillResultCache(PageID*, KeyValue*, PageID*, BtreePage*, Two)
+ */
+
+
+#include <stdlib.h>
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_ResultCache btm_resultCaches[BTM_MAXRESULTCACHES];  /* the caches, in the buffer manager mutex */
+
+
+/*@ Internal Function Prototypes */
+btm_ResultCache *edubtm_LookupResultCache(PageID*);
+btm_ResultEntry *edubtm_FindResult(btm_ResultCache*, KeyValue*);
+
+
+
+/*@================================
+ * edubtm_LookupResultCache()
+ *================================*/
+/*
+ * Function: btm_ResultCache *edubtm_LookupResultCache(PageID*)
+ *
+ * Description:
+ *  Find the result cache of the index. The caller should be in the buffer
+ *  manager mutex.
+ *
+ * Returns:
+ *  the cache, or NULL if the index has none
+ */
+btm_ResultCache *edubtm_LookupResultCache(
+    PageID                      *root)          /* IN root of the index */
+{
+    Two                         i;              /* index of the table */
+
+
+    for (i = 0; i < BTM_MAXRESULTCACHES; i++) {
+        if (btm_resultCaches[i].inUse &&
+            btm_resultCaches[i].root.volNo == root->volNo && btm_resultCaches[i].root.pageNo == root->pageNo)
+            return(&btm_resultCaches[i]);
+    }
+
+    return(NULL);
+
+}   /* edubtm_LookupResultCache() */
+
+
+
+/*@================================
+ * edubtm_FindResult()
+ *================================*/
+/*
+ * Function: btm_ResultEntry *edubtm_FindResult(btm_ResultCache*, KeyValue*)
+ *
+ * Description:
+ *  Find the entry of the key value in its set. The caller should be in
+ *  the buffer manager mutex.
+ *
+ * Returns:
+ *  the entry, or NULL if the key value is not cached
+ */
+btm_ResultEntry *edubtm_FindResult(
+    btm_ResultCache             *cache,         /* IN result cache of the index */
+    KeyValue                    *kval)          /* IN key value */
+{
+    Two                         i;              /* index of the ways */
+    UFour                       h1;             /* hash choosing the set */
+    UFour                       h2;             /* unused second hash */
+    btm_ResultSet               *set;           /* set of the key value */
+
+
+    edubtm_HashKey(kval, &h1, &h2);
+    set = &cache->sets[h1 % BTM_RESULTCACHESETS];
+
+    for (i = 0; i < BTM_RESULTCACHEWAYS; i++) {
+        if (set->ways[i].valid && set->ways[i].klen == kval->len &&
+            memcmp(set->ways[i].kval, kval->val, kval->len) == 0)
+            return(&set->ways[i]);
+    }
+
+    return(NULL);
+
+}   /* edubtm_FindResult() */
+
+
+
+/*@================================
+ * edubtm_CreateResultCache()
+ *================================*/
+/*
+ * Function: Four edubtm_CreateResultCache(PageID*)
+ *
+ * Description:
+ *  Give the index an empty result cache, unless it has one already. No
+ *  cache is created if the table is full. The caller should be in the
+ *  buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    eMEMORYALLOCERR_BTM
+ */
+Four edubtm_CreateResultCache(
+    PageID                      *root)          /* IN root of the index */
+{
+    Two                         i;              /* index of the table */
+    btm_ResultCache             *cache;         /* the cache of the index */
+
+
+    if (edubtm_LookupResultCache(root) != NULL) return(eNOERROR);
+
+    cache = NULL;
+    for (i = 0; i < BTM_MAXRESULTCACHES; i++)
+        if (!btm_resultCaches[i].inUse) { cache = &btm_resultCaches[i]; break; }
+
+    if (cache == NULL) return(eNOERROR);
+
+    /* All the entries start invalid */
+    cache->sets = (btm_ResultSet*)calloc(BTM_RESULTCACHESETS, sizeof(btm_ResultSet));
+    if (cache->sets == NULL) ERR(eMEMORYALLOCERR_BTM);
+
+    cache->inUse = TRUE;
+    cache->root = *root;
+    cache->nHits = 0;
+    cache->nMisses = 0;
+
+    return(eNOERROR);
+
+}   /* edubtm_CreateResultCache() */
+
+
+
+/*@================================
+ * edubtm_DropResultCache()
+ *================================*/
+/*
+ * Function: void edubtm_DropResultCache(PageID*)
+ *
+ * Description:
+ *  Drop the result cache of the index, if any. The caller should be in the
+ *  buffer manager mutex.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_DropResultCache(
+    PageID                      *root)          /* IN root of the index */
+{
+    btm_ResultCache             *cache;         /* the cache of the index */
+
+
+    if ((cache = edubtm_LookupResultCache(root)) == NULL) return;
+
+    free(cache->sets);
+    cache->sets = NULL;
+    cache->inUse = FALSE;
+
+}   /* edubtm_DropResultCache() */
+
+
+
+/*@================================
+ * edubtm_ResultCacheFetch()
+ *================================*/
+/*
+ * Function: Four edubtm_ResultCacheFetch(PageID*, KeyDesc*, KeyValue*, KeyValue*, Four, BtreeCursor*, Boolean*)
+ *
+ * Description:
+ *  Answer the SM_EQ lookup of the key value from the result cache of the
+ *  index. The cached leaf is pinned without a latch and its slot is read
+ *  between two checks of its version; the result is used only if the
+ *  version is still the cached one and the slot holds the key value with
+ *  the cached ObjectID. An entry which fails the checks is forgotten.
+ *
+ *  The caller holds the tree latch, so the cached leaf is not freed
+ *  meanwhile.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  cursor : the position of the key value when 'hit' is TRUE
+ *  hit    : TRUE if the lookup is answered by the cache
+ */
+Four edubtm_ResultCacheFetch(
+    PageID                      *root,          /* IN root of the index */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to look up */
+    KeyValue                    *stopKval,      /* IN key value of stop condition */
+    Four                        stopCompOp,     /* IN comparison operator of stop condition */
+    BtreeCursor                 *cursor,        /* OUT Btree cursor */
+    Boolean                     *hit)           /* OUT TRUE if the result was cached */
+{
+    Four                        e;              /* error number */
+    Four                        cmp;            /* result of comparison */
+    Two                         offset;         /* offset of the entry in the leaf */
+    UFour                       version;        /* current version of the leaf */
+    Boolean                     valid;          /* TRUE if the cached result holds */
+    Boolean                     satisfied;      /* TRUE if the stop condition holds */
+    btm_ResultCache             *cache;         /* the cache of the index */
+    btm_ResultEntry             *rEntry;        /* entry of the key value in the cache */
+    btm_ResultEntry             result;         /* copy of the entry */
+    PageID                      leaf;           /* the cached leaf */
+    BtreePage                   *apage;         /* pointer to the buffer holding the leaf */
+    btm_LeafEntry               *lEntry;        /* the entry in the cached slot */
+
+
+    *hit = FALSE;
+
+    if (kval->len > BTM_RESULTCACHEKEYLEN) return(eNOERROR);
+
+    edubtm_EnterBfM();
+    if ((cache = edubtm_LookupResultCache(root)) == NULL) {
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+    if ((rEntry = edubtm_FindResult(cache, kval)) == NULL) {
+        cache->nMisses++;
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+    rEntry->referenced = TRUE;
+    result = *rEntry;
+    edubtm_LeaveBfM();
+
+    MAKE_PAGEID(leaf, root->volNo, result.leaf);
+
+    /* The leaf has been changed since the result was cached */
+    valid = (edubtm_ReadVersion(&leaf, &version) && version == result.version) ? TRUE : FALSE;
+
+    if (valid) {
+        if ((e = edubtm_PinPage(&leaf, &apage)) < 0) ERR(e);
+
+        /* The page may be in the middle of a change; nothing read is trusted before the check */
+        valid = FALSE;
+        if ((apage->any.hdr.type & LEAF) && result.slotNo < apage->bl.hdr.nSlots) {
+            offset = apage->bl.slot[-result.slotNo];
+            if (offset >= 0 &&
+                offset <= PAGESIZE - BL_FIXED - BTM_LEAFENTRY_FIXED - ALIGNED_LENGTH(result.klen) - OBJECTID_SIZE) {
+                lEntry = (btm_LeafEntry*)&(apage->bl.data[offset]);
+                valid = (lEntry->nObjects == 1 && lEntry->klen == result.klen &&
+                         memcmp(lEntry->kval, result.kval, result.klen) == 0 &&
+                         memcmp(&(lEntry->kval[ALIGNED_LENGTH(result.klen)]), &(result.oid), OBJECTID_SIZE) == 0) ? TRUE : FALSE;
+            }
+        }
+
+        if ((e = edubtm_UnpinPage(&leaf)) < 0) ERR(e);
+
+        if (valid) valid = edubtm_ValidateVersion(&leaf, version);
+    }
+
+    edubtm_EnterBfM();
+    if ((cache = edubtm_LookupResultCache(root)) != NULL) {
+        if (valid) cache->nHits++;
+        else {
+            cache->nMisses++;
+
+            /* Forget the entry unless it has been refilled meanwhile */
+            rEntry = edubtm_FindResult(cache, kval);
+            if (rEntry != NULL && rEntry->leaf == result.leaf && rEntry->version == result.version)
+                rEntry->valid = FALSE;
+        }
+    }
+    edubtm_LeaveBfM();
+
+    if (!valid) return(eNOERROR);
+
+    satisfied = TRUE;
+    if (stopCompOp != SM_BOF && stopCompOp != SM_EOF) {
+        cmp = edubtm_KeyCompare(kdesc, kval, stopKval);
+
+        switch (stopCompOp) {
+            case SM_EQ: satisfied = (cmp == EQUAL) ? TRUE : FALSE; break;
+            case SM_LT: satisfied = (cmp == LESS) ? TRUE : FALSE; break;
+            case SM_LE: satisfied = (cmp != GREATER) ? TRUE : FALSE; break;
+            case SM_GT: satisfied = (cmp == GREATER) ? TRUE : FALSE; break;
+            case SM_GE: satisfied = (cmp != LESS) ? TRUE : FALSE; break;
+        }
+    }
+
+    if (satisfied) {
+        cursor->flag = CURSOR_ON;
+        cursor->leaf = leaf;
+        cursor->overflow.pageNo = NIL;
+        cursor->slotNo = result.slotNo;
+        cursor->oidArrayElemNo = 0;
+        cursor->key.len = result.klen;
+        memcpy(cursor->key.val, result.kval, result.klen);
+        cursor->oid = result.oid;
+    }
+    else
+        cursor->flag = CURSOR_EOS;
+
+    *hit = TRUE;
+
+    return(eNOERROR);
+
+}   /* edubtm_ResultCacheFetch() */
+
+
+
+/*@================================
+ * edubtm_FillResultCache()
+ *================================*/
+/*
+ * Function: void edubtm_FillResultCache(PageID*, KeyValue*, PageID*, BtreePage*, Two)
+ *
+ * Description:
+ *  Remember where an SM_EQ lookup found the key value. The caller holds
+ *  the shared latch of the leaf, so the version read here is the one of
+ *  the entry in the slot. An entry of the set not used since the clock
+ *  hand last passed it is replaced.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_FillResultCache(
+    PageID                      *root,          /* IN root of the index */
+    KeyValue                    *kval,          /* IN key value looked up */
+    PageID                      *leaf,          /* IN leaf holding the key value */
+    BtreePage                   *apage,         /* IN pointer to the buffer holding the leaf */
+    Two                         slotNo)         /* IN slot of the key value */
+{
+    UFour                       version;        /* version of the leaf */
+    UFour                       h1;             /* hash choosing the set */
+    UFour                       h2;             /* unused second hash */
+    btm_ResultCache             *cache;         /* the cache of the index */
+    btm_ResultSet               *set;           /* set of the key value */
+    btm_ResultEntry             *rEntry;        /* entry to be filled */
+    btm_LeafEntry               *lEntry;        /* the entry in the leaf */
+
+
+    if (kval->len > BTM_RESULTCACHEKEYLEN) return;
+
+    lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-slotNo]]);
+
+    /* The ObjectIDs of an entry kept in overflow pages are not cached */
+    if (lEntry->nObjects != 1) return;
+
+    /* Another page of the same version word is being changed */
+    if (!edubtm_ReadVersion(leaf, &version)) return;
+
+    edubtm_EnterBfM();
+
+    if ((cache = edubtm_LookupResultCache(root)) == NULL) {
+        edubtm_LeaveBfM();
+        return;
+    }
+
+    if ((rEntry = edubtm_FindResult(cache, kval)) == NULL) {
+        edubtm_HashKey(kval, &h1, &h2);
+        set = &cache->sets[h1 % BTM_RESULTCACHESETS];
+
+        /* Second chance: skip the entries used since the hand passed them */
+        while (set->ways[set->hand].valid && set->ways[set->hand].referenced) {
+            set->ways[set->hand].referenced = FALSE;
+            set->hand = (set->hand + 1) % BTM_RESULTCACHEWAYS;
+        }
+        rEntry = &set->ways[set->hand];
+        set->hand = (set->hand + 1) % BTM_RESULTCACHEWAYS;
+    }
+
+    rEntry->valid = TRUE;
+    rEntry->referenced = FALSE;
+    rEntry->leaf = leaf->pageNo;
+    rEntry->slotNo = slotNo;
+    rEntry->version = version;
+    memcpy(&(rEntry->oid), &(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)]), OBJECTID_SIZE);
+    rEntry->klen = kval->len;
+    memcpy(rEntry->kval, kval->val, kval->len);
+
+    edubtm_LeaveBfM();
+
+}   /* edubtm_FillResultCache() */
@@ -0,0 +1,741 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_Search.c
+ *
+ * Description :
+ *  Search of a B+ tree for the concurrent readers. The internal pages are
+ *  read optimistically: a search pins them without latching and validates
+ *  their versions after reading them, and starts over from the root if some
+ *  writer has latched one of them meanwhile. Only the leaf is latched. After
+ *  a few failed attempts the search couples the shared latches instead,
+ *  holding at most two of them at a time: it latches the child (or the
+ *  sibling leaf) before it releases the current page.
+ *
+ *  A page split by a concurrent insert may not be known to its parent yet;
+ *  a search landing on it follows its right link when the key value is not
+ *  less than its high key (see edubtm_BLink.c).
+ *
+ * Exports:
+ *  Four edubtm_SearchLeaf(PageID*, KeyDesc*, KeyValue*, Boolean, Four, btm_TreePath*, PageID*, BtreePage**)
+ *  Four edubtm_PositionCursor(PageID*, BtreePage*, Two, Boolean, KeyDesc*, KeyValue*, Four, BtreeCursor*)
+ *  Four edubtm_MoveRightToLeaf(PageID*, BtreePage**, KeyDesc*, KeyValue*, Boolean, Four)
+ *  Boolean edubtm_UnlatchedSearchInternal(BtreeInternal*, KeyDesc*, KeyValue*, Boolean, Two*, ShortPageID*)
+ */
+
+
+#include <string.h>
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Internal Function Prototypes */
+Four edubtm_OptimisticSearchLeaf(PageID*, btm_UpperCache*, KeyDesc*, KeyValue*, Boolean, Four, btm_TreePath*, PageID*, BtreePage**, Boolean*);
+Four edubtm_CoupledSearchLeaf(PageID*, KeyDesc*, KeyValue*, Boolean, Four, btm_TreePath*, PageID*, BtreePage**);
+Boolean edubtm_ReadUnlatchedEntry(BtreeInternal*, KeyDesc*, Two, Two, KeyValue*, ShortPageID*);
+
+
+
+/*@================================
+ * edubtm_SearchLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_SearchLeaf(PageID*, KeyDesc*, KeyValue*, Boolean, Four,
+ *                                  btm_TreePath*, PageID*, BtreePage**)
+ *
+ * Description:
+ *  Descend from the root to the leaf which covers the given key value,
+ *  reading the internal pages optimistically. If 'kval' is NULL, the leftmost
+ *  leaf is found, or the rightmost one if 'last' is TRUE. A page whose split
+ *  is pending is passed over to the right when the key value is not less
+ *  than its high key, at any level.
+ *
+ *  The leaf is latched in the given mode. If 'path' is not NULL, the
+ *  internal pages from which the search went down are put on it, so that an
+ *  insert can find the parents of the pages it splits.
+ *
+ *  A lookup with a key value and no path is tried first on the model of
+ *  the leaf level, if the index has one (see edubtm_LearnedIndex.c).
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  leaf  : PageID of the leaf found
+ *  apage : pointer to the buffer holding the leaf; the leaf is left fixed
+ *          and latched, and the caller should release it by
+ *          edubtm_UnfixPage(...)
+ */
+Four edubtm_SearchLeaf(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last leaf */
+    Boolean                     last,           /* IN TRUE for the last leaf when 'kval' is NULL */
+    Four                        mode,           /* IN BTM_LATCH_S or BTM_LATCH_X for the leaf */
+    btm_TreePath                *path,          /* OUT internal pages on the way, may be NULL */
+    PageID                      *leaf,          /* OUT the leaf found */
+    BtreePage                   **apage)        /* OUT pointer to the buffer holding the leaf */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* # of attempts */
+    Boolean                     restart;        /* TRUE if the optimistic descent failed */
+    Boolean                     found;          /* TRUE if the model of the leaves found the leaf */
+    btm_UpperCache              *cache;         /* cache of the upper levels of the index */
+
+
+    /* A lookup goes to the leaf directly if the index has a model of its leaves */
+    if (kval != NULL && path == NULL) {
+        if ((e = edubtm_LearnedSearchLeaf(root, kdesc, kval, mode, leaf, apage, &found)) < 0) ERR(e);
+        if (found) return(eNOERROR);
+    }
+
+    /* The upper pages are taken from the cache of the index */
+    if ((e = edubtm_EnterUpperCache(root, &cache)) < 0) ERR(e);
+
+    for (i = 0; i < BTM_OPTIMISTIC_RETRIES; i++) {
+        e = edubtm_OptimisticSearchLeaf(root, cache, kdesc, kval, last, mode, path, leaf, apage, &restart);
+        if (e < 0 || !restart) {
+            edubtm_LeaveUpperCache(cache);
+            if (e < 0) ERR(e);
+            return(eNOERROR);
+        }
+    }
+
+    edubtm_LeaveUpperCache(cache);
+
+    /* The pages on the path keep changing; latch them */
+    if ((e = edubtm_CoupledSearchLeaf(root, kdesc, kval, last, mode, path, leaf, apage)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_SearchLeaf() */
+
+
+
+/*@================================
+ * edubtm_OptimisticSearchLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_OptimisticSearchLeaf(PageID*, btm_UpperCache*, KeyDesc*, KeyValue*, Boolean,
+ *                                            Four, btm_TreePath*, PageID*, BtreePage**, Boolean*)
+ *
+ * Description:
+ *  Descend from the root to the leaf without latching the internal pages.
+ *  The child (or the right page) read from a page is followed only if the
+ *  version of the page is unchanged after the next page's version is read,
+ *  so the next page was really pointed to by the page. The leaf is latched
+ *  and its version is validated once more under the latch.
+ *
+ *  A page being updated may be read half-written; such a read is thrown
+ *  away by the validation, which is done before anything read is used.
+ *  The search in the page itself checks every offset and length it reads
+ *  against the page, so a torn page makes the descent start over instead
+ *  of reading outside the page.
+ *
+ *  The pages of the upper levels are taken from the cache of the index,
+ *  if any; the versions are validated for them all the same.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  leaf    : PageID of the leaf found
+ *  apage   : pointer to the buffer holding the leaf, fixed with the latch
+ *  restart : TRUE if a writer got in the way; then nothing is left fixed
+ */
+Four edubtm_OptimisticSearchLeaf(
+    PageID                      *root,          /* IN root of the Btree */
+    btm_UpperCache              *cache,         /* IN cache of the upper levels, may be NULL */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last leaf */
+    Boolean                     last,           /* IN TRUE for the last leaf when 'kval' is NULL */
+    Four                        mode,           /* IN BTM_LATCH_S or BTM_LATCH_X for the leaf */
+    btm_TreePath                *path,          /* OUT internal pages on the way, may be NULL */
+    PageID                      *leaf,          /* OUT the leaf found */
+    BtreePage                   **apage,        /* OUT pointer to the buffer holding the leaf */
+    Boolean                     *restart)       /* OUT TRUE if the descent should start over */
+{
+    Four                        e;              /* error number */
+    One                         type;           /* type of the current page */
+    UFour                       version;        /* version of the current page */
+    UFour                       nVersion;       /* version of the next page */
+    Boolean                     right;          /* TRUE if the search moves right */
+    ShortPageID                 childNo;        /* page number of the child */
+    PageID                      pid;            /* current page */
+    PageID                      next;           /* the child or the right page */
+    BtreePage                   *page;          /* pointer to the buffer holding the current page */
+    BtreePage                   *npage;         /* pointer to the buffer holding the next page */
+    Two                         slot;           /* slot of the child followed, BTM_NOCHILDREF if none */
+    btm_CachedPage              *entry;         /* the current page in the cache, NULL if not cached */
+    btm_CachedPage              *nEntry;        /* the next page in the cache, NULL if not cached */
+
+
+    *restart = TRUE;
+    if (path != NULL) path->nPages = 0;
+
+    pid = *root;
+    if (!edubtm_ReadVersion(&pid, &version)) return(eNOERROR);
+    if ((e = edubtm_PinUpperPage(cache, &pid, &page, &entry)) < 0) ERR(e);
+
+    for (;;) {
+
+        type = page->any.hdr.type;
+        if (!(type & INTERNAL)) break;
+
+        right = edubtm_FollowRightLink(&pid, page, kdesc, kval, last, &next);
+        slot = BTM_NOCHILDREF;
+        if (!right) {
+            /* A page which does not look like an internal page is being written */
+            if (!edubtm_UnlatchedSearchInternal(&(page->bi), kdesc, kval, last, &slot, &childNo)) {
+                if ((e = edubtm_UnpinUpperPage(&pid, entry != NULL)) < 0) ERR(e);
+                return(eNOERROR);
+            }
+
+            MAKE_PAGEID(next, root->volNo, childNo);
+        }
+
+        /* The next page is still pointed to by the page when its version is read */
+        if (!edubtm_ValidateVersion(&pid, version) ||
+            !edubtm_ReadVersion(&next, &nVersion) || !edubtm_ValidateVersion(&pid, version)) {
+            if ((e = edubtm_UnpinUpperPage(&pid, entry != NULL)) < 0) ERR(e);
+            return(eNOERROR);
+        }
+
+        if (!right && path != NULL) {
+            if (path->nPages == BTM_MAXTREEHEIGHT) {
+                (Four) edubtm_UnpinUpperPage(&pid, entry != NULL);
+                ERR(eEXCEEDMAXDEPTHOFBTREE_BTM);
+            }
+            path->pid[path->nPages++] = pid;
+        }
+
+        /* A swizzled reference saves the search of the cache for the child */
+        if ((e = edubtm_PinUpperChild(cache, entry, slot, &next, &npage, &nEntry)) < 0) {
+            (Four) edubtm_UnpinUpperPage(&pid, entry != NULL);
+            ERR(e);
+        }
+        if ((e = edubtm_UnpinUpperPage(&pid, entry != NULL)) < 0) {
+            (Four) edubtm_UnpinUpperPage(&next, nEntry != NULL);
+            ERR(e);
+        }
+
+        pid = next;
+        page = npage;
+        entry = nEntry;
+        version = nVersion;
+    }
+
+    /* Latch the leaf; its pin is kept until the latched fix is done */
+    if ((e = edubtm_FixPage(&pid, apage, mode)) < 0) {
+        (Four) edubtm_UnpinUpperPage(&pid, entry != NULL);
+        ERR(e);
+    }
+    if ((e = edubtm_UnpinUpperPage(&pid, entry != NULL)) < 0) {
+        (Four) edubtm_UnfixPage(&pid, FALSE);
+        ERR(e);
+    }
+
+    /* The exclusive latch just acquired is counted in the version word */
+    if (!edubtm_ValidateVersion(&pid, (mode == BTM_LATCH_X) ? version+1 : version)) {
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if (!(type & LEAF)) {
+        (Four) edubtm_UnfixPage(&pid, FALSE);
+        ERR(eBADBTREEPAGE_BTM);
+    }
+
+    if ((e = edubtm_MoveRightToLeaf(&pid, apage, kdesc, kval, last, mode)) < 0) ERR(e);
+
+    *restart = FALSE;
+    *leaf = pid;
+
+    return(eNOERROR);
+
+}   /* edubtm_OptimisticSearchLeaf() */
+
+
+
+/*@================================
+ * edubtm_UnlatchedSearchInternal()
+ *================================*/
+/*
+ * Function: Boolean edubtm_UnlatchedSearchInternal(BtreeInternal*, KeyDesc*, KeyValue*, Boolean,
+ *                                                  Two*, ShortPageID*)
+ *
+ * Description:
+ *  Find the child to follow in an internal page which is not latched, as
+ *  edubtm_BinarySearchInternal(...) does. The page may be written at the
+ *  same time, so the # of slots is read once and every entry is read by
+ *  edubtm_ReadUnlatchedEntry(...); nothing is dereferenced before it is
+ *  checked to lie in the page. If 'kval' is NULL, the first child is found,
+ *  or the last one if 'last' is TRUE.
+ *
+ * Returns:
+ *  FALSE if the page is inconsistent; TRUE otherwise
+ *
+ * Side effects:
+ *  slot    : slot of the child, -1 for 'p0'
+ *  childNo : page number of the child
+ *
+ * Note:
+ *  The result means nothing until the version of the page is validated.
+ */
+Boolean edubtm_UnlatchedSearchInternal(
+    BtreeInternal               *ipage,         /* IN internal page read without a latch */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last child */
+    Boolean                     last,           /* IN TRUE for the last child when 'kval' is NULL */
+    Two                         *slot,          /* OUT slot of the child */
+    ShortPageID                 *childNo)       /* OUT page number of the child */
+{
+    Two                         nSlots;         /* # of slots read once */
+    Two                         low;            /* low index */
+    Two                         mid;            /* mid index */
+    Two                         high;           /* high index */
+    Four                        cmp;            /* result of comparison */
+    ShortPageID                 spid;           /* child of an entry */
+    KeyValue                    key;            /* copy of the key of an entry */
+
+
+    nSlots = ipage->hdr.nSlots;
+    if (nSlots < 0 || nSlots > (PAGESIZE - BI_FIXED) / sizeof(Two)) return(FALSE);
+
+    if (kval == NULL)
+        high = (last) ? nSlots-1 : -1;
+    else {
+        low = 0;
+        high = nSlots - 1;
+        while (low <= high) {
+            mid = (low + high) / 2;
+            if (!edubtm_ReadUnlatchedEntry(ipage, kdesc, nSlots, mid, &key, &spid)) return(FALSE);
+
+            cmp = edubtm_KeyCompare(kdesc, kval, &key);
+            if (cmp == EQUAL) {
+                high = mid;
+                break;
+            }
+            else if (cmp == GREATER) low = mid + 1;
+            else high = mid - 1;
+        }
+    }
+
+    /* 'high' is the last slot whose key is not greater than the key value */
+    if (high < 0) {
+        *slot = -1;
+        *childNo = ipage->hdr.p0;
+        return(TRUE);
+    }
+
+    if (!edubtm_ReadUnlatchedEntry(ipage, kdesc, nSlots, high, &key, &spid)) return(FALSE);
+
+    *slot = high;
+    *childNo = spid;
+
+    return(TRUE);
+
+}   /* edubtm_UnlatchedSearchInternal() */
+
+
+
+/*@================================
+ * edubtm_ReadUnlatchedEntry()
+ *================================*/
+/*
+ * Function: Boolean edubtm_ReadUnlatchedEntry(BtreeInternal*, KeyDesc*, Two, Two, KeyValue*,
+ *                                             ShortPageID*)
+ *
+ * Description:
+ *  Copy the key and the child of the entry in the given slot of a page
+ *  which is not latched. The slot offset and the key length are read once
+ *  and checked to keep the entry between the start of the data area and
+ *  the slot array; the parts of the copied key are checked to fit in it, so
+ *  that edubtm_KeyCompare(...) never reads past the copy.
+ *
+ * Returns:
+ *  FALSE if the entry is out of the page or malformed; TRUE otherwise
+ *
+ * Side effects:
+ *  key  : copy of the key of the entry
+ *  spid : the child of the entry
+ */
+Boolean edubtm_ReadUnlatchedEntry(
+    BtreeInternal               *ipage,         /* IN internal page read without a latch */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    Two                         nSlots,         /* IN # of slots read by the caller */
+    Two                         slotNo,         /* IN slot of the entry, less than 'nSlots' */
+    KeyValue                    *key,           /* OUT copy of the key */
+    ShortPageID                 *spid)          /* OUT the child */
+{
+    Two                         i;              /* index of the key parts */
+    Two                         offset;         /* offset of the entry */
+    Two                         klen;           /* key length read once */
+    Two                         len;            /* length of a string part */
+    Four                        limit;          /* end of the data area before the slot array */
+    Four                        used;           /* # of bytes of the key used by the parts */
+    btm_InternalEntry           *iEntry;        /* the entry */
+
+
+    limit = PAGESIZE - BI_FIXED - (nSlots - 1) * sizeof(Two);
+
+    offset = ipage->slot[-slotNo];
+    if (offset < 0 || offset + sizeof(ShortPageID) + sizeof(Two) > limit) return(FALSE);
+
+    iEntry = (btm_InternalEntry*)&(ipage->data[offset]);
+    klen = iEntry->klen;
+    if (klen < 0 || klen > MAXKEYLEN || offset + BTM_INTERNALENTRY_LEN(klen) > limit) return(FALSE);
+
+    key->len = klen;
+    memcpy(key->val, iEntry->kval, klen);
+    *spid = iEntry->spid;
+
+    for (i = 0, used = 0; i < kdesc->nparts && used <= klen; i++) {
+        if (kdesc->kpart[i].type == SM_VARSTRING) {
+            if (used + sizeof(Two) > klen) return(FALSE);
+            memcpy(&len, &(key->val[used]), sizeof(Two));
+            if (len < 0) return(FALSE);
+            used += sizeof(Two) + len;
+        }
+        else
+            used += sizeof(Four_Invariable);
+    }
+
+    return((used <= klen) ? TRUE : FALSE);
+
+}   /* edubtm_ReadUnlatchedEntry() */
+
+
+
+/*@================================
+ * edubtm_CoupledSearchLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_CoupledSearchLeaf(PageID*, KeyDesc*, KeyValue*, Boolean, Four,
+ *                                         btm_TreePath*, PageID*, BtreePage**)
+ *
+ * Description:
+ *  Descend from the root to the leaf which covers the given key value,
+ *  coupling the shared latches on the way. The leaf is latched in the given
+ *  mode while its parent is still latched. It always makes progress, so it
+ *  is the fallback of the optimistic descent.
+ *
+ * Returns:
+ *  error code
+ *    eBADBTREEPAGE_BTM
+ *    eEXCEEDMAXDEPTHOFBTREE_BTM
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  leaf  : PageID of the leaf found
+ *  apage : pointer to the buffer holding the leaf, fixed with the latch
+ */
+Four edubtm_CoupledSearchLeaf(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last leaf */
+    Boolean                     last,           /* IN TRUE for the last leaf when 'kval' is NULL */
+    Four                        mode,           /* IN BTM_LATCH_S or BTM_LATCH_X for the leaf */
+    btm_TreePath                *path,          /* OUT internal pages on the way, may be NULL */
+    PageID                      *leaf,          /* OUT the leaf found */
+    BtreePage                   **apage)        /* OUT pointer to the buffer holding the leaf */
+{
+    Four                        e;              /* error number */
+    Two                         idx;            /* index of the child */
+    Boolean                     right;          /* TRUE if the search moves right */
+    PageID                      pid;            /* current page */
+    PageID                      next;           /* the child or the right page */
+    BtreePage                   *page;          /* pointer to the buffer holding the current page */
+    BtreePage                   *npage;         /* pointer to the buffer holding the next page */
+    btm_InternalEntry           *iEntry;        /* an internal entry */
+
+
+    for (;;) {
+        if (path != NULL) path->nPages = 0;
+
+        pid = *root;
+        if ((e = edubtm_FixPage(&pid, &page, BTM_LATCH_S)) < 0) ERR(e);
+        if (!(page->any.hdr.type & LEAF) || mode == BTM_LATCH_S) break;
+
+        /* The root is the leaf; latch it again in the given mode */
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+        if ((e = edubtm_FixPage(&pid, &page, mode)) < 0) ERR(e);
+        if (page->any.hdr.type & LEAF) break;
+
+        /* The root has been split meanwhile */
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+    }
+
+    while (page->any.hdr.type & INTERNAL) {
+
+        right = edubtm_FollowRightLink(&pid, page, kdesc, kval, last, &next);
+        if (!right) {
+            if (kval != NULL)
+                edubtm_BinarySearchInternal(&(page->bi), kdesc, kval, &idx);
+            else
+                idx = (last) ? page->bi.hdr.nSlots-1 : -1;
+
+            if (idx == -1) {
+                MAKE_PAGEID(next, root->volNo, page->bi.hdr.p0);
+            }
+            else {
+                iEntry = (btm_InternalEntry*)&(page->bi.data[page->bi.slot[-idx]]);
+                MAKE_PAGEID(next, root->volNo, iEntry->spid);
+            }
+
+            if (path != NULL) {
+                if (path->nPages == BTM_MAXTREEHEIGHT) {
+                    (Four) edubtm_UnfixPage(&pid, FALSE);
+                    ERR(eEXCEEDMAXDEPTHOFBTREE_BTM);
+                }
+                path->pid[path->nPages++] = pid;
+            }
+        }
+
+        /* Latch the next page before releasing the current one */
+        if ((e = edubtm_FixPage(&next, &npage, BTM_LATCH_S)) < 0) {
+            (Four) edubtm_UnfixPage(&pid, FALSE);
+            ERR(e);
+        }
+
+        /* A leaf never becomes an internal page unless it is the root */
+        if ((npage->any.hdr.type & LEAF) && mode != BTM_LATCH_S) {
+            e = edubtm_UnfixPage(&next, FALSE);
+            if (e >= 0) e = edubtm_FixPage(&next, &npage, mode);
+            if (e < 0) {
+                (Four) edubtm_UnfixPage(&pid, FALSE);
+                ERR(e);
+            }
+        }
+
+        if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) {
+            (Four) edubtm_UnfixPage(&next, FALSE);
+            ERR(e);
+        }
+
+        pid = next;
+        page = npage;
+    }
+
+    if (!(page->any.hdr.type & LEAF)) {
+        (Four) edubtm_UnfixPage(&pid, FALSE);
+        ERR(eBADBTREEPAGE_BTM);
+    }
+
+    *apage = page;
+    if ((e = edubtm_MoveRightToLeaf(&pid, apage, kdesc, kval, last, mode)) < 0) ERR(e);
+
+    *leaf = pid;
+
+    return(eNOERROR);
+
+}   /* edubtm_CoupledSearchLeaf() */
+
+
+
+/*@================================
+ * edubtm_MoveRightToLeaf()
+ *================================*/
+/*
+ * Function: Four edubtm_MoveRightToLeaf(PageID*, BtreePage**, KeyDesc*, KeyValue*, Boolean, Four)
+ *
+ * Description:
+ *  Move from the given leaf to the right while the split of the leaf is
+ *  pending and the key value is not less than its high key. A shared latch
+ *  is coupled to the right page; an exclusive latch is released before the
+ *  right page is latched, because a writer does not wait for a latch while
+ *  holding a leaf. The right page keeps the key range it got by the split,
+ *  so nothing is missed in between.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  pid   : PageID of the leaf which covers the key value
+ *  apage : pointer to the buffer holding the leaf, fixed with the latch
+ *
+ * Note:
+ *  On an error, nothing is left fixed.
+ */
+Four edubtm_MoveRightToLeaf(
+    PageID                      *pid,           /* INOUT current leaf */
+    BtreePage                   **apage,        /* INOUT pointer to the buffer holding the leaf */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *kval,          /* IN key value to search, NULL for the first or last leaf */
+    Boolean                     last,           /* IN TRUE for the last leaf when 'kval' is NULL */
+    Four                        mode)           /* IN mode of the latch of the leaf */
+{
+    Four                        e;              /* error number */
+    PageID                      right;          /* the right page */
+    BtreePage                   *rpage;         /* pointer to the buffer holding the right page */
+
+
+    while (edubtm_FollowRightLink(pid, *apage, kdesc, kval, last, &right)) {
+
+        if (mode == BTM_LATCH_S) {
+            if ((e = edubtm_FixPage(&right, &rpage, mode)) < 0) {
+                (Four) edubtm_UnfixPage(pid, FALSE);
+                ERR(e);
+            }
+            if ((e = edubtm_UnfixPage(pid, FALSE)) < 0) {
+                (Four) edubtm_UnfixPage(&right, FALSE);
+                ERR(e);
+            }
+        }
+        else {
+            if ((e = edubtm_UnfixPage(pid, FALSE)) < 0) ERR(e);
+            if ((e = edubtm_FixPage(&right, &rpage, mode)) < 0) ERR(e);
+        }
+
+        *pid = right;
+        *apage = rpage;
+    }
+
+    return(eNOERROR);
+
+}   /* edubtm_MoveRightToLeaf() */
+
+
+
+/*@================================
+ * edubtm_PositionCursor()
+ *================================*/
+/*
+ * Function: Four edubtm_PositionCursor(PageID*, BtreePage*, Two, Boolean,
+ *                                      KeyDesc*, KeyValue*, Four, BtreeCursor*)
+ *
+ * Description:
+ *  Make the cursor point to the given slot of the given leaf, which is fixed
+ *  with a shared latch. If the slot is out of the leaf, the cursor goes to
+ *  the first slot of the next leaf (or the last slot of the previous leaf if
+ *  'forward' is FALSE). The cursor gets CURSOR_EOS if there is no more entry
+ *  or the entry does not satisfy the stop condition. The leaf is released
+ *  before return.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  cursor : the position of the entry found and its ObjectID
+ */
+Four edubtm_PositionCursor(
+    PageID                      *leaf,          /* IN leaf fixed with a shared latch */
+    BtreePage                   *apage,         /* IN pointer to the buffer holding the leaf */
+    Two                         slotNo,         /* IN slot to point to */
+    Boolean                     forward,        /* IN direction of the scan */
+    KeyDesc                     *kdesc,         /* IN Btree key descriptor */
+    KeyValue                    *stopKval,      /* IN key value of stop condition */
+    Four                        stopCompOp,     /* IN comparison operator of stop condition */
+    BtreeCursor                 *cursor)        /* OUT Btree cursor */
+{
+    Four                        e;              /* error number */
+    Four                        cmp;            /* result of comparison */
+    Boolean                     eos;            /* TRUE if there is no more leaf */
+    Boolean                     satisfied;      /* TRUE if the stop condition holds */
+    PageID                      pid;            /* current leaf */
+    btm_LeafEntry               *lEntry;        /* a leaf entry */
+
+
+    pid = *leaf;
+
+    /* An empty leaf is skipped over */
+    while (slotNo < 0 || slotNo >= apage->bl.hdr.nSlots) {
+        if ((e = edubtm_MoveToSibling(&pid, &apage, forward, &eos)) < 0) ERR(e);
+
+        if (eos) {
+            cursor->flag = CURSOR_EOS;
+            if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+            return(eNOERROR);
+        }
+
+        slotNo = (forward) ? 0 : apage->bl.hdr.nSlots-1;
+    }
+
+    lEntry = (btm_LeafEntry*)&(apage->bl.data[apage->bl.slot[-slotNo]]);
+
+    satisfied = TRUE;
+    if (stopCompOp != SM_BOF && stopCompOp != SM_EOF) {
+        cmp = edubtm_KeyCompare(kdesc, (KeyValue*)&(lEntry->klen), stopKval);
+
+        switch (stopCompOp) {
+            case SM_EQ: satisfied = (cmp == EQUAL) ? TRUE : FALSE; break;
+            case SM_LT: satisfied = (cmp == LESS) ? TRUE : FALSE; break;
+            case SM_LE: satisfied = (cmp != GREATER) ? TRUE : FALSE; break;
+            case SM_GT: satisfied = (cmp == GREATER) ? TRUE : FALSE; break;
+            case SM_GE: satisfied = (cmp != LESS) ? TRUE : FALSE; break;
+        }
+    }
+
+    if (satisfied) {
+        cursor->flag = CURSOR_ON;
+        cursor->leaf = pid;
+        cursor->overflow.pageNo = NIL;
+        cursor->slotNo = slotNo;
+        cursor->oidArrayElemNo = 0;
+        cursor->key.len = lEntry->klen;
+        memcpy(cursor->key.val, lEntry->kval, lEntry->klen);
+        memcpy(&(cursor->oid), &(lEntry->kval[ALIGNED_LENGTH(lEntry->klen)]), OBJECTID_SIZE);
+    }
+    else
+        cursor->flag = CURSOR_EOS;
+
+    if ((e = edubtm_UnfixPage(&pid, FALSE)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_PositionCursor() */
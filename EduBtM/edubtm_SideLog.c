@@ -0,0 +1,539 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_SideLog.c
+ *
+ * Description :
+ *  Side logs of the indexes built online.
+ *
+ *  An index being built is registered with the meta page holding its side
+ *  log. Its inserts and deletes are appended to the side log under the
+ *  mutex of the table, without the latch of the tree which the build holds,
+ *  and are replayed into the tree, in the order they were made, when the
+ *  build ends. The records have the format of the change buffer, with no
+ *  leaf given.
+ *
+ * Exports:
+ *  Four edubtm_RegisterOnlineBuild(ObjectID*, PageID*, PageID*)
+ *  Boolean edubtm_InOnlineBuild(PageID*)
+ *  Four edubtm_LogSideChange(PageID*, Two, KeyValue*, ObjectID*, Boolean*)
+ *  Four edubtm_ReplaySideLog(PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ */
+
+
+#include <string.h>
+#include <pthread.h>
+#include "EduBtM_common.h"
+#include "Util.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_OnlineBuildTable btm_onlineBuildTable;                      /* the indexes being built */
+pthread_once_t btm_onlineBuildTableOnce = PTHREAD_ONCE_INIT;    /* initializes the table once */
+
+
+/*@ Internal Function Prototypes */
+void edubtm_InitOnlineBuildTable(void);
+Four edubtm_LookupOnlineBuild(PageID*);
+Four edubtm_AppendSideLog(btm_OnlineBuild*, btm_Message*);
+Four edubtm_ApplySideLog(btm_OnlineBuild*, KeyDesc*, Pool*, DeallocListElem*);
+
+
+
+/*@================================
+ * edubtm_InitOnlineBuildTable()
+ *================================*/
+/*
+ * Function: void edubtm_InitOnlineBuildTable(void)
+ *
+ * Description:
+ *  Initialize the table of the indexes being built; called once through
+ *  pthread_once().
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_InitOnlineBuildTable(void)
+{
+    Four                        i;              /* index */
+
+
+    pthread_mutex_init(&btm_onlineBuildTable.mutex, NULL);
+
+    for (i = 0; i < BTM_MAXONLINEBUILDS; i++)
+        btm_onlineBuildTable.entries[i].inUse = FALSE;
+
+}   /* edubtm_InitOnlineBuildTable() */
+
+
+
+/*@================================
+ * edubtm_LookupOnlineBuild()
+ *================================*/
+/*
+ * Function: Four edubtm_LookupOnlineBuild(PageID*)
+ *
+ * Description:
+ *  Find the entry of the index whose root is given. The caller should be in
+ *  the mutex of the table.
+ *
+ * Returns:
+ *  index of the entry, NIL if the index is not being built
+ */
+Four edubtm_LookupOnlineBuild(
+    PageID                      *root)          /* IN root of the Btree */
+{
+    Four                        i;              /* index of the entry */
+    btm_OnlineBuild             *build;         /* entry of the index */
+
+
+    for (i = 0; i < BTM_MAXONLINEBUILDS; i++) {
+        build = &btm_onlineBuildTable.entries[i];
+        if (build->inUse && build->root.pageNo == root->pageNo && build->root.volNo == root->volNo)
+            return(i);
+    }
+
+    return(NIL);
+
+}   /* edubtm_LookupOnlineBuild() */
+
+
+
+/*@================================
+ * edubtm_RegisterOnlineBuild()
+ *================================*/
+/*
+ * Function: Four edubtm_RegisterOnlineBuild(ObjectID*, PageID*, PageID*)
+ *
+ * Description:
+ *  Register an index whose build begins. From now on its changes go to the
+ *  side log hanging from the given meta page.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eONLINEBUILDTABLEFULL_BTM
+ */
+Four edubtm_RegisterOnlineBuild(
+    ObjectID                    *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID                      *root,          /* IN root of the Btree */
+    PageID                      *metaPid)       /* IN meta page of the index */
+{
+    Four                        i;              /* index of the entry */
+    btm_OnlineBuild             *build;         /* entry of the index */
+
+
+    pthread_once(&btm_onlineBuildTableOnce, edubtm_InitOnlineBuildTable);
+
+    pthread_mutex_lock(&btm_onlineBuildTable.mutex);
+
+    /* The index is being built already */
+    if (edubtm_LookupOnlineBuild(root) != NIL) {
+        pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+        ERR(eBADPARAMETER_BTM);
+    }
+
+    for (i = 0; i < BTM_MAXONLINEBUILDS; i++)
+        if (!btm_onlineBuildTable.entries[i].inUse) break;
+
+    if (i == BTM_MAXONLINEBUILDS) {
+        pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+        ERR(eONLINEBUILDTABLEFULL_BTM);
+    }
+
+    build = &btm_onlineBuildTable.entries[i];
+    build->inUse = TRUE;
+    build->root = *root;
+    build->metaPid = *metaPid;
+    build->catObjForFile = *catObjForFile;
+
+    pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+
+    return(eNOERROR);
+
+}   /* edubtm_RegisterOnlineBuild() */
+
+
+
+/*@================================
+ * edubtm_InOnlineBuild()
+ *================================*/
+/*
+ * Function: Boolean edubtm_InOnlineBuild(PageID*)
+ *
+ * Description:
+ *  Check whether the index is being built. The updates which cannot be
+ *  written as plain inserts and deletes are refused during a build.
+ *
+ * Returns:
+ *  TRUE if the index is being built, FALSE otherwise
+ */
+Boolean edubtm_InOnlineBuild(
+    PageID                      *root)          /* IN root of the Btree */
+{
+    Boolean                     found;          /* TRUE if the index is registered */
+
+
+    pthread_once(&btm_onlineBuildTableOnce, edubtm_InitOnlineBuildTable);
+
+    pthread_mutex_lock(&btm_onlineBuildTable.mutex);
+    found = (edubtm_LookupOnlineBuild(root) != NIL) ? TRUE : FALSE;
+    pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+
+    return(found);
+
+}   /* edubtm_InOnlineBuild() */
+
+
+
+/*@================================
+ * edubtm_LogSideChange()
+ *================================*/
+/*
+ * Function: Four edubtm_LogSideChange(PageID*, Two, KeyValue*, ObjectID*, Boolean*)
+ *
+ * Description:
+ *  If the index is being built, append the insert or the delete to its side
+ *  log instead of applying it to the tree. The latch of the tree is not
+ *  needed; the mutex of the table orders the change with the replay.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  logged : TRUE if the change is appended to the side log
+ */
+Four edubtm_LogSideChange(
+    PageID                      *root,          /* IN root of the Btree */
+    Two                         op,             /* IN BTM_MSG_INSERT or BTM_MSG_DELETE */
+    KeyValue                    *kval,          /* IN key value */
+    ObjectID                    *oid,           /* IN ObjectID */
+    Boolean                     *logged)        /* OUT TRUE if the change is logged */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of the entry */
+    Four                        msgArea[(BTM_MESSAGE_FIXED + MAXKEYLEN)/sizeof(Four) + 1]; /* space for the change */
+    btm_Message                 *msg;           /* the change */
+
+
+    *logged = FALSE;
+
+    pthread_once(&btm_onlineBuildTableOnce, edubtm_InitOnlineBuildTable);
+
+    pthread_mutex_lock(&btm_onlineBuildTable.mutex);
+
+    i = edubtm_LookupOnlineBuild(root);
+    if (i == NIL) {
+        pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+        return(eNOERROR);
+    }
+
+    msg = (btm_Message*)msgArea;
+    msg->oid = *oid;
+    msg->op = op;
+    msg->klen = kval->len;
+    memcpy(&(msg->kval[0]), &(kval->val[0]), kval->len);
+
+    edubtm_EnterBfM();
+    e = edubtm_AppendSideLog(&btm_onlineBuildTable.entries[i], msg);
+    edubtm_LeaveBfM();
+
+    pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+    if (e < 0) ERR(e);
+
+    *logged = TRUE;
+
+    return(eNOERROR);
+
+}   /* edubtm_LogSideChange() */
+
+
+
+/*@================================
+ * edubtm_AppendSideLog()
+ *================================*/
+/*
+ * Function: Four edubtm_AppendSideLog(btm_OnlineBuild*, btm_Message*)
+ *
+ * Description:
+ *  Append a change record to the side log of an index being built. A new
+ *  page is linked at the end when the last page is full; the side log is
+ *  not bounded like the change buffer, since it cannot be merged until the
+ *  build ends. The caller should be in the mutex of the table and in the
+ *  buffer manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_AppendSideLog(
+    btm_OnlineBuild             *build,         /* IN entry of the index */
+    btm_Message                 *msg)           /* IN the change */
+{
+    Four                        e;              /* error number */
+    Two                         len;            /* length of the change record */
+    PageID                      curPid;         /* PageID of the page to which the change is appended */
+    PageID                      newPid;         /* PageID of a new page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreeChangeBuffer           *cpage;         /* pointer to the buffer holding a side log page */
+    btm_ChangeRecord            *rec;           /* the new change record */
+
+
+    len = BTM_CHANGERECORD_LEN(msg->klen);
+
+    if ((e = BfM_GetTrain((TrainID*)&build->metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    /* The first page of the side log */
+    if (mpage->hdr.slLast == NIL) {
+        if ((e = edubtm_NewChangeBufferPage(&build->catObjForFile, &build->metaPid, &newPid)) < 0)
+            ERRB1(e, &build->metaPid, PAGE_BUF);
+
+        mpage->hdr.slFirst = mpage->hdr.slLast = newPid.pageNo;
+    }
+
+    MAKE_PAGEID(curPid, build->metaPid.volNo, mpage->hdr.slLast);
+    if ((e = BfM_GetTrain((TrainID*)&curPid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+
+    if (cpage->hdr.used + len > PAGESIZE - BC_FIXED) {
+        if ((e = edubtm_NewChangeBufferPage(&build->catObjForFile, &curPid, &newPid)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+
+        cpage->hdr.nextPage = newPid.pageNo;
+        if ((e = BfM_SetDirty((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+        if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+
+        mpage->hdr.slLast = newPid.pageNo;
+
+        curPid = newPid;
+        if ((e = BfM_GetTrain((TrainID*)&curPid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+    }
+
+    rec = (btm_ChangeRecord*)&(cpage->data[cpage->hdr.used]);
+    rec->leaf = NIL;
+    memcpy((char*)&(rec->msg), (char*)msg, BTM_MESSAGE_FIXED + msg->klen);
+
+    cpage->hdr.used += len;
+    cpage->hdr.nRecords++;
+
+    if ((e = BfM_SetDirty((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &curPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&curPid, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+
+    if ((e = BfM_SetDirty((TrainID*)&build->metaPid, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)&build->metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_AppendSideLog() */
+
+
+
+/*@================================
+ * edubtm_ReplaySideLog()
+ *================================*/
+/*
+ * Function: Four edubtm_ReplaySideLog(PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Replay the side log of the index into the tree and end its build. The
+ *  caller holds the exclusive latch of the tree. The mutex of the table is
+ *  held until the index is unregistered, so a change made meanwhile waits
+ *  and then goes to the tree through the latch of the tree.
+ *
+ *  A duplicated key value ends the build as well, with the records after it
+ *  left in the side log; the index is not complete and should be dropped.
+ *  On another error the build goes on, and the replay may be tried again.
+ *
+ * Returns:
+ *  error code
+ *    eBADPARAMETER_BTM
+ *    eDUPLICATEDKEY_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_ReplaySideLog(
+    PageID                      *root,          /* IN root of the Btree */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Four                        i;              /* index of the entry */
+
+
+    pthread_once(&btm_onlineBuildTableOnce, edubtm_InitOnlineBuildTable);
+
+    pthread_mutex_lock(&btm_onlineBuildTable.mutex);
+
+    i = edubtm_LookupOnlineBuild(root);
+    if (i == NIL) {
+        pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+        ERR(eBADPARAMETER_BTM);
+    }
+
+    edubtm_EnterBfM();
+    e = edubtm_ApplySideLog(&btm_onlineBuildTable.entries[i], kdesc, dlPool, dlHead);
+    edubtm_LeaveBfM();
+
+    /* On an error but a duplicated key value the build goes on, and the records not replayed are kept */
+    if (e >= 0 || e == eDUPLICATEDKEY_BTM) btm_onlineBuildTable.entries[i].inUse = FALSE;
+
+    pthread_mutex_unlock(&btm_onlineBuildTable.mutex);
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ReplaySideLog() */
+
+
+
+/*@================================
+ * edubtm_ApplySideLog()
+ *================================*/
+/*
+ * Function: Four edubtm_ApplySideLog(btm_OnlineBuild*, KeyDesc*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  Apply the records of the side log to the tree in the order they were
+ *  appended, and put the pages of the side log into the dealloc list. Each
+ *  record is removed from its page once it is applied, and each page is
+ *  unlinked from the meta page once it is empty, so a replay stopped by an
+ *  error goes on from the first record not applied.
+ *
+ *  An insert of a key value already in the tree is rejected unless the
+ *  entry has the same ObjectID; that change was made while the snapshot was
+ *  read, and is in the tree already. A delete removes the entry only if it
+ *  has the ObjectID.
+ *
+ * Returns:
+ *  error code
+ *    eDUPLICATEDKEY_BTM
+ *    some errors caused by function calls
+ */
+Four edubtm_ApplySideLog(
+    btm_OnlineBuild             *build,         /* IN entry of the index */
+    KeyDesc                     *kdesc,         /* IN a key descriptor */
+    Pool                        *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem             *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four                        e;              /* error number */
+    Two                         len;            /* length of a change record */
+    Two                         n;              /* # of delivered messages */
+    Boolean                     f;              /* TRUE if the root is not half full */
+    Boolean                     h;              /* TRUE if the root is split */
+    Boolean                     found;          /* TRUE if the key value is in the tree */
+    ObjectID                    curOid;         /* ObjectID of the key value in the tree */
+    InternalItem                item;           /* Internal item for the new root */
+    PageID                      pid;            /* PageID of a side log page */
+    BtreeMeta                   *mpage;         /* pointer to the buffer holding the meta page */
+    BtreeChangeBuffer           *cpage;         /* pointer to the buffer holding a side log page */
+    btm_ChangeRecord            *rec;           /* a change record */
+    DeallocListElem             *dlElem;        /* an element of dealloc list */
+
+
+    if ((e = BfM_GetTrain((TrainID*)&build->metaPid, (char**)&mpage, PAGE_BUF)) < 0) ERR(e);
+
+    while (mpage->hdr.slFirst != NIL) {
+        MAKE_PAGEID(pid, build->metaPid.volNo, mpage->hdr.slFirst);
+        if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&cpage, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+
+        while (cpage->hdr.used > 0) {
+            rec = (btm_ChangeRecord*)&(cpage->data[0]);
+            len = BTM_CHANGERECORD_LEN(rec->msg.klen);
+
+            /* The key value of an insert may be in the tree already */
+            found = FALSE;
+            if (rec->msg.op == BTM_MSG_INSERT) {
+                if ((e = edubtm_SearchPending(&build->root, kdesc, (KeyValue*)&(rec->msg.klen), &found, &curOid)) < 0)
+                    ERRB2(e, &pid, PAGE_BUF, &build->metaPid, PAGE_BUF);
+
+                if (found && btm_ObjectIdComp(&(rec->msg.oid), &curOid) != EQUAL)
+                    ERRB2(eDUPLICATEDKEY_BTM, &pid, PAGE_BUF, &build->metaPid, PAGE_BUF);
+            }
+
+            /* A split of the root stops the delivery */
+            while (!found) {
+                if ((e = edubtm_DeliverMessages(&build->catObjForFile, &build->root, kdesc, (char*)&(rec->msg),
+                                                1, FALSE, &n, &f, &h, &item, NULL, NULL)) < 0)
+                    ERRB2(e, &pid, PAGE_BUF, &build->metaPid, PAGE_BUF);
+
+                if (h) {
+                    if ((e = edubtm_root_insert(&build->catObjForFile, &build->root, &item)) < 0)
+                        ERRB2(e, &pid, PAGE_BUF, &build->metaPid, PAGE_BUF);
+                }
+                if (n == 1) break;
+            }
+
+            memmove(&(cpage->data[0]), &(cpage->data[len]), cpage->hdr.used - len);
+            cpage->hdr.used -= len;
+            cpage->hdr.nRecords--;
+
+            if ((e = BfM_SetDirty((TrainID*)&pid, PAGE_BUF)) < 0) ERRB2(e, &pid, PAGE_BUF, &build->metaPid, PAGE_BUF);
+        }
+
+        mpage->hdr.slFirst = cpage->hdr.nextPage;
+        if (mpage->hdr.slFirst == NIL) mpage->hdr.slLast = NIL;
+
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+
+        /* Insert the emptied page into the dealloc list */
+        if ((e = Util_getElementFromPool(dlPool, &dlElem)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+        dlElem->type = DL_PAGE;
+        dlElem->elem.pid = pid;
+        dlElem->next = dlHead->next;
+        dlHead->next = dlElem;
+
+        if ((e = BfM_SetDirty((TrainID*)&build->metaPid, PAGE_BUF)) < 0) ERRB1(e, &build->metaPid, PAGE_BUF);
+    }
+
+    if ((e = BfM_FreeTrain((TrainID*)&build->metaPid, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ApplySideLog() */
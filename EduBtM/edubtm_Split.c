@@ -117,25 +117,87 @@ Four edubtm_SplitInternal(
     btm_InternalEntry           *fEntry;                /* internal entry in the given page, fpage */
     btm_InternalEntry           *nEntry;                /* internal entry in the new page, npage*/
     Boolean                     isTmp;
+    BtreeInternal               tpage;                  /* a temporary page for the given page */
+    Four                        half;                   /* half of the area for the entries */
 
     /**/
 
     /* Allocate a new page to be used as a B+ index page */
-    if((e = btm_AllocPage(catObjForFile, &(fpage->hdr.pid), &newPid))<0) ERR(e);
-    /* Initiate the page as a leaf page */
-    if((e = btm_InitInternal(&newPid, FALSE, FALSE))<0) ERR(e);
-    /* Fix the page that has been newly allocated on the disk to the buffer */    
-    if((e = BfM_GetNewTrain(&newPid, (char**)&npage, PAGE_BUF))<0) ERR(e);
+    if((e = edubtm_AllocIndexPage(catObjForFile, &(fpage->hdr.pid), &newPid))<0) ERR(e);
+    /* Initiate the page as an internal page */
+    if((e = edubtm_InitInternal(&newPid, FALSE, FALSE))<0) ERR(e);
+    /* Fix the new page to the buffer */
+    if((e = BfM_GetTrain((TrainID*)&newPid, (char**)&npage, PAGE_BUF))<0) ERR(e);
 
-    /* Sort index entries + 1 new entry. Insert the entries to the fpage until page is full 50% */
-    /* Copy fpage data[] to tpage data[] until tpage is full 50% */
+    /* The new page has the children at the same level */
+    npage->hdr.flags |= (fpage->hdr.flags & BTM_LEAFPARENT);
 
+    /* The new page of a buffered page has its own message buffer */
+    if(fpage->hdr.flags & BTM_MSGBUFFER)
+        edubtm_InitMsgBuffer(npage, &(BTM_MSGBUF_HDR(fpage)->catObjForFile));
 
+    /* Copy fpage to tpage; the entries are merged with 'item' in the order of the slots */
+    memcpy((char*)&tpage, (char*)fpage, PAGESIZE);
 
+    maxLoop = fpage->hdr.nSlots + 1;
+    half = (PAGESIZE - BI_FIXED - BI_DATA_START(fpage)) / 2;
 
+    /* Fill fpage with the first entries until a half of the area is used */
+    fEntryOffset = BI_DATA_START(fpage);
+    sum = 0;
+    for(i = 0, j = 0; j < maxLoop && sum < half; j++){
+        if(j == high+1)
+            fEntry = (btm_InternalEntry*)item;
+        else
+            fEntry = (btm_InternalEntry*)&(tpage.data[tpage.slot[-(i++)]]);
 
+        entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + fEntry->klen);
+        memcpy(&(fpage->data[fEntryOffset]), (char*)fEntry, entryLen);
+        fpage->slot[-j] = fEntryOffset;
 
-    
+        fEntryOffset += entryLen;
+        sum += entryLen + sizeof(Two);
+    }
+    fpage->hdr.nSlots = j;
+
+    /* The next entry goes up to the parent; its child becomes 'p0' of npage */
+    if(j == high+1)
+        fEntry = (btm_InternalEntry*)item;
+    else
+        fEntry = (btm_InternalEntry*)&(tpage.data[tpage.slot[-(i++)]]);
+    j++;
+
+    npage->hdr.p0 = fEntry->spid;
+    ritem->spid = newPid.pageNo;
+    ritem->klen = fEntry->klen;
+    memcpy(ritem->kval, fEntry->kval, fEntry->klen);
+
+    /* The remaining entries go to npage */
+    nEntryOffset = BI_DATA_START(npage);
+    for(k = 0; j < maxLoop; j++, k++){
+        if(j == high+1)
+            fEntry = (btm_InternalEntry*)item;
+        else
+            fEntry = (btm_InternalEntry*)&(tpage.data[tpage.slot[-(i++)]]);
+
+        entryLen = sizeof(ShortPageID) + ALIGNED_LENGTH(sizeof(Two) + fEntry->klen);
+        nEntry = (btm_InternalEntry*)&(npage->data[nEntryOffset]);
+        memcpy((char*)nEntry, (char*)fEntry, entryLen);
+        npage->slot[-k] = nEntryOffset;
+
+        nEntryOffset += entryLen;
+    }
+    npage->hdr.nSlots = k;
+    npage->hdr.free = nEntryOffset;
+
+    fpage->hdr.free = fEntryOffset;
+    fpage->hdr.unused = 0;
+
+    /* The given page is no more a root */
+    fpage->hdr.type &= ~ROOT;
+
+    if((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);
+    if((e = BfM_FreeTrain((TrainID*)&newPid, PAGE_BUF))<0) ERR(e);
 
     /**/
     return(eNOERROR);
@@ -203,100 +265,61 @@ Four edubtm_SplitLeaf(
     Boolean                     isTmp;
     /**/
 
-    printf("DBG : Welcome to Splitleaf(root : %d, high : %d, item : \n", *root, high);
-    for (int i = 0; i < item->klen; i++){
-        printf("%c", *(char *)(item->kval + i));
-    }
-    printf("\n");
+    /* Allocate the new right sibling from the leaf run of the file */
+    if((e = edubtm_AllocLeafPage(catObjForFile, root, &newPid))<0) ERR(e);
 
-    /* Allocate a new page to be used as a B+ index page */
-    if((e = btm_AllocPage(catObjForFile, root, &newPid))<0) ERR(e);
-    
     /* Initiate the page as a leaf page */
-    if((e = btm_InitLeaf(&newPid, FALSE, FALSE))<0) ERR(e);
+    if((e = edubtm_InitLeaf(&newPid, FALSE, FALSE))<0) ERR(e);
+
+    /* Fix the new page to the buffer */
+    if((e = BfM_GetTrain((TrainID*)&newPid, (char**)&npage, PAGE_BUF))<0) ERR(e);
 
-    /* Fix the page that has been newly allocated on the disk to the buffer */    
-    if((e = BfM_GetNewTrain(&newPid, (char**)&npage, PAGE_BUF))<0) ERR(e);
+    /* Copy fpage to tpage; the entries are merged with 'item' in the order of the slots */
+    memcpy((char*)&tpage, (char*)fpage, PAGESIZE);
 
-    /* Fix the root page to the buffer */    
-    if ((e = BfM_GetTrain((TrainID*)root, (char**)&fpage, PAGE_BUF)) < 0) ERR(e);
+    maxLoop = fpage->hdr.nSlots + 1;
+    itemEntryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(item->klen) + OBJECTID_SIZE;
 
-    /* Sort index entries + 1 new entry. Insert the entries to the fpage until page is full 50% */
-    /* Copy fpage data[] to tpage data[] until tpage is full 50% */
-    high++;
-    i = 0;
-    j = 0;
-    k = 0;
+    /* The first entries stay in fpage until a half of the area is used */
     fEntryOffset = 0;
     nEntryOffset = 0;
-    maxLoop = fpage->hdr.nSlots+1;
-    flag = FALSE;
     sum = 0;
-    /* Copy apage data[] to tpage data[] */
-    for(int l = 0; l < fpage->hdr.free; l++){
-        tpage.data[l] = fpage->data[l];
-    }
-
-    fpage->hdr.nSlots++;
-    for(j = maxLoop-1; j > high; j--){                
-        fpage->slot[-j] = fpage->slot[-(j-1)];        
-    }
-    fpage->slot[-high] = -1; 
-
-    printf("DBG : loop A\n");
-    for(j = 0; j < maxLoop; j++){
-
-        if (sum > BL_HALF) break;
-
-        if (j == high)
-            itemEntry = (btm_LeafEntry *)item;
-        else
-            itemEntry = (btm_LeafEntry *)&(tpage.data[fpage->slot[-i]]);    
-
-        alignedKlen = ALIGNED_LENGTH(itemEntry->klen);
-        entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
-
-        fEntry = (btm_LeafEntry *)&(fpage->data[fEntryOffset]);            
-        fEntry->nObjects = itemEntry->nObjects;
-        fEntry->klen = itemEntry->klen;
-        for (int l = 0; l < alignedKlen + OBJECTID_SIZE; l++)
-            *((char *)(fEntry->kval + l ) = *((char *)(itemEntry->kval + l ));             
-
-        fpage->slot[-i] = fEntryOffset;
-        fEntryOffset = fEntryOffset + entryLen;
-        sum = sum + entryLen + sizeof(Two);
-        i++;
-    }
-    printf("DBG : high = %d, j = %d, i = %d, nO = %d, klen = %d, kval = \n", high, j, i, fEntry->nObjects, fEntry->klen);
-    for (int i = 0; i < fEntry->klen; i++){
-        printf("%c", *(char *)(fEntry->kval + i));
-    }
-
-    printf("DBG : loop B\n");
-    for(j; j < maxLoop; j++){
-
-        npage->slot[k] = fpage->slot[j];
-
-        if (j == high)
-            itemEntry = (btm_LeafEntry *)item;
-        else
-            itemEntry = (btm_LeafEntry *)&(tpage.data[npage->slot[-k]]);    
-        
-        nEntry = (btm_LeafEntry *)&(npage->data[fEntryOffset]);
-        alignedKlen = ALIGNED_LENGTH(itemEntry->klen);
-        nEntry->nObjects = itemEntry->nObjects;
-        *((KeyValue *)&(nEntry->klen)) = *((KeyValue *)&(itemEntry->klen));        
-        for (int l = 0; l < OBJECTID_SIZE; l++)
-            *((char *)(nEntry->kval) + alignedKlen + l ) = *((char *)(itemEntry->kval) + alignedKlen + l );             
-    
-        entryLen = BTM_LEAFENTRY_FIXED + alignedKlen + OBJECTID_SIZE;
-        npage->slot[-k] = nEntryOffset;
-        nEntryOffset = nEntryOffset + entryLen;
-        k++;
+    flag = FALSE;
+    for(i = 0, j = 0, k = 0; j < maxLoop; j++){
+        if(j == high+1){
+            entryLen = itemEntryLen;
+            itemEntry = NULL;
+        }
+        else{
+            itemEntry = (btm_LeafEntry*)&(tpage.data[tpage.slot[-(i++)]]);
+            entryLen = BTM_LEAFENTRY_FIXED + ALIGNED_LENGTH(itemEntry->klen) + itemEntry->nObjects*OBJECTID_SIZE;
+        }
+
+        if(!flag && sum < BL_HALF){
+            fEntry = (btm_LeafEntry*)&(fpage->data[fEntryOffset]);
+            fpage->slot[-(j-k)] = fEntryOffset;
+            fEntryOffset += entryLen;
+            sum += entryLen + sizeof(Two);
+        }
+        else{
+            flag = TRUE;
+            fEntry = (btm_LeafEntry*)&(npage->data[nEntryOffset]);
+            npage->slot[-(k++)] = nEntryOffset;
+            nEntryOffset += entryLen;
+        }
+
+        if(itemEntry != NULL)
+            memcpy((char*)fEntry, (char*)itemEntry, entryLen);
+        else{
+            fEntry->nObjects = item->nObjects;
+            fEntry->klen = item->klen;
+            memcpy(fEntry->kval, item->kval, item->klen);
+            memcpy(&(fEntry->kval[ALIGNED_LENGTH(item->klen)]), (char*)&(item->oid), OBJECTID_SIZE);
+        }
     }
 
-    /* Update the headers of fpage, npage */
-    fpage->hdr.nSlots = i;
+    /* Update the headers of fpage and npage */
+    fpage->hdr.nSlots = maxLoop - k;
     fpage->hdr.free = fEntryOffset;
     fpage->hdr.unused = 0;
 
@@ -304,25 +327,29 @@ Four edubtm_SplitLeaf(
     npage->hdr.free = nEntryOffset;
     npage->hdr.unused = 0;
 
-    /* Insert the npage to the doubly-linked list of leaf pages */
-    npage->hdr.nextPage = fpage->hdr.nextPage;
+    /* Insert npage into the doubly linked list of the leaves */
     npage->hdr.prevPage = root->pageNo;
+    npage->hdr.nextPage = fpage->hdr.nextPage;
     fpage->hdr.nextPage = newPid.pageNo;
-        
-    /* Create internal index entry. (1) Spid = pid of npage (2) discrimator key = npage's 1st index entry key */
-    nEntryOffset = npage->slot[0];
-    itemEntry = (btm_LeafEntry *)&(npage->data[nEntryOffset]);
+
+    if(npage->hdr.nextPage != NIL){
+        MAKE_PAGEID(nextPid, root->volNo, npage->hdr.nextPage);
+        if((e = BfM_GetTrain((TrainID*)&nextPid, (char**)&mpage, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);
+        mpage->hdr.prevPage = newPid.pageNo;
+        if((e = BfM_SetDirty((TrainID*)&nextPid, PAGE_BUF))<0) ERRB2(e, &nextPid, PAGE_BUF, &newPid, PAGE_BUF);
+        if((e = BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);
+    }
+
+    /* The first key value of npage is the discriminator key in the parent */
+    nEntry = (btm_LeafEntry*)&(npage->data[npage->slot[0]]);
     ritem->spid = newPid.pageNo;
-    ritem->klen = itemEntry->klen;
-    for (i = 0; i < itemEntry->klen; i++){
-        *((char *)(ritem->kval) + i) = *((char *)(itemEntry->kval) + i);
-    }    
-
-    /* Set the DIRTY bit */
-    if((e = BfM_SetDirty((TrainID*)root, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
-    if((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);    
-    /* Unfix the pages from the buffer */ 
-    if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
+    ritem->klen = nEntry->klen;
+    memcpy(ritem->kval, nEntry->kval, nEntry->klen);
+
+    /* Half of the entries have left the page */
+    edubtm_BumpVersion(root);
+
+    if((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);
     if((e = BfM_FreeTrain((TrainID*)&newPid, PAGE_BUF))<0) ERR(e);
 
     /**/
@@ -0,0 +1,681 @@
+/******************************************************************************/
+/*                                                                            */
+/*    Copyright (c) 2013-2015, Kyu-Young Whang, KAIST                         */
+/*    All rights reserved.                                                    */
+/*                                                                            */
+/*    Redistribution and use in source and binary forms, with or without      */
+/*    modification, are permitted provided that the following conditions      */
+/*    are met:                                                                */
+/*                                                                            */
+/*    1. Redistributions of source code must retain the above copyright       */
+/*       notice, this list of conditions and the following disclaimer.        */
+/*                                                                            */
+/*    2. Redistributions in binary form must reproduce the above copyright    */
+/*       notice, this list of conditions and the following disclaimer in      */
+/*       the documentation and/or other materials provided with the           */
+/*       distribution.                                                        */
+/*                                                                            */
+/*    3. Neither the name of the copyright holder nor the names of its        */
+/*       contributors may be used to endorse or promote products derived      */
+/*       from this software without specific prior written permission.        */
+/*                                                                            */
+/*    THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS     */
+/*    "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT       */
+/*    LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS       */
+/*    FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE          */
+/*    COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,    */
+/*    INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING,    */
+/*    BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;        */
+/*    LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER        */
+/*    CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT      */
+/*    LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN       */
+/*    ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE         */
+/*    POSSIBILITY OF SUCH DAMAGE.                                             */
+/*                                                                            */
+/******************************************************************************/
+/******************************************************************************/
+/*                                                                            */
+/*    ODYSSEUS/EduCOSMOS Educational Purpose Object Storage System            */
+/*    (Version 1.0)                                                           */
+/*                                                                            */
+/*    Developed by Professor Kyu-Young Whang et al.                           */
+/*                                                                            */
+/*    Advanced Information Technology Research Center (AITrc)                 */
+/*    Korea Advanced Institute of Science and Technology (KAIST)              */
+/*                                                                            */
+/*    e-mail: odysseus.educosmos@gmail.com                                    */
+/*                                                                            */
+/******************************************************************************/
+/*
+ * Module: edubtm_UpperCache.c
+ *
+ * Description :
+ *  Cache of the upper levels of the indexes. Every descent used to fix the
+ *  root and the internal pages below it through the buffer manager, which
+ *  looks each of them up in its hash table; and a long scan could push them
+ *  out of the buffer. Here the internal pages of the top BTM_CACHEDLEVELS
+ *  levels stay fixed while the index is in use, and a descent finds them
+ *  by a binary search in the cache of the index. Between two cached pages,
+ *  a descent follows the swizzled child reference of the parent instead.
+ *
+ *  A page in the cache is never given back to the buffer manager while a
+ *  descent may read it. The operations freeing pages of an index hold the
+ *  exclusive tree latch, so no descent is in the index then, and they drop
+ *  the cache of the index before the pages are deallocated.
+ *
+ * Exports:
+ *  Four edubtm_EnterUpperCache(PageID*, btm_UpperCache**)
+ *  void edubtm_LeaveUpperCache(btm_UpperCache*)
+ *  Four edubtm_PinUpperPage(btm_UpperCache*, PageID*, BtreePage**, btm_CachedPage**)
+ *  Four edubtm_PinUpperChild(btm_UpperCache*, btm_CachedPage*, Two, PageID*, BtreePage**, btm_CachedPage**)
+ *  Four edubtm_UnpinUpperPage(PageID*, Boolean)
+ *  void edubtm_StaleUpperCache(PageID*)
+ *  Four edubtm_ReleaseUpperCache(PageID*)
+ */
+
+
+#include "EduBtM_common.h"
+#include "BfM.h"
+#include "EduBtM_Internal.h"
+
+
+/*@ Global Variables */
+btm_UpperCache btm_upperCaches[BTM_MAXCACHEDINDEXES];  /* the caches, in the buffer manager mutex */
+
+
+/*@ Internal Function Prototypes */
+btm_UpperCache *edubtm_LookupUpperCache(PageID*, Boolean);
+Four edubtm_BuildUpperCache(btm_UpperCache*);
+Four edubtm_EmptyUpperCache(btm_UpperCache*);
+Two edubtm_FindCachedPage(btm_UpperCache*, ShortPageID);
+void edubtm_SwizzleChildren(btm_UpperCache*);
+
+
+
+/*@================================
+ * edubtm_LookupUpperCache()
+ *================================*/
+/*
+ * Function: btm_UpperCache *edubtm_LookupUpperCache(PageID*, Boolean)
+ *
+ * Description:
+ *  Find the cache of the index. A new stale cache is made if 'create' is
+ *  TRUE and the index has none. The caller should be in the buffer manager
+ *  mutex.
+ *
+ * Returns:
+ *  the cache, or NULL if there is none (and the table is full)
+ */
+btm_UpperCache *edubtm_LookupUpperCache(
+    PageID                      *root,          /* IN root of the index */
+    Boolean                     create)         /* IN TRUE to make a cache if none */
+{
+    Two                         i;              /* index of the table */
+    btm_UpperCache              *freeCache;     /* an unused entry */
+
+
+    freeCache = NULL;
+    for (i = 0; i < BTM_MAXCACHEDINDEXES; i++) {
+        if (!btm_upperCaches[i].inUse) {
+            if (freeCache == NULL) freeCache = &btm_upperCaches[i];
+            continue;
+        }
+        if (btm_upperCaches[i].root.volNo == root->volNo && btm_upperCaches[i].root.pageNo == root->pageNo)
+            return(&btm_upperCaches[i]);
+    }
+
+    if (!create || freeCache == NULL) return(NULL);
+
+    freeCache->inUse = TRUE;
+    freeCache->stale = TRUE;
+    freeCache->root = *root;
+    freeCache->nUsers = 0;
+    freeCache->nPages = 0;
+    freeCache->nRefs = 0;
+
+    return(freeCache);
+
+}   /* edubtm_LookupUpperCache() */
+
+
+
+/*@================================
+ * edubtm_EnterUpperCache()
+ *================================*/
+/*
+ * Function: Four edubtm_EnterUpperCache(PageID*, btm_UpperCache**)
+ *
+ * Description:
+ *  Start using the cache of the index for a descent. A stale cache is read
+ *  again first if no other descent uses it; otherwise the descent uses the
+ *  pages cached before, which are still pages of the index. 'cache' is NULL
+ *  if the index cannot have a cache; the descent goes through the buffer
+ *  manager then.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  cache : the cache, to be given back by edubtm_LeaveUpperCache(...)
+ */
+Four edubtm_EnterUpperCache(
+    PageID                      *root,          /* IN root of the index */
+    btm_UpperCache              **cache)        /* OUT the cache, NULL if none */
+{
+    Four                        e;              /* error number */
+
+
+    edubtm_EnterBfM();
+
+    *cache = edubtm_LookupUpperCache(root, TRUE);
+
+    if (*cache != NULL && (*cache)->stale && (*cache)->nUsers == 0) {
+        if ((e = edubtm_BuildUpperCache(*cache)) < 0) {
+            (*cache)->inUse = FALSE;
+            *cache = NULL;
+            edubtm_LeaveBfM();
+            ERR(e);
+        }
+    }
+
+    if (*cache != NULL) (*cache)->nUsers++;
+
+    edubtm_LeaveBfM();
+
+    return(eNOERROR);
+
+}   /* edubtm_EnterUpperCache() */
+
+
+
+/*@================================
+ * edubtm_LeaveUpperCache()
+ *================================*/
+/*
+ * Function: void edubtm_LeaveUpperCache(btm_UpperCache*)
+ *
+ * Description:
+ *  Stop using the cache entered by edubtm_EnterUpperCache(...). The pages
+ *  taken from the cache should not be read any more.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_LeaveUpperCache(
+    btm_UpperCache              *cache)         /* IN the cache, may be NULL */
+{
+    if (cache == NULL) return;
+
+    edubtm_EnterBfM();
+    cache->nUsers--;
+    edubtm_LeaveBfM();
+
+}   /* edubtm_LeaveUpperCache() */
+
+
+
+/*@================================
+ * edubtm_PinUpperPage()
+ *================================*/
+/*
+ * Function: Four edubtm_PinUpperPage(btm_UpperCache*, PageID*, BtreePage**, btm_CachedPage**)
+ *
+ * Description:
+ *  Get the page for an optimistic read: from the cache if it is there,
+ *  without the buffer manager mutex, or by edubtm_PinPage(...) otherwise.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  entry : the page in the cache, NULL if the page is not cached; whether
+ *          it is NULL is to be passed to edubtm_UnpinUpperPage(...)
+ */
+Four edubtm_PinUpperPage(
+    btm_UpperCache              *cache,         /* IN the cache entered, may be NULL */
+    PageID                      *pid,           /* IN page to be pinned */
+    BtreePage                   **apage,        /* OUT pointer to the buffer holding the page */
+    btm_CachedPage              **entry)        /* OUT the page in the cache, NULL if not cached */
+{
+    Four                        e;              /* error number */
+    Two                         i;              /* index of the page in the cache */
+
+
+    *entry = NULL;
+
+    if (cache != NULL && pid->volNo == cache->root.volNo) {
+        if ((i = edubtm_FindCachedPage(cache, pid->pageNo)) >= 0) {
+            *entry = &(cache->pages[i]);
+            *apage = (*entry)->page;
+            return(eNOERROR);
+        }
+    }
+
+    if ((e = edubtm_PinPage(pid, apage)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_PinUpperPage() */
+
+
+
+/*@================================
+ * edubtm_PinUpperChild()
+ *================================*/
+/*
+ * Function: Four edubtm_PinUpperChild(btm_UpperCache*, btm_CachedPage*, Two, PageID*,
+ *                                     BtreePage**, btm_CachedPage**)
+ *
+ * Description:
+ *  Get the child in the given slot of the page, or the page reached by a
+ *  right link if 'slot' is BTM_NOCHILDREF, as edubtm_PinUpperPage(...)
+ *  does. If the page is cached and the swizzled reference of the slot
+ *  still names the child read from the page, the child is taken from
+ *  the reference without any search.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ *
+ * Side effects:
+ *  nEntry : the child in the cache, NULL if it is not cached
+ */
+Four edubtm_PinUpperChild(
+    btm_UpperCache              *cache,         /* IN the cache entered, may be NULL */
+    btm_CachedPage              *entry,         /* IN the page in the cache, NULL if not cached */
+    Two                         slot,           /* IN slot of the child, -1 for 'p0' */
+    PageID                      *next,          /* IN the child read from the page */
+    BtreePage                   **npage,        /* OUT pointer to the buffer holding the child */
+    btm_CachedPage              **nEntry)       /* OUT the child in the cache, NULL if not cached */
+{
+    Four                        e;              /* error number */
+    btm_SwizzledRef             *ref;           /* the reference of the slot */
+
+
+    if (entry != NULL && slot != BTM_NOCHILDREF && slot + 1 < entry->nRefs) {
+        ref = &(cache->refs[entry->firstRef + slot + 1]);
+
+        if (ref->pageNo == next->pageNo && ref->cacheIdx >= 0) {
+            *nEntry = &(cache->pages[ref->cacheIdx]);
+            *npage = (*nEntry)->page;
+            return(eNOERROR);
+        }
+    }
+
+    if ((e = edubtm_PinUpperPage(cache, next, npage, nEntry)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_PinUpperChild() */
+
+
+
+/*@================================
+ * edubtm_UnpinUpperPage()
+ *================================*/
+/*
+ * Function: Four edubtm_UnpinUpperPage(PageID*, Boolean)
+ *
+ * Description:
+ *  Release the page got by edubtm_PinUpperPage(...). A cached page stays
+ *  fixed.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_UnpinUpperPage(
+    PageID                      *pid,           /* IN the page */
+    Boolean                     cached)         /* IN TRUE if the page came from the cache */
+{
+    Four                        e;              /* error number */
+
+
+    if (cached) return(eNOERROR);
+
+    if ((e = edubtm_UnpinPage(pid)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_UnpinUpperPage() */
+
+
+
+/*@================================
+ * edubtm_StaleUpperCache()
+ *================================*/
+/*
+ * Function: void edubtm_StaleUpperCache(PageID*)
+ *
+ * Description:
+ *  Mark stale the cache holding the page, or the cache of the index whose
+ *  root it is. It is called when the page is split, since its new page
+ *  belongs to the cached levels too.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_StaleUpperCache(
+    PageID                      *pid)           /* IN the split page */
+{
+    Two                         i;              /* index of the table */
+    Two                         j;              /* index of the cached pages */
+    btm_UpperCache              *cache;         /* a cache */
+
+
+    edubtm_EnterBfM();
+
+    for (i = 0; i < BTM_MAXCACHEDINDEXES; i++) {
+        cache = &btm_upperCaches[i];
+        if (!cache->inUse || cache->stale || cache->root.volNo != pid->volNo) continue;
+
+        if (cache->root.pageNo == pid->pageNo) {
+            cache->stale = TRUE;
+            continue;
+        }
+
+        for (j = 0; j < cache->nPages; j++)
+            if (cache->pages[j].pageNo == pid->pageNo) {
+                cache->stale = TRUE;
+                break;
+            }
+    }
+
+    edubtm_LeaveBfM();
+
+}   /* edubtm_StaleUpperCache() */
+
+
+
+/*@================================
+ * edubtm_ReleaseUpperCache()
+ *================================*/
+/*
+ * Function: Four edubtm_ReleaseUpperCache(PageID*)
+ *
+ * Description:
+ *  Give the cached pages of the index back to the buffer manager and drop
+ *  its cache. It is called before pages of the index are deallocated, and
+ *  when the index is not used any more. The caller should hold the
+ *  exclusive tree latch, so that no descent uses the cache.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_ReleaseUpperCache(
+    PageID                      *root)          /* IN root of the index */
+{
+    Four                        e;              /* error number */
+    btm_UpperCache              *cache;         /* the cache of the index */
+
+
+    edubtm_EnterBfM();
+
+    cache = edubtm_LookupUpperCache(root, FALSE);
+
+    /* A descent still in the cache keeps it; it is read again afterwards */
+    if (cache == NULL || cache->nUsers > 0) {
+        if (cache != NULL) cache->stale = TRUE;
+        edubtm_LeaveBfM();
+        return(eNOERROR);
+    }
+
+    e = edubtm_EmptyUpperCache(cache);
+    cache->inUse = FALSE;
+
+    edubtm_LeaveBfM();
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_ReleaseUpperCache() */
+
+
+
+/*@================================
+ * edubtm_BuildUpperCache()
+ *================================*/
+/*
+ * Function: Four edubtm_BuildUpperCache(btm_UpperCache*)
+ *
+ * Description:
+ *  Read the cache again: the pages cached before are released, and the
+ *  internal pages of the top BTM_CACHEDLEVELS levels are fixed level by
+ *  level, as many as fit. The leaves are never cached. The caller should
+ *  be in the buffer manager mutex, and no descent may use the cache.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_BuildUpperCache(
+    btm_UpperCache              *cache)         /* INOUT the cache */
+{
+    Four                        e;              /* error number */
+    Two                         level;          /* level being cached, 0 for the root */
+    Two                         first;          /* first page of the level above */
+    Two                         end;            /* the page after the last one of the level above */
+    Two                         i;              /* index of the cached pages */
+    Two                         j;              /* child No. */
+    Two                         k;              /* index for sorting */
+    Boolean                     full;           /* TRUE if no more page fits */
+    PageID                      pid;            /* a page to be cached */
+    BtreePage                   *apage;         /* pointer to the buffer holding the page */
+    BtreeInternal               *ppage;         /* a cached page of the level above */
+    btm_CachedPage              tPage;          /* temporary entry for sorting */
+
+
+    if ((e = edubtm_EmptyUpperCache(cache)) < 0) ERR(e);
+
+    /* The root is cached only while it is an internal page */
+    pid = cache->root;
+    if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) ERR(e);
+    if (!(apage->any.hdr.type & INTERNAL)) {
+        if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) ERR(e);
+        cache->stale = FALSE;
+        return(eNOERROR);
+    }
+    cache->pages[0].pageNo = pid.pageNo;
+    cache->pages[0].page = apage;
+    cache->pages[0].nRefs = 0;
+    cache->nPages = 1;
+
+    /* The children of the pages of a level make the next level */
+    full = FALSE;
+    first = 0;
+    for (level = 1; level < BTM_CACHEDLEVELS && !full; level++) {
+        end = cache->nPages;
+
+        for (i = first; i < end && !full; i++) {
+            ppage = &(cache->pages[i].page->bi);
+            if (ppage->hdr.flags & BTM_LEAFPARENT) continue;
+
+            for (j = -1; j < ppage->hdr.nSlots; j++) {
+                if (cache->nPages == BTM_MAXCACHEDPAGES) {
+                    full = TRUE;
+                    break;
+                }
+
+                if (j == -1) MAKE_PAGEID(pid, cache->root.volNo, ppage->hdr.p0);
+                else MAKE_PAGEID(pid, cache->root.volNo, ((btm_InternalEntry*)&(ppage->data[ppage->slot[-j]]))->spid);
+
+                if ((e = BfM_GetTrain((TrainID*)&pid, (char**)&apage, PAGE_BUF)) < 0) {
+                    (Four) edubtm_EmptyUpperCache(cache);
+                    ERR(e);
+                }
+                if (!(apage->any.hdr.type & INTERNAL)) {
+                    if ((e = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) {
+                        (Four) edubtm_EmptyUpperCache(cache);
+                        ERR(e);
+                    }
+                    break;
+                }
+
+                cache->pages[cache->nPages].pageNo = pid.pageNo;
+                cache->pages[cache->nPages].page = apage;
+                cache->pages[cache->nPages].nRefs = 0;
+                cache->nPages++;
+            }
+        }
+
+        first = end;
+    }
+
+    /* The descents search the pages by the page number */
+    for (i = 1; i < cache->nPages; i++) {
+        tPage = cache->pages[i];
+        for (k = i; k > 0 && cache->pages[k-1].pageNo > tPage.pageNo; k--) cache->pages[k] = cache->pages[k-1];
+        cache->pages[k] = tPage;
+    }
+
+    /* Resolve the references between the cached pages */
+    edubtm_SwizzleChildren(cache);
+
+    cache->stale = FALSE;
+
+    return(eNOERROR);
+
+}   /* edubtm_BuildUpperCache() */
+
+
+
+/*@================================
+ * edubtm_EmptyUpperCache()
+ *================================*/
+/*
+ * Function: Four edubtm_EmptyUpperCache(btm_UpperCache*)
+ *
+ * Description:
+ *  Unfix all the pages of the cache. The caller should be in the buffer
+ *  manager mutex.
+ *
+ * Returns:
+ *  error code
+ *    some errors caused by function calls
+ */
+Four edubtm_EmptyUpperCache(
+    btm_UpperCache              *cache)         /* INOUT the cache */
+{
+    Four                        e;              /* error number */
+    Four                        e2;             /* error number of an unfix */
+    Two                         i;              /* index of the cached pages */
+    PageID                      pid;            /* a cached page */
+
+
+    e = eNOERROR;
+    for (i = 0; i < cache->nPages; i++) {
+        MAKE_PAGEID(pid, cache->root.volNo, cache->pages[i].pageNo);
+        if ((e2 = BfM_FreeTrain((TrainID*)&pid, PAGE_BUF)) < 0) e = e2;
+    }
+
+    cache->nPages = 0;
+    cache->nRefs = 0;
+    cache->stale = TRUE;
+
+    if (e < 0) ERR(e);
+
+    return(eNOERROR);
+
+}   /* edubtm_EmptyUpperCache() */
+
+
+
+/*@================================
+ * edubtm_FindCachedPage()
+ *================================*/
+/*
+ * Function: Two edubtm_FindCachedPage(btm_UpperCache*, ShortPageID)
+ *
+ * Description:
+ *  Find the page in the cache by a binary search on the page numbers.
+ *
+ * Returns:
+ *  index of the page in the cache, -1 if it is not cached
+ */
+Two edubtm_FindCachedPage(
+    btm_UpperCache              *cache,         /* IN the cache */
+    ShortPageID                 pageNo)         /* IN the page */
+{
+    Two                         low;            /* lower end of the binary search */
+    Two                         high;           /* upper end of the binary search */
+    Two                         mid;            /* middle of the binary search */
+
+
+    low = 0;
+    high = cache->nPages - 1;
+
+    while (low <= high) {
+        mid = (low + high) / 2;
+        if (cache->pages[mid].pageNo == pageNo) return(mid);
+        if (cache->pages[mid].pageNo < pageNo) low = mid + 1;
+        else high = mid - 1;
+    }
+
+    return(-1);
+
+}   /* edubtm_FindCachedPage() */
+
+
+
+/*@================================
+ * edubtm_SwizzleChildren()
+ *================================*/
+/*
+ * Function: void edubtm_SwizzleChildren(btm_UpperCache*)
+ *
+ * Description:
+ *  Resolve the child references of the cached pages whose children are
+ *  cached as well, i.e. of the pages above the lowest cached level, as
+ *  long as the references fit. The pages should be sorted already.
+ *
+ * Returns:
+ *  None
+ */
+void edubtm_SwizzleChildren(
+    btm_UpperCache              *cache)         /* INOUT the cache */
+{
+    Two                         i;              /* index of the cached pages */
+    Two                         j;              /* child No. */
+    Two                         k;              /* index of the child in the cache */
+    Boolean                     any;            /* TRUE if some child of the page is cached */
+    ShortPageID                 childNo;        /* a child */
+    BtreeInternal               *ppage;         /* a cached page */
+    btm_SwizzledRef             *ref;           /* a reference */
+
+
+    cache->nRefs = 0;
+
+    for (i = 0; i < cache->nPages; i++) {
+        ppage = &(cache->pages[i].page->bi);
+        cache->pages[i].nRefs = 0;
+
+        if ((ppage->hdr.flags & BTM_LEAFPARENT) ||
+            cache->nRefs + ppage->hdr.nSlots + 1 > BTM_MAXSWIZZLEDREFS) continue;
+
+        cache->pages[i].firstRef = cache->nRefs;
+        any = FALSE;
+
+        for (j = -1; j < ppage->hdr.nSlots; j++) {
+            if (j == -1) childNo = ppage->hdr.p0;
+            else childNo = ((btm_InternalEntry*)&(ppage->data[ppage->slot[-j]]))->spid;
+
+            k = edubtm_FindCachedPage(cache, childNo);
+            if (k >= 0) any = TRUE;
+
+            ref = &(cache->refs[cache->nRefs + j + 1]);
+            ref->pageNo = childNo;
+            ref->cacheIdx = k;
+        }
+
+        /* The lowest cached level keeps no references */
+        if (any) {
+            cache->pages[i].nRefs = ppage->hdr.nSlots + 1;
+            cache->nRefs += cache->pages[i].nRefs;
+        }
+    }
+
+}   /* edubtm_SwizzleChildren() */
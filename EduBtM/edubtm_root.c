@@ -58,6 +58,7 @@
  *
  * Exports:
  *  Four edubtm_root_insert(ObjectID*, PageID*, InternalItem*)
+ *  Four edubtm_root_delete(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*)
  */
 
 
@@ -65,6 +66,7 @@
 #include "EduBtM_common.h"
 #include "Util.h"
 #include "BfM.h"
+#include "OM_Internal.h"	/* for "SlottedPage" including catalog object */
 #include "EduBtM_Internal.h"
 
 
@@ -104,69 +106,149 @@ Four edubtm_root_insert(
     BtreeLeaf *nextPage;	/* pointer to a buffer holding next page of root */
     btm_InternalEntry *entry;	/* an internal entry */
     Boolean   isTmp;
+    Four      flags;		/* flags of the root page to keep in the new root */
+    Four      reserved;		/* PageNo of the meta page kept by the root */
+    Boolean   leafSplit;	/* TRUE if the split root was a leaf */
     
     /**/
-    MAKE_PAGEID(nextPid, root->volNo, item->spid);
-    printf("DBG : Welcome to call the btm_root_insert, item =");
-    for (int i = 0; i < item->klen; i++){
-        printf("%c", *(char *)(item->kval + i));
-    }
-    printf("\n");
-    
     /* Fix the pages to the buffer */ 
-    if((e = btm_AllocPage(catObjForFile, root, &newPid))<0) ERR(e);
-    if((e = edubtm_InitLeaf(&newPid, FALSE, FALSE))<0) ERR(e);
+    if((e = edubtm_AllocIndexPage(catObjForFile, root, &newPid))<0) ERR(e);
     if((e = BfM_GetNewTrain(&newPid, (char**)&newPage, PAGE_BUF))<0) ERR(e);
-    if((e = BfM_GetTrain(root, (char**)&rootPage, PAGE_BUF))<0) ERR(e);
-    if((e = BfM_GetTrain(&nextPid, (char**)&nextPage, PAGE_BUF))<0) ERR(e);
-
-    /* Copy rootPage to newPage  */
-    newPage->bl.hdr.flags = rootPage->bl.hdr.flags;
-    newPage->bl.hdr.nSlots = rootPage->bl.hdr.nSlots;
-    newPage->bl.hdr.free = rootPage->bl.hdr.free;    
-    newPage->bl.hdr.unused = rootPage->bl.hdr.unused;
-    
-    newPage->bl.hdr.pid = newPid;
-    newPage->bl.hdr.type = LEAF;
-    
-    for(int i = 0; i < PAGESIZE - BL_FIXED; i++){
-        *((char *)(newPage->bl.data)+i) = *((char *)(rootPage->bl.data)+i);
+    if((e = BfM_GetTrain(root, (char**)&rootPage, PAGE_BUF))<0) ERRB1(e, &newPid, PAGE_BUF);
+
+    /* Copy rootPage to newPage; a message buffer of the root goes with its entries */
+    memcpy((char*)newPage, (char*)rootPage, PAGESIZE);
+    newPage->any.hdr.pid = newPid;
+    newPage->any.hdr.type &= ~ROOT;
+    newPage->any.hdr.flags &= ~BTM_ROOTFLAGS;
+    newPage->any.hdr.reserved = NIL;
+
+    flags = rootPage->any.hdr.flags & BTM_ROOTFLAGS;
+    reserved = rootPage->any.hdr.reserved;
+    reserved = rootPage->any.hdr.reserved;
+
+    /* The split leaf root was linked with the page 'item->spid' */
+    leafSplit = (newPage->any.hdr.type & LEAF) ? TRUE : FALSE;
+    if(leafSplit){
+        MAKE_PAGEID(nextPid, root->volNo, item->spid);
+        if((e = BfM_GetTrain(&nextPid, (char**)&nextPage, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
+        nextPage->hdr.prevPage = newPid.pageNo;
+        if((e = BfM_SetDirty((TrainID*)&nextPid, PAGE_BUF))<0) ERRB1(e, &nextPid, PAGE_BUF);
+        if((e = BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF))<0) ERR(e);
     }
 
     /* Initiate root page as an internal root page */
     if((e = edubtm_InitInternal(root, TRUE, FALSE))<0) ERR(e);
-    
+    rootPage->bi.hdr.flags |= (flags & BTM_ROOTFLAGS);
+    rootPage->bi.hdr.reserved = reserved;
+    if(newPage->any.hdr.type & LEAF)
+        rootPage->bi.hdr.flags |= BTM_LEAFPARENT;
+
     /* Set parent-child realtionship */
     entry = (btm_InternalEntry *)((char*)(rootPage->bi.data) + rootPage->bi.hdr.free);
     entry->spid = item->spid;
     entry->klen = item->klen;
-    for (int i = 0; i < item->klen; i++){
-        *((char *)(entry->kval)+i) = *((char *)(item->kval)+i);
-    }
-
-    printf("DBG : spid = %d, klen = %d\n", entry->spid, entry->klen);
+    memcpy(entry->kval, item->kval, item->klen);
 
-    rootPage->bi.slot[0] = 0;    
+    rootPage->bi.slot[0] = rootPage->bi.hdr.free;
     rootPage->bi.hdr.p0 = newPid.pageNo;
     rootPage->bi.hdr.nSlots++;
     rootPage->bi.hdr.free = rootPage->bi.hdr.free + (OFFSET_OF(btm_InternalEntry, klen) + ALIGNED_LENGTH(sizeof(Two) + entry->klen));
 
-    if((newPage->any.hdr.type & LEAF)&&(nextPage->hdr.type & LEAF)){
-        newPage->bl.hdr.nextPage = nextPid.pageNo; 
-        nextPage->hdr.prevPage = newPid.pageNo;
-    }
-
     /* Set the DIRTY bits */
     if((e = BfM_SetDirty((TrainID*)&newPid, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
     if((e = BfM_SetDirty((TrainID*)root, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
-    if((e = BfM_SetDirty((TrainID*)&nextPid, PAGE_BUF))<0) ERRB1(e, root, PAGE_BUF);
 
     /* Unfix the pages from the buffer */ 
     if((e = BfM_FreeTrain((TrainID*)&newPid, PAGE_BUF))<0) ERR(e);
     if((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF))<0) ERR(e);
-    if((e = BfM_FreeTrain((TrainID*)&nextPid, PAGE_BUF))<0) ERR(e);
+
+    /* The tree has grown by a level; the cached upper levels are read again */
+    edubtm_StaleUpperCache(root);
+
+    /* The two leaves are the end leaves of the index */
+    if(leafSplit){
+        if((e = edubtm_NoteEndLeaves(catObjForFile, root, newPid.pageNo, item->spid))<0) ERR(e);
+    }
 
     /**/   
     return(eNOERROR);
     
 } /* edubtm_root_insert() */
+
+
+
+/*@================================
+ * edubtm_root_delete()
+ *================================*/
+/*
+ * Function: Four edubtm_root_delete(ObjectID*, PageID*, KeyDesc*, Pool*, DeallocListElem*)
+ *
+ * Description:
+ *  This routine is called when the root page is not half full. If the root
+ *  is an internal page having only 'p0', its child is moved into the root
+ *  by btm_root_delete(...).
+ *
+ *  The messages of such a root are all routed to 'p0'; they are pushed down
+ *  first so that they are not lost. The information which belongs to the
+ *  index rather than to the root node - the update modes in the flags and
+ *  the meta page in 'reserved' - is kept in the root page.
+ *
+ * Returns:
+ *  Error code
+ *    some errors caused by function calls
+ */
+Four edubtm_root_delete(
+    ObjectID        *catObjForFile, /* IN catalog object of B+ tree file */
+    PageID          *root,          /* IN root Page IDentifier */
+    KeyDesc         *kdesc,         /* IN a key descriptor */
+    Pool            *dlPool,        /* INOUT pool of dealloc list elements */
+    DeallocListElem *dlHead)        /* INOUT head of the dealloc list */
+{
+    Four      e;		/* error number */
+    Four      flags;		/* flags of the root page to keep */
+    Four      reserved;		/* PageNo of the meta page kept by the root */
+    Boolean   h;		/* TRUE if the root is split */
+    InternalItem item;		/* Internal item for the new root */
+    BtreePage *rootPage;	/* pointer to a buffer holding the root page */
+    SlottedPage *catPage;	/* buffer page containing the catalog object */
+    sm_CatOverlayForBtree *catEntry; /* pointer to Btree file catalog information */
+    PhysicalFileID pFid;	/* B+-tree file's FileID */
+
+
+    if ((e = BfM_GetTrain((TrainID*)catObjForFile, (char**)&catPage, PAGE_BUF)) < 0) ERR(e);
+    GET_PTR_TO_CATENTRY_FOR_BTREE(catObjForFile, catPage, catEntry);
+    MAKE_PHYSICALFILEID(pFid, catEntry->fid.volNo, catEntry->firstPage);
+    if ((e = BfM_FreeTrain((TrainID*)catObjForFile, PAGE_BUF)) < 0) ERR(e);
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rootPage, PAGE_BUF)) < 0) ERR(e);
+
+    h = FALSE;
+    if ((rootPage->any.hdr.type & INTERNAL) && rootPage->bi.hdr.nSlots == 0 &&
+        (rootPage->bi.hdr.flags & BTM_MSGBUFFER)) {
+        if ((e = edubtm_UnbufferPage(catObjForFile, &(rootPage->bi), kdesc, &h, &item)) < 0) ERRB1(e, root, PAGE_BUF);
+        if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    }
+
+    flags = rootPage->any.hdr.flags & BTM_ROOTFLAGS;
+    reserved = rootPage->any.hdr.reserved;
+
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    /* A split of 'p0' by the messages leaves the root more than one child */
+    if (h) {
+        if ((e = edubtm_root_insert(catObjForFile, root, &item)) < 0) ERR(e);
+        return(eNOERROR);
+    }
+
+    if ((e = btm_root_delete(&pFid, root, dlPool, dlHead)) < 0) ERR(e);
+
+    if ((e = BfM_GetTrain((TrainID*)root, (char**)&rootPage, PAGE_BUF)) < 0) ERR(e);
+    rootPage->any.hdr.flags = (rootPage->any.hdr.flags & ~BTM_ROOTFLAGS) | flags;
+    rootPage->any.hdr.reserved = reserved;
+    if ((e = BfM_SetDirty((TrainID*)root, PAGE_BUF)) < 0) ERRB1(e, root, PAGE_BUF);
+    if ((e = BfM_FreeTrain((TrainID*)root, PAGE_BUF)) < 0) ERR(e);
+
+    return(eNOERROR);
+
+} /* edubtm_root_delete() */